@@ -0,0 +1,51 @@
+// Benchmark firmware: configures ITM and DWT, runs library benchmark suites once and sends results to
+// BENCH_RESULT_PORT, to be read with `orbcode-trace-bench`. TPIU/SWO is expected to be configured by debug probe.
+
+#include ORBCODE_BENCH_DEVICE_HEADER
+
+#include "orbcode/benchmarks/library.h"
+#include "orbcode/trace/dwt.h"
+#include "orbcode/trace/itm.h"
+
+#define BENCH_RESULT_PORT 8U
+#define BENCH_WRITE_PORT 9U
+
+int main(void)
+{
+    // Measure with caches enabled, as applications run on cores that have them
+#if defined(__ICACHE_PRESENT) && (__ICACHE_PRESENT == 1U)
+    SCB_EnableICache();
+#endif
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+    SCB_EnableDCache();
+#endif
+
+    const DWTOptions dwt = {
+        .LSUCounterEvent = true,
+        .CPICounterEvent = true,
+        .SyncTap = DWTSyncTap24,
+        .CycleTap = DWTCycleTap6,
+        .SamplingPrescaler = 1,
+    };
+    DWTSetup(&dwt);
+
+    const ITMOptions itm = {
+        .TraceBusID = 1,
+        .GlobalTimestampFrequency = ITMGlobalTimestampFrequencyDisabled,
+        .LocalTimestampPrescaler = ITMLocalTimestampPrescalerNoPrescaling,
+        .EnableLocalTimestamp = false,
+        .ForwardDWT = false,
+        .EnableSyncPacket = true,
+        .EnabledStimulusPorts = (1UL << BENCH_RESULT_PORT) | (1UL << BENCH_WRITE_PORT),
+    };
+    ITMSetup(&itm);
+
+    TraceBenchRunLibrary(BENCH_RESULT_PORT, BENCH_WRITE_PORT);
+    TraceBenchRunComponents(BENCH_RESULT_PORT, BENCH_WRITE_PORT);
+
+    // Results are complete, halt when debugger is attached
+    for(;;)
+    {
+        __BKPT(0);
+    }
+}
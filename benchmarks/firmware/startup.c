@@ -0,0 +1,82 @@
+// Minimal startup for benchmark firmware: vector table, .data/.bss initialization and FPU enable. Symbols are
+// provided by firmware.ld.
+
+#include ORBCODE_BENCH_DEVICE_HEADER
+
+#include <stdint.h>
+
+extern uint32_t __stack_top;
+extern uint32_t __data_load;
+extern uint32_t __data_start;
+extern uint32_t __data_end;
+extern uint32_t __bss_start;
+extern uint32_t __bss_end;
+
+extern int main(void);
+
+void Reset_Handler(void);
+
+static void DefaultHandler(void)
+{
+    for(;;)
+    {
+    }
+}
+
+void NMI_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void HardFault_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void MemManage_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void BusFault_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void UsageFault_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void SecureFault_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void SVC_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void DebugMon_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void PendSV_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+void SysTick_Handler(void) __attribute__((weak, alias("DefaultHandler")));
+
+// Benchmarks do not use interrupts, only system exceptions are listed
+__attribute__((section(".vectors"), used)) static void (*const Vectors[16])(void) = {
+    (void (*)(void))(&__stack_top),
+    Reset_Handler,
+    NMI_Handler,
+    HardFault_Handler,
+    MemManage_Handler,
+    BusFault_Handler,
+    UsageFault_Handler,
+    SecureFault_Handler,
+    0,
+    0,
+    0,
+    SVC_Handler,
+    DebugMon_Handler,
+    0,
+    PendSV_Handler,
+    SysTick_Handler,
+};
+
+void Reset_Handler(void)
+{
+#if defined(__FPU_USED) && (__FPU_USED == 1U)
+    // Full access to CP10 and CP11, compiler may use FPU registers anywhere
+    SCB->CPACR |= (3UL << 20) | (3UL << 22);
+    __DSB();
+    __ISB();
+#endif
+
+    const uint32_t* source = &__data_load;
+    for(uint32_t* destination = &__data_start; destination < &__data_end;)
+    {
+        *destination++ = *source++;
+    }
+
+    for(uint32_t* destination = &__bss_start; destination < &__bss_end;)
+    {
+        *destination++ = 0;
+    }
+
+    main();
+
+    for(;;)
+    {
+    }
+}
@@ -0,0 +1,380 @@
+// Measures library write paths on host against simulated trace registers (see orbcode/sim/device.hpp). Output of
+// every benchmark is decoded and compared with its input before it is timed, so the tool doubles as a smoke test.
+
+#include "orbcode/sim/device.hpp"
+
+#include "orbcode/trace/delta.h"
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/itm_buffer.h"
+#include "orbcode/trace/itm_frame.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "orbcode/decoder/delta.hpp"
+#include "orbcode/decoder/frame.hpp"
+
+#if defined(__linux__)
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+using namespace orbcode;
+
+namespace
+{
+    constexpr uint8_t Port = 1;
+    constexpr size_t DeltaChannels = 8;
+
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " [--drain <bytes>] [--fifo <bytes>] [--min-time <ms>] [--csv]\n"
+                  << "\n"
+                  << "Runs ITMWriteBuffer, ring buffer, framing and delta compression against simulated ITM and\n"
+                  << "prints throughput and instructions per byte (when hardware counters are available).\n"
+                  << "\n"
+                  << "  --drain     Bytes drained from ITM FIFO per stimulus port access (default: 0, never full)\n"
+                  << "  --fifo      ITM FIFO size in bytes (default: 16)\n"
+                  << "  --min-time  Minimum measured time per benchmark in milliseconds (default: 200)\n"
+                  << "  --csv       Print results as CSV\n";
+    }
+
+    // Counts retired user-space instructions of this thread, unavailable without perf_event support
+    class InstructionCounter
+    {
+    public:
+        InstructionCounter()
+        {
+#if defined(__linux__)
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+        }
+
+        ~InstructionCounter()
+        {
+#if defined(__linux__)
+            if(fd_ >= 0)
+            {
+                close(fd_);
+            }
+#endif
+        }
+
+        bool available() const
+        {
+            return fd_ >= 0;
+        }
+
+        void start()
+        {
+#if defined(__linux__)
+            if(fd_ >= 0)
+            {
+                ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        uint64_t stop()
+        {
+            uint64_t count = 0;
+#if defined(__linux__)
+            if(fd_ >= 0)
+            {
+                ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+                if(read(fd_, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count)))
+                {
+                    count = 0;
+                }
+            }
+#endif
+            return count;
+        }
+
+    private:
+        int fd_ = -1;
+    };
+
+    struct Options
+    {
+        sim::FifoOptions Fifo;
+        double MinTime = 0.2;
+        bool Csv = false;
+    };
+
+    struct Benchmark
+    {
+        std::string Name;
+        size_t Size;
+        size_t Offset;
+        // Bytes of input processed by single call of Run
+        size_t Bytes;
+        std::function<void()> Run;
+        // Checks output captured from single call of Run
+        std::function<bool(const std::vector<uint8_t>&)> Verify;
+    };
+
+    struct Result
+    {
+        double BytesPerSecond = 0;
+        double InstructionsPerByte = NAN;
+        double StallsPerCall = 0;
+    };
+
+    Result measure(const Benchmark& benchmark, const Options& options, InstructionCounter& counter)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Double iteration count until run takes at least minimum time
+        uint64_t iterations = 1;
+        for(;;)
+        {
+            sim::Device.reset(options.Fifo);
+            sim::Device.Itm.TCR = ITM_TCR_ITMENA_Msk;
+            sim::Device.Itm.TER = 1UL << Port;
+
+            counter.start();
+            const Clock::time_point start = Clock::now();
+            for(uint64_t i = 0; i < iterations; i++)
+            {
+                benchmark.Run();
+            }
+            const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            const uint64_t instructions = counter.stop();
+
+            if(elapsed >= options.MinTime || iterations >= (1ULL << 40))
+            {
+                const double bytes = static_cast<double>(benchmark.Bytes) * static_cast<double>(iterations);
+                Result result;
+                result.BytesPerSecond = elapsed > 0 ? bytes / elapsed : 0;
+                if(counter.available() && instructions > 0)
+                {
+                    result.InstructionsPerByte = static_cast<double>(instructions) / bytes;
+                }
+                result.StallsPerCall =
+                    static_cast<double>(sim::Device.statistics().Stalls) / static_cast<double>(iterations);
+                return result;
+            }
+            iterations *= 2;
+        }
+    }
+
+    bool verify(const Benchmark& benchmark, const Options& options)
+    {
+        sim::Device.reset(options.Fifo);
+        sim::Device.Itm.TCR = ITM_TCR_ITMENA_Msk;
+        sim::Device.Itm.TER = 1UL << Port;
+        sim::Device.capture(true);
+        benchmark.Run();
+        sim::Device.capture(false);
+        return sim::Device.statistics().Overflows == 0 && benchmark.Verify(sim::Device.output(Port));
+    }
+
+    std::vector<uint8_t> pattern(size_t size)
+    {
+        std::vector<uint8_t> data(size);
+        for(size_t i = 0; i < size; i++)
+        {
+            data[i] = static_cast<uint8_t>(i * 7U + 1U);
+        }
+        return data;
+    }
+
+    // Source buffers word-aligned, benchmarks add offset
+    alignas(4) uint8_t Source[1024 + 4];
+    alignas(4) uint8_t RingStorage[4096];
+    ITMBuffer Ring;
+    TraceDeltaEncoder Delta;
+    int32_t DeltaSamples[DeltaChannels];
+
+    std::vector<Benchmark> benchmarks()
+    {
+        std::memcpy(Source, pattern(sizeof(Source)).data(), sizeof(Source));
+        std::vector<Benchmark> list;
+
+        for(size_t size : {1, 4, 16, 64, 256, 1024})
+        {
+            for(size_t offset = 0; offset < 4; offset++)
+            {
+                const uint8_t* data = Source + offset;
+                list.push_back({"ITMWriteBuffer", size, offset, size,
+                                [data, size]() { ITMWriteBuffer(Port, data, size); },
+                                [data, size](const std::vector<uint8_t>& output) {
+                                    return output == std::vector<uint8_t>(data, data + size);
+                                }});
+            }
+        }
+
+        for(size_t size : {16, 64, 256})
+        {
+            for(size_t offset : {0, 1})
+            {
+                const uint8_t* data = Source + offset;
+                list.push_back({"ITMBufferWrite+Drain", size, offset, size,
+                                [data, size]() {
+                                    ITMBufferWrite(&Ring, data, size);
+                                    ITMBufferDrain(&Ring, ITM_BUFFER_DRAIN_ALL);
+                                },
+                                [data, size](const std::vector<uint8_t>& output) {
+                                    return output == std::vector<uint8_t>(data, data + size);
+                                }});
+            }
+        }
+
+        for(size_t size : {16, 64, 256})
+        {
+            const uint8_t* data = Source;
+            list.push_back({"ITMFrameWrite", size, 0, size, [data, size]() { ITMFrameWrite(Port, data, size); },
+                            [data, size](const std::vector<uint8_t>& output) {
+                                std::vector<uint8_t> decoded;
+                                decoder::FrameDecoder frames(
+                                    [&decoded](const uint8_t* frame, size_t frameSize) {
+                                        decoded.assign(frame, frame + frameSize);
+                                    },
+                                    ITM_FRAME_CRC != 0);
+                                frames.feed(output.data(), output.size());
+                                return decoded == std::vector<uint8_t>(data, data + size);
+                            }});
+        }
+
+        list.push_back({"TraceDeltaWrite", DeltaChannels, 0, sizeof(DeltaSamples),
+                        []() {
+                            // Slowly changing samples, most deltas fit single varint byte
+                            for(size_t i = 0; i < DeltaChannels; i++)
+                            {
+                                DeltaSamples[i] += static_cast<int32_t>(i % 3) - 1;
+                            }
+                            TraceDeltaWrite(&Delta, DeltaSamples);
+                        },
+                        [](const std::vector<uint8_t>& output) {
+                            std::vector<int32_t> decoded;
+                            decoder::DeltaDecoder records(
+                                [&decoded](const decoder::DeltaRecord& record) { decoded = record.Samples; });
+                            records.feed(output.data(), output.size());
+                            return decoded == std::vector<int32_t>(DeltaSamples, DeltaSamples + DeltaChannels);
+                        }});
+
+        return list;
+    }
+
+    void resetState()
+    {
+        ITMBufferInit(&Ring, Port, RingStorage, sizeof(RingStorage));
+        TraceDeltaInit(&Delta, Port, 0, DeltaChannels, 1);
+        for(size_t i = 0; i < DeltaChannels; i++)
+        {
+            DeltaSamples[i] = static_cast<int32_t>(i * 1000);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--drain") == 0 && i + 1 < argc)
+        {
+            options.Fifo.DrainPerAccess = std::strtod(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--fifo") == 0 && i + 1 < argc)
+        {
+            options.Fifo.Depth = std::strtoul(argv[++i], nullptr, 0);
+        }
+        else if(std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            options.MinTime = std::strtod(argv[++i], nullptr) / 1000.0;
+        }
+        else if(std::strcmp(argv[i], "--csv") == 0)
+        {
+            options.Csv = true;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(options.Fifo.DrainPerAccess > 0 && options.Fifo.Depth < 4)
+    {
+        std::cerr << "FIFO must hold at least one word\n";
+        return 2;
+    }
+
+    InstructionCounter counter;
+    if(options.Csv)
+    {
+        std::printf("name,size,offset,bytes_per_second,instructions_per_byte,stalls_per_call\n");
+    }
+    else
+    {
+        std::printf("%-22s %6s %6s %14s %12s %12s\n", "Benchmark", "Size", "Offset", "MB/s", "Instr/byte",
+                    "Stalls/call");
+    }
+
+    int failed = 0;
+    for(const Benchmark& benchmark : benchmarks())
+    {
+        // Delta encoder keys only first record, so each stage starts from fresh state
+        resetState();
+        if(!verify(benchmark, options))
+        {
+            std::cerr << benchmark.Name << "/" << benchmark.Size << "/+" << benchmark.Offset
+                      << ": output does not match input\n";
+            failed++;
+            continue;
+        }
+
+        resetState();
+        const Result result = measure(benchmark, options, counter);
+        if(options.Csv)
+        {
+            // Empty field when instructions were not counted
+            std::printf("%s,%zu,%zu,%.0f,", benchmark.Name.c_str(), benchmark.Size, benchmark.Offset,
+                        result.BytesPerSecond);
+            if(!std::isnan(result.InstructionsPerByte))
+            {
+                std::printf("%.3f", result.InstructionsPerByte);
+            }
+            std::printf(",%.3f\n", result.StallsPerCall);
+        }
+        else
+        {
+            char instructions[16] = "-";
+            if(!std::isnan(result.InstructionsPerByte))
+            {
+                std::snprintf(instructions, sizeof(instructions), "%.2f", result.InstructionsPerByte);
+            }
+            std::printf("%-22s %6zu %6zu %14.1f %12s %12.2f\n", benchmark.Name.c_str(), benchmark.Size,
+                        benchmark.Offset, result.BytesPerSecond / 1e6, instructions, result.StallsPerCall);
+        }
+    }
+
+    if(!counter.available() && !options.Csv)
+    {
+        std::printf("\nInstruction counter not available (perf_event_open failed), instructions per byte not "
+                    "measured\n");
+    }
+
+    return failed == 0 ? 0 : 1;
+}
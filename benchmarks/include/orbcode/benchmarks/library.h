@@ -0,0 +1,40 @@
+/** @file */
+
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Runs benchmarks of library write paths and sends results to stimulus port
+     *
+     * Measures ITMWrite8(), ITMWrite16(), ITMWrite32() and ITMWriteBuffer() with sizes 1-256 bytes and source
+     * alignments 0-3. Writes go to @p writePort, which must be enabled and should not be decoded by host. Blocking
+     * writes wait for ITM FIFO, so results depend on trace link speed once FIFO is full.
+     *
+     * ITM and DWT (cycle counter, CPI and LSU counters) must be configured before calling this function. Results are
+     * printed by `orbcode-trace-bench`.
+     *
+     * @param resultPort Stimulus port for benchmark results
+     * @param writePort Stimulus port used by benchmarked writes
+     */
+    void TraceBenchRunLibrary(uint8_t resultPort, uint8_t writePort);
+
+    /**
+     * @brief Runs benchmarks of buffered writes, framing, logging, profiler, histograms and delta compression
+     *
+     * Measures ITMBufferWrite(), ITMFrameWrite(), @ref TRACE_LOG, @ref TRACE_SCOPE, TraceHistogramRecord(),
+     * TraceHistogramFlush(), TraceDeltaEncode() and TraceDeltaWrite(). Output of all of them goes to @p writePort.
+     * Requirements and result reporting are the same as for TraceBenchRunLibrary().
+     *
+     * @param resultPort Stimulus port for benchmark results
+     * @param writePort Stimulus port used by benchmarked writes
+     */
+    void TraceBenchRunComponents(uint8_t resultPort, uint8_t writePort);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,77 @@
+#include ORBCODE_BENCH_DEVICE_HEADER
+
+#include "orbcode/benchmarks/library.h"
+#include "orbcode/trace/bench.h"
+#include "orbcode/trace/itm.h"
+
+#define BENCH_RUNS 32U
+#define BENCH_WARMUP_RUNS 4U
+
+typedef struct
+{
+    uint8_t Port;
+    const void* Data;
+    size_t Size;
+} WriteContext;
+
+static uint32_t Source[(256 + 4) / 4];
+
+static void BenchWrite8(void* context)
+{
+    ITMWrite8(((const WriteContext*)context)->Port, 0x5A);
+}
+
+static void BenchWrite16(void* context)
+{
+    ITMWrite16(((const WriteContext*)context)->Port, 0x5AA5);
+}
+
+static void BenchWrite32(void* context)
+{
+    ITMWrite32(((const WriteContext*)context)->Port, 0x5AA55AA5UL);
+}
+
+static void BenchWriteBuffer(void* context)
+{
+    const WriteContext* write = (const WriteContext*)context;
+    ITMWriteBuffer(write->Port, write->Data, write->Size);
+}
+
+// Name of ITMWriteBuffer benchmark: size and offset of source from word-aligned address
+#define BENCH_WRITE_BUFFER(size, offset) {"ITMWriteBuffer/" #size "/+" #offset, (size), (offset)}
+
+static const struct
+{
+    const char* Name;
+    size_t Size;
+    size_t Offset;
+} WriteBufferCases[] = {
+    BENCH_WRITE_BUFFER(1, 0),   BENCH_WRITE_BUFFER(3, 0),   BENCH_WRITE_BUFFER(3, 1),   BENCH_WRITE_BUFFER(4, 0),
+    BENCH_WRITE_BUFFER(4, 1),   BENCH_WRITE_BUFFER(4, 2),   BENCH_WRITE_BUFFER(4, 3),   BENCH_WRITE_BUFFER(16, 0),
+    BENCH_WRITE_BUFFER(16, 1),  BENCH_WRITE_BUFFER(16, 2),  BENCH_WRITE_BUFFER(16, 3),  BENCH_WRITE_BUFFER(64, 0),
+    BENCH_WRITE_BUFFER(64, 1),  BENCH_WRITE_BUFFER(64, 2),  BENCH_WRITE_BUFFER(64, 3),  BENCH_WRITE_BUFFER(256, 0),
+    BENCH_WRITE_BUFFER(256, 1), BENCH_WRITE_BUFFER(256, 2), BENCH_WRITE_BUFFER(256, 3),
+};
+
+void TraceBenchRunLibrary(uint8_t resultPort, uint8_t writePort)
+{
+    WriteContext single = {writePort, NULL, 0};
+    const TraceBenchmark singles[] = {
+        {"ITMWrite8", BenchWrite8, &single, BENCH_RUNS},
+        {"ITMWrite16", BenchWrite16, &single, BENCH_RUNS},
+        {"ITMWrite32", BenchWrite32, &single, BENCH_RUNS},
+    };
+    TraceBenchRun(resultPort, singles, sizeof(singles) / sizeof(singles[0]), BENCH_WARMUP_RUNS, true);
+
+    for(size_t i = 0; i < sizeof(Source); i++)
+    {
+        ((uint8_t*)Source)[i] = (uint8_t)(i * 7U + 1U);
+    }
+
+    for(size_t i = 0; i < sizeof(WriteBufferCases) / sizeof(WriteBufferCases[0]); i++)
+    {
+        WriteContext write = {writePort, (const uint8_t*)Source + WriteBufferCases[i].Offset, WriteBufferCases[i].Size};
+        const TraceBenchmark benchmark = {WriteBufferCases[i].Name, BenchWriteBuffer, &write, BENCH_RUNS};
+        TraceBenchRun(resultPort, &benchmark, 1, BENCH_WARMUP_RUNS, true);
+    }
+}
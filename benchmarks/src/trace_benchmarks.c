@@ -0,0 +1,160 @@
+#include ORBCODE_BENCH_DEVICE_HEADER
+
+#include "orbcode/benchmarks/library.h"
+#include "orbcode/trace/bench.h"
+#include "orbcode/trace/delta.h"
+#include "orbcode/trace/histogram.h"
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/itm_buffer.h"
+#include "orbcode/trace/itm_frame.h"
+#include "orbcode/trace/log.h"
+
+// Profiler records go to ring buffer owned by benchmarks, application may define its own TraceProfileBuffer
+static ITMBuffer ProfileBuffer;
+#define ORBCODE_TRACE_PROFILE_WRITE(data, size) ITMBufferWrite(&ProfileBuffer, (data), (size))
+#include "orbcode/trace/profile.h"
+
+#define BENCH_RUNS 32U
+#define BENCH_WARMUP_RUNS 4U
+#define BENCH_DELTA_CHANNELS 8U
+#define BENCH_HISTOGRAM_SUB_BUCKET_BITS 3U
+
+typedef struct
+{
+    uint8_t Port;
+    const void* Data;
+    size_t Size;
+} WriteContext;
+
+static uint32_t Source[64 / 4];
+
+// Large enough for warm-up and measured runs of each benchmark without dropping records
+static uint32_t RingStorage[4096 / 4];
+static ITMBuffer Ring;
+static uint32_t ProfileStorage[1024 / 4];
+
+static uint32_t HistogramBuckets[TRACE_HISTOGRAM_BUCKETS(BENCH_HISTOGRAM_SUB_BUCKET_BITS)];
+static TraceHistogram Histogram;
+static uint32_t HistogramValue;
+
+static TraceDeltaEncoder Delta;
+static int32_t DeltaSamples[BENCH_DELTA_CHANNELS];
+static uint8_t DeltaRecord[TRACE_DELTA_MAX_RECORD_SIZE(BENCH_DELTA_CHANNELS)];
+
+static void BenchBufferWrite(void* context)
+{
+    const WriteContext* write = (const WriteContext*)context;
+    ITMBufferWrite(&Ring, write->Data, write->Size);
+}
+
+static void BenchBufferWriteDrain(void* context)
+{
+    const WriteContext* write = (const WriteContext*)context;
+    ITMBufferWrite(&Ring, write->Data, write->Size);
+    ITMBufferDrain(&Ring, ITM_BUFFER_DRAIN_ALL);
+}
+
+static void BenchFrameWrite(void* context)
+{
+    const WriteContext* write = (const WriteContext*)context;
+    ITMFrameWrite(write->Port, write->Data, write->Size);
+}
+
+static void BenchLog(void* context)
+{
+    const WriteContext* write = (const WriteContext*)context;
+    TRACE_LOG(write->Port, "Benchmark %u: %u", write->Size, Source[0]);
+}
+
+static void BenchScope(void* context)
+{
+    (void)context;
+    TRACE_SCOPE(1);
+}
+
+static void BenchHistogramRecord(void* context)
+{
+    (void)context;
+    // Values spread over many buckets
+    HistogramValue = HistogramValue * 1664525UL + 1013904223UL;
+    TraceHistogramRecord(&Histogram, HistogramValue >> (HistogramValue & 31U));
+}
+
+static void BenchHistogramFlush(void* context)
+{
+    TraceHistogram* const histograms[] = {&Histogram};
+    TraceHistogramFlush(((const WriteContext*)context)->Port, histograms, 1, false);
+}
+
+static void UpdateDeltaSamples(void)
+{
+    // Slowly changing samples, most deltas fit single varint byte
+    for(size_t i = 0; i < BENCH_DELTA_CHANNELS; i++)
+    {
+        DeltaSamples[i] += (int32_t)(i % 3U) - 1;
+    }
+}
+
+static void BenchDeltaEncode(void* context)
+{
+    (void)context;
+    UpdateDeltaSamples();
+    TraceDeltaEncode(&Delta, DeltaSamples, DeltaRecord);
+}
+
+static void BenchDeltaWrite(void* context)
+{
+    (void)context;
+    UpdateDeltaSamples();
+    TraceDeltaWrite(&Delta, DeltaSamples);
+}
+
+static void RunOne(uint8_t resultPort, const char* name, TraceBenchFunction function, void* context)
+{
+    const TraceBenchmark benchmark = {name, function, context, BENCH_RUNS};
+    TraceBenchRun(resultPort, &benchmark, 1, BENCH_WARMUP_RUNS, true);
+}
+
+void TraceBenchRunComponents(uint8_t resultPort, uint8_t writePort)
+{
+    for(size_t i = 0; i < sizeof(Source); i++)
+    {
+        ((uint8_t*)Source)[i] = (uint8_t)(i * 7U + 1U);
+    }
+
+    WriteContext write16 = {writePort, Source, 16};
+    WriteContext write64 = {writePort, Source, 64};
+
+    // Ring buffer is reset before each benchmark so that every one starts with empty buffer
+    ITMBufferInit(&Ring, writePort, RingStorage, sizeof(RingStorage));
+    RunOne(resultPort, "ITMBufferWrite/16", BenchBufferWrite, &write16);
+    ITMBufferInit(&Ring, writePort, RingStorage, sizeof(RingStorage));
+    RunOne(resultPort, "ITMBufferWrite/64", BenchBufferWrite, &write64);
+    ITMBufferInit(&Ring, writePort, RingStorage, sizeof(RingStorage));
+    RunOne(resultPort, "ITMBufferWrite+Drain/16", BenchBufferWriteDrain, &write16);
+    RunOne(resultPort, "ITMBufferWrite+Drain/64", BenchBufferWriteDrain, &write64);
+
+    RunOne(resultPort, "ITMFrameWrite/16", BenchFrameWrite, &write16);
+    RunOne(resultPort, "ITMFrameWrite/64", BenchFrameWrite, &write64);
+
+    RunOne(resultPort, "TRACE_LOG/2", BenchLog, &write16);
+
+    ITMBufferInit(&ProfileBuffer, writePort, ProfileStorage, sizeof(ProfileStorage));
+    RunOne(resultPort, "TRACE_SCOPE", BenchScope, NULL);
+
+    TraceHistogramInit(&Histogram, 1, BENCH_HISTOGRAM_SUB_BUCKET_BITS, HistogramBuckets,
+                       sizeof(HistogramBuckets) / sizeof(HistogramBuckets[0]));
+    HistogramValue = 1;
+    RunOne(resultPort, "TraceHistogramRecord", BenchHistogramRecord, NULL);
+    WriteContext flush = {writePort, NULL, 0};
+    RunOne(resultPort, "TraceHistogramFlush", BenchHistogramFlush, &flush);
+
+    for(size_t i = 0; i < BENCH_DELTA_CHANNELS; i++)
+    {
+        DeltaSamples[i] = (int32_t)(i * 1000U);
+    }
+    TraceDeltaInit(&Delta, writePort, 0, BENCH_DELTA_CHANNELS, 0);
+    TraceDeltaEncode(&Delta, DeltaSamples, DeltaRecord);
+    RunOne(resultPort, "TraceDeltaEncode/8", BenchDeltaEncode, NULL);
+    RunOne(resultPort, "TraceDeltaWrite/8", BenchDeltaWrite, NULL);
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_bench Benchmark result decoder
+         * @ingroup decoder
+         *
+         * @brief Decodes benchmark results sent by TraceBenchReport() (see @ref bench)
+         *
+         * @{
+         */
+
+        /**
+         * @brief First word of every benchmark result record (matches `TRACE_BENCH_MAGIC`)
+         */
+        constexpr uint32_t BenchMagic = 0x48434E42;
+
+        /**
+         * @brief Current version of benchmark result record format (matches `TRACE_BENCH_VERSION`)
+         *
+         * Records of version 1 (without PMU counters) are decoded as well.
+         */
+        constexpr uint8_t BenchVersion = 2;
+
+        /**
+         * @brief Sum of PMU counter increments reported with benchmark result
+         */
+        struct BenchPmuCounter
+        {
+            /**
+             * @brief PMU event number (`ARM_PMU_*`), see pmuEventName()
+             */
+            uint16_t Event = 0;
+            /**
+             * @brief Sum of counter increments over all runs
+             */
+            uint32_t Sum = 0;
+        };
+
+        /**
+         * @brief Benchmark result received from target
+         */
+        struct BenchResult
+        {
+            /**
+             * @brief Benchmark name
+             */
+            std::string Name;
+            /**
+             * @brief Number of measured runs
+             */
+            uint32_t Runs = 0;
+            /**
+             * @brief Minimum number of cycles
+             */
+            uint32_t Min = 0;
+            /**
+             * @brief Median number of cycles
+             */
+            uint32_t Median = 0;
+            /**
+             * @brief Maximum number of cycles
+             */
+            uint32_t Max = 0;
+            /**
+             * @brief Sum of `CPICNT` increments over all runs
+             */
+            uint32_t CPI = 0;
+            /**
+             * @brief Sum of `LSUCNT` increments over all runs
+             */
+            uint32_t LSU = 0;
+            /**
+             * @brief CPI and LSU sums are valid
+             */
+            bool Counters = false;
+            /**
+             * @brief PMU counter sums (empty when target reports no PMU counters)
+             */
+            std::vector<BenchPmuCounter> Pmu;
+        };
+
+        /**
+         * @brief Streaming decoder of stimulus port data carrying benchmark results
+         *
+         * Searches for @ref BenchMagic, so decoding resynchronizes after data loss at next record. Magic word is checked
+         * inside records too: record cut short by lost words is discarded when next one starts. Measurement or name word
+         * equal to magic is read as start of new record (discarding current one).
+         */
+        class BenchDecoder
+        {
+        public:
+            /**
+             * @brief Callback invoked for each complete result
+             */
+            using Callback = std::function<void(const BenchResult&)>;
+
+            /**
+             * @brief Creates decoder
+             *
+             * @param callback Callback invoked for each result
+             */
+            explicit BenchDecoder(Callback callback);
+
+            /**
+             * @brief Feeds data received from stimulus port
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+        private:
+            void word(uint32_t value);
+
+            Callback callback_;
+            bool synchronized_ = false;
+            uint32_t window_ = 0;
+            size_t windowBytes_ = 0;
+            uint32_t word_ = 0;
+            size_t wordBytes_ = 0;
+            size_t words_ = 0;
+            size_t nameLength_ = 0;
+            size_t pmuCounters_ = 0;
+            BenchResult result_;
+        };
+
+        /** @} */
+    }
+}
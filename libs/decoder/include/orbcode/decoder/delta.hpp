@@ -0,0 +1,161 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_delta Delta-compressed samples decoder
+         * @ingroup decoder
+         *
+         * @brief Decodes records sent by TraceDeltaWrite() (see @ref delta)
+         *
+         * @{
+         */
+
+        /**
+         * @brief Maximum number of channels in single stream (matches `TRACE_DELTA_MAX_CHANNELS`)
+         */
+        constexpr size_t DeltaMaxChannels = 16;
+
+        /**
+         * @brief Maximum number of streams on single stimulus port (matches `TRACE_DELTA_MAX_STREAMS`)
+         */
+        constexpr size_t DeltaMaxStreams = 8;
+
+        /**
+         * @brief Flag in record header set for key records (matches `TRACE_DELTA_FLAG_KEY`)
+         */
+        constexpr uint8_t DeltaFlagKey = 0x80;
+
+        /**
+         * @brief Decoded record
+         */
+        struct DeltaRecord
+        {
+            /**
+             * @brief Stream ID
+             */
+            uint8_t Stream = 0;
+            /**
+             * @brief Record sequence number
+             */
+            uint8_t Sequence = 0;
+            /**
+             * @brief Record was key record
+             */
+            bool Key = false;
+            /**
+             * @brief One sample per channel
+             */
+            std::vector<int32_t> Samples;
+        };
+
+        /**
+         * @brief Streaming decoder of stimulus port data carrying delta-compressed records
+         *
+         * Records of stream are reported only after its first key record. Gap in sequence numbers (lost records) stops
+         * reporting stream until next key record.
+         */
+        class DeltaDecoder
+        {
+        public:
+            /**
+             * @brief Callback invoked for each decoded record
+             */
+            using Callback = std::function<void(const DeltaRecord&)>;
+
+            /**
+             * @brief Decoder counters
+             */
+            struct Statistics
+            {
+                /**
+                 * @brief Number of reported records
+                 */
+                uint64_t Records = 0;
+                /**
+                 * @brief Number of records missing according to sequence numbers
+                 */
+                uint64_t Lost = 0;
+                /**
+                 * @brief Number of received records not reported while waiting for key record
+                 */
+                uint64_t Skipped = 0;
+                /**
+                 * @brief Number of malformed records (varint too long, record cut by reset())
+                 */
+                uint64_t Errors = 0;
+            };
+
+            /**
+             * @brief Creates decoder
+             *
+             * @param callback Callback invoked for each record
+             */
+            explicit DeltaDecoder(Callback callback);
+
+            /**
+             * @brief Feeds data received from stimulus port
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+            /**
+             * @brief Discards partially received record
+             *
+             * Call before each frame when records are written with ITMFrameWrite(). Streams stay synchronized, lost
+             * records are detected from sequence numbers.
+             */
+            void reset();
+
+            /**
+             * @brief Returns decoder counters
+             */
+            const Statistics& statistics() const
+            {
+                return statistics_;
+            }
+
+        private:
+            enum class State
+            {
+                Header,
+                Sequence,
+                Sample,
+            };
+
+            struct Stream
+            {
+                bool Synchronized = false;
+                uint8_t Channels = 0;
+                uint8_t NextSequence = 0;
+                uint32_t Previous[DeltaMaxChannels] = {};
+            };
+
+            void finishRecord();
+
+            Callback callback_;
+            State state_ = State::Header;
+            uint8_t header_ = 0;
+            uint8_t sequence_ = 0;
+            uint32_t zigzag_[DeltaMaxChannels] = {};
+            size_t channel_ = 0;
+            uint32_t varint_ = 0;
+            unsigned varintShift_ = 0;
+            Stream streams_[DeltaMaxStreams];
+            DeltaRecord record_;
+            Statistics statistics_;
+        };
+
+        /** @} */
+    }
+}
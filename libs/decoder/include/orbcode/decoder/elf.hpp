@@ -0,0 +1,231 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder Host-side decoding
+         *
+         * @brief C++ library for decoding trace data produced by libtrace on host computer
+         *
+         * Built when `ORBCODE_LIBTRACE_BUILD_HOST` CMake option is enabled (default when not cross-compiling) and available
+         * as `Orbcode::TraceDecoder` target.
+         */
+
+        /**
+         * @defgroup decoder_elf ELF reader
+         * @ingroup decoder
+         *
+         * @brief Minimal reader of little-endian ELF32/ELF64 files
+         *
+         * @{
+         */
+
+        /**
+         * @brief Error raised when ELF file cannot be read or is malformed
+         */
+        class ElfError : public std::runtime_error
+        {
+        public:
+            using std::runtime_error::runtime_error;
+        };
+
+        /**
+         * @brief Section header
+         */
+        struct ElfSection
+        {
+            /**
+             * @brief Section name
+             */
+            std::string Name;
+            /**
+             * @brief Section type (`sh_type`)
+             */
+            uint32_t Type;
+            /**
+             * @brief Section flags (`sh_flags`)
+             */
+            uint64_t Flags;
+            /**
+             * @brief Virtual address of section
+             */
+            uint64_t Address;
+            /**
+             * @brief Offset of section data in file
+             */
+            uint64_t Offset;
+            /**
+             * @brief Size of section
+             */
+            uint64_t Size;
+            /**
+             * @brief Index of associated section (`sh_link`, e.g. string table of symbol table)
+             */
+            uint32_t Link;
+        };
+
+        /**
+         * @brief Symbol table entry
+         */
+        struct ElfSymbol
+        {
+            /**
+             * @brief Symbol name
+             */
+            std::string Name;
+            /**
+             * @brief Symbol value, address of functions and objects
+             */
+            uint64_t Address;
+            /**
+             * @brief Size of object or function in bytes (0 if unknown)
+             */
+            uint64_t Size;
+            /**
+             * @brief Symbol type (`ELF_ST_TYPE(st_info)`)
+             */
+            uint8_t Type;
+            /**
+             * @brief Symbol binding (`ELF_ST_BIND(st_info)`)
+             */
+            uint8_t Binding;
+        };
+
+        /**
+         * @brief ELF file loaded into memory
+         */
+        class ElfFile
+        {
+        public:
+            /**
+             * @brief `SHT_NOBITS` section type (section occupies no space in file)
+             */
+            static constexpr uint32_t SectionTypeNoBits = 8;
+
+            /**
+             * @brief `SHF_ALLOC` section flag
+             */
+            static constexpr uint64_t SectionFlagAlloc = 2;
+
+            /**
+             * @brief `SHT_SYMTAB` section type
+             */
+            static constexpr uint32_t SectionTypeSymbolTable = 2;
+
+            /**
+             * @brief `STT_FUNC` symbol type
+             */
+            static constexpr uint8_t SymbolTypeFunction = 2;
+
+            /**
+             * @brief `STB_GLOBAL` symbol binding
+             */
+            static constexpr uint8_t SymbolBindingGlobal = 1;
+
+            /**
+             * @brief `STB_WEAK` symbol binding
+             */
+            static constexpr uint8_t SymbolBindingWeak = 2;
+
+            /**
+             * @brief `EM_ARM` machine type
+             */
+            static constexpr uint16_t MachineArm = 40;
+
+            /**
+             * @brief Loads ELF file from disk
+             *
+             * @param path Path to file
+             * @throws ElfError File cannot be read or is not valid ELF file
+             */
+            static ElfFile load(const std::string& path);
+
+            /**
+             * @brief Parses ELF file from memory
+             *
+             * @param data File content
+             * @throws ElfError Data is not valid ELF file
+             */
+            static ElfFile parse(std::vector<uint8_t> data);
+
+            /**
+             * @brief Returns all sections
+             */
+            const std::vector<ElfSection>& sections() const
+            {
+                return sections_;
+            }
+
+            /**
+             * @brief Finds section by name
+             *
+             * @param name Section name
+             * @return Section or `nullptr` when not found
+             */
+            const ElfSection* findSection(std::string_view name) const;
+
+            /**
+             * @brief Returns section content
+             *
+             * @param section Section (one of sections())
+             * @return Section content, empty for `SHT_NOBITS` sections
+             */
+            std::string_view sectionData(const ElfSection& section) const;
+
+            /**
+             * @brief Reads NUL-terminated string located at target address
+             *
+             * Only sections occupying target memory (`SHF_ALLOC`) and having content in file are searched.
+             *
+             * @param address Target address
+             * @return String or nothing if address is not covered by any section
+             */
+            std::optional<std::string> readString(uint64_t address) const;
+
+            /**
+             * @brief Reads defined symbols of symbol table (`.symtab`)
+             *
+             * Thumb bit (bit 0) of function addresses is cleared in ARM files, so addresses match program counter.
+             *
+             * @return Symbols in order of symbol table, empty if file has no symbol table (stripped)
+             * @throws ElfError Symbol table is malformed
+             */
+            std::vector<ElfSymbol> symbols() const;
+
+            /**
+             * @brief Returns machine type (`e_machine`)
+             */
+            uint16_t machine() const
+            {
+                return machine_;
+            }
+
+            /**
+             * @brief Returns true for ELF64 files
+             */
+            bool is64() const
+            {
+                return is64_;
+            }
+
+        private:
+            ElfFile() = default;
+
+            std::vector<uint8_t> data_;
+            std::vector<ElfSection> sections_;
+            bool is64_ = false;
+            uint16_t machine_ = 0;
+        };
+
+        /** @} */
+    }
+}
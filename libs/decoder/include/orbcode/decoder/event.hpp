@@ -0,0 +1,296 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "elf.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_event Structured events decoder
+         * @ingroup decoder
+         *
+         * @brief Decodes structs sent by `TRACE_EVENT` (see @ref event) into typed rows
+         *
+         * @{
+         */
+
+        /**
+         * @brief Mask applied to schema record address to produce schema ID (matches `TRACE_EVENT_ID_MASK`)
+         */
+        constexpr uint32_t EventIdMask = 0x000FFFFF;
+
+        /**
+         * @brief Position of struct size in event header (matches `TRACE_EVENT_SIZE_POS`)
+         */
+        constexpr unsigned EventSizePos = 20;
+
+        /**
+         * @brief Default name of section with schema records (matches `ORBCODE_TRACE_EVENT_SECTION`)
+         */
+        constexpr std::string_view EventDefaultSection = ".orbcode_trace_evt";
+
+        /**
+         * @brief Type of event field
+         */
+        enum class EventFieldType
+        {
+            U8,
+            I8,
+            U16,
+            I16,
+            U32,
+            I32,
+            U64,
+            I64,
+            F32,
+            F64,
+            Char,
+        };
+
+        /**
+         * @brief Single field of event struct
+         */
+        struct EventField
+        {
+            /**
+             * @brief Field name
+             */
+            std::string Name;
+            /**
+             * @brief Element type
+             */
+            EventFieldType Type = EventFieldType::U8;
+            /**
+             * @brief Number of elements (1 for scalar fields)
+             */
+            size_t Count = 1;
+            /**
+             * @brief Field was declared as array
+             */
+            bool Array = false;
+            /**
+             * @brief Offset of field in struct
+             */
+            size_t Offset = 0;
+        };
+
+        /**
+         * @brief Layout of event struct
+         */
+        struct EventSchema
+        {
+            /**
+             * @brief Schema ID (schema record address masked with @ref EventIdMask)
+             */
+            uint32_t Id = 0;
+            /**
+             * @brief Struct type name
+             */
+            std::string Name;
+            /**
+             * @brief Struct size reported by target (`sizeof`)
+             */
+            uint32_t Size = 0;
+            /**
+             * @brief Fields in declaration order
+             */
+            std::vector<EventField> Fields;
+            /**
+             * @brief Reason why field description cannot be used, empty for valid schema
+             */
+            std::string Error;
+
+            /**
+             * @brief Returns true if fields can be decoded
+             */
+            bool valid() const
+            {
+                return Error.empty();
+            }
+        };
+
+        /**
+         * @brief Parses field description and lays out fields with natural alignment
+         *
+         * @param name Struct type name
+         * @param size Struct size reported by target
+         * @param fields Field description (e.g. `"u32 timestamp; i16 current[3]"`)
+         * @return Schema, EventSchema#Error is set when description is malformed or its size differs from @p size
+         */
+        EventSchema parseEventSchema(std::string name, uint32_t size, std::string_view fields);
+
+        /**
+         * @brief Maps schema IDs to schemas
+         */
+        class EventSchemaTable
+        {
+        public:
+            /**
+             * @brief Builds table from all schema records stored in section of ELF file
+             *
+             * @param elf ELF file
+             * @param section Name of section with schema records
+             * @throws ElfError Section not found
+             */
+            static EventSchemaTable fromElf(const ElfFile& elf, std::string_view section = EventDefaultSection);
+
+            /**
+             * @brief Adds schema
+             *
+             * @param address Address of schema record in target memory (masked with @ref EventIdMask)
+             * @param schema Schema (EventSchema#Id is overwritten)
+             */
+            void add(uint32_t address, EventSchema schema);
+
+            /**
+             * @brief Finds schema
+             *
+             * @param id Schema ID
+             * @return Schema or `nullptr` if ID is unknown
+             */
+            const EventSchema* find(uint32_t id) const;
+
+            /**
+             * @brief Returns all schemas
+             */
+            const std::unordered_map<uint32_t, EventSchema>& schemas() const
+            {
+                return schemas_;
+            }
+
+            /**
+             * @brief Returns number of schemas
+             */
+            size_t size() const
+            {
+                return schemas_.size();
+            }
+
+        private:
+            std::unordered_map<uint32_t, EventSchema> schemas_;
+        };
+
+        /**
+         * @brief Returns CSV header line (without newline) with one column per scalar field or array element
+         *
+         * `char` arrays take single column.
+         *
+         * @param schema Valid schema
+         */
+        std::string eventCsvHeader(const EventSchema& schema);
+
+        /**
+         * @brief Formats event as CSV line (without newline) matching eventCsvHeader()
+         *
+         * @param schema Valid schema
+         * @param data Struct bytes, EventSchema#Size bytes
+         */
+        std::string formatEventCsv(const EventSchema& schema, const uint8_t* data);
+
+        /**
+         * @brief Decoded event
+         */
+        struct Event
+        {
+            /**
+             * @brief Schema ID
+             */
+            uint32_t Id = 0;
+            /**
+             * @brief Schema or `nullptr` if ID is unknown or struct size does not match schema
+             */
+            const EventSchema* Schema = nullptr;
+            /**
+             * @brief Struct bytes
+             */
+            std::vector<uint8_t> Data;
+        };
+
+        /**
+         * @brief Streaming decoder of stimulus port data carrying `TRACE_EVENT` records
+         *
+         * Struct size is part of event header, so decoder stays synchronized across events of unknown schemas.
+         */
+        class EventDecoder
+        {
+        public:
+            /**
+             * @brief Callback invoked for each complete event
+             */
+            using Callback = std::function<void(const Event&)>;
+
+            /**
+             * @brief Decoder counters
+             */
+            struct Statistics
+            {
+                /**
+                 * @brief Number of events with known schema
+                 */
+                uint64_t Events = 0;
+                /**
+                 * @brief Number of events with unknown schema ID
+                 */
+                uint64_t Unknown = 0;
+                /**
+                 * @brief Number of events whose size differs from size of their schema
+                 */
+                uint64_t Mismatched = 0;
+            };
+
+            /**
+             * @brief Creates decoder
+             *
+             * @param schemas Schemas (must outlive decoder)
+             * @param callback Callback invoked for each event
+             */
+            EventDecoder(const EventSchemaTable& schemas, Callback callback);
+
+            /**
+             * @brief Feeds data received from stimulus port
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+            /**
+             * @brief Discards partially received event
+             *
+             * Use after data loss (e.g. ITM overflow) to start decoding from next event boundary.
+             */
+            void reset();
+
+            /**
+             * @brief Returns decoder counters
+             */
+            const Statistics& statistics() const
+            {
+                return statistics_;
+            }
+
+        private:
+            void finishEvent();
+
+            const EventSchemaTable& schemas_;
+            Callback callback_;
+            uint32_t header_ = 0;
+            unsigned headerBytes_ = 0;
+            size_t remaining_ = 0;
+            Event event_;
+            Statistics statistics_;
+        };
+
+        /** @} */
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "orbcode/decoder/itm.hpp"
+#include "orbcode/decoder/profile.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_exception Exception latency analyzer
+         * @ingroup decoder
+         *
+         * @brief Reconstructs exception handler timing from DWT exception trace (see @ref exception_trace)
+         *
+         * Time is sum of local timestamp deltas, in timestamp clock ticks. Packets are assigned time of local timestamp
+         * which follows them.
+         *
+         * @{
+         */
+
+        /**
+         * @brief Default stimulus port of pending markers (matches `TRACE_EXCEPTION_MARK_PORT`)
+         */
+        constexpr int ExceptionMarkPort = 30;
+
+        /**
+         * @brief Exception trace function: exception entered
+         */
+        constexpr uint8_t ExceptionFunctionEnter = 1;
+
+        /**
+         * @brief Exception trace function: exception exited
+         */
+        constexpr uint8_t ExceptionFunctionExit = 2;
+
+        /**
+         * @brief Exception trace function: returned to exception (or thread mode)
+         */
+        constexpr uint8_t ExceptionFunctionReturn = 3;
+
+        /**
+         * @brief Timing statistics of single exception
+         */
+        struct ExceptionStatistics
+        {
+            /**
+             * @brief Number of entries
+             */
+            uint64_t Entries = 0;
+            /**
+             * @brief Number of entries directly after exit of another handler (without returning in between)
+             */
+            uint64_t TailChained = 0;
+            /**
+             * @brief Number of times handler was preempted by another exception
+             */
+            uint64_t Preempted = 0;
+            /**
+             * @brief Number of entries preempting another handler
+             */
+            uint64_t Preempting = 0;
+            /**
+             * @brief Deepest nesting level of handler (1 when entered from thread mode)
+             */
+            size_t MaxDepth = 0;
+            /**
+             * @brief Time from entry to exit including preempting handlers
+             */
+            ScopeStatistics Duration;
+            /**
+             * @brief Time from entry to exit excluding preempting handlers
+             */
+            ScopeStatistics Self;
+            /**
+             * @brief Time from pending marker to entry
+             */
+            ScopeStatistics Latency;
+        };
+
+        /**
+         * @brief Collects exception statistics from ITM packets
+         */
+        class ExceptionAnalyzer
+        {
+        public:
+            /**
+             * @brief Creates analyzer
+             *
+             * @param markerPort Stimulus port of pending markers, -1 disables latency measurement
+             */
+            explicit ExceptionAnalyzer(int markerPort = ExceptionMarkPort);
+
+            /**
+             * @brief Adds packet, packets unrelated to exception trace are ignored
+             *
+             * @param packet Packet
+             */
+            void add(const ItmPacket& packet);
+
+            /**
+             * @brief Returns statistics of all exceptions ordered by exception number
+             */
+            const std::map<uint16_t, ExceptionStatistics>& exceptions() const
+            {
+                return exceptions_;
+            }
+
+            /**
+             * @brief Returns number of overflow packets, nesting state is rebuilt after each of them
+             */
+            uint64_t overflows() const
+            {
+                return overflows_;
+            }
+
+        private:
+            struct Frame
+            {
+                uint16_t Exception;
+                uint64_t Entry;
+                uint64_t Children;
+            };
+
+            void process(const ItmPacket& packet);
+            void enter(uint16_t exception);
+            void exit(uint16_t exception);
+            void returnTo(uint16_t exception);
+
+            int markerPort_;
+            uint64_t time_ = 0;
+            uint64_t overflows_ = 0;
+            bool afterExit_ = false;
+            std::vector<ItmPacket> untimed_;
+            std::vector<Frame> stack_;
+            std::map<uint16_t, uint64_t> pending_;
+            std::map<uint16_t, ExceptionStatistics> exceptions_;
+        };
+
+        /** @} */
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_frame Frame decoder
+         * @ingroup decoder
+         *
+         * @brief Splits stimulus port data into messages written with ITMFrame* functions (see @ref itm_frame)
+         *
+         * @{
+         */
+
+        /**
+         * @brief Byte terminating each frame (matches `ITM_FRAME_DELIMITER`)
+         */
+        constexpr uint8_t FrameDelimiter = 0x00;
+
+        /**
+         * @brief Maximum length of single COBS run (matches `ITM_FRAME_MAX_RUN`)
+         */
+        constexpr size_t FrameMaxRun = 254;
+
+        /**
+         * @brief Computes CRC-8 used by frames (matches ITMFrameCrc8())
+         *
+         * @param data Data
+         * @param size Size of data
+         * @return CRC of data
+         */
+        uint8_t frameCrc8(const uint8_t* data, size_t size);
+
+        /**
+         * @brief Encodes message into frame (including delimiter), same as ITMFrameEncode()
+         *
+         * @param data Message
+         * @param size Size of message
+         * @param crc Append CRC-8 of message (`ITM_FRAME_CRC`)
+         * @return Frame
+         */
+        std::vector<uint8_t> encodeFrame(const uint8_t* data, size_t size, bool crc = true);
+
+        /**
+         * @brief Streaming decoder of framed stimulus port data
+         *
+         * Frames that cannot be decoded (invalid encoding, CRC mismatch, too long) are dropped and decoding continues
+         * with next frame.
+         */
+        class FrameDecoder
+        {
+        public:
+            /**
+             * @brief Callback invoked for each correctly decoded message (without CRC byte)
+             */
+            using Callback = std::function<void(const uint8_t* data, size_t size)>;
+
+            /**
+             * @brief Decoder counters
+             */
+            struct Statistics
+            {
+                /**
+                 * @brief Number of correctly decoded frames
+                 */
+                uint64_t Frames = 0;
+                /**
+                 * @brief Number of dropped frames
+                 */
+                uint64_t Errors = 0;
+                /**
+                 * @brief Number of bytes discarded while synchronizing (after reset())
+                 */
+                uint64_t SkippedBytes = 0;
+            };
+
+            /**
+             * @brief Creates decoder
+             *
+             * @param callback Callback invoked for each message
+             * @param crc Frames carry CRC-8 (`ITM_FRAME_CRC`)
+             * @param maxFrameSize Longer frames are dropped
+             */
+            explicit FrameDecoder(Callback callback, bool crc = true, size_t maxFrameSize = 64 * 1024);
+
+            /**
+             * @brief Feeds data received from stimulus port
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+            /**
+             * @brief Discards partially received frame and skips data up to next delimiter
+             *
+             * Use after data loss when CRC is disabled. With CRC enabled damaged frame is detected anyway.
+             */
+            void reset();
+
+            /**
+             * @brief Returns decoder counters
+             */
+            const Statistics& statistics() const
+            {
+                return statistics_;
+            }
+
+        private:
+            void finishFrame();
+
+            Callback callback_;
+            bool crc_;
+            size_t maxFrameSize_;
+            bool synchronized_ = true;
+            bool overflow_ = false;
+            std::vector<uint8_t> encoded_;
+            std::vector<uint8_t> decoded_;
+            Statistics statistics_;
+        };
+
+        /** @} */
+    }
+}
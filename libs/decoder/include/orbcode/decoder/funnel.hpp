@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_funnel Trace source IDs
+         * @ingroup decoder
+         *
+         * @brief Names of trace sources merged by trace funnel (see @ref funnel)
+         *
+         * IDs follow `TRACE_FUNNEL_TRACE_ID`: bits 4-6 are core index plus one, bits 0-3 source on the core. Use with
+         * TpiuDeframer to split merged stream per core.
+         *
+         * @{
+         */
+
+        /**
+         * @brief ITM source on core (matches `TraceSourceItm`)
+         */
+        constexpr uint8_t FunnelSourceItm = 0;
+
+        /**
+         * @brief ETM source on core (matches `TraceSourceEtm`)
+         */
+        constexpr uint8_t FunnelSourceEtm = 1;
+
+        /**
+         * @brief Returns trace source ID assigned by `TRACE_FUNNEL_TRACE_ID`
+         *
+         * @param core Core index (0 - 5)
+         * @param source Source on core (0 - 15)
+         */
+        constexpr uint8_t traceFunnelId(uint8_t core, uint8_t source)
+        {
+            return static_cast<uint8_t>(((core + 1U) << 4) | (source & 0xFU));
+        }
+
+        /**
+         * @brief Returns name of trace source
+         *
+         * IDs assigned by `TRACE_FUNNEL_TRACE_ID` are named by core and source (`core0-itm`, `core1-etm`, `core1-src5`),
+         * other IDs by number (`id1`).
+         *
+         * @param id Trace source ID
+         * @return Source name
+         */
+        std::string traceSourceName(uint8_t id);
+
+        /**
+         * @brief Parses trace source name returned by traceSourceName() or ID number
+         *
+         * @param text Source name or decimal/hexadecimal ID
+         * @param id Receives trace source ID
+         * @return true Source parsed
+         */
+        bool parseTraceSource(const std::string& text, uint8_t& id);
+
+        /** @} */
+    }
+}
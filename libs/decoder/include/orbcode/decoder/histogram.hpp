@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_histogram Histogram decoder
+         * @ingroup decoder
+         *
+         * @brief Decodes histograms sent by TraceHistogramFlush() (see @ref histogram)
+         *
+         * @{
+         */
+
+        /**
+         * @brief First word of every serialized histogram (matches `TRACE_HISTOGRAM_MAGIC`)
+         */
+        constexpr uint32_t HistogramMagic = 0x54534948;
+
+        /**
+         * @brief Supported version of serialized histogram format (matches `TRACE_HISTOGRAM_VERSION`)
+         */
+        constexpr uint8_t HistogramVersion = 1;
+
+        /**
+         * @brief Histogram received from target
+         */
+        struct Histogram
+        {
+            /**
+             * @brief Histogram ID
+             */
+            uint16_t Id = 0;
+            /**
+             * @brief Number of linear sub-bucket bits
+             */
+            uint8_t SubBucketBits = 0;
+            /**
+             * @brief Bucket counts
+             */
+            std::vector<uint64_t> Buckets;
+
+            /**
+             * @brief Returns smallest value counted in bucket
+             *
+             * @param bucket Bucket index
+             */
+            uint64_t lowerBound(size_t bucket) const;
+
+            /**
+             * @brief Returns largest value counted in bucket (last bucket also counts all larger values)
+             *
+             * @param bucket Bucket index
+             */
+            uint64_t upperBound(size_t bucket) const;
+
+            /**
+             * @brief Returns total number of samples
+             */
+            uint64_t total() const;
+
+            /**
+             * @brief Returns value below or equal to which given fraction of samples lies
+             *
+             * Result is upper bound of bucket containing requested percentile, so it overestimates true value by at
+             * most bucket width.
+             *
+             * @param fraction Fraction of samples (e.g. 0.99 for 99th percentile)
+             * @return Value (0 when histogram is empty)
+             */
+            uint64_t percentile(double fraction) const;
+
+            /**
+             * @brief Adds counts from other histogram with the same layout
+             *
+             * @param other Histogram to merge
+             * @return false Layouts differ, nothing merged
+             */
+            bool merge(const Histogram& other);
+        };
+
+        /**
+         * @brief Streaming decoder of stimulus port data carrying histograms
+         *
+         * Searches for @ref HistogramMagic, so decoding resynchronizes after data loss at next histogram. Magic word is
+         * checked inside histograms too: histogram cut short by lost words is discarded when next one starts. Bucket
+         * index or count equal to magic is read as start of new histogram (discarding current one).
+         */
+        class HistogramDecoder
+        {
+        public:
+            /**
+             * @brief Callback invoked for each complete histogram
+             */
+            using Callback = std::function<void(const Histogram&)>;
+
+            /**
+             * @brief Creates decoder
+             *
+             * @param callback Callback invoked for each histogram
+             */
+            explicit HistogramDecoder(Callback callback);
+
+            /**
+             * @brief Feeds data received from stimulus port
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+        private:
+            enum class State
+            {
+                Magic,
+                Info,
+                Layout,
+                Index,
+                Count,
+            };
+
+            void word(uint32_t value);
+
+            Callback callback_;
+            State state_ = State::Magic;
+            uint32_t window_ = 0;
+            size_t windowBytes_ = 0;
+            uint32_t word_ = 0;
+            size_t wordBytes_ = 0;
+            uint32_t remaining_ = 0;
+            uint32_t index_ = 0;
+            Histogram histogram_;
+        };
+
+        /** @} */
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "elf.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_log Deferred-formatting log decoder
+         * @ingroup decoder
+         *
+         * @brief Rebuilds text of messages produced by `TRACE_LOG` (see @ref log)
+         *
+         * @{
+         */
+
+        /**
+         * @brief Mask applied to format string address to produce message ID (matches `TRACE_LOG_ID_MASK`)
+         */
+        constexpr uint32_t LogIdMask = 0x0FFFFFFF;
+
+        /**
+         * @brief Position of argument count in message header (matches `TRACE_LOG_ARGC_POS`)
+         */
+        constexpr unsigned LogArgcPos = 28;
+
+        /**
+         * @brief Default name of section with format strings (matches `ORBCODE_TRACE_LOG_SECTION`)
+         */
+        constexpr std::string_view LogDefaultSection = ".orbcode_trace_fmt";
+
+        /**
+         * @brief Maps message IDs to format strings
+         */
+        class LogFormatTable
+        {
+        public:
+            /**
+             * @brief Builds table from all strings stored in section of ELF file
+             *
+             * @param elf ELF file
+             * @param section Name of section with format strings
+             * @throws ElfError Section not found
+             */
+            static LogFormatTable fromElf(const ElfFile& elf, std::string_view section = LogDefaultSection);
+
+            /**
+             * @brief Adds format string
+             *
+             * @param address Address of format string in target memory (masked with @ref LogIdMask)
+             * @param format Format string
+             */
+            void add(uint32_t address, std::string format);
+
+            /**
+             * @brief Finds format string
+             *
+             * @param id Message ID
+             * @return Format string or `nullptr` if ID is unknown
+             */
+            const std::string* find(uint32_t id) const;
+
+            /**
+             * @brief Returns number of format strings
+             */
+            size_t size() const
+            {
+                return formats_.size();
+            }
+
+        private:
+            std::unordered_map<uint32_t, std::string> formats_;
+        };
+
+        /**
+         * @brief Formats message using printf-like format string and 32-bit argument words
+         *
+         * Conversions `d`, `i`, `u`, `o`, `x`, `X`, `c`, `p`, `f`, `F`, `e`, `E`, `g`, `G`, `a`, `A` and `s` are supported
+         * together with flags, width and precision (including `*`). Length modifiers are accepted and ignored as every
+         * argument is 32 bits wide. Floating-point arguments are passed as `float` bit pattern. `%s` arguments are target
+         * addresses resolved using @p elf.
+         *
+         * @param format Format string
+         * @param args Argument words
+         * @param elf ELF file used to resolve `%s` arguments (may be `nullptr`)
+         * @return Formatted text
+         */
+        std::string formatLogMessage(std::string_view format, const std::vector<uint32_t>& args, const ElfFile* elf);
+
+        /**
+         * @brief Decoded message
+         */
+        struct LogMessage
+        {
+            /**
+             * @brief Message ID (format string address masked with @ref LogIdMask)
+             */
+            uint32_t Id;
+            /**
+             * @brief Format string or `nullptr` if ID is unknown
+             */
+            const std::string* Format;
+            /**
+             * @brief Argument words
+             */
+            std::vector<uint32_t> Args;
+        };
+
+        /**
+         * @brief Streaming decoder of stimulus port data carrying `TRACE_LOG` messages
+         */
+        class LogDecoder
+        {
+        public:
+            /**
+             * @brief Callback invoked for each complete message
+             */
+            using Callback = std::function<void(const LogMessage&)>;
+
+            /**
+             * @brief Creates decoder
+             *
+             * @param formats Format strings (must outlive decoder)
+             * @param callback Callback invoked for each message
+             */
+            LogDecoder(const LogFormatTable& formats, Callback callback);
+
+            /**
+             * @brief Feeds data received from stimulus port
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+            /**
+             * @brief Discards partially received message
+             *
+             * Use after data loss (e.g. ITM overflow) to start decoding from next message boundary.
+             */
+            void reset();
+
+        private:
+            const LogFormatTable& formats_;
+            Callback callback_;
+            uint32_t word_ = 0;
+            unsigned wordBytes_ = 0;
+            bool haveHeader_ = false;
+            uint32_t remaining_ = 0;
+            LogMessage message_{};
+        };
+
+        /** @} */
+    }
+}
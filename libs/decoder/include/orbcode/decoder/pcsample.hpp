@@ -0,0 +1,191 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "orbcode/decoder/itm.hpp"
+#include "orbcode/decoder/symbols.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_pcsample PC sampling profiler
+         * @ingroup decoder
+         *
+         * @brief Statistical profile of functions, source lines and exception handlers from DWT PC samples
+         *
+         * Every PC sample packet (see DWTOptions#PCSampling) is resolved with @ref SymbolTable and @ref LineTable as it
+         * arrives and only counters are incremented. Counters of functions and lines are allocated once for all
+         * entries of both tables, so memory use does not depend on capture length and profiler can run on endless
+         * live streams.
+         *
+         * When exception trace is enabled too (DWTOptions#ExceptionTrace), samples are attributed to currently active
+         * exception. Nesting is tracked from entry, exit and return packets, so samples of preempting handler are not
+         * counted to preempted one. Exception packets lost in overflow can leave wrong nesting until next return to
+         * thread mode.
+         *
+         * Folded stacks (one line per stack, frames separated by `;` followed by sample count) are accepted by
+         * `flamegraph.pl`, speedscope and similar tools. First frame is `Thread` for thread mode or names of active
+         * exceptions from outermost to innermost (e.g. `IRQ 5;SysTick`), last frame is sampled function.
+         *
+         * @{
+         */
+
+        /**
+         * @brief Name of folded stack frame of samples outside of all functions
+         */
+        constexpr const char* PcSampleUnknownFrame = "[unknown]";
+
+        /**
+         * @brief Name of folded stack frame of sleep samples (core was sleeping, no PC available)
+         */
+        constexpr const char* PcSampleSleepFrame = "[sleep]";
+
+        /**
+         * @brief Samples of single function
+         */
+        struct PcFunctionSamples
+        {
+            /**
+             * @brief Function
+             */
+            const Symbol* Function;
+            /**
+             * @brief Number of samples
+             */
+            uint64_t Samples;
+        };
+
+        /**
+         * @brief Samples of single source line
+         */
+        struct PcLineSamples
+        {
+            /**
+             * @brief File name
+             */
+            const std::string* File;
+            /**
+             * @brief Line number
+             */
+            uint32_t Line;
+            /**
+             * @brief Number of samples
+             */
+            uint64_t Samples;
+        };
+
+        /**
+         * @brief Aggregates PC samples into function, line and exception histograms
+         */
+        class PcSampleProfiler
+        {
+        public:
+            /**
+             * @brief Creates profiler
+             *
+             * @param symbols Function index (must outlive profiler)
+             * @param lines Line index (must outlive profiler), may be empty
+             */
+            PcSampleProfiler(const SymbolTable& symbols, const LineTable& lines);
+
+            /**
+             * @brief Adds packet, packets other than PC samples, exception trace and overflow are ignored
+             *
+             * @param packet Packet
+             */
+            void add(const ItmPacket& packet);
+
+            /**
+             * @brief Returns number of all PC samples, including sleep samples
+             */
+            uint64_t samples() const
+            {
+                return samples_;
+            }
+
+            /**
+             * @brief Returns number of sleep samples
+             */
+            uint64_t sleepSamples() const
+            {
+                return sleepSamples_;
+            }
+
+            /**
+             * @brief Returns number of samples outside of all functions
+             */
+            uint64_t unknownSamples() const
+            {
+                return unknownSamples_;
+            }
+
+            /**
+             * @brief Returns number of overflow packets
+             */
+            uint64_t overflows() const
+            {
+                return overflows_;
+            }
+
+            /**
+             * @brief Returns samples of each exception (innermost active one), index is exception number
+             *
+             * Index 0 counts samples taken in thread mode, including all samples when exception trace is disabled.
+             */
+            const std::vector<uint64_t>& exceptionSamples() const
+            {
+                return exceptionSamples_;
+            }
+
+            /**
+             * @brief Returns functions with at least one sample, most sampled first
+             */
+            std::vector<PcFunctionSamples> functions() const;
+
+            /**
+             * @brief Returns source lines with at least one sample, most sampled first
+             *
+             * Samples of all address ranges of the same line are summed.
+             */
+            std::vector<PcLineSamples> lines() const;
+
+            /**
+             * @brief Writes folded stacks, one stack per line ordered by stack
+             *
+             * @param out Output stream
+             */
+            void writeFolded(std::ostream& out) const;
+
+        private:
+            static constexpr size_t ExceptionCount = 512;
+
+            uint32_t stackId();
+
+            const SymbolTable& symbols_;
+            const LineTable& lines_;
+            uint64_t samples_ = 0;
+            uint64_t sleepSamples_ = 0;
+            uint64_t unknownSamples_ = 0;
+            uint64_t overflows_ = 0;
+            std::vector<uint64_t> functionSamples_;
+            std::vector<uint64_t> lineSamples_;
+            std::vector<uint64_t> exceptionSamples_;
+
+            std::vector<uint16_t> exceptions_;
+            bool stackValid_ = false;
+            uint32_t stackId_ = 0;
+            std::map<std::vector<uint16_t>, uint32_t> stackIds_;
+            std::vector<std::string> stackNames_;
+            std::unordered_map<uint64_t, uint64_t> folded_;
+        };
+
+        /** @} */
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_pmu PMU events
+         * @ingroup decoder
+         *
+         * @brief Names of ARMv8.1-M PMU events counted by target (see @ref pmu)
+         *
+         * @{
+         */
+
+        /**
+         * @brief Returns name of PMU event
+         *
+         * Known architectural and Cortex-M55/M85 events are named like `ARM_PMU_*` constants without prefix (e.g.
+         * `L1D_CACHE_REFILL`), other events are printed as hexadecimal number.
+         *
+         * @param event Event number
+         * @return Event name
+         */
+        std::string pmuEventName(uint16_t event);
+
+        /**
+         * @brief Parses PMU event name or number
+         *
+         * Accepts names returned by pmuEventName() (with or without `ARM_PMU_` prefix) and decimal or hexadecimal
+         * numbers.
+         *
+         * @param text Event name or number
+         * @param event Receives event number
+         * @return true Event parsed
+         */
+        bool parsePmuEvent(const std::string& text, uint16_t& event);
+
+        /** @} */
+    }
+}
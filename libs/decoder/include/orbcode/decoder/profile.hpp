@@ -0,0 +1,189 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_profile Scope profiler decoder
+         * @ingroup decoder
+         *
+         * @brief Decodes records produced by `TRACE_SCOPE` (see @ref profile)
+         *
+         * @{
+         */
+
+        /**
+         * @brief Record type emitted on scope entry (matches `TRACE_PROFILE_RECORD_ENTER`)
+         */
+        constexpr uint8_t ProfileRecordEnter = 1;
+
+        /**
+         * @brief Record type emitted on scope exit (matches `TRACE_PROFILE_RECORD_EXIT`)
+         */
+        constexpr uint8_t ProfileRecordExit = 2;
+
+        /**
+         * @brief Record type emitted on scope exit with PMU counter increments (matches `TRACE_PROFILE_RECORD_EXIT_PMU`)
+         */
+        constexpr uint8_t ProfileRecordExitPmu = 3;
+
+        /**
+         * @brief Maximum number of PMU counters accepted in single record, records with more are dropped
+         */
+        constexpr size_t ProfileMaxCounters = 16;
+
+        /**
+         * @brief Single profiler record
+         */
+        struct ProfileRecord
+        {
+            /**
+             * @brief Record type (@ref ProfileRecordEnter, @ref ProfileRecordExit or @ref ProfileRecordExitPmu)
+             */
+            uint8_t Type;
+            /**
+             * @brief Scope ID
+             */
+            uint32_t Id;
+            /**
+             * @brief Cycle counter value for enter record, scope duration in cycles for exit record
+             */
+            uint32_t Value;
+            /**
+             * @brief PMU counter increments during scope (only for @ref ProfileRecordExitPmu)
+             */
+            std::vector<uint32_t> Counters;
+        };
+
+        /**
+         * @brief Streaming decoder of stimulus port data carrying profiler records
+         */
+        class ProfileDecoder
+        {
+        public:
+            /**
+             * @brief Callback invoked for each record
+             */
+            using Callback = std::function<void(const ProfileRecord&)>;
+
+            /**
+             * @brief Creates decoder
+             *
+             * @param callback Callback invoked for each record
+             */
+            explicit ProfileDecoder(Callback callback);
+
+            /**
+             * @brief Feeds data received from stimulus port
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+            /**
+             * @brief Discards partially received record
+             */
+            void reset();
+
+        private:
+            void word(uint32_t value);
+
+            Callback callback_;
+            uint32_t word_ = 0;
+            size_t wordBytes_ = 0;
+            size_t words_ = 0;
+            size_t counters_ = 0;
+            ProfileRecord record_ = {};
+        };
+
+        /**
+         * @brief Duration statistics of single scope
+         */
+        struct ScopeStatistics
+        {
+            /**
+             * @brief Number of completed scope executions
+             */
+            uint64_t Count = 0;
+            /**
+             * @brief Sum of durations in cycles
+             */
+            uint64_t Total = 0;
+            /**
+             * @brief Shortest duration in cycles
+             */
+            uint32_t Min = UINT32_MAX;
+            /**
+             * @brief Longest duration in cycles
+             */
+            uint32_t Max = 0;
+            /**
+             * @brief Sums of PMU counter increments, in order of counters (empty when scope has no PMU records)
+             */
+            std::vector<uint64_t> Counters;
+
+            /**
+             * @brief Adds single duration
+             *
+             * @param duration Duration in cycles
+             */
+            void add(uint32_t duration);
+
+            /**
+             * @brief Adds single duration with PMU counter increments
+             *
+             * @param duration Duration in cycles
+             * @param counters PMU counter increments
+             */
+            void add(uint32_t duration, const std::vector<uint32_t>& counters);
+
+            /**
+             * @brief Returns average duration in cycles (0 when no executions were recorded)
+             */
+            double mean() const;
+
+            /**
+             * @brief Returns average increment of PMU counter per execution (0 when counter was not recorded)
+             *
+             * @param counter Counter index
+             */
+            double meanCounter(size_t counter) const;
+        };
+
+        /**
+         * @brief Collects duration statistics of all scopes from exit records
+         */
+        class ProfileSummary
+        {
+        public:
+            /**
+             * @brief Adds record, enter records are ignored
+             *
+             * @param record Record
+             */
+            void add(const ProfileRecord& record);
+
+            /**
+             * @brief Returns statistics of all scopes ordered by scope ID
+             */
+            const std::map<uint32_t, ScopeStatistics>& scopes() const
+            {
+                return scopes_;
+            }
+
+        private:
+            std::map<uint32_t, ScopeStatistics> scopes_;
+        };
+
+        /** @} */
+    }
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "orbcode/decoder/elf.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_symbols Symbolization
+         * @ingroup decoder
+         *
+         * @brief Maps program counter values to functions and source lines using ELF symbol table and DWARF line table
+         *
+         * Both tables are built once and kept sorted by address, lookups are binary searches without allocation.
+         *
+         * @{
+         */
+
+        /**
+         * @brief Function covering range of addresses
+         */
+        struct Symbol
+        {
+            /**
+             * @brief Function name
+             */
+            std::string Name;
+            /**
+             * @brief Address of first instruction
+             */
+            uint64_t Address;
+            /**
+             * @brief Size in bytes
+             */
+            uint64_t Size;
+        };
+
+        /**
+         * @brief Sorted index of functions
+         */
+        class SymbolTable
+        {
+        public:
+            /**
+             * @brief Builds table from function symbols of ELF file
+             *
+             * Of several symbols at the same address (e.g. weak aliases of default interrupt handler) global symbol is
+             * preferred over weak and local ones.
+             *
+             * @param elf ELF file
+             * @throws ElfError Symbol table is malformed
+             */
+            static SymbolTable fromElf(const ElfFile& elf);
+
+            /**
+             * @brief Creates table from list of functions
+             *
+             * Symbols are sorted by address, only the first of symbols sharing address is kept. Symbols of size 0
+             * (e.g. assembly labels without `.size`) extend up to next symbol.
+             *
+             * @param symbols Functions
+             */
+            explicit SymbolTable(std::vector<Symbol> symbols = {});
+
+            /**
+             * @brief Finds function containing address
+             *
+             * @param address Address
+             * @return Function or `nullptr` if address is outside of all functions
+             */
+            const Symbol* find(uint64_t address) const;
+
+            /**
+             * @brief Returns all functions ordered by address
+             */
+            const std::vector<Symbol>& symbols() const
+            {
+                return symbols_;
+            }
+
+        private:
+            std::vector<Symbol> symbols_;
+        };
+
+        /**
+         * @brief Range of addresses generated from single source line
+         */
+        struct LineRange
+        {
+            /**
+             * @brief First address
+             */
+            uint64_t Start;
+            /**
+             * @brief Address following range
+             */
+            uint64_t End;
+            /**
+             * @brief Index of file in LineTable#files()
+             */
+            uint32_t File;
+            /**
+             * @brief Line number (1-based, 0 if not attributable to any line)
+             */
+            uint32_t Line;
+        };
+
+        /**
+         * @brief Sorted index of source lines
+         */
+        class LineTable
+        {
+        public:
+            /**
+             * @brief Builds table from DWARF line number programs (`.debug_line`, DWARF versions 2 to 5)
+             *
+             * File names are combined with their include directory unless they are absolute or belong to compilation
+             * directory.
+             *
+             * @param elf ELF file
+             * @return Table, empty if file has no line information
+             * @throws ElfError Line number information is malformed or uses unsupported encoding
+             */
+            static LineTable fromElf(const ElfFile& elf);
+
+            /**
+             * @brief Creates table from list of ranges
+             *
+             * @param files File names referenced by LineRange#File
+             * @param ranges Ranges, sorted by this constructor
+             */
+            LineTable(std::vector<std::string> files = {}, std::vector<LineRange> ranges = {});
+
+            /**
+             * @brief Finds line containing address
+             *
+             * @param address Address
+             * @return Range or `nullptr` if address is not covered by line information
+             */
+            const LineRange* find(uint64_t address) const;
+
+            /**
+             * @brief Returns all file names
+             */
+            const std::vector<std::string>& files() const
+            {
+                return files_;
+            }
+
+            /**
+             * @brief Returns all ranges ordered by address
+             */
+            const std::vector<LineRange>& ranges() const
+            {
+                return ranges_;
+            }
+
+        private:
+            std::vector<std::string> files_;
+            std::vector<LineRange> ranges_;
+        };
+
+        /** @} */
+    }
+}
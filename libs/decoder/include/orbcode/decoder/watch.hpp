@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+#include "orbcode/decoder/itm.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_watch Watchpoint rotation heatmap
+         * @ingroup decoder
+         *
+         * @brief Counts data accesses per region from tagged data trace of rotating watchpoints (see @ref
+         * watch_rotation)
+         *
+         * @{
+         */
+
+        /**
+         * @brief Value of bits 24-31 of rotation tag word (matches `TRACE_WATCH_TAG_MARKER`)
+         */
+        constexpr uint8_t WatchTagMarker = 0x57;
+
+        /**
+         * @brief Access statistics of single region
+         */
+        struct WatchRegionStatistics
+        {
+            /**
+             * @brief Number of data trace packets attributed to region
+             */
+            uint64_t Accesses = 0;
+            /**
+             * @brief Number of rotation steps during which region was watched
+             */
+            uint64_t Steps = 0;
+
+            /**
+             * @brief Returns accesses per rotation step (0 when region was never watched)
+             */
+            double rate() const;
+        };
+
+        /**
+         * @brief Attributes data trace packets to regions using rotation tags
+         *
+         * Single access can produce several data trace packets (PC, address and value). Only first packet of each access
+         * is counted: packet directly following packet of the same comparator that precedes it in this order is
+         * ignored.
+         */
+        class WatchHeatmap
+        {
+        public:
+            /**
+             * @brief Creates heatmap
+             *
+             * @param tagPort Stimulus port of rotation tags (TraceWatchRotationOptions#TagPort)
+             */
+            explicit WatchHeatmap(uint8_t tagPort);
+
+            /**
+             * @brief Adds packet, unrelated packets are ignored
+             *
+             * @param packet Packet
+             */
+            void add(const ItmPacket& packet);
+
+            /**
+             * @brief Returns statistics of all tagged regions ordered by region index
+             */
+            const std::map<uint16_t, WatchRegionStatistics>& regions() const
+            {
+                return regions_;
+            }
+
+            /**
+             * @brief Returns number of data trace packets from comparators without tag
+             */
+            uint64_t untagged() const
+            {
+                return untagged_;
+            }
+
+            /**
+             * @brief Returns number of overflow packets
+             */
+            uint64_t overflows() const
+            {
+                return overflows_;
+            }
+
+        private:
+            static constexpr int NoRegion = -1;
+            static constexpr size_t Comparators = 4;
+
+            uint8_t tagPort_;
+            int current_[Comparators] = {NoRegion, NoRegion, NoRegion, NoRegion};
+            int lastComparator_ = -1;
+            int lastOrder_ = 0;
+            uint64_t untagged_ = 0;
+            uint64_t overflows_ = 0;
+            std::map<uint16_t, WatchRegionStatistics> regions_;
+        };
+
+        /** @} */
+    }
+}
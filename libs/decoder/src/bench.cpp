@@ -0,0 +1,120 @@
+#include "orbcode/decoder/bench.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            // Words following magic before PMU counters and name
+            constexpr size_t HeaderWords = 7;
+            constexpr uint8_t BenchVersionNoPmu = 1;
+        }
+
+        BenchDecoder::BenchDecoder(Callback callback) : callback_(std::move(callback))
+        {
+        }
+
+        void BenchDecoder::feed(const uint8_t* data, size_t size)
+        {
+            for(size_t i = 0; i < size; i++)
+            {
+                if(!synchronized_)
+                {
+                    // Magic can start at any byte after data loss
+                    window_ = (window_ >> 8) | (static_cast<uint32_t>(data[i]) << 24);
+                    windowBytes_ = windowBytes_ < 4 ? windowBytes_ + 1 : 4;
+                    if(windowBytes_ == 4 && window_ == BenchMagic)
+                    {
+                        windowBytes_ = 0;
+                        window_ = 0;
+                        synchronized_ = true;
+                        words_ = 0;
+                        result_ = BenchResult{};
+                    }
+                    continue;
+                }
+
+                word_ |= static_cast<uint32_t>(data[i]) << (8 * wordBytes_);
+                if(++wordBytes_ == 4)
+                {
+                    const uint32_t value = word_;
+                    word_ = 0;
+                    wordBytes_ = 0;
+                    word(value);
+                }
+            }
+        }
+
+        void BenchDecoder::word(uint32_t value)
+        {
+            // Target abandons record at first dropped word, next one starts with magic
+            if(value == BenchMagic)
+            {
+                words_ = 0;
+                result_ = BenchResult{};
+                return;
+            }
+
+            switch(words_++)
+            {
+                case 0:
+                {
+                    const uint8_t version = value & 0xFF;
+                    if(version != BenchVersion && version != BenchVersionNoPmu)
+                    {
+                        synchronized_ = false;
+                        return;
+                    }
+                    nameLength_ = (value >> 8) & 0xFF;
+                    result_.Counters = (value & (1U << 16)) != 0;
+                    pmuCounters_ = version == BenchVersionNoPmu ? 0 : (value >> 24) & 0xFF;
+                    break;
+                }
+                case 1:
+                    result_.Runs = value;
+                    break;
+                case 2:
+                    result_.Min = value;
+                    break;
+                case 3:
+                    result_.Median = value;
+                    break;
+                case 4:
+                    result_.Max = value;
+                    break;
+                case 5:
+                    result_.CPI = value;
+                    break;
+                case 6:
+                    result_.LSU = value;
+                    break;
+                default:
+                    if(words_ <= HeaderWords + 2 * pmuCounters_)
+                    {
+                        // Pairs of event number and sum
+                        if((words_ - HeaderWords) % 2 == 1)
+                        {
+                            result_.Pmu.push_back(BenchPmuCounter{static_cast<uint16_t>(value), 0});
+                        }
+                        else
+                        {
+                            result_.Pmu.back().Sum = value;
+                        }
+                        break;
+                    }
+                    for(int i = 0; i < 4 && result_.Name.size() < nameLength_; i++)
+                    {
+                        result_.Name.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+                    }
+                    break;
+            }
+
+            if(words_ >= HeaderWords + 2 * pmuCounters_ && result_.Name.size() == nameLength_)
+            {
+                synchronized_ = false;
+                callback_(result_);
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "orbcode/decoder/delta.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        DeltaDecoder::DeltaDecoder(Callback callback) : callback_(std::move(callback))
+        {
+        }
+
+        void DeltaDecoder::feed(const uint8_t* data, size_t size)
+        {
+            for(size_t i = 0; i < size; i++)
+            {
+                const uint8_t byte = data[i];
+                switch(state_)
+                {
+                    case State::Header:
+                        header_ = byte;
+                        state_ = State::Sequence;
+                        break;
+                    case State::Sequence:
+                        sequence_ = byte;
+                        channel_ = 0;
+                        varint_ = 0;
+                        varintShift_ = 0;
+                        state_ = State::Sample;
+                        break;
+                    case State::Sample:
+                        if(varintShift_ == 28 && (byte & 0xF0) != 0)
+                        {
+                            // Longer than any 32-bit varint, record boundaries are lost
+                            statistics_.Errors++;
+                            state_ = State::Header;
+                            break;
+                        }
+
+                        varint_ |= static_cast<uint32_t>(byte & 0x7F) << varintShift_;
+                        if((byte & 0x80) != 0)
+                        {
+                            varintShift_ += 7;
+                            break;
+                        }
+
+                        zigzag_[channel_++] = varint_;
+                        varint_ = 0;
+                        varintShift_ = 0;
+                        if(channel_ == static_cast<size_t>(header_ & 0x0F) + 1)
+                        {
+                            finishRecord();
+                            state_ = State::Header;
+                        }
+                        break;
+                }
+            }
+        }
+
+        void DeltaDecoder::reset()
+        {
+            if(state_ != State::Header)
+            {
+                statistics_.Errors++;
+            }
+            state_ = State::Header;
+        }
+
+        void DeltaDecoder::finishRecord()
+        {
+            Stream& stream = streams_[(header_ >> 4) & 0x07];
+            const bool key = (header_ & DeltaFlagKey) != 0;
+            const uint8_t channels = static_cast<uint8_t>(channel_);
+
+            if(stream.Synchronized && (sequence_ != stream.NextSequence || channels != stream.Channels))
+            {
+                statistics_.Lost += static_cast<uint8_t>(sequence_ - stream.NextSequence);
+                stream.Synchronized = false;
+            }
+            stream.NextSequence = static_cast<uint8_t>(sequence_ + 1);
+
+            if(!stream.Synchronized && !key)
+            {
+                statistics_.Skipped++;
+                return;
+            }
+            stream.Synchronized = true;
+            stream.Channels = channels;
+
+            record_.Stream = static_cast<uint8_t>((header_ >> 4) & 0x07);
+            record_.Sequence = sequence_;
+            record_.Key = key;
+            record_.Samples.resize(channels);
+            for(size_t i = 0; i < channels; i++)
+            {
+                const uint32_t delta = (zigzag_[i] >> 1) ^ (0U - (zigzag_[i] & 1));
+                const uint32_t sample = (key ? 0U : stream.Previous[i]) + delta;
+                stream.Previous[i] = sample;
+                record_.Samples[i] = static_cast<int32_t>(sample);
+            }
+
+            statistics_.Records++;
+            callback_(record_);
+        }
+    }
+}
@@ -0,0 +1,247 @@
+#include "orbcode/decoder/elf.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            constexpr uint8_t ElfClass32 = 1;
+            constexpr uint8_t ElfClass64 = 2;
+            constexpr uint8_t ElfDataLittleEndian = 1;
+            constexpr uint16_t SectionIndexExtended = 0xFFFF;
+
+            class Reader
+            {
+            public:
+                explicit Reader(const std::vector<uint8_t>& data) : data_(data)
+                {
+                }
+
+                uint64_t read(uint64_t offset, size_t size) const
+                {
+                    if(offset > data_.size() || data_.size() - offset < size)
+                    {
+                        throw ElfError("ELF file truncated");
+                    }
+
+                    uint64_t value = 0;
+                    for(size_t i = 0; i < size; i++)
+                    {
+                        value |= static_cast<uint64_t>(data_[offset + i]) << (8 * i);
+                    }
+                    return value;
+                }
+
+            private:
+                const std::vector<uint8_t>& data_;
+            };
+        }
+
+        ElfFile ElfFile::load(const std::string& path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if(!file)
+            {
+                throw ElfError("Cannot open " + path);
+            }
+
+            std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            return parse(std::move(data));
+        }
+
+        ElfFile ElfFile::parse(std::vector<uint8_t> data)
+        {
+            if(data.size() < 16 || std::memcmp(data.data(), "\x7F" "ELF", 4) != 0)
+            {
+                throw ElfError("Not an ELF file");
+            }
+
+            ElfFile elf;
+            elf.is64_ = data[4] == ElfClass64;
+            if(data[4] != ElfClass32 && data[4] != ElfClass64)
+            {
+                throw ElfError("Unsupported ELF class");
+            }
+
+            if(data[5] != ElfDataLittleEndian)
+            {
+                throw ElfError("Only little-endian ELF files are supported");
+            }
+
+            elf.data_ = std::move(data);
+            Reader r(elf.data_);
+
+            elf.machine_ = static_cast<uint16_t>(r.read(0x12, 2));
+            const size_t word = elf.is64_ ? 8 : 4;
+            const uint64_t shoff = r.read(elf.is64_ ? 0x28 : 0x20, word);
+            const uint64_t headerTail = elf.is64_ ? 0x3A : 0x2E;
+            const uint64_t shentsize = r.read(headerTail, 2);
+            uint64_t shnum = r.read(headerTail + 2, 2);
+            uint64_t shstrndx = r.read(headerTail + 4, 2);
+
+            if(shoff == 0)
+            {
+                return elf;
+            }
+
+            const auto sectionField = [&](uint64_t index, uint64_t offset32, uint64_t offset64, size_t size32,
+                                          size_t size64) {
+                const uint64_t base = shoff + index * shentsize;
+                return elf.is64_ ? r.read(base + offset64, size64) : r.read(base + offset32, size32);
+            };
+
+            // Extended numbering: real values are stored in section 0
+            if(shnum == 0)
+            {
+                shnum = sectionField(0, 0x14, 0x20, 4, 8);
+            }
+            if(shstrndx == SectionIndexExtended)
+            {
+                shstrndx = sectionField(0, 0x18, 0x28, 4, 4);
+            }
+
+            if(shoff > elf.data_.size() || shentsize < (elf.is64_ ? 0x40U : 0x28U) ||
+               shnum > (elf.data_.size() - shoff) / shentsize)
+            {
+                throw ElfError("Invalid section header table");
+            }
+
+            std::vector<uint32_t> nameOffsets;
+            elf.sections_.reserve(shnum);
+            for(uint64_t i = 0; i < shnum; i++)
+            {
+                ElfSection section;
+                nameOffsets.push_back(static_cast<uint32_t>(sectionField(i, 0x00, 0x00, 4, 4)));
+                section.Type = static_cast<uint32_t>(sectionField(i, 0x04, 0x04, 4, 4));
+                section.Flags = sectionField(i, 0x08, 0x08, 4, 8);
+                section.Address = sectionField(i, 0x0C, 0x10, 4, 8);
+                section.Offset = sectionField(i, 0x10, 0x18, 4, 8);
+                section.Size = sectionField(i, 0x14, 0x20, 4, 8);
+                section.Link = static_cast<uint32_t>(sectionField(i, 0x18, 0x28, 4, 4));
+
+                if(section.Type != SectionTypeNoBits &&
+                   (section.Offset > elf.data_.size() || elf.data_.size() - section.Offset < section.Size))
+                {
+                    throw ElfError("Section data outside of file");
+                }
+
+                elf.sections_.push_back(section);
+            }
+
+            if(shstrndx < elf.sections_.size())
+            {
+                const std::string_view names = elf.sectionData(elf.sections_[shstrndx]);
+                for(size_t i = 0; i < elf.sections_.size(); i++)
+                {
+                    if(nameOffsets[i] >= names.size())
+                    {
+                        continue;
+                    }
+
+                    const std::string_view tail = names.substr(nameOffsets[i]);
+                    elf.sections_[i].Name = std::string(tail.substr(0, tail.find('\0')));
+                }
+            }
+
+            return elf;
+        }
+
+        const ElfSection* ElfFile::findSection(std::string_view name) const
+        {
+            for(const auto& section : sections_)
+            {
+                if(section.Name == name)
+                {
+                    return &section;
+                }
+            }
+
+            return nullptr;
+        }
+
+        std::string_view ElfFile::sectionData(const ElfSection& section) const
+        {
+            if(section.Type == SectionTypeNoBits)
+            {
+                return {};
+            }
+
+            return std::string_view(reinterpret_cast<const char*>(data_.data()) + section.Offset, section.Size);
+        }
+
+        std::optional<std::string> ElfFile::readString(uint64_t address) const
+        {
+            for(const auto& section : sections_)
+            {
+                if((section.Flags & SectionFlagAlloc) == 0 || section.Type == SectionTypeNoBits)
+                {
+                    continue;
+                }
+
+                if(address < section.Address || address - section.Address >= section.Size)
+                {
+                    continue;
+                }
+
+                const std::string_view tail = sectionData(section).substr(address - section.Address);
+                return std::string(tail.substr(0, tail.find('\0')));
+            }
+
+            return std::nullopt;
+        }
+
+        std::vector<ElfSymbol> ElfFile::symbols() const
+        {
+            std::vector<ElfSymbol> symbols;
+            const auto table = std::find_if(sections_.begin(), sections_.end(), [](const ElfSection& section) {
+                return section.Type == SectionTypeSymbolTable;
+            });
+            if(table == sections_.end())
+            {
+                return symbols;
+            }
+
+            if(table->Link >= sections_.size())
+            {
+                throw ElfError("Invalid symbol string table");
+            }
+            const std::string_view names = sectionData(sections_[table->Link]);
+
+            Reader r(data_);
+            const uint64_t entrySize = is64_ ? 24 : 16;
+            const uint64_t count = table->Size / entrySize;
+            for(uint64_t i = 1; i < count; i++)
+            {
+                const uint64_t base = table->Offset + i * entrySize;
+                const uint32_t name = static_cast<uint32_t>(r.read(base, 4));
+                const uint8_t info = static_cast<uint8_t>(r.read(base + (is64_ ? 4 : 12), 1));
+                const uint16_t sectionIndex = static_cast<uint16_t>(r.read(base + (is64_ ? 6 : 14), 2));
+                if(sectionIndex == 0 || name >= names.size())
+                {
+                    continue;
+                }
+
+                ElfSymbol symbol;
+                const std::string_view tail = names.substr(name);
+                symbol.Name = std::string(tail.substr(0, tail.find('\0')));
+                symbol.Address = is64_ ? r.read(base + 8, 8) : r.read(base + 4, 4);
+                symbol.Size = is64_ ? r.read(base + 16, 8) : r.read(base + 8, 4);
+                symbol.Type = info & 0x0F;
+                symbol.Binding = info >> 4;
+                if(machine_ == MachineArm && symbol.Type == SymbolTypeFunction)
+                {
+                    symbol.Address &= ~static_cast<uint64_t>(1);
+                }
+                symbols.push_back(std::move(symbol));
+            }
+
+            return symbols;
+        }
+    }
+}
@@ -0,0 +1,423 @@
+#include "orbcode/decoder/event.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            struct FieldTypeInfo
+            {
+                std::string_view Name;
+                EventFieldType Type;
+                size_t Size;
+            };
+
+            constexpr FieldTypeInfo FieldTypes[] = {
+                {"u8", EventFieldType::U8, 1},   {"i8", EventFieldType::I8, 1},   {"u16", EventFieldType::U16, 2},
+                {"i16", EventFieldType::I16, 2}, {"u32", EventFieldType::U32, 4}, {"i32", EventFieldType::I32, 4},
+                {"u64", EventFieldType::U64, 8}, {"i64", EventFieldType::I64, 8}, {"f32", EventFieldType::F32, 4},
+                {"f64", EventFieldType::F64, 8}, {"char", EventFieldType::Char, 1},
+            };
+
+            size_t fieldTypeSize(EventFieldType type)
+            {
+                for(const FieldTypeInfo& info : FieldTypes)
+                {
+                    if(info.Type == type)
+                    {
+                        return info.Size;
+                    }
+                }
+                return 1;
+            }
+
+            std::string_view trim(std::string_view text)
+            {
+                const size_t first = text.find_first_not_of(" \t\r\n");
+                if(first == std::string_view::npos)
+                {
+                    return {};
+                }
+                const size_t last = text.find_last_not_of(" \t\r\n");
+                return text.substr(first, last - first + 1);
+            }
+
+            bool parseField(std::string_view text, EventField& field, std::string& error)
+            {
+                const size_t space = text.find_first_of(" \t");
+                if(space == std::string_view::npos)
+                {
+                    error = "Field '" + std::string(text) + "' has no name";
+                    return false;
+                }
+
+                const std::string_view typeName = text.substr(0, space);
+                std::string_view name = trim(text.substr(space));
+
+                const FieldTypeInfo* info = nullptr;
+                for(const FieldTypeInfo& candidate : FieldTypes)
+                {
+                    if(candidate.Name == typeName)
+                    {
+                        info = &candidate;
+                    }
+                }
+                if(info == nullptr)
+                {
+                    error = "Unknown type '" + std::string(typeName) + "'";
+                    return false;
+                }
+
+                field.Type = info->Type;
+                field.Count = 1;
+                field.Array = false;
+
+                const size_t bracket = name.find('[');
+                if(bracket != std::string_view::npos)
+                {
+                    const size_t close = name.find(']', bracket);
+                    if(close == std::string_view::npos || close + 1 != name.size() || close == bracket + 1)
+                    {
+                        error = "Malformed array '" + std::string(name) + "'";
+                        return false;
+                    }
+
+                    size_t count = 0;
+                    for(size_t i = bracket + 1; i < close; i++)
+                    {
+                        if(name[i] < '0' || name[i] > '9' || count > 0xFFFF)
+                        {
+                            error = "Malformed array '" + std::string(name) + "'";
+                            return false;
+                        }
+                        count = count * 10 + static_cast<size_t>(name[i] - '0');
+                    }
+
+                    field.Count = count;
+                    field.Array = true;
+                    name = trim(name.substr(0, bracket));
+                }
+
+                if(name.empty() || name.find_first_of(" \t") != std::string_view::npos)
+                {
+                    error = "Malformed field '" + std::string(text) + "'";
+                    return false;
+                }
+
+                field.Name = std::string(name);
+                return true;
+            }
+
+            uint64_t readLittleEndian(const uint8_t* data, size_t size)
+            {
+                uint64_t value = 0;
+                for(size_t i = 0; i < size; i++)
+                {
+                    value |= static_cast<uint64_t>(data[i]) << (8 * i);
+                }
+                return value;
+            }
+
+            template <typename T>
+            void appendNumber(std::string& out, const char* format, T value)
+            {
+                char buffer[64];
+                const int length = std::snprintf(buffer, sizeof(buffer), format, value);
+                if(length > 0)
+                {
+                    out.append(buffer, static_cast<size_t>(length) < sizeof(buffer) ? static_cast<size_t>(length)
+                                                                                     : sizeof(buffer) - 1);
+                }
+            }
+
+            void appendValue(std::string& out, EventFieldType type, const uint8_t* data)
+            {
+                const uint64_t raw = readLittleEndian(data, fieldTypeSize(type));
+                switch(type)
+                {
+                    case EventFieldType::U8:
+                    case EventFieldType::U16:
+                    case EventFieldType::U32:
+                    case EventFieldType::U64:
+                    case EventFieldType::Char:
+                        appendNumber(out, "%llu", static_cast<unsigned long long>(raw));
+                        break;
+                    case EventFieldType::I8:
+                        appendNumber(out, "%d", static_cast<int>(static_cast<int8_t>(raw)));
+                        break;
+                    case EventFieldType::I16:
+                        appendNumber(out, "%d", static_cast<int>(static_cast<int16_t>(raw)));
+                        break;
+                    case EventFieldType::I32:
+                        appendNumber(out, "%ld", static_cast<long>(static_cast<int32_t>(raw)));
+                        break;
+                    case EventFieldType::I64:
+                        appendNumber(out, "%lld", static_cast<long long>(raw));
+                        break;
+                    case EventFieldType::F32:
+                    {
+                        float value;
+                        const uint32_t word = static_cast<uint32_t>(raw);
+                        std::memcpy(&value, &word, sizeof(value));
+                        appendNumber(out, "%.9g", static_cast<double>(value));
+                        break;
+                    }
+                    case EventFieldType::F64:
+                    {
+                        double value;
+                        std::memcpy(&value, &raw, sizeof(value));
+                        appendNumber(out, "%.17g", value);
+                        break;
+                    }
+                }
+            }
+
+            void appendText(std::string& out, const uint8_t* data, size_t size)
+            {
+                // Quoted by CSV rules, text ends at first NUL
+                out.push_back('"');
+                for(size_t i = 0; i < size && data[i] != 0; i++)
+                {
+                    if(data[i] == '"')
+                    {
+                        out.push_back('"');
+                    }
+                    out.push_back(static_cast<char>(data[i]));
+                }
+                out.push_back('"');
+            }
+        }
+
+        EventSchema parseEventSchema(std::string name, uint32_t size, std::string_view fields)
+        {
+            EventSchema schema;
+            schema.Name = std::move(name);
+            schema.Size = size;
+
+            size_t offset = 0;
+            size_t alignment = 1;
+            size_t start = 0;
+            while(start <= fields.size())
+            {
+                size_t end = fields.find(';', start);
+                if(end == std::string_view::npos)
+                {
+                    end = fields.size();
+                }
+
+                const std::string_view text = trim(fields.substr(start, end - start));
+                start = end + 1;
+                if(text.empty())
+                {
+                    continue;
+                }
+
+                EventField field;
+                if(!parseField(text, field, schema.Error))
+                {
+                    schema.Fields.clear();
+                    return schema;
+                }
+
+                // Natural alignment, as AAPCS lays out non-packed structs
+                const size_t elementSize = fieldTypeSize(field.Type);
+                offset = (offset + elementSize - 1) / elementSize * elementSize;
+                alignment = elementSize > alignment ? elementSize : alignment;
+                field.Offset = offset;
+                offset += elementSize * field.Count;
+                schema.Fields.push_back(std::move(field));
+            }
+
+            offset = (offset + alignment - 1) / alignment * alignment;
+            if(schema.Fields.empty())
+            {
+                schema.Error = "No fields";
+            }
+            else if(offset != size)
+            {
+                schema.Error = "Fields take " + std::to_string(offset) + " bytes, struct has " + std::to_string(size);
+            }
+
+            if(!schema.Error.empty())
+            {
+                schema.Fields.clear();
+            }
+            return schema;
+        }
+
+        EventSchemaTable EventSchemaTable::fromElf(const ElfFile& elf, std::string_view section)
+        {
+            const ElfSection* schemaSection = elf.findSection(section);
+            if(schemaSection == nullptr)
+            {
+                throw ElfError("Section " + std::string(section) + " not found");
+            }
+
+            EventSchemaTable table;
+            const std::string_view data = elf.sectionData(*schemaSection);
+            size_t offset = 0;
+            while(offset + 4 <= data.size())
+            {
+                const uint32_t size =
+                    static_cast<uint32_t>(readLittleEndian(reinterpret_cast<const uint8_t*>(data.data()) + offset, 4));
+
+                // Records are word-aligned, zero words are alignment padding between them
+                if(size == 0)
+                {
+                    offset += 4;
+                    continue;
+                }
+
+                const size_t nameEnd = data.find('\0', offset + 4);
+                const size_t fieldsEnd = nameEnd == std::string_view::npos ? nameEnd : data.find('\0', nameEnd + 1);
+                if(fieldsEnd == std::string_view::npos)
+                {
+                    break;
+                }
+
+                table.add(static_cast<uint32_t>(schemaSection->Address + offset),
+                          parseEventSchema(std::string(data.substr(offset + 4, nameEnd - offset - 4)), size,
+                                           data.substr(nameEnd + 1, fieldsEnd - nameEnd - 1)));
+                offset = (fieldsEnd + 1 + 3) / 4 * 4;
+            }
+
+            return table;
+        }
+
+        void EventSchemaTable::add(uint32_t address, EventSchema schema)
+        {
+            schema.Id = address & EventIdMask;
+            schemas_[schema.Id] = std::move(schema);
+        }
+
+        const EventSchema* EventSchemaTable::find(uint32_t id) const
+        {
+            auto it = schemas_.find(id & EventIdMask);
+            return it != schemas_.end() ? &it->second : nullptr;
+        }
+
+        std::string eventCsvHeader(const EventSchema& schema)
+        {
+            std::string out;
+            for(const EventField& field : schema.Fields)
+            {
+                const bool text = field.Type == EventFieldType::Char;
+                const size_t columns = text ? 1 : field.Count;
+                for(size_t i = 0; i < columns; i++)
+                {
+                    if(!out.empty())
+                    {
+                        out.push_back(',');
+                    }
+                    out += field.Name;
+                    if(field.Array && !text)
+                    {
+                        out += "[" + std::to_string(i) + "]";
+                    }
+                }
+            }
+            return out;
+        }
+
+        std::string formatEventCsv(const EventSchema& schema, const uint8_t* data)
+        {
+            std::string out;
+            bool first = true;
+            for(const EventField& field : schema.Fields)
+            {
+                if(field.Type == EventFieldType::Char)
+                {
+                    if(!first)
+                    {
+                        out.push_back(',');
+                    }
+                    first = false;
+                    appendText(out, data + field.Offset, field.Count);
+                    continue;
+                }
+
+                const size_t elementSize = fieldTypeSize(field.Type);
+                for(size_t i = 0; i < field.Count; i++)
+                {
+                    if(!first)
+                    {
+                        out.push_back(',');
+                    }
+                    first = false;
+                    appendValue(out, field.Type, data + field.Offset + i * elementSize);
+                }
+            }
+            return out;
+        }
+
+        EventDecoder::EventDecoder(const EventSchemaTable& schemas, Callback callback)
+            : schemas_(schemas), callback_(std::move(callback))
+        {
+        }
+
+        void EventDecoder::feed(const uint8_t* data, size_t size)
+        {
+            size_t i = 0;
+            while(i < size)
+            {
+                if(headerBytes_ < 4)
+                {
+                    header_ |= static_cast<uint32_t>(data[i++]) << (8 * headerBytes_);
+                    if(++headerBytes_ < 4)
+                    {
+                        continue;
+                    }
+
+                    event_.Id = header_ & EventIdMask;
+                    event_.Data.clear();
+                    remaining_ = header_ >> EventSizePos;
+                }
+                else
+                {
+                    const size_t chunk = size - i < remaining_ ? size - i : remaining_;
+                    event_.Data.insert(event_.Data.end(), data + i, data + i + chunk);
+                    remaining_ -= chunk;
+                    i += chunk;
+                }
+
+                if(remaining_ == 0)
+                {
+                    finishEvent();
+                }
+            }
+        }
+
+        void EventDecoder::reset()
+        {
+            header_ = 0;
+            headerBytes_ = 0;
+            remaining_ = 0;
+            event_.Data.clear();
+        }
+
+        void EventDecoder::finishEvent()
+        {
+            event_.Schema = schemas_.find(event_.Id);
+            if(event_.Schema == nullptr)
+            {
+                statistics_.Unknown++;
+            }
+            else if(event_.Schema->Size != event_.Data.size())
+            {
+                event_.Schema = nullptr;
+                statistics_.Mismatched++;
+            }
+            else
+            {
+                statistics_.Events++;
+            }
+
+            callback_(event_);
+            reset();
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include "orbcode/decoder/exception.hpp"
+
+#include <algorithm>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            constexpr uint16_t ExceptionNumberMask = 0x1FF;
+
+            uint32_t clampDuration(uint64_t duration)
+            {
+                return duration > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(duration);
+            }
+        }
+
+        ExceptionAnalyzer::ExceptionAnalyzer(int markerPort) : markerPort_(markerPort)
+        {
+        }
+
+        void ExceptionAnalyzer::add(const ItmPacket& packet)
+        {
+            switch(packet.Type)
+            {
+                case ItmPacketType::Overflow:
+                    overflows_++;
+                    untimed_.clear();
+                    stack_.clear();
+                    pending_.clear();
+                    afterExit_ = false;
+                    break;
+                case ItmPacketType::LocalTimestamp:
+                    time_ += packet.Value;
+                    for(const ItmPacket& untimed : untimed_)
+                    {
+                        process(untimed);
+                    }
+                    untimed_.clear();
+                    break;
+                case ItmPacketType::Exception:
+                    untimed_.push_back(packet);
+                    break;
+                case ItmPacketType::Stimulus:
+                    if(static_cast<int>(packet.Address) == markerPort_)
+                    {
+                        untimed_.push_back(packet);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void ExceptionAnalyzer::process(const ItmPacket& packet)
+        {
+            if(packet.Type == ItmPacketType::Stimulus)
+            {
+                // Pending flag is set once, keep the earliest marker
+                pending_.emplace(static_cast<uint16_t>(packet.Value & ExceptionNumberMask), time_);
+                return;
+            }
+
+            const uint16_t exception = static_cast<uint16_t>(packet.Value);
+            switch(packet.Info)
+            {
+                case ExceptionFunctionEnter:
+                    enter(exception);
+                    break;
+                case ExceptionFunctionExit:
+                    exit(exception);
+                    break;
+                case ExceptionFunctionReturn:
+                    returnTo(exception);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void ExceptionAnalyzer::enter(uint16_t exception)
+        {
+            ExceptionStatistics& stats = exceptions_[exception];
+            stats.Entries++;
+
+            if(afterExit_)
+            {
+                stats.TailChained++;
+            }
+            else if(!stack_.empty())
+            {
+                stats.Preempting++;
+                exceptions_[stack_.back().Exception].Preempted++;
+            }
+            afterExit_ = false;
+
+            stack_.push_back(Frame{exception, time_, 0});
+            stats.MaxDepth = stack_.size() > stats.MaxDepth ? stack_.size() : stats.MaxDepth;
+
+            auto marker = pending_.find(exception);
+            if(marker != pending_.end())
+            {
+                stats.Latency.add(clampDuration(time_ - marker->second));
+                pending_.erase(marker);
+            }
+        }
+
+        void ExceptionAnalyzer::exit(uint16_t exception)
+        {
+            afterExit_ = true;
+
+            // Exit of handler entered before trace was enabled
+            auto found = std::find_if(stack_.rbegin(), stack_.rend(),
+                                      [exception](const Frame& frame) { return frame.Exception == exception; });
+            if(found == stack_.rend())
+            {
+                return;
+            }
+
+            // Frames above exited one lost their exit packets
+            stack_.erase(found.base(), stack_.end());
+
+            const Frame frame = stack_.back();
+            stack_.pop_back();
+
+            const uint64_t duration = time_ - frame.Entry;
+            ExceptionStatistics& stats = exceptions_[exception];
+            stats.Duration.add(clampDuration(duration));
+            stats.Self.add(clampDuration(duration > frame.Children ? duration - frame.Children : 0));
+
+            if(!stack_.empty())
+            {
+                stack_.back().Children += duration;
+            }
+        }
+
+        void ExceptionAnalyzer::returnTo(uint16_t exception)
+        {
+            afterExit_ = false;
+
+            if(exception == 0)
+            {
+                stack_.clear();
+                return;
+            }
+            while(!stack_.empty() && stack_.back().Exception != exception)
+            {
+                stack_.pop_back();
+            }
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#include "orbcode/decoder/frame.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        uint8_t frameCrc8(const uint8_t* data, size_t size)
+        {
+            uint8_t crc = 0;
+            for(size_t i = 0; i < size; i++)
+            {
+                crc ^= data[i];
+                for(int bit = 0; bit < 8; bit++)
+                {
+                    crc = static_cast<uint8_t>((crc & 0x80) != 0 ? (crc << 1) ^ 0x07 : crc << 1);
+                }
+            }
+            return crc;
+        }
+
+        std::vector<uint8_t> encodeFrame(const uint8_t* data, size_t size, bool crc)
+        {
+            std::vector<uint8_t> message(data, data + size);
+            if(crc)
+            {
+                message.push_back(frameCrc8(data, size));
+            }
+
+            std::vector<uint8_t> frame;
+            frame.reserve(message.size() + message.size() / FrameMaxRun + 2);
+
+            size_t pos = 0;
+            for(;;)
+            {
+                size_t run = 0;
+                while(pos + run < message.size() && run < FrameMaxRun && message[pos + run] != 0)
+                {
+                    run++;
+                }
+
+                frame.push_back(static_cast<uint8_t>(run + 1));
+                frame.insert(frame.end(), message.begin() + pos, message.begin() + pos + run);
+                pos += run;
+
+                if(pos == message.size())
+                {
+                    break;
+                }
+                if(run < FrameMaxRun)
+                {
+                    pos++; // zero implied by code byte
+                }
+            }
+
+            frame.push_back(FrameDelimiter);
+            return frame;
+        }
+
+        FrameDecoder::FrameDecoder(Callback callback, bool crc, size_t maxFrameSize)
+            : callback_(std::move(callback)), crc_(crc), maxFrameSize_(maxFrameSize)
+        {
+        }
+
+        void FrameDecoder::feed(const uint8_t* data, size_t size)
+        {
+            for(size_t i = 0; i < size; i++)
+            {
+                const uint8_t byte = data[i];
+
+                if(!synchronized_)
+                {
+                    statistics_.SkippedBytes++;
+                    synchronized_ = byte == FrameDelimiter;
+                    continue;
+                }
+
+                if(byte == FrameDelimiter)
+                {
+                    finishFrame();
+                    continue;
+                }
+
+                if(encoded_.size() >= maxFrameSize_)
+                {
+                    overflow_ = true;
+                    continue;
+                }
+
+                encoded_.push_back(byte);
+            }
+        }
+
+        void FrameDecoder::reset()
+        {
+            encoded_.clear();
+            overflow_ = false;
+            synchronized_ = false;
+        }
+
+        void FrameDecoder::finishFrame()
+        {
+            const bool overflow = overflow_;
+            overflow_ = false;
+
+            // Consecutive delimiters carry no frame
+            if(encoded_.empty() && !overflow)
+            {
+                return;
+            }
+
+            decoded_.clear();
+            bool valid = !overflow;
+            size_t i = 0;
+            while(valid && i < encoded_.size())
+            {
+                const size_t code = encoded_[i++];
+                if(code - 1 > encoded_.size() - i)
+                {
+                    valid = false;
+                    break;
+                }
+
+                decoded_.insert(decoded_.end(), encoded_.begin() + i, encoded_.begin() + i + (code - 1));
+                i += code - 1;
+
+                if(code <= FrameMaxRun && i < encoded_.size())
+                {
+                    decoded_.push_back(0);
+                }
+            }
+            encoded_.clear();
+
+            if(valid && crc_)
+            {
+                valid = !decoded_.empty() && frameCrc8(decoded_.data(), decoded_.size() - 1) == decoded_.back();
+                if(valid)
+                {
+                    decoded_.pop_back();
+                }
+            }
+
+            if(!valid)
+            {
+                statistics_.Errors++;
+                return;
+            }
+
+            statistics_.Frames++;
+            callback_(decoded_.data(), decoded_.size());
+        }
+    }
+}
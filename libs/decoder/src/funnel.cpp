@@ -0,0 +1,96 @@
+#include "orbcode/decoder/funnel.hpp"
+
+#include <cstdlib>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            // IDs 0x70 - 0x7F are reserved, leaving 6 cores
+            constexpr uint8_t MaxCores = 6;
+            constexpr uint8_t MaxId = 0x6F;
+
+            bool parseNumber(const std::string& text, unsigned long max, unsigned long& value)
+            {
+                if(text.empty())
+                {
+                    return false;
+                }
+                char* end = nullptr;
+                value = std::strtoul(text.c_str(), &end, 0);
+                return *end == '\0' && value <= max;
+            }
+        }
+
+        std::string traceSourceName(uint8_t id)
+        {
+            const uint8_t core = static_cast<uint8_t>(id >> 4);
+            if(core == 0 || core > MaxCores)
+            {
+                return "id" + std::to_string(id);
+            }
+
+            const uint8_t source = id & 0xF;
+            std::string name = "core" + std::to_string(core - 1) + "-";
+            switch(source)
+            {
+                case FunnelSourceItm:
+                    return name + "itm";
+                case FunnelSourceEtm:
+                    return name + "etm";
+                default:
+                    return name + "src" + std::to_string(source);
+            }
+        }
+
+        bool parseTraceSource(const std::string& text, uint8_t& id)
+        {
+            unsigned long value;
+            if(text.compare(0, 2, "id") == 0)
+            {
+                if(!parseNumber(text.substr(2), MaxId, value))
+                {
+                    return false;
+                }
+                id = static_cast<uint8_t>(value);
+                return true;
+            }
+
+            if(text.compare(0, 4, "core") == 0)
+            {
+                const size_t dash = text.find('-');
+                if(dash == std::string::npos || !parseNumber(text.substr(4, dash - 4), MaxCores - 1, value))
+                {
+                    return false;
+                }
+                const uint8_t core = static_cast<uint8_t>(value);
+                const std::string source = text.substr(dash + 1);
+                if(source == "itm")
+                {
+                    id = traceFunnelId(core, FunnelSourceItm);
+                    return true;
+                }
+                if(source == "etm")
+                {
+                    id = traceFunnelId(core, FunnelSourceEtm);
+                    return true;
+                }
+                if(source.compare(0, 3, "src") != 0 || !parseNumber(source.substr(3), 15, value))
+                {
+                    return false;
+                }
+                id = traceFunnelId(core, static_cast<uint8_t>(value));
+                return true;
+            }
+
+            if(!parseNumber(text, MaxId, value))
+            {
+                return false;
+            }
+            id = static_cast<uint8_t>(value);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#include "orbcode/decoder/histogram.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        uint64_t Histogram::lowerBound(size_t bucket) const
+        {
+            const size_t linear = size_t{2} << SubBucketBits;
+            if(bucket < linear)
+            {
+                return bucket;
+            }
+
+            const unsigned shift = static_cast<unsigned>(bucket >> SubBucketBits) - 1;
+            const uint64_t mantissa = bucket - (static_cast<uint64_t>(shift) << SubBucketBits);
+            return mantissa << shift;
+        }
+
+        uint64_t Histogram::upperBound(size_t bucket) const
+        {
+            if(bucket + 1 >= Buckets.size())
+            {
+                return UINT32_MAX;
+            }
+            return lowerBound(bucket + 1) - 1;
+        }
+
+        uint64_t Histogram::total() const
+        {
+            uint64_t sum = 0;
+            for(uint64_t count : Buckets)
+            {
+                sum += count;
+            }
+            return sum;
+        }
+
+        uint64_t Histogram::percentile(double fraction) const
+        {
+            const uint64_t samples = total();
+            if(samples == 0)
+            {
+                return 0;
+            }
+
+            // Smallest rank covering requested fraction, at least first sample
+            uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(samples) + 0.5);
+            rank = rank == 0 ? 1 : (rank > samples ? samples : rank);
+
+            uint64_t seen = 0;
+            for(size_t i = 0; i < Buckets.size(); i++)
+            {
+                seen += Buckets[i];
+                if(seen >= rank)
+                {
+                    return upperBound(i);
+                }
+            }
+            return upperBound(Buckets.size() - 1);
+        }
+
+        bool Histogram::merge(const Histogram& other)
+        {
+            if(other.SubBucketBits != SubBucketBits || other.Buckets.size() != Buckets.size())
+            {
+                return false;
+            }
+
+            for(size_t i = 0; i < Buckets.size(); i++)
+            {
+                Buckets[i] += other.Buckets[i];
+            }
+            return true;
+        }
+
+        HistogramDecoder::HistogramDecoder(Callback callback) : callback_(std::move(callback))
+        {
+        }
+
+        void HistogramDecoder::feed(const uint8_t* data, size_t size)
+        {
+            for(size_t i = 0; i < size; i++)
+            {
+                if(state_ == State::Magic)
+                {
+                    // Magic can start at any byte after data loss
+                    window_ = (window_ >> 8) | (static_cast<uint32_t>(data[i]) << 24);
+                    windowBytes_ = windowBytes_ < 4 ? windowBytes_ + 1 : 4;
+                    if(windowBytes_ == 4 && window_ == HistogramMagic)
+                    {
+                        windowBytes_ = 0;
+                        window_ = 0;
+                        state_ = State::Info;
+                    }
+                    continue;
+                }
+
+                word_ |= static_cast<uint32_t>(data[i]) << (8 * wordBytes_);
+                if(++wordBytes_ == 4)
+                {
+                    const uint32_t value = word_;
+                    word_ = 0;
+                    wordBytes_ = 0;
+                    word(value);
+                }
+            }
+        }
+
+        void HistogramDecoder::word(uint32_t value)
+        {
+            // Target abandons histogram at first dropped word, next one starts with magic
+            if(value == HistogramMagic)
+            {
+                state_ = State::Info;
+                return;
+            }
+
+            switch(state_)
+            {
+                case State::Magic:
+                    break;
+                case State::Info:
+                    if((value >> 24) != HistogramVersion || ((value >> 16) & 0xFF) > 8)
+                    {
+                        state_ = State::Magic;
+                        break;
+                    }
+                    histogram_ = Histogram{};
+                    histogram_.Id = static_cast<uint16_t>(value & 0xFFFF);
+                    histogram_.SubBucketBits = static_cast<uint8_t>((value >> 16) & 0xFF);
+                    state_ = State::Layout;
+                    break;
+                case State::Layout:
+                    histogram_.Buckets.assign(value & 0xFFFF, 0);
+                    remaining_ = value >> 16;
+                    state_ = remaining_ == 0 ? State::Magic : State::Index;
+                    if(remaining_ == 0)
+                    {
+                        callback_(histogram_);
+                    }
+                    break;
+                case State::Index:
+                    index_ = value;
+                    state_ = State::Count;
+                    break;
+                case State::Count:
+                    if(index_ < histogram_.Buckets.size())
+                    {
+                        histogram_.Buckets[index_] += value;
+                    }
+                    if(--remaining_ == 0)
+                    {
+                        state_ = State::Magic;
+                        callback_(histogram_);
+                    }
+                    else
+                    {
+                        state_ = State::Index;
+                    }
+                    break;
+            }
+        }
+    }
+}
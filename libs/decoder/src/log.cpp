@@ -0,0 +1,274 @@
+#include "orbcode/decoder/log.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            template <typename T>
+            void appendFormatted(std::string& out, const std::string& spec, T value)
+            {
+                char buffer[128];
+                int length = std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+                if(length < 0)
+                {
+                    return;
+                }
+
+                if(static_cast<size_t>(length) < sizeof(buffer))
+                {
+                    out.append(buffer, static_cast<size_t>(length));
+                    return;
+                }
+
+                std::string large(static_cast<size_t>(length) + 1, '\0');
+                std::snprintf(large.data(), large.size(), spec.c_str(), value);
+                out.append(large.data(), static_cast<size_t>(length));
+            }
+
+            float wordToFloat(uint32_t word)
+            {
+                float value;
+                std::memcpy(&value, &word, sizeof(value));
+                return value;
+            }
+        }
+
+        LogFormatTable LogFormatTable::fromElf(const ElfFile& elf, std::string_view section)
+        {
+            const ElfSection* formatSection = elf.findSection(section);
+            if(formatSection == nullptr)
+            {
+                throw ElfError("Section " + std::string(section) + " not found");
+            }
+
+            LogFormatTable table;
+            const std::string_view data = elf.sectionData(*formatSection);
+            size_t offset = 0;
+            while(offset < data.size())
+            {
+                size_t end = data.find('\0', offset);
+                if(end == std::string_view::npos)
+                {
+                    end = data.size();
+                }
+
+                // Skip alignment padding between strings
+                if(end > offset)
+                {
+                    table.add(static_cast<uint32_t>(formatSection->Address + offset),
+                              std::string(data.substr(offset, end - offset)));
+                }
+                offset = end + 1;
+            }
+
+            return table;
+        }
+
+        void LogFormatTable::add(uint32_t address, std::string format)
+        {
+            formats_[address & LogIdMask] = std::move(format);
+        }
+
+        const std::string* LogFormatTable::find(uint32_t id) const
+        {
+            auto it = formats_.find(id & LogIdMask);
+            return it == formats_.end() ? nullptr : &it->second;
+        }
+
+        std::string formatLogMessage(std::string_view format, const std::vector<uint32_t>& args, const ElfFile* elf)
+        {
+            std::string out;
+            size_t nextArg = 0;
+            bool missing = false;
+
+            const auto takeArg = [&]() -> uint32_t {
+                if(nextArg >= args.size())
+                {
+                    missing = true;
+                    return 0;
+                }
+                return args[nextArg++];
+            };
+
+            size_t i = 0;
+            while(i < format.size())
+            {
+                const char c = format[i++];
+                if(c != '%')
+                {
+                    out.push_back(c);
+                    continue;
+                }
+
+                if(i < format.size() && format[i] == '%')
+                {
+                    out.push_back('%');
+                    i++;
+                    continue;
+                }
+
+                std::string spec = "%";
+                while(i < format.size() && std::strchr("-+ #0", format[i]) != nullptr)
+                {
+                    spec.push_back(format[i++]);
+                }
+
+                if(i < format.size() && format[i] == '*')
+                {
+                    spec += std::to_string(static_cast<int32_t>(takeArg()));
+                    i++;
+                }
+                while(i < format.size() && format[i] >= '0' && format[i] <= '9')
+                {
+                    spec.push_back(format[i++]);
+                }
+
+                if(i < format.size() && format[i] == '.')
+                {
+                    spec.push_back(format[i++]);
+                    if(i < format.size() && format[i] == '*')
+                    {
+                        spec += std::to_string(static_cast<int32_t>(takeArg()));
+                        i++;
+                    }
+                    while(i < format.size() && format[i] >= '0' && format[i] <= '9')
+                    {
+                        spec.push_back(format[i++]);
+                    }
+                }
+
+                // Every argument is single 32-bit word, length modifiers carry no information
+                while(i < format.size() && std::strchr("hljztL", format[i]) != nullptr)
+                {
+                    i++;
+                }
+
+                if(i >= format.size())
+                {
+                    out += spec;
+                    break;
+                }
+
+                const char conversion = format[i++];
+                switch(conversion)
+                {
+                    case 'd':
+                    case 'i':
+                        appendFormatted(out, spec + conversion, static_cast<int>(static_cast<int32_t>(takeArg())));
+                        break;
+                    case 'u':
+                    case 'o':
+                    case 'x':
+                    case 'X':
+                        appendFormatted(out, spec + conversion, static_cast<unsigned>(takeArg()));
+                        break;
+                    case 'c':
+                        appendFormatted(out, spec + conversion, static_cast<int>(takeArg() & 0xFF));
+                        break;
+                    case 'p':
+                        appendFormatted(out, "0x%08x", static_cast<unsigned>(takeArg()));
+                        break;
+                    case 'f':
+                    case 'F':
+                    case 'e':
+                    case 'E':
+                    case 'g':
+                    case 'G':
+                    case 'a':
+                    case 'A':
+                        appendFormatted(out, spec + conversion, static_cast<double>(wordToFloat(takeArg())));
+                        break;
+                    case 's':
+                    {
+                        const uint32_t address = takeArg();
+                        std::optional<std::string> text;
+                        if(elf != nullptr)
+                        {
+                            text = elf->readString(address);
+                        }
+
+                        if(text)
+                        {
+                            appendFormatted(out, spec + conversion, text->c_str());
+                        }
+                        else
+                        {
+                            char buffer[16];
+                            std::snprintf(buffer, sizeof(buffer), "<0x%08x>", static_cast<unsigned>(address));
+                            out += buffer;
+                        }
+                        break;
+                    }
+                    case 'n':
+                        takeArg();
+                        break;
+                    default:
+                        out += spec;
+                        out.push_back(conversion);
+                        break;
+                }
+            }
+
+            if(missing)
+            {
+                out += " <missing arguments>";
+            }
+
+            return out;
+        }
+
+        LogDecoder::LogDecoder(const LogFormatTable& formats, Callback callback)
+            : formats_(formats), callback_(std::move(callback))
+        {
+        }
+
+        void LogDecoder::feed(const uint8_t* data, size_t size)
+        {
+            for(size_t i = 0; i < size; i++)
+            {
+                word_ |= static_cast<uint32_t>(data[i]) << (8 * wordBytes_);
+                if(++wordBytes_ < 4)
+                {
+                    continue;
+                }
+
+                const uint32_t word = word_;
+                word_ = 0;
+                wordBytes_ = 0;
+
+                if(!haveHeader_)
+                {
+                    message_.Id = word & LogIdMask;
+                    message_.Format = formats_.find(message_.Id);
+                    message_.Args.clear();
+                    remaining_ = word >> LogArgcPos;
+                    haveHeader_ = true;
+                }
+                else
+                {
+                    message_.Args.push_back(word);
+                    remaining_--;
+                }
+
+                if(remaining_ == 0)
+                {
+                    haveHeader_ = false;
+                    callback_(message_);
+                }
+            }
+        }
+
+        void LogDecoder::reset()
+        {
+            word_ = 0;
+            wordBytes_ = 0;
+            haveHeader_ = false;
+            remaining_ = 0;
+        }
+    }
+}
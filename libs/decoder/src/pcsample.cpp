@@ -0,0 +1,199 @@
+#include "orbcode/decoder/pcsample.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "orbcode/decoder/exception.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            constexpr uint16_t ExceptionNumberMask = 0x1FF;
+        }
+
+        PcSampleProfiler::PcSampleProfiler(const SymbolTable& symbols, const LineTable& lines)
+            : symbols_(symbols), lines_(lines), functionSamples_(symbols.symbols().size()),
+              lineSamples_(lines.ranges().size()), exceptionSamples_(ExceptionCount)
+        {
+        }
+
+        void PcSampleProfiler::add(const ItmPacket& packet)
+        {
+            switch(packet.Type)
+            {
+                case ItmPacketType::Overflow:
+                    overflows_++;
+                    break;
+                case ItmPacketType::Exception:
+                {
+                    const uint16_t exception = static_cast<uint16_t>(packet.Value & ExceptionNumberMask);
+                    stackValid_ = false;
+                    if(packet.Info == ExceptionFunctionEnter)
+                    {
+                        exceptions_.push_back(exception);
+                    }
+                    else if(packet.Info == ExceptionFunctionExit)
+                    {
+                        // Frames above exited one lost their exit packets
+                        auto found = std::find(exceptions_.rbegin(), exceptions_.rend(), exception);
+                        if(found != exceptions_.rend())
+                        {
+                            exceptions_.erase(std::prev(found.base()), exceptions_.end());
+                        }
+                    }
+                    else if(packet.Info == ExceptionFunctionReturn)
+                    {
+                        while(!exceptions_.empty() && exceptions_.back() != exception)
+                        {
+                            exceptions_.pop_back();
+                        }
+                        // Returned to handler entered before trace was enabled (or before overflow)
+                        if(exceptions_.empty() && exception != 0)
+                        {
+                            exceptions_.push_back(exception);
+                        }
+                    }
+                    break;
+                }
+                case ItmPacketType::PCSample:
+                {
+                    samples_++;
+                    exceptionSamples_[exceptions_.empty() ? 0 : exceptions_.back()]++;
+
+                    uint32_t leaf;
+                    if(packet.Info != 0)
+                    {
+                        sleepSamples_++;
+                        leaf = static_cast<uint32_t>(functionSamples_.size()) + 1;
+                    }
+                    else
+                    {
+                        const Symbol* function = symbols_.find(packet.Value);
+                        if(function != nullptr)
+                        {
+                            leaf = static_cast<uint32_t>(function - symbols_.symbols().data());
+                            functionSamples_[leaf]++;
+                        }
+                        else
+                        {
+                            unknownSamples_++;
+                            leaf = static_cast<uint32_t>(functionSamples_.size());
+                        }
+
+                        const LineRange* line = lines_.find(packet.Value);
+                        if(line != nullptr)
+                        {
+                            lineSamples_[static_cast<size_t>(line - lines_.ranges().data())]++;
+                        }
+                    }
+
+                    folded_[(static_cast<uint64_t>(stackId()) << 32) | leaf]++;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        uint32_t PcSampleProfiler::stackId()
+        {
+            if(stackValid_)
+            {
+                return stackId_;
+            }
+
+            const auto [it, inserted] = stackIds_.emplace(exceptions_, static_cast<uint32_t>(stackNames_.size()));
+            if(inserted)
+            {
+                std::string name;
+                if(exceptions_.empty())
+                {
+                    name = exceptionName(0);
+                }
+                for(uint16_t exception : exceptions_)
+                {
+                    name += (name.empty() ? "" : ";") + exceptionName(exception);
+                }
+                stackNames_.push_back(std::move(name));
+            }
+
+            stackId_ = it->second;
+            stackValid_ = true;
+            return stackId_;
+        }
+
+        std::vector<PcFunctionSamples> PcSampleProfiler::functions() const
+        {
+            std::vector<PcFunctionSamples> functions;
+            for(size_t i = 0; i < functionSamples_.size(); i++)
+            {
+                if(functionSamples_[i] > 0)
+                {
+                    functions.push_back(PcFunctionSamples{&symbols_.symbols()[i], functionSamples_[i]});
+                }
+            }
+
+            std::stable_sort(functions.begin(), functions.end(),
+                             [](const PcFunctionSamples& a, const PcFunctionSamples& b) {
+                                 return a.Samples > b.Samples;
+                             });
+            return functions;
+        }
+
+        std::vector<PcLineSamples> PcSampleProfiler::lines() const
+        {
+            // Several ranges (e.g. loop body split by branches) belong to the same line
+            std::map<std::pair<uint32_t, uint32_t>, uint64_t> merged;
+            for(size_t i = 0; i < lineSamples_.size(); i++)
+            {
+                if(lineSamples_[i] > 0)
+                {
+                    const LineRange& range = lines_.ranges()[i];
+                    merged[{range.File, range.Line}] += lineSamples_[i];
+                }
+            }
+
+            std::vector<PcLineSamples> lines;
+            lines.reserve(merged.size());
+            for(const auto& [key, samples] : merged)
+            {
+                lines.push_back(PcLineSamples{&lines_.files()[key.first], key.second, samples});
+            }
+
+            std::stable_sort(lines.begin(), lines.end(),
+                             [](const PcLineSamples& a, const PcLineSamples& b) { return a.Samples > b.Samples; });
+            return lines;
+        }
+
+        void PcSampleProfiler::writeFolded(std::ostream& out) const
+        {
+            std::vector<std::pair<std::string, uint64_t>> stacks;
+            stacks.reserve(folded_.size());
+            for(const auto& [key, samples] : folded_)
+            {
+                const uint32_t leaf = static_cast<uint32_t>(key);
+                const std::string& stack = stackNames_[key >> 32];
+                if(leaf < functionSamples_.size())
+                {
+                    stacks.emplace_back(stack + ";" + symbols_.symbols()[leaf].Name, samples);
+                }
+                else
+                {
+                    stacks.emplace_back(
+                        stack + ";" + (leaf == functionSamples_.size() ? PcSampleUnknownFrame : PcSampleSleepFrame),
+                        samples);
+                }
+            }
+
+            std::sort(stacks.begin(), stacks.end());
+            for(const auto& [stack, samples] : stacks)
+            {
+                out << stack << ' ' << samples << '\n';
+            }
+        }
+    }
+}
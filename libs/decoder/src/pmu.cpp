@@ -0,0 +1,125 @@
+#include "orbcode/decoder/pmu.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            struct PmuEvent
+            {
+                uint16_t Number;
+                const char* Name;
+            };
+
+            constexpr PmuEvent Events[] = {
+                {0x0000, "SW_INCR"},
+                {0x0001, "L1I_CACHE_REFILL"},
+                {0x0003, "L1D_CACHE_REFILL"},
+                {0x0004, "L1D_CACHE"},
+                {0x0006, "LD_RETIRED"},
+                {0x0007, "ST_RETIRED"},
+                {0x0008, "INST_RETIRED"},
+                {0x0009, "EXC_TAKEN"},
+                {0x000A, "EXC_RETURN"},
+                {0x000C, "PC_WRITE_RETIRED"},
+                {0x000D, "BR_IMMED_RETIRED"},
+                {0x000E, "BR_RETURN_RETIRED"},
+                {0x000F, "UNALIGNED_LDST_RETIRED"},
+                {0x0010, "BR_MIS_PRED"},
+                {0x0011, "CPU_CYCLES"},
+                {0x0012, "BR_PRED"},
+                {0x0013, "MEM_ACCESS"},
+                {0x0014, "L1I_CACHE"},
+                {0x0015, "L1D_CACHE_WB"},
+                {0x0019, "BUS_ACCESS"},
+                {0x001A, "MEMORY_ERROR"},
+                {0x001B, "INST_SPEC"},
+                {0x001D, "BUS_CYCLES"},
+                {0x001E, "CHAIN"},
+                {0x001F, "L1D_CACHE_ALLOCATE"},
+                {0x0021, "BR_RETIRED"},
+                {0x0022, "BR_MIS_PRED_RETIRED"},
+                {0x0023, "STALL_FRONTEND"},
+                {0x0024, "STALL_BACKEND"},
+                {0x0039, "L1D_CACHE_MISS_RD"},
+                {0x003C, "STALL"},
+                {0x0040, "L1D_CACHE_RD"},
+                {0x0100, "LE_RETIRED"},
+                {0x0104, "BF_RETIRED"},
+                {0x0108, "LE_CANCEL"},
+                {0x0109, "BF_CANCEL"},
+                {0x0200, "MVE_INST_RETIRED"},
+                {0x0204, "MVE_FP_RETIRED"},
+                {0x0214, "MVE_FP_MAC_RETIRED"},
+                {0x0224, "MVE_INT_RETIRED"},
+                {0x0228, "MVE_INT_MAC_RETIRED"},
+                {0x0238, "MVE_LDST_RETIRED"},
+                {0x023C, "MVE_LD_RETIRED"},
+                {0x0240, "MVE_ST_RETIRED"},
+                {0x028C, "MVE_LDST_UNALIGNED_RETIRED"},
+                {0x02B8, "MVE_PRED"},
+                {0x02CC, "MVE_STALL"},
+                {0x02CD, "MVE_STALL_RESOURCE"},
+                {0x02CE, "MVE_STALL_RESOURCE_MEM"},
+                {0x02CF, "MVE_STALL_RESOURCE_FP"},
+                {0x02D0, "MVE_STALL_RESOURCE_INT"},
+                {0x02D3, "MVE_STALL_BREAK"},
+                {0x02D4, "MVE_STALL_DEPENDENCY"},
+                {0x4007, "ITCM_ACCESS"},
+                {0x4008, "DTCM_ACCESS"},
+            };
+
+            constexpr char Prefix[] = "ARM_PMU_";
+        }
+
+        std::string pmuEventName(uint16_t event)
+        {
+            for(const PmuEvent& known : Events)
+            {
+                if(known.Number == event)
+                {
+                    return known.Name;
+                }
+            }
+
+            char text[8];
+            std::snprintf(text, sizeof(text), "0x%04X", event);
+            return text;
+        }
+
+        bool parsePmuEvent(const std::string& text, uint16_t& event)
+        {
+            std::string name = text;
+            if(name.compare(0, sizeof(Prefix) - 1, Prefix) == 0)
+            {
+                name.erase(0, sizeof(Prefix) - 1);
+            }
+
+            for(const PmuEvent& known : Events)
+            {
+                if(name == known.Name)
+                {
+                    event = known.Number;
+                    return true;
+                }
+            }
+
+            if(name.empty())
+            {
+                return false;
+            }
+            char* end = nullptr;
+            const unsigned long value = std::strtoul(name.c_str(), &end, 0);
+            if(*end != '\0' || value > UINT16_MAX)
+            {
+                return false;
+            }
+            event = static_cast<uint16_t>(value);
+            return true;
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#include "orbcode/decoder/profile.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            constexpr uint32_t ProfileIdMask = 0x00FFFFFF;
+            constexpr unsigned ProfileTypePos = 24;
+        }
+
+        ProfileDecoder::ProfileDecoder(Callback callback) : callback_(std::move(callback))
+        {
+        }
+
+        void ProfileDecoder::feed(const uint8_t* data, size_t size)
+        {
+            for(size_t i = 0; i < size; i++)
+            {
+                word_ |= static_cast<uint32_t>(data[i]) << (8 * wordBytes_);
+                if(++wordBytes_ < 4)
+                {
+                    continue;
+                }
+                const uint32_t value = word_;
+                word_ = 0;
+                wordBytes_ = 0;
+                word(value);
+            }
+        }
+
+        void ProfileDecoder::reset()
+        {
+            word_ = 0;
+            wordBytes_ = 0;
+            words_ = 0;
+        }
+
+        void ProfileDecoder::word(uint32_t value)
+        {
+            switch(words_++)
+            {
+                case 0:
+                    record_.Type = static_cast<uint8_t>(value >> ProfileTypePos);
+                    record_.Id = value & ProfileIdMask;
+                    record_.Counters.clear();
+                    return;
+                case 1:
+                    record_.Value = value;
+                    if(record_.Type != ProfileRecordExitPmu)
+                    {
+                        break;
+                    }
+                    return;
+                case 2:
+                    // Counter count is not known in advance, implausible value means lost sync
+                    if(value > ProfileMaxCounters)
+                    {
+                        words_ = 0;
+                        return;
+                    }
+                    counters_ = value;
+                    if(counters_ > 0)
+                    {
+                        return;
+                    }
+                    break;
+                default:
+                    record_.Counters.push_back(value);
+                    if(record_.Counters.size() < counters_)
+                    {
+                        return;
+                    }
+                    break;
+            }
+
+            words_ = 0;
+            callback_(record_);
+        }
+
+        void ScopeStatistics::add(uint32_t duration)
+        {
+            Count++;
+            Total += duration;
+            Min = duration < Min ? duration : Min;
+            Max = duration > Max ? duration : Max;
+        }
+
+        void ScopeStatistics::add(uint32_t duration, const std::vector<uint32_t>& counters)
+        {
+            add(duration);
+            if(Counters.size() < counters.size())
+            {
+                Counters.resize(counters.size());
+            }
+            for(size_t i = 0; i < counters.size(); i++)
+            {
+                Counters[i] += counters[i];
+            }
+        }
+
+        double ScopeStatistics::mean() const
+        {
+            return Count == 0 ? 0.0 : static_cast<double>(Total) / static_cast<double>(Count);
+        }
+
+        double ScopeStatistics::meanCounter(size_t counter) const
+        {
+            if(Count == 0 || counter >= Counters.size())
+            {
+                return 0.0;
+            }
+            return static_cast<double>(Counters[counter]) / static_cast<double>(Count);
+        }
+
+        void ProfileSummary::add(const ProfileRecord& record)
+        {
+            if(record.Type == ProfileRecordExit)
+            {
+                scopes_[record.Id].add(record.Value);
+            }
+            else if(record.Type == ProfileRecordExitPmu)
+            {
+                scopes_[record.Id].add(record.Value, record.Counters);
+            }
+        }
+    }
+}
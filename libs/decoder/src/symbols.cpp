@@ -0,0 +1,583 @@
+#include "orbcode/decoder/symbols.hpp"
+
+#include <algorithm>
+#include <map>
+#include <string_view>
+#include <utility>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            // DWARF 5, section 7.5.6 and 7.22
+            constexpr uint64_t FormBlock = 0x09;
+            constexpr uint64_t FormData1 = 0x0B;
+            constexpr uint64_t FormData2 = 0x05;
+            constexpr uint64_t FormData4 = 0x06;
+            constexpr uint64_t FormData8 = 0x07;
+            constexpr uint64_t FormData16 = 0x1E;
+            constexpr uint64_t FormString = 0x08;
+            constexpr uint64_t FormStrp = 0x0E;
+            constexpr uint64_t FormUdata = 0x0F;
+            constexpr uint64_t FormLineStrp = 0x1F;
+
+            constexpr uint64_t ContentPath = 1;
+            constexpr uint64_t ContentDirectoryIndex = 2;
+
+            // Standard and extended opcodes, DWARF 5 section 6.2.5
+            constexpr uint8_t OpCopy = 1;
+            constexpr uint8_t OpAdvancePc = 2;
+            constexpr uint8_t OpAdvanceLine = 3;
+            constexpr uint8_t OpSetFile = 4;
+            constexpr uint8_t OpConstAddPc = 8;
+            constexpr uint8_t OpFixedAdvancePc = 9;
+            constexpr uint8_t OpExtendedEndSequence = 1;
+            constexpr uint8_t OpExtendedSetAddress = 2;
+            constexpr uint8_t OpExtendedDefineFile = 3;
+
+            class DwarfReader
+            {
+            public:
+                DwarfReader(std::string_view data, size_t position = 0, size_t end = std::string_view::npos)
+                    : data_(data), position_(position), end_(std::min(end, data.size()))
+                {
+                }
+
+                bool atEnd() const
+                {
+                    return position_ >= end_;
+                }
+
+                size_t position() const
+                {
+                    return position_;
+                }
+
+                uint64_t read(size_t size)
+                {
+                    if(position_ > end_ || end_ - position_ < size)
+                    {
+                        throw ElfError("Line number information truncated");
+                    }
+
+                    uint64_t value = 0;
+                    for(size_t i = 0; i < size; i++)
+                    {
+                        value |= static_cast<uint64_t>(static_cast<uint8_t>(data_[position_ + i])) << (8 * i);
+                    }
+                    position_ += size;
+                    return value;
+                }
+
+                void skip(uint64_t size)
+                {
+                    if(position_ > end_ || end_ - position_ < size)
+                    {
+                        throw ElfError("Line number information truncated");
+                    }
+                    position_ += static_cast<size_t>(size);
+                }
+
+                uint64_t uleb()
+                {
+                    uint64_t value = 0;
+                    for(unsigned shift = 0;; shift += 7)
+                    {
+                        const uint8_t byte = static_cast<uint8_t>(read(1));
+                        if(shift < 64)
+                        {
+                            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                        }
+                        if((byte & 0x80) == 0)
+                        {
+                            return value;
+                        }
+                    }
+                }
+
+                int64_t sleb()
+                {
+                    int64_t value = 0;
+                    unsigned shift = 0;
+                    uint8_t byte;
+                    do
+                    {
+                        byte = static_cast<uint8_t>(read(1));
+                        if(shift < 64)
+                        {
+                            value |= static_cast<int64_t>(static_cast<uint64_t>(byte & 0x7F) << shift);
+                        }
+                        shift += 7;
+                    } while((byte & 0x80) != 0);
+
+                    if(shift < 64 && (byte & 0x40) != 0)
+                    {
+                        value |= -(static_cast<int64_t>(1) << shift);
+                    }
+                    return value;
+                }
+
+                std::string string()
+                {
+                    const size_t terminator = data_.find('\0', position_);
+                    if(terminator == std::string_view::npos || terminator >= end_)
+                    {
+                        throw ElfError("Line number information truncated");
+                    }
+
+                    std::string value(data_.substr(position_, terminator - position_));
+                    position_ = terminator + 1;
+                    return value;
+                }
+
+            private:
+                std::string_view data_;
+                size_t position_;
+                size_t end_;
+            };
+
+            std::string stringAt(std::string_view table, uint64_t offset)
+            {
+                if(offset >= table.size())
+                {
+                    throw ElfError("Invalid string offset in line number information");
+                }
+
+                const std::string_view tail = table.substr(offset);
+                return std::string(tail.substr(0, tail.find('\0')));
+            }
+
+            bool isAbsolute(const std::string& path)
+            {
+                return !path.empty() && (path[0] == '/' || (path.size() > 2 && path[1] == ':'));
+            }
+
+            std::string joinPath(const std::string& directory, const std::string& name)
+            {
+                if(directory.empty() || isAbsolute(name))
+                {
+                    return name;
+                }
+                return directory + "/" + name;
+            }
+
+            struct EntryFormat
+            {
+                uint64_t Content;
+                uint64_t Form;
+            };
+
+            struct Entry
+            {
+                std::string Path;
+                uint64_t Directory = 0;
+            };
+
+            class LineProgramParser
+            {
+            public:
+                LineProgramParser(const ElfFile& elf, std::vector<std::string>& files, std::vector<LineRange>& ranges)
+                    : files_(files), ranges_(ranges)
+                {
+                    if(const ElfSection* section = elf.findSection(".debug_str"))
+                    {
+                        strings_ = elf.sectionData(*section);
+                    }
+                    if(const ElfSection* section = elf.findSection(".debug_line_str"))
+                    {
+                        lineStrings_ = elf.sectionData(*section);
+                    }
+                }
+
+                // Parses single unit starting at reader position, returns offset of following unit
+                size_t parseUnit(std::string_view data, size_t offset)
+                {
+                    DwarfReader header(data, offset);
+                    uint64_t length = header.read(4);
+                    size_t offsetSize = 4;
+                    if(length == 0xFFFFFFFF)
+                    {
+                        length = header.read(8);
+                        offsetSize = 8;
+                    }
+                    if(length > data.size() - header.position())
+                    {
+                        throw ElfError("Line number information truncated");
+                    }
+                    const size_t unitEnd = header.position() + static_cast<size_t>(length);
+
+                    DwarfReader r(data, header.position(), unitEnd);
+                    version_ = static_cast<uint16_t>(r.read(2));
+                    if(version_ < 2 || version_ > 5)
+                    {
+                        throw ElfError("Unsupported line number information version " + std::to_string(version_));
+                    }
+
+                    if(version_ >= 5)
+                    {
+                        r.read(2); // address and segment selector size, addresses are sized by DW_LNE_set_address
+                    }
+
+                    const uint64_t headerLength = r.read(offsetSize);
+                    const size_t programStart = r.position() + static_cast<size_t>(headerLength);
+                    minimumInstructionLength_ = static_cast<uint8_t>(r.read(1));
+                    if(version_ >= 4)
+                    {
+                        r.read(1); // maximum operations per instruction, VLIW only
+                    }
+                    r.read(1); // default is_stmt, all rows are used
+                    lineBase_ = static_cast<int8_t>(r.read(1));
+                    lineRange_ = static_cast<uint8_t>(r.read(1));
+                    opcodeBase_ = static_cast<uint8_t>(r.read(1));
+                    if(lineRange_ == 0 || opcodeBase_ == 0)
+                    {
+                        throw ElfError("Invalid line number program header");
+                    }
+                    standardOpcodeLengths_.assign(opcodeBase_, 0);
+                    for(uint8_t i = 1; i < opcodeBase_; i++)
+                    {
+                        standardOpcodeLengths_[i] = static_cast<uint8_t>(r.read(1));
+                    }
+
+                    directories_.clear();
+                    unitFiles_.clear();
+                    if(version_ >= 5)
+                    {
+                        readEntries(r, offsetSize, false);
+                        readEntries(r, offsetSize, true);
+                    }
+                    else
+                    {
+                        directories_.push_back({});
+                        for(std::string directory = r.string(); !directory.empty(); directory = r.string())
+                        {
+                            directories_.push_back(directory);
+                        }
+
+                        // File numbers start at 1 before DWARF 5
+                        unitFiles_.push_back(~0U);
+                        for(std::string name = r.string(); !name.empty(); name = r.string())
+                        {
+                            const uint64_t directory = r.uleb();
+                            r.uleb(); // modification time
+                            r.uleb(); // length
+                            unitFiles_.push_back(addFile(name, directory));
+                        }
+                    }
+
+                    DwarfReader program(data, programStart, unitEnd);
+                    run(program);
+                    return unitEnd;
+                }
+
+            private:
+                uint64_t readForm(DwarfReader& r, uint64_t form, size_t offsetSize, std::string* text)
+                {
+                    switch(form)
+                    {
+                        case FormString:
+                            *text = r.string();
+                            return 0;
+                        case FormLineStrp:
+                            *text = stringAt(lineStrings_, r.read(offsetSize));
+                            return 0;
+                        case FormStrp:
+                            *text = stringAt(strings_, r.read(offsetSize));
+                            return 0;
+                        case FormUdata:
+                            return r.uleb();
+                        case FormData1:
+                            return r.read(1);
+                        case FormData2:
+                            return r.read(2);
+                        case FormData4:
+                            return r.read(4);
+                        case FormData8:
+                            return r.read(8);
+                        case FormData16:
+                            r.skip(16);
+                            return 0;
+                        case FormBlock:
+                            r.skip(r.uleb());
+                            return 0;
+                        default:
+                            throw ElfError("Unsupported form in line number program header");
+                    }
+                }
+
+                // Reads DWARF 5 directory table or file name table
+                void readEntries(DwarfReader& r, size_t offsetSize, bool files)
+                {
+                    std::vector<EntryFormat> formats(r.read(1));
+                    for(EntryFormat& format : formats)
+                    {
+                        format.Content = r.uleb();
+                        format.Form = r.uleb();
+                    }
+
+                    const uint64_t count = r.uleb();
+                    for(uint64_t i = 0; i < count; i++)
+                    {
+                        Entry entry;
+                        for(const EntryFormat& format : formats)
+                        {
+                            std::string text;
+                            const uint64_t value = readForm(r, format.Form, offsetSize, &text);
+                            if(format.Content == ContentPath)
+                            {
+                                entry.Path = text;
+                            }
+                            else if(format.Content == ContentDirectoryIndex)
+                            {
+                                entry.Directory = value;
+                            }
+                        }
+
+                        if(files)
+                        {
+                            unitFiles_.push_back(addFile(entry.Path, entry.Directory));
+                        }
+                        else
+                        {
+                            directories_.push_back(entry.Path);
+                        }
+                    }
+                }
+
+                uint32_t addFile(const std::string& name, uint64_t directory)
+                {
+                    // Directory 0 is compilation directory, paths relative to it are kept short
+                    const std::string path =
+                        directory > 0 && directory < directories_.size() ? joinPath(directories_[directory], name)
+                                                                          : name;
+                    const auto [it, inserted] = fileIndex_.emplace(path, static_cast<uint32_t>(files_.size()));
+                    if(inserted)
+                    {
+                        files_.push_back(path);
+                    }
+                    return it->second;
+                }
+
+                void emit(uint64_t address, uint64_t file, uint64_t line, bool endSequence)
+                {
+                    if(hasRow_ && address > rowAddress_ && rowFile_ < unitFiles_.size() && unitFiles_[rowFile_] != ~0U)
+                    {
+                        ranges_.push_back(LineRange{rowAddress_, address, unitFiles_[rowFile_],
+                                                    static_cast<uint32_t>(rowLine_)});
+                    }
+
+                    hasRow_ = !endSequence;
+                    rowAddress_ = address;
+                    rowFile_ = file;
+                    rowLine_ = line;
+                }
+
+                void run(DwarfReader& r)
+                {
+                    uint64_t address = 0;
+                    uint64_t file = 1;
+                    int64_t line = 1;
+                    hasRow_ = false;
+
+                    const auto reset = [&]() {
+                        address = 0;
+                        file = 1;
+                        line = 1;
+                    };
+
+                    while(!r.atEnd())
+                    {
+                        const uint8_t opcode = static_cast<uint8_t>(r.read(1));
+                        if(opcode >= opcodeBase_)
+                        {
+                            const uint8_t adjusted = opcode - opcodeBase_;
+                            address += static_cast<uint64_t>(adjusted / lineRange_) * minimumInstructionLength_;
+                            line += lineBase_ + adjusted % lineRange_;
+                            emit(address, file, static_cast<uint64_t>(line), false);
+                            continue;
+                        }
+
+                        switch(opcode)
+                        {
+                            case 0:
+                            {
+                                const uint64_t length = r.uleb();
+                                if(length == 0)
+                                {
+                                    break;
+                                }
+                                const size_t next = r.position() + static_cast<size_t>(length);
+                                const uint8_t extended = static_cast<uint8_t>(r.read(1));
+                                if(extended == OpExtendedEndSequence)
+                                {
+                                    emit(address, file, static_cast<uint64_t>(line), true);
+                                    reset();
+                                }
+                                else if(extended == OpExtendedSetAddress)
+                                {
+                                    address = r.read(static_cast<size_t>(std::min<uint64_t>(length - 1, 8)));
+                                }
+                                else if(extended == OpExtendedDefineFile)
+                                {
+                                    const std::string name = r.string();
+                                    const uint64_t directory = r.uleb();
+                                    unitFiles_.push_back(addFile(name, directory));
+                                }
+                                r.skip(next - r.position());
+                                break;
+                            }
+                            case OpCopy:
+                                emit(address, file, static_cast<uint64_t>(line), false);
+                                break;
+                            case OpAdvancePc:
+                                address += r.uleb() * minimumInstructionLength_;
+                                break;
+                            case OpAdvanceLine:
+                                line += r.sleb();
+                                break;
+                            case OpSetFile:
+                                file = r.uleb();
+                                break;
+                            case OpConstAddPc:
+                                address += static_cast<uint64_t>((255 - opcodeBase_) / lineRange_) *
+                                           minimumInstructionLength_;
+                                break;
+                            case OpFixedAdvancePc:
+                                address += r.read(2);
+                                break;
+                            default:
+                                // Remaining standard opcodes only affect columns and flags
+                                for(uint8_t i = 0; i < standardOpcodeLengths_[opcode]; i++)
+                                {
+                                    r.uleb();
+                                }
+                                break;
+                        }
+                    }
+                }
+
+                std::vector<std::string>& files_;
+                std::vector<LineRange>& ranges_;
+                std::map<std::string, uint32_t> fileIndex_;
+                std::string_view strings_;
+                std::string_view lineStrings_;
+
+                uint16_t version_ = 0;
+                uint8_t minimumInstructionLength_ = 1;
+                int8_t lineBase_ = 0;
+                uint8_t lineRange_ = 1;
+                uint8_t opcodeBase_ = 1;
+                std::vector<uint8_t> standardOpcodeLengths_;
+                std::vector<std::string> directories_;
+                std::vector<uint32_t> unitFiles_;
+
+                bool hasRow_ = false;
+                uint64_t rowAddress_ = 0;
+                uint64_t rowFile_ = 0;
+                uint64_t rowLine_ = 0;
+            };
+
+            int bindingRank(uint8_t binding)
+            {
+                if(binding == ElfFile::SymbolBindingGlobal)
+                {
+                    return 0;
+                }
+                return binding == ElfFile::SymbolBindingWeak ? 1 : 2;
+            }
+        }
+
+        SymbolTable SymbolTable::fromElf(const ElfFile& elf)
+        {
+            std::vector<ElfSymbol> functions = elf.symbols();
+            functions.erase(std::remove_if(functions.begin(), functions.end(),
+                                           [](const ElfSymbol& symbol) {
+                                               return symbol.Type != ElfFile::SymbolTypeFunction ||
+                                                      symbol.Name.empty();
+                                           }),
+                            functions.end());
+            std::stable_sort(functions.begin(), functions.end(), [](const ElfSymbol& a, const ElfSymbol& b) {
+                return bindingRank(a.Binding) < bindingRank(b.Binding);
+            });
+
+            std::vector<Symbol> symbols;
+            symbols.reserve(functions.size());
+            for(ElfSymbol& function : functions)
+            {
+                symbols.push_back(Symbol{std::move(function.Name), function.Address, function.Size});
+            }
+            return SymbolTable(std::move(symbols));
+        }
+
+        SymbolTable::SymbolTable(std::vector<Symbol> symbols) : symbols_(std::move(symbols))
+        {
+            std::stable_sort(symbols_.begin(), symbols_.end(),
+                             [](const Symbol& a, const Symbol& b) { return a.Address < b.Address; });
+            symbols_.erase(std::unique(symbols_.begin(), symbols_.end(),
+                                       [](const Symbol& a, const Symbol& b) { return a.Address == b.Address; }),
+                           symbols_.end());
+
+            for(size_t i = 0; i + 1 < symbols_.size(); i++)
+            {
+                if(symbols_[i].Size == 0)
+                {
+                    symbols_[i].Size = symbols_[i + 1].Address - symbols_[i].Address;
+                }
+            }
+        }
+
+        const Symbol* SymbolTable::find(uint64_t address) const
+        {
+            auto it = std::upper_bound(symbols_.begin(), symbols_.end(), address,
+                                       [](uint64_t value, const Symbol& symbol) { return value < symbol.Address; });
+            if(it == symbols_.begin())
+            {
+                return nullptr;
+            }
+
+            --it;
+            return address - it->Address < it->Size ? &*it : nullptr;
+        }
+
+        LineTable LineTable::fromElf(const ElfFile& elf)
+        {
+            std::vector<std::string> files;
+            std::vector<LineRange> ranges;
+
+            const ElfSection* section = elf.findSection(".debug_line");
+            if(section != nullptr)
+            {
+                const std::string_view data = elf.sectionData(*section);
+                LineProgramParser parser(elf, files, ranges);
+                for(size_t offset = 0; offset < data.size();)
+                {
+                    offset = parser.parseUnit(data, offset);
+                }
+            }
+
+            return LineTable(std::move(files), std::move(ranges));
+        }
+
+        LineTable::LineTable(std::vector<std::string> files, std::vector<LineRange> ranges)
+            : files_(std::move(files)), ranges_(std::move(ranges))
+        {
+            std::stable_sort(ranges_.begin(), ranges_.end(),
+                             [](const LineRange& a, const LineRange& b) { return a.Start < b.Start; });
+        }
+
+        const LineRange* LineTable::find(uint64_t address) const
+        {
+            auto it = std::upper_bound(ranges_.begin(), ranges_.end(), address,
+                                       [](uint64_t value, const LineRange& range) { return value < range.Start; });
+            if(it == ranges_.begin())
+            {
+                return nullptr;
+            }
+
+            --it;
+            return address < it->End ? &*it : nullptr;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#include "orbcode/decoder/watch.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            constexpr unsigned WatchTagMarkerPos = 24;
+            constexpr unsigned WatchTagComparatorPos = 16;
+            constexpr uint32_t WatchTagComparatorMask = 0x0F;
+            constexpr uint32_t WatchTagRegionMask = 0xFFFF;
+        }
+
+        double WatchRegionStatistics::rate() const
+        {
+            return Steps == 0 ? 0.0 : static_cast<double>(Accesses) / static_cast<double>(Steps);
+        }
+
+        WatchHeatmap::WatchHeatmap(uint8_t tagPort) : tagPort_(tagPort)
+        {
+        }
+
+        void WatchHeatmap::add(const ItmPacket& packet)
+        {
+            switch(packet.Type)
+            {
+                case ItmPacketType::Stimulus:
+                {
+                    if(packet.Address != tagPort_ || packet.Size != 4 ||
+                       (packet.Value >> WatchTagMarkerPos) != WatchTagMarker)
+                    {
+                        return;
+                    }
+                    // Data trace packets carry only 2 bits of comparator number
+                    const size_t comparator = ((packet.Value >> WatchTagComparatorPos) & WatchTagComparatorMask) %
+                        Comparators;
+                    const uint16_t region = static_cast<uint16_t>(packet.Value & WatchTagRegionMask);
+                    current_[comparator] = region;
+                    regions_[region].Steps++;
+                    lastComparator_ = -1;
+                    return;
+                }
+                case ItmPacketType::Overflow:
+                    overflows_++;
+                    lastComparator_ = -1;
+                    return;
+                case ItmPacketType::DataTracePC:
+                case ItmPacketType::DataTraceAddress:
+                case ItmPacketType::DataTraceValue:
+                    break;
+                default:
+                    return;
+            }
+
+            // Packets of single access are emitted in order PC, address, value
+            const int comparator = packet.Address;
+            const int order = packet.Type == ItmPacketType::DataTracePC ? 0
+                : packet.Type == ItmPacketType::DataTraceAddress        ? 1
+                                                                        : 2;
+            const bool sameAccess = lastComparator_ == comparator && order > lastOrder_;
+            lastComparator_ = comparator;
+            lastOrder_ = order;
+            if(sameAccess)
+            {
+                return;
+            }
+
+            const int region = current_[comparator % Comparators];
+            if(region == NoRegion)
+            {
+                untagged_++;
+                return;
+            }
+            regions_[static_cast<uint16_t>(region)].Accesses++;
+        }
+    }
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_itm ITM packet decoder
+         * @ingroup decoder
+         *
+         * @brief Splits raw ITM/DWT trace stream (TPIU formatting disabled) into packets
+         *
+         * Reference: ARMv7-M Architecture Reference Manual, appendix D4 Debug ITM and DWT Packet Protocol
+         *
+         * @{
+         */
+
+        /**
+         * @brief Type of ITM packet
+         */
+        enum class ItmPacketType : uint8_t
+        {
+            /**
+             * @brief Synchronization packet
+             */
+            Sync,
+            /**
+             * @brief Overflow packet, some packets were lost before it
+             */
+            Overflow,
+            /**
+             * @brief Local timestamp, ItmPacket#Value is number of timestamp clock ticks since previous one,
+             * ItmPacket#Info is TC field (0 for single-byte timestamps)
+             */
+            LocalTimestamp,
+            /**
+             * @brief Global timestamp bits 0-25 in ItmPacket#Value, ItmPacket#Info bit 0: clock changed, bit 1: wrap
+             */
+            GlobalTimestamp1,
+            /**
+             * @brief Global timestamp bits 26-47 in ItmPacket#Value (unshifted)
+             */
+            GlobalTimestamp2,
+            /**
+             * @brief Extension packet, ItmPacket#Value holds extension information bits, ItmPacket#Info bit 0 is SH bit
+             */
+            Extension,
+            /**
+             * @brief Data written to stimulus port ItmPacket#Address
+             */
+            Stimulus,
+            /**
+             * @brief DWT event counter wrap, ItmPacket#Value holds counter bits (CPI, EXC, SLEEP, LSU, FOLD, CYC)
+             */
+            EventCounter,
+            /**
+             * @brief Exception trace, ItmPacket#Value is exception number, ItmPacket#Info is function (1: entry,
+             * 2: exit, 3: return)
+             */
+            Exception,
+            /**
+             * @brief Periodic PC sample, ItmPacket#Info is 1 for sleep packet (no PC available)
+             */
+            PCSample,
+            /**
+             * @brief Data trace PC value of comparator ItmPacket#Address
+             */
+            DataTracePC,
+            /**
+             * @brief Data trace address offset (bits 0-15) of comparator ItmPacket#Address
+             */
+            DataTraceAddress,
+            /**
+             * @brief Data trace value of comparator ItmPacket#Address, ItmPacket#Info is 1 for write, 0 for read
+             */
+            DataTraceValue,
+            /**
+             * @brief Other hardware source packet, ItmPacket#Address is discriminator
+             */
+            Hardware,
+            /**
+             * @brief Reserved header byte
+             */
+            Reserved,
+        };
+
+        /**
+         * @brief Single decoded packet, meaning of fields depends on ItmPacket#Type
+         */
+        struct ItmPacket
+        {
+            /**
+             * @brief Packet type
+             */
+            ItmPacketType Type = ItmPacketType::Reserved;
+            /**
+             * @brief Stimulus port, hardware discriminator or comparator number
+             */
+            uint8_t Address = 0;
+            /**
+             * @brief Number of payload bytes
+             */
+            uint8_t Size = 0;
+            /**
+             * @brief Type-specific flags
+             */
+            uint8_t Info = 0;
+            /**
+             * @brief Payload
+             */
+            uint32_t Value = 0;
+        };
+
+        /**
+         * @brief Longest ITM packet in bytes (global timestamp 2 with 6 continuation bytes)
+         */
+        constexpr size_t ItmMaxPacketSize = 7;
+
+        /**
+         * @brief Streaming decoder of raw ITM stream
+         *
+         * Decoder starts unsynchronized and emits packets only after first synchronization packet unless constructed
+         * with @p synchronized set.
+         *
+         * Packets are parsed directly from caller's buffer, only packet split between two buffers is collected in
+         * decoder (at most @ref ItmMaxPacketSize bytes). Search for synchronization packet and skipping of zero
+         * padding process 16 bytes at a time (SSE2) or 8 bytes at a time (other targets). Decoder does not allocate
+         * memory.
+         *
+         * Use decode() to receive packets in caller-provided array (fastest) or feed() to receive them through
+         * callback.
+         */
+        class ItmPacketDecoder
+        {
+        public:
+            /**
+             * @brief Callback invoked for each packet
+             */
+            using Callback = std::function<void(const ItmPacket&)>;
+
+            /**
+             * @brief Creates decoder
+             *
+             * @param callback Callback invoked for each packet by feed(), can be empty when only decode() is used
+             * @param synchronized Assume stream starts at packet boundary (e.g. capture started before trace enabled)
+             */
+            explicit ItmPacketDecoder(Callback callback, bool synchronized = false);
+
+            /**
+             * @brief Decodes raw trace data into array of packets
+             *
+             * Stops when all data is consumed or @p capacity packets were decoded, caller passes remaining data in
+             * next call. Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             * @param packets Receives decoded packets
+             * @param capacity Size of @p packets array (at least 1)
+             * @param count Receives number of decoded packets
+             * @return Number of consumed bytes
+             */
+            size_t decode(const uint8_t* data, size_t size, ItmPacket* packets, size_t capacity, size_t& count);
+
+            /**
+             * @brief Feeds raw trace data, callback is invoked for each decoded packet
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+            /**
+             * @brief Returns true when decoder is synchronized to packet boundaries
+             */
+            bool synchronized() const
+            {
+                return synchronized_;
+            }
+
+        private:
+            static constexpr size_t BatchSize = 256;
+
+            const uint8_t* findSync(const uint8_t* data, const uint8_t* end);
+            void countTrailingZeros(const uint8_t* data, const uint8_t* end);
+
+            Callback callback_;
+            bool synchronized_;
+            size_t zeros_ = 0;
+            uint8_t pending_[ItmMaxPacketSize] = {};
+            size_t pendingSize_ = 0;
+            ItmPacket batch_[BatchSize];
+        };
+
+        /**
+         * @brief Returns name of exception (e.g. "SysTick", "IRQ 5")
+         *
+         * @param exception Exception number (0 is thread mode)
+         */
+        std::string exceptionName(uint16_t exception);
+
+        /** @} */
+    }
+}
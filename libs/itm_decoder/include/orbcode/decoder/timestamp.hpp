@@ -0,0 +1,166 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "orbcode/decoder/itm.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_timestamp Timestamp reconstruction
+         * @ingroup decoder
+         *
+         * @brief Attaches absolute time to ITM packets from local and global timestamps
+         *
+         * Local timestamp packet carries number of timestamp clock ticks since previous local timestamp and follows
+         * packets it applies to. Reconstructor keeps packets until next local timestamp, sums deltas multiplied by
+         * prescaler (`ITMOptions::LocalTimestampPrescaler`) into time in core clock cycles and reports TC field as
+         * ItmTimedPacket#Quality.
+         *
+         * Global timestamp is rebuilt from GTS1 packets (low 26 bits, bytes not sent are unchanged) and GTS2 packets
+         * (high bits). It is valid after first complete GTS1 packet and stays invalid between GTS1 with wrap flag and
+         * following GTS2.
+         *
+         * Overflow starts new epoch: local time continues from last known value but time lost in overflow is not
+         * included, so local times are comparable only within single epoch. Global timestamp becomes valid again
+         * after next complete GTS1 packet. State has constant size, overflow recovery does not need to look back in
+         * capture.
+         *
+         * @{
+         */
+
+        /**
+         * @brief Relationship between packet and its time
+         */
+        enum class ItmTimeQuality : uint8_t
+        {
+            /**
+             * @brief Timestamp is synchronous to packet (TC = 0)
+             */
+            Synchronous,
+            /**
+             * @brief Timestamp was delayed relative to packet (TC = 1)
+             */
+            TimestampDelayed,
+            /**
+             * @brief Packet was delayed relative to event it describes (TC = 2)
+             */
+            PacketDelayed,
+            /**
+             * @brief Both timestamp and packet were delayed (TC = 3)
+             */
+            BothDelayed,
+            /**
+             * @brief No local timestamp followed packet (overflow, end of data or too many packets), time of previous
+             * timestamp is used
+             */
+            Approximate,
+        };
+
+        /**
+         * @brief Packet with reconstructed time
+         */
+        struct ItmTimedPacket
+        {
+            /**
+             * @brief Packet
+             */
+            ItmPacket Packet;
+            /**
+             * @brief Local time in core clock cycles (sum of local timestamps)
+             */
+            uint64_t Time = 0;
+            /**
+             * @brief Number of overflows before packet, ItmTimedPacket#Time is comparable only within single epoch
+             */
+            uint32_t Epoch = 0;
+            /**
+             * @brief Relationship between packet and ItmTimedPacket#Time
+             */
+            ItmTimeQuality Quality = ItmTimeQuality::Approximate;
+            /**
+             * @brief ItmTimedPacket#GlobalTime is valid
+             */
+            bool GlobalValid = false;
+            /**
+             * @brief Most recent global timestamp (in global timestamp clock ticks)
+             */
+            uint64_t GlobalTime = 0;
+        };
+
+        /**
+         * @brief Streaming timestamp reconstructor
+         */
+        class ItmTimestampReconstructor
+        {
+        public:
+            /**
+             * @brief Callback invoked for each packet, in order of packets in stream
+             */
+            using Callback = std::function<void(const ItmTimedPacket&)>;
+
+            /**
+             * @brief Maximum number of packets waiting for local timestamp, older packets are reported as
+             * ItmTimeQuality::Approximate
+             */
+            static constexpr size_t MaxPending = 64;
+
+            /**
+             * @brief Creates reconstructor
+             *
+             * @param callback Callback invoked for each packet
+             * @param localPrescaler Local timestamp prescaler (1, 4, 16 or 64)
+             */
+            explicit ItmTimestampReconstructor(Callback callback, uint32_t localPrescaler = 1);
+
+            /**
+             * @brief Adds decoded packet
+             *
+             * @param packet Packet
+             */
+            void add(const ItmPacket& packet);
+
+            /**
+             * @brief Reports packets still waiting for local timestamp (e.g. at end of capture)
+             */
+            void flush();
+
+            /**
+             * @brief Returns current local time in core clock cycles
+             */
+            uint64_t time() const
+            {
+                return time_;
+            }
+
+            /**
+             * @brief Returns current epoch (number of overflows)
+             */
+            uint32_t epoch() const
+            {
+                return epoch_;
+            }
+
+        private:
+            void updateGlobal(const ItmPacket& packet);
+            void emitPending(ItmTimeQuality quality);
+            ItmTimedPacket timed(const ItmPacket& packet, ItmTimeQuality quality) const;
+
+            Callback callback_;
+            uint32_t prescaler_;
+            uint64_t time_ = 0;
+            uint32_t epoch_ = 0;
+            uint64_t global_ = 0;
+            bool globalLowValid_ = false;
+            bool globalWrapPending_ = false;
+            ItmTimedPacket pending_[MaxPending];
+            size_t pendingFirst_ = 0;
+            size_t pendingCount_ = 0;
+        };
+
+        /** @} */
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        /**
+         * @defgroup decoder_tpiu TPIU deframer
+         * @ingroup decoder
+         *
+         * @brief Splits TPIU formatter output (`TpiuOptions::FormattingEnabled`) into streams of trace sources
+         *
+         * Formatter wraps data in 16-byte frames. Even bytes carry either data (with least significant bit stored in
+         * the last byte of frame) or change of trace source ID, odd bytes always carry data. Frames are separated by
+         * optional full synchronization packets (`FF FF FF 7F`) and, on parallel trace port, halfword
+         * synchronization packets (`FF 7F`) used as filler.
+         *
+         * Frames containing only data (the common case) are unpacked 16 bytes at a time with SSE2 (x86) or NEON
+         * (AArch64), other frames byte by byte.
+         *
+         * Reference: CoreSight Architecture Specification, chapter D4 Trace Formatter
+         *
+         * @{
+         */
+
+        /**
+         * @brief Size of TPIU frame in bytes
+         */
+        constexpr size_t TpiuFrameSize = 16;
+
+        /**
+         * @brief Streaming TPIU deframer
+         *
+         * Data of each trace source is collected in deframer-owned buffer and passed to callback as single span per
+         * source at the end of every feed() call, so it can be fed to ItmPacketDecoder without further copying. Data
+         * of each source arrives in order, relative order of different sources is kept only with granularity of
+         * feed() calls.
+         *
+         * Data of null source (ID 0), reserved IDs (0x70 - 0x7F) and data preceding first ID change after
+         * synchronization is discarded.
+         */
+        class TpiuDeframer
+        {
+        public:
+            /**
+             * @brief Callback invoked with data of single trace source
+             *
+             * @param id Trace source ID (ITMOptions#TraceBusID for ITM)
+             * @param data Data, valid only during callback
+             * @param size Size of data
+             */
+            using Callback = std::function<void(uint8_t id, const uint8_t* data, size_t size)>;
+
+            /**
+             * @brief Deframer counters
+             */
+            struct Statistics
+            {
+                /**
+                 * @brief Number of frames
+                 */
+                uint64_t Frames = 0;
+                /**
+                 * @brief Number of full synchronization packets
+                 */
+                uint64_t Syncs = 0;
+                /**
+                 * @brief Number of halfword synchronization packets
+                 */
+                uint64_t HalfSyncs = 0;
+                /**
+                 * @brief Number of times synchronization was lost (unexpected data at frame boundary)
+                 */
+                uint64_t SyncLosses = 0;
+                /**
+                 * @brief Number of discarded data bytes
+                 */
+                uint64_t DiscardedBytes = 0;
+            };
+
+            /**
+             * @brief Creates deframer
+             *
+             * @param callback Callback invoked with data of each trace source
+             * @param synchronized Assume stream starts at frame boundary, otherwise data is skipped up to first full
+             * synchronization packet
+             */
+            explicit TpiuDeframer(Callback callback, bool synchronized = false);
+
+            /**
+             * @brief Feeds raw TPIU output
+             *
+             * Data can be split at any point.
+             *
+             * @param data Data
+             * @param size Size of data
+             */
+            void feed(const uint8_t* data, size_t size);
+
+            /**
+             * @brief Returns true when deframer is synchronized to frame boundaries
+             */
+            bool synchronized() const
+            {
+                return synchronized_;
+            }
+
+            /**
+             * @brief Returns deframer counters
+             */
+            const Statistics& statistics() const
+            {
+                return statistics_;
+            }
+
+        private:
+            static constexpr int UnknownId = -1;
+            static constexpr size_t IdCount = 128;
+
+            const uint8_t* findSync(const uint8_t* data, const uint8_t* end);
+            size_t boundary(const uint8_t* data, size_t available);
+            void frame(const uint8_t* frame);
+            void emit(uint8_t byte);
+            std::vector<uint8_t>* output();
+
+            Callback callback_;
+            bool synchronized_;
+            int id_ = UnknownId;
+            uint32_t syncWindow_ = 0;
+            uint8_t partial_[TpiuFrameSize] = {};
+            size_t partialSize_ = 0;
+            std::vector<uint8_t> outputs_[IdCount];
+            std::vector<uint8_t> active_;
+            Statistics statistics_;
+        };
+
+        /** @} */
+    }
+}
@@ -0,0 +1,391 @@
+#include "orbcode/decoder/itm.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#endif
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            constexpr uint8_t OverflowHeader = 0x70;
+            constexpr uint8_t SyncLastByte = 0x80;
+            constexpr uint8_t GlobalTimestamp1Header = 0x94;
+            constexpr uint8_t GlobalTimestamp2Header = 0xB4;
+
+            // Synchronization packet is at least 47 zero bits followed by single one bit
+            constexpr size_t SyncZeros = 5;
+
+            ItmPacket syncPacket()
+            {
+                ItmPacket packet;
+                packet.Type = ItmPacketType::Sync;
+                return packet;
+            }
+
+            // Returns length of packet with header continuation bytes, 0 if more data is needed
+            size_t continuationLength(const uint8_t* data, size_t available, size_t maxContinuation)
+            {
+                for(size_t i = 1; i <= maxContinuation; i++)
+                {
+                    if(i >= available)
+                    {
+                        return 0;
+                    }
+                    if((data[i] & 0x80) == 0)
+                    {
+                        return i + 1;
+                    }
+                }
+                return maxContinuation + 1;
+            }
+
+            // Returns length of packet starting at header byte, 0 if more data is needed
+            size_t packetLength(const uint8_t* data, size_t available)
+            {
+                const uint8_t header = data[0];
+                if((header & 0x03) != 0)
+                {
+                    static const uint8_t sizes[] = {0, 2, 3, 5};
+                    const size_t length = sizes[header & 0x03];
+                    return length <= available ? length : 0;
+                }
+                if(header == GlobalTimestamp1Header || ((header & 0xCF) == 0xC0))
+                {
+                    return continuationLength(data, available, 4);
+                }
+                if(header == GlobalTimestamp2Header)
+                {
+                    return continuationLength(data, available, 6);
+                }
+                if((header & 0x0B) == 0x08 && (header & 0x80) != 0)
+                {
+                    return continuationLength(data, available, 4);
+                }
+                return 1;
+            }
+
+            uint32_t continuationValue(const uint8_t* data, size_t length, unsigned shift)
+            {
+                uint32_t value = 0;
+                for(size_t i = 1; i < length; i++, shift += 7)
+                {
+                    if(shift < 32)
+                    {
+                        value |= static_cast<uint32_t>(data[i] & 0x7F) << shift;
+                    }
+                }
+                return value;
+            }
+
+            void parseHardware(ItmPacket& packet)
+            {
+                const uint8_t id = packet.Address;
+                if(id == 0)
+                {
+                    packet.Type = ItmPacketType::EventCounter;
+                }
+                else if(id == 1)
+                {
+                    packet.Type = ItmPacketType::Exception;
+                    packet.Info = static_cast<uint8_t>((packet.Value >> 12) & 0x03);
+                    packet.Value &= 0x1FF;
+                }
+                else if(id == 2)
+                {
+                    packet.Type = ItmPacketType::PCSample;
+                    packet.Info = packet.Size == 1 ? 1 : 0;
+                }
+                else if(id >= 8 && id <= 23)
+                {
+                    packet.Address = (id >> 1) & 0x03;
+                    if((id & 0x10) != 0)
+                    {
+                        packet.Type = ItmPacketType::DataTraceValue;
+                        packet.Info = id & 0x01;
+                    }
+                    else
+                    {
+                        packet.Type = (id & 0x01) != 0 ? ItmPacketType::DataTraceAddress : ItmPacketType::DataTracePC;
+                    }
+                }
+            }
+
+            // Decodes complete packet (length from packetLength())
+            void parse(const uint8_t* data, size_t length, ItmPacket& packet)
+            {
+                const uint8_t header = data[0];
+                packet = ItmPacket{};
+
+                if((header & 0x03) != 0)
+                {
+                    packet.Type = (header & 0x04) != 0 ? ItmPacketType::Hardware : ItmPacketType::Stimulus;
+                    packet.Address = header >> 3;
+                    packet.Size = static_cast<uint8_t>(length - 1);
+                    for(size_t i = 1; i < length; i++)
+                    {
+                        packet.Value |= static_cast<uint32_t>(data[i]) << (8 * (i - 1));
+                    }
+                    if(packet.Type == ItmPacketType::Hardware)
+                    {
+                        parseHardware(packet);
+                    }
+                    return;
+                }
+
+                packet.Size = static_cast<uint8_t>(length - 1);
+                if(header == OverflowHeader)
+                {
+                    packet.Type = ItmPacketType::Overflow;
+                }
+                else if((header & 0x8F) == 0x00)
+                {
+                    packet.Type = ItmPacketType::LocalTimestamp;
+                    packet.Value = (header >> 4) & 0x07;
+                }
+                else if((header & 0xCF) == 0xC0)
+                {
+                    packet.Type = ItmPacketType::LocalTimestamp;
+                    packet.Info = (header >> 4) & 0x03;
+                    packet.Value = continuationValue(data, length, 0);
+                }
+                else if(header == GlobalTimestamp1Header)
+                {
+                    packet.Type = ItmPacketType::GlobalTimestamp1;
+                    packet.Value = continuationValue(data, length, 0);
+                    if(length == 5)
+                    {
+                        // Last byte carries bits 21-25 of timestamp, clock change and wrap flags
+                        packet.Info =
+                            static_cast<uint8_t>(((packet.Value >> 26) & 0x01) | ((packet.Value >> 26) & 0x02));
+                        packet.Value &= 0x03FFFFFF;
+                    }
+                }
+                else if(header == GlobalTimestamp2Header)
+                {
+                    packet.Type = ItmPacketType::GlobalTimestamp2;
+                    packet.Value = continuationValue(data, length, 0);
+                }
+                else if((header & 0x0B) == 0x08)
+                {
+                    packet.Type = ItmPacketType::Extension;
+                    packet.Info = (header >> 2) & 0x01;
+                    packet.Value = ((header >> 4) & 0x07) | continuationValue(data, length, 3);
+                }
+                else
+                {
+                    packet.Address = header;
+                }
+            }
+
+            // Returns first non-zero byte or end
+            const uint8_t* skipZeros(const uint8_t* data, const uint8_t* end)
+            {
+#if defined(__SSE2__) && defined(__GNUC__)
+                const __m128i zero = _mm_setzero_si128();
+                while(end - data >= 16)
+                {
+                    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                    const unsigned nonZero = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero))) &
+                        0xFFFFU;
+                    if(nonZero != 0)
+                    {
+                        return data + __builtin_ctz(nonZero);
+                    }
+                    data += 16;
+                }
+#else
+                while(end - data >= 8)
+                {
+                    uint64_t word;
+                    std::memcpy(&word, data, sizeof(word));
+                    if(word != 0)
+                    {
+                        break;
+                    }
+                    data += 8;
+                }
+#endif
+                while(data < end && *data == 0)
+                {
+                    data++;
+                }
+                return data;
+            }
+        }
+
+        ItmPacketDecoder::ItmPacketDecoder(Callback callback, bool synchronized)
+            : callback_(std::move(callback)), synchronized_(synchronized)
+        {
+        }
+
+        size_t ItmPacketDecoder::decode(const uint8_t* data, size_t size, ItmPacket* packets, size_t capacity,
+                                        size_t& count)
+        {
+            const uint8_t* p = data;
+            const uint8_t* const end = data + size;
+            count = 0;
+
+            while(p < end && count < capacity)
+            {
+                if(pendingSize_ > 0)
+                {
+                    // Packet split between buffers
+                    pending_[pendingSize_++] = *p++;
+                    const size_t length = packetLength(pending_, pendingSize_);
+                    if(length != 0)
+                    {
+                        parse(pending_, length, packets[count++]);
+                        pendingSize_ = 0;
+                    }
+                    continue;
+                }
+
+                if(!synchronized_)
+                {
+                    p = findSync(p, end);
+                    if(synchronized_)
+                    {
+                        packets[count++] = syncPacket();
+                    }
+                    continue;
+                }
+
+                if(*p == 0x00)
+                {
+                    const uint8_t* next = skipZeros(p, end);
+                    zeros_ += static_cast<size_t>(next - p);
+                    p = next;
+                    continue;
+                }
+
+                if(*p == SyncLastByte && zeros_ >= SyncZeros)
+                {
+                    zeros_ = 0;
+                    p++;
+                    packets[count++] = syncPacket();
+                    continue;
+                }
+                zeros_ = 0;
+
+                const size_t available = static_cast<size_t>(end - p);
+                const size_t length = packetLength(p, available);
+                if(length == 0)
+                {
+                    std::memcpy(pending_, p, available);
+                    pendingSize_ = available;
+                    p = end;
+                    break;
+                }
+
+                parse(p, length, packets[count++]);
+                p += length;
+            }
+
+            return static_cast<size_t>(p - data);
+        }
+
+        void ItmPacketDecoder::feed(const uint8_t* data, size_t size)
+        {
+            while(size > 0)
+            {
+                size_t count;
+                const size_t consumed = decode(data, size, batch_, BatchSize, count);
+                for(size_t i = 0; i < count; i++)
+                {
+                    callback_(batch_[i]);
+                }
+                data += consumed;
+                size -= consumed;
+            }
+        }
+
+        const uint8_t* ItmPacketDecoder::findSync(const uint8_t* data, const uint8_t* end)
+        {
+            const uint8_t* p = data;
+            while(p < end)
+            {
+                // memchr is vectorized by C library
+                auto candidate =
+                    static_cast<const uint8_t*>(std::memchr(p, SyncLastByte, static_cast<size_t>(end - p)));
+                if(candidate == nullptr)
+                {
+                    countTrailingZeros(p, end);
+                    return end;
+                }
+
+                size_t run = 0;
+                const uint8_t* q = candidate;
+                while(q > p && q[-1] == 0x00 && run < SyncZeros)
+                {
+                    q--;
+                    run++;
+                }
+                if(q == p)
+                {
+                    // All bytes since previous position are zeros, continue run from previous data
+                    run += zeros_;
+                }
+
+                zeros_ = 0;
+                p = candidate + 1;
+                if(run >= SyncZeros)
+                {
+                    synchronized_ = true;
+                    return p;
+                }
+            }
+            return p;
+        }
+
+        void ItmPacketDecoder::countTrailingZeros(const uint8_t* data, const uint8_t* end)
+        {
+            size_t run = 0;
+            const uint8_t* q = end;
+            while(q > data && q[-1] == 0x00 && run < SyncZeros)
+            {
+                q--;
+                run++;
+            }
+            zeros_ = q == data ? zeros_ + run : run;
+        }
+
+        std::string exceptionName(uint16_t exception)
+        {
+            switch(exception)
+            {
+                case 0:
+                    return "Thread";
+                case 1:
+                    return "Reset";
+                case 2:
+                    return "NMI";
+                case 3:
+                    return "HardFault";
+                case 4:
+                    return "MemManage";
+                case 5:
+                    return "BusFault";
+                case 6:
+                    return "UsageFault";
+                case 7:
+                    return "SecureFault";
+                case 11:
+                    return "SVCall";
+                case 12:
+                    return "DebugMonitor";
+                case 14:
+                    return "PendSV";
+                case 15:
+                    return "SysTick";
+                default:
+                    break;
+            }
+            return exception >= 16 ? "IRQ " + std::to_string(exception - 16) : "Exception " + std::to_string(exception);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#include "orbcode/decoder/timestamp.hpp"
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            constexpr unsigned GlobalLowBits = 26;
+            constexpr size_t GlobalFullSize = 4;
+        }
+
+        ItmTimestampReconstructor::ItmTimestampReconstructor(Callback callback, uint32_t localPrescaler)
+            : callback_(std::move(callback)), prescaler_(localPrescaler == 0 ? 1 : localPrescaler)
+        {
+        }
+
+        void ItmTimestampReconstructor::add(const ItmPacket& packet)
+        {
+            switch(packet.Type)
+            {
+                case ItmPacketType::LocalTimestamp:
+                {
+                    time_ += static_cast<uint64_t>(packet.Value) * prescaler_;
+                    const ItmTimeQuality quality = static_cast<ItmTimeQuality>(packet.Info & 0x03);
+                    emitPending(quality);
+                    callback_(timed(packet, quality));
+                    return;
+                }
+                case ItmPacketType::Overflow:
+                    // Timestamps of pending packets might have been lost
+                    emitPending(ItmTimeQuality::Approximate);
+                    epoch_++;
+                    globalLowValid_ = false;
+                    callback_(timed(packet, ItmTimeQuality::Approximate));
+                    return;
+                case ItmPacketType::GlobalTimestamp1:
+                case ItmPacketType::GlobalTimestamp2:
+                    updateGlobal(packet);
+                    break;
+                default:
+                    break;
+            }
+
+            if(pendingCount_ == MaxPending)
+            {
+                callback_(pending_[pendingFirst_]);
+                pendingFirst_ = (pendingFirst_ + 1) % MaxPending;
+                pendingCount_--;
+            }
+            pending_[(pendingFirst_ + pendingCount_) % MaxPending] = timed(packet, ItmTimeQuality::Approximate);
+            pendingCount_++;
+        }
+
+        void ItmTimestampReconstructor::flush()
+        {
+            emitPending(ItmTimeQuality::Approximate);
+        }
+
+        void ItmTimestampReconstructor::updateGlobal(const ItmPacket& packet)
+        {
+            if(packet.Type == ItmPacketType::GlobalTimestamp2)
+            {
+                const uint64_t low = global_ & ((uint64_t{1} << GlobalLowBits) - 1);
+                global_ = low | (static_cast<uint64_t>(packet.Value) << GlobalLowBits);
+                globalWrapPending_ = false;
+                return;
+            }
+
+            // Bytes not sent are the same as in previous GTS1 packet
+            const unsigned bits = packet.Size >= GlobalFullSize ? GlobalLowBits : 7U * packet.Size;
+            const uint64_t mask = (uint64_t{1} << bits) - 1;
+            global_ = (global_ & ~mask) | (packet.Value & mask);
+
+            if(packet.Size >= GlobalFullSize)
+            {
+                globalLowValid_ = true;
+                // High bits changed, valid again after GTS2
+                globalWrapPending_ = (packet.Info & 0x02) != 0;
+            }
+        }
+
+        void ItmTimestampReconstructor::emitPending(ItmTimeQuality quality)
+        {
+            for(size_t i = 0; i < pendingCount_; i++)
+            {
+                ItmTimedPacket& packet = pending_[(pendingFirst_ + i) % MaxPending];
+                packet.Time = time_;
+                packet.Quality = quality;
+                callback_(packet);
+            }
+            pendingFirst_ = 0;
+            pendingCount_ = 0;
+        }
+
+        ItmTimedPacket ItmTimestampReconstructor::timed(const ItmPacket& packet, ItmTimeQuality quality) const
+        {
+            ItmTimedPacket result;
+            result.Packet = packet;
+            result.Time = time_;
+            result.Epoch = epoch_;
+            result.Quality = quality;
+            result.GlobalValid = globalLowValid_ && !globalWrapPending_;
+            result.GlobalTime = global_;
+            return result;
+        }
+    }
+}
@@ -0,0 +1,291 @@
+#include "orbcode/decoder/tpiu.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#    include <arm_neon.h>
+#endif
+
+namespace orbcode
+{
+    namespace decoder
+    {
+        namespace
+        {
+            constexpr uint8_t SyncByte = 0xFF;
+            constexpr uint8_t SyncLastByte = 0x7F;
+            constexpr size_t FrameDataSize = TpiuFrameSize - 1;
+            constexpr uint8_t FirstReservedId = 0x70;
+
+            // Unpacks frame without ID changes into 15 data bytes (plus one garbage byte), returns false for frames
+            // with ID changes
+            bool unpackDataFrame(const uint8_t* frame, uint8_t* out)
+            {
+#if defined(__SSE2__)
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frame));
+                // Bit 0 of every byte moved to bit 7, only even bytes 0-14 carry ID flag
+                const int flags = _mm_movemask_epi8(_mm_slli_epi16(v, 7)) & 0x5555;
+                if(flags != 0)
+                {
+                    return false;
+                }
+
+                const __m128i lsbSelect = _mm_setr_epi8(1, 0, 2, 0, 4, 0, 8, 0, 16, 0, 32, 0, 64, 0, -128, 0);
+                const __m128i dataMask = _mm_setr_epi8(-2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2, 0);
+                const __m128i aux = _mm_set1_epi8(static_cast<char>(frame[TpiuFrameSize - 1]));
+                // Compare on odd bytes (select 0) is always true, only even bytes take LSB
+                const __m128i set = _mm_cmpeq_epi8(_mm_and_si128(aux, lsbSelect), lsbSelect);
+                const __m128i even = _mm_setr_epi8(1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0);
+                const __m128i evenLsb = _mm_and_si128(set, even);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_or_si128(_mm_and_si128(v, dataMask), evenLsb));
+                return true;
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+                static const uint8_t evenBytes[16] = {1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0};
+                static const uint8_t lsbSelectBytes[16] = {1, 0, 2, 0, 4, 0, 8, 0, 16, 0, 32, 0, 64, 0, 128, 0};
+                static const uint8_t dataMaskBytes[16] = {0xFE, 0xFF, 0xFE, 0xFF, 0xFE, 0xFF, 0xFE, 0xFF,
+                                                          0xFE, 0xFF, 0xFE, 0xFF, 0xFE, 0xFF, 0xFE, 0x00};
+                const uint8x16_t v = vld1q_u8(frame);
+                const uint8x16_t even = vld1q_u8(evenBytes);
+                if(vmaxvq_u8(vandq_u8(v, even)) != 0)
+                {
+                    return false;
+                }
+
+                const uint8x16_t aux = vdupq_n_u8(frame[TpiuFrameSize - 1]);
+                const uint8x16_t lsb = vandq_u8(vtstq_u8(aux, vld1q_u8(lsbSelectBytes)), even);
+                vst1q_u8(out, vorrq_u8(vandq_u8(v, vld1q_u8(dataMaskBytes)), lsb));
+                return true;
+#else
+                const uint8_t aux = frame[TpiuFrameSize - 1];
+                for(size_t i = 0; i < FrameDataSize; i += 2)
+                {
+                    if((frame[i] & 0x01) != 0)
+                    {
+                        return false;
+                    }
+                }
+                for(size_t i = 0; i < FrameDataSize; i++)
+                {
+                    out[i] = (i & 1) != 0 ? frame[i] : static_cast<uint8_t>(frame[i] | ((aux >> (i / 2)) & 0x01));
+                }
+                return true;
+#endif
+            }
+        }
+
+        TpiuDeframer::TpiuDeframer(Callback callback, bool synchronized)
+            : callback_(std::move(callback)), synchronized_(synchronized)
+        {
+        }
+
+        void TpiuDeframer::feed(const uint8_t* data, size_t size)
+        {
+            const uint8_t* p = data;
+            const uint8_t* const end = data + size;
+
+            while(p < end)
+            {
+                if(!synchronized_)
+                {
+                    p = findSync(p, end);
+                    continue;
+                }
+
+                if(partialSize_ > 0)
+                {
+                    // Frame or synchronization packet split between buffers
+                    partial_[partialSize_++] = *p++;
+                    if(boundary(partial_, partialSize_) != 0)
+                    {
+                        partialSize_ = 0;
+                    }
+                    continue;
+                }
+
+                const size_t available = static_cast<size_t>(end - p);
+                if(available >= TpiuFrameSize && p[0] != SyncByte)
+                {
+                    frame(p);
+                    p += TpiuFrameSize;
+                    continue;
+                }
+
+                const size_t consumed = boundary(p, available);
+                if(consumed == 0)
+                {
+                    std::memcpy(partial_, p, available);
+                    partialSize_ = available;
+                    break;
+                }
+                p += consumed;
+            }
+
+            for(uint8_t id : active_)
+            {
+                std::vector<uint8_t>& output = outputs_[id];
+                callback_(id, output.data(), output.size());
+                output.clear();
+            }
+            active_.clear();
+        }
+
+        const uint8_t* TpiuDeframer::findSync(const uint8_t* data, const uint8_t* end)
+        {
+            const uint8_t* p = data;
+            while(p < end)
+            {
+                // memchr is vectorized by C library
+                auto candidate =
+                    static_cast<const uint8_t*>(std::memchr(p, SyncLastByte, static_cast<size_t>(end - p)));
+                if(candidate == nullptr)
+                {
+                    break;
+                }
+
+                // Three preceding bytes, taken from previous data when candidate is close to start
+                bool sync = true;
+                for(size_t k = 1; k <= 3 && sync; k++)
+                {
+                    const size_t inBuffer = static_cast<size_t>(candidate - data);
+                    const uint8_t byte = k <= inBuffer ? candidate[-static_cast<ptrdiff_t>(k)]
+                                                       : static_cast<uint8_t>(syncWindow_ >> (8 * (k - inBuffer - 1)));
+                    sync = byte == SyncByte;
+                }
+
+                p = candidate + 1;
+                if(sync)
+                {
+                    synchronized_ = true;
+                    id_ = UnknownId;
+                    partialSize_ = 0;
+                    syncWindow_ = 0;
+                    statistics_.Syncs++;
+                    return p;
+                }
+            }
+
+            // Keep last three bytes for packet split between buffers
+            for(const uint8_t* q = end - std::min<size_t>(3, static_cast<size_t>(end - data)); q < end; q++)
+            {
+                syncWindow_ = ((syncWindow_ << 8) | *q) & 0xFFFFFF;
+            }
+            return end;
+        }
+
+        size_t TpiuDeframer::boundary(const uint8_t* data, size_t available)
+        {
+            if(data[0] != SyncByte)
+            {
+                if(available < TpiuFrameSize)
+                {
+                    return 0;
+                }
+                frame(data);
+                return TpiuFrameSize;
+            }
+
+            // ID 0x7F is reserved, 0xFF at frame boundary always starts synchronization packet
+            static const uint8_t sync[] = {SyncByte, SyncByte, SyncByte, SyncLastByte};
+            for(size_t i = 1; i < sizeof(sync); i++)
+            {
+                if(i >= available)
+                {
+                    return 0;
+                }
+                if(i == 1 && data[i] == SyncLastByte)
+                {
+                    statistics_.HalfSyncs++;
+                    return 2;
+                }
+                if(data[i] != sync[i])
+                {
+                    synchronized_ = false;
+                    id_ = UnknownId;
+                    syncWindow_ = 0;
+                    statistics_.SyncLosses++;
+                    return i + 1;
+                }
+            }
+            statistics_.Syncs++;
+            return sizeof(sync);
+        }
+
+        void TpiuDeframer::frame(const uint8_t* frame)
+        {
+            statistics_.Frames++;
+
+            uint8_t unpacked[TpiuFrameSize];
+            if(unpackDataFrame(frame, unpacked))
+            {
+                std::vector<uint8_t>* out = output();
+                if(out == nullptr)
+                {
+                    statistics_.DiscardedBytes += FrameDataSize;
+                    return;
+                }
+                out->insert(out->end(), unpacked, unpacked + FrameDataSize);
+                return;
+            }
+
+            const uint8_t aux = frame[TpiuFrameSize - 1];
+            for(size_t k = 0; k < TpiuFrameSize / 2; k++)
+            {
+                const uint8_t even = frame[2 * k];
+                const bool flag = ((aux >> k) & 0x01) != 0;
+                const bool hasOdd = 2 * k + 1 < FrameDataSize;
+
+                if((even & 0x01) == 0)
+                {
+                    emit(static_cast<uint8_t>(even | (flag ? 1 : 0)));
+                    if(hasOdd)
+                    {
+                        emit(frame[2 * k + 1]);
+                    }
+                    continue;
+                }
+
+                // Flag set: following data byte still belongs to previous ID
+                if(flag && hasOdd)
+                {
+                    emit(frame[2 * k + 1]);
+                    id_ = even >> 1;
+                    continue;
+                }
+                id_ = even >> 1;
+                if(hasOdd)
+                {
+                    emit(frame[2 * k + 1]);
+                }
+            }
+        }
+
+        void TpiuDeframer::emit(uint8_t byte)
+        {
+            std::vector<uint8_t>* out = output();
+            if(out == nullptr)
+            {
+                statistics_.DiscardedBytes++;
+                return;
+            }
+            out->push_back(byte);
+        }
+
+        std::vector<uint8_t>* TpiuDeframer::output()
+        {
+            if(id_ <= 0 || id_ >= FirstReservedId)
+            {
+                return nullptr;
+            }
+
+            std::vector<uint8_t>& out = outputs_[id_];
+            if(out.empty())
+            {
+                active_.push_back(static_cast<uint8_t>(id_));
+            }
+            return &out;
+        }
+    }
+}
@@ -0,0 +1,508 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @defgroup sim Simulated trace registers
+ *
+ * @brief Host replacement of device header (`core_cmX.h`) with ITM, DWT, TPI and CoreDebug registers in RAM
+ *
+ * Include this header instead of vendor device header to run target code on host, e.g. to measure and
+ * regression-test write paths without hardware:
+ *
+ * @code{.cpp}
+ * #include "orbcode/sim/device.hpp"
+ * #include "orbcode/trace/itm.h"
+ *
+ * orbcode::sim::FifoOptions fifo;
+ * fifo.DrainPerAccess = 0.5; // trace link twice slower than CPU writing to stimulus port
+ * orbcode::sim::Device.reset(fifo);
+ * ITMSetup(&options);
+ * ITMWriteBuffer(1, data, size);
+ * @endcode
+ *
+ * Registers follow ARMv7-M layout (Cortex-M3), so `atomic.h` uses PRIMASK critical sections (simulated as plain
+ * variables, there are no interrupts). Stimulus port accesses go through orbcode::sim::Simulator which models
+ * shared ITM FIFO: each read or write of stimulus port register drains FifoOptions#DrainPerAccess bytes and port reads
+ * as ready while at least one word fits. Written data can be captured for comparison with expected output.
+ *
+ * Supported headers: `itm.h`, `atomic.h`, `itm_buffer.h`, `itm_atomic.h`, `itm_frame.h`, `delta.h`, `event.h`,
+ * `log.h`, `flight_recorder.h`, `dwt.h` (ARMv7-M comparators), `dwt_counters.h`, `tpiu.h` and `itm_lowpower.h`
+ * (`__WFI()` returns immediately, advancing cycle counter by Simulator#SleepCycles). RAM backend (`itm_ram.h`) is used
+ * when `ITM_BACKEND` is defined as `ITM_BACKEND_RAM` before including `itm.h`. Register values are not interpreted
+ * beyond stimulus ports, so DWT packets, timestamps and cycle counter are not simulated.
+ *
+ * @{
+ */
+
+#define __CORTEX_M 3U
+#define __NVIC_PRIO_BITS 3U
+
+struct ITM_Type;
+
+namespace orbcode
+{
+    namespace sim
+    {
+        /**
+         * @brief Model of ITM FIFO
+         */
+        struct FifoOptions
+        {
+            /**
+             * @brief FIFO capacity in bytes
+             */
+            size_t Depth = 16;
+            /**
+             * @brief Bytes sent to trace link per stimulus port access, 0 or less makes FIFO always ready
+             */
+            double DrainPerAccess = 0;
+        };
+
+        /**
+         * @brief Counters of stimulus port accesses
+         */
+        struct Statistics
+        {
+            /**
+             * @brief Reads and writes of stimulus port registers
+             */
+            uint64_t Accesses = 0;
+            /**
+             * @brief Reads of stimulus port registers that returned not ready
+             */
+            uint64_t Stalls = 0;
+            /**
+             * @brief Writes to stimulus port registers accepted by FIFO
+             */
+            uint64_t Writes = 0;
+            /**
+             * @brief Bytes accepted by FIFO
+             */
+            uint64_t Bytes = 0;
+            /**
+             * @brief Writes lost because FIFO was full (code did not wait for ready port)
+             */
+            uint64_t Overflows = 0;
+        };
+
+        /**
+         * @brief Access of given width to stimulus port register
+         *
+         * Reading returns 1 when FIFO can accept data (`FIFOREADY`), writing pushes value into FIFO.
+         */
+        template <typename T>
+        class PortAccess
+        {
+        public:
+            PortAccess& operator=(T value);
+
+            operator uint32_t();
+
+        private:
+            friend struct ::ITM_Type;
+
+            uint8_t port_ = 0;
+        };
+
+        /**
+         * @brief Stimulus port register accessed as 8, 16 or 32 bits
+         */
+        struct StimulusPort
+        {
+            PortAccess<uint8_t> u8;
+            PortAccess<uint16_t> u16;
+            PortAccess<uint32_t> u32;
+        };
+    }
+}
+
+/**
+ * @brief ITM registers
+ */
+struct ITM_Type
+{
+    ITM_Type()
+    {
+        for(uint8_t i = 0; i < 32; i++)
+        {
+            PORT[i].u8.port_ = i;
+            PORT[i].u16.port_ = i;
+            PORT[i].u32.port_ = i;
+        }
+    }
+
+    orbcode::sim::StimulusPort PORT[32];
+    volatile uint32_t TER = 0;
+    volatile uint32_t TPR = 0;
+    volatile uint32_t TCR = 0;
+    volatile uint32_t LAR = 0;
+    volatile uint32_t LSR = 0;
+};
+
+/**
+ * @brief DWT registers (ARMv7-M layout from `CTRL` to comparators)
+ */
+struct DWT_Type
+{
+    volatile uint32_t CTRL = 4UL << 28; // 4 comparators
+    volatile uint32_t CYCCNT = 0;
+    volatile uint32_t CPICNT = 0;
+    volatile uint32_t EXCCNT = 0;
+    volatile uint32_t SLEEPCNT = 0;
+    volatile uint32_t LSUCNT = 0;
+    volatile uint32_t FOLDCNT = 0;
+    volatile uint32_t PCSR = 0;
+    volatile uint32_t COMP0 = 0;
+    volatile uint32_t MASK0 = 0;
+    volatile uint32_t FUNCTION0 = 0;
+    volatile uint32_t RESERVED0 = 0;
+    volatile uint32_t Comparators[12] = {}; // COMP1-FUNCTION3 addressed relative to COMP0
+    volatile uint32_t LAR = 0;
+};
+
+/**
+ * @brief TPI registers used by `tpiu.h`
+ */
+struct TPI_Type
+{
+    volatile uint32_t SSPSR = 0xB; // port widths 1, 2 and 4
+    volatile uint32_t CSPSR = 0;
+    volatile uint32_t ACPR = 0;
+    volatile uint32_t SPPR = 0;
+    volatile uint32_t FFSR = 0;
+    volatile uint32_t FFCR = 0;
+};
+
+/**
+ * @brief CoreDebug registers
+ */
+struct CoreDebug_Type
+{
+    volatile uint32_t DHCSR = 0;
+    volatile uint32_t DCRSR = 0;
+    volatile uint32_t DCRDR = 0;
+    volatile uint32_t DEMCR = 0;
+};
+
+namespace orbcode
+{
+    namespace sim
+    {
+        /**
+         * @brief Simulated trace registers and ITM FIFO
+         */
+        class Simulator
+        {
+        public:
+            /**
+             * @brief Restores registers to reset values, clears counters and captured data
+             *
+             * @param fifo FIFO model
+             */
+            void reset(const FifoOptions& fifo = FifoOptions())
+            {
+                Itm = ITM_Type();
+                Dwt = DWT_Type();
+                Tpi = TPI_Type();
+                CoreDebug = CoreDebug_Type();
+                Primask = 0;
+                Basepri = 0;
+                SleepCycles = 0;
+                Sleeps = 0;
+                fifo_ = fifo;
+                level_ = 0;
+                statistics_ = Statistics();
+                for(std::vector<uint8_t>& output : output_)
+                {
+                    output.clear();
+                }
+            }
+
+            /**
+             * @brief Enables or disables capture of data accepted by FIFO
+             */
+            void capture(bool enabled)
+            {
+                capture_ = enabled;
+            }
+
+            /**
+             * @brief Returns data captured from stimulus port
+             */
+            const std::vector<uint8_t>& output(uint8_t port) const
+            {
+                return output_[port & 31U];
+            }
+
+            /**
+             * @brief Clears captured data of all stimulus ports
+             */
+            void clearOutput()
+            {
+                for(std::vector<uint8_t>& output : output_)
+                {
+                    output.clear();
+                }
+            }
+
+            /**
+             * @brief Returns access counters
+             */
+            const Statistics& statistics() const
+            {
+                return statistics_;
+            }
+
+            /**
+             * @brief Reads stimulus port register
+             *
+             * @return true FIFO can accept one word
+             */
+            bool poll(uint8_t port)
+            {
+                (void)port;
+                access();
+                const bool ready = unlimited() || level_ + 4.0 <= static_cast<double>(fifo_.Depth);
+                if(!ready)
+                {
+                    statistics_.Stalls++;
+                }
+                return ready;
+            }
+
+            /**
+             * @brief Writes stimulus port register
+             */
+            void write(uint8_t port, uint32_t value, unsigned size)
+            {
+                access();
+                if(!unlimited())
+                {
+                    if(level_ + size > static_cast<double>(fifo_.Depth))
+                    {
+                        statistics_.Overflows++;
+                        return;
+                    }
+                    level_ += size;
+                }
+
+                statistics_.Writes++;
+                statistics_.Bytes += size;
+                if(capture_)
+                {
+                    for(unsigned i = 0; i < size; i++)
+                    {
+                        output_[port & 31U].push_back(static_cast<uint8_t>(value >> (8 * i)));
+                    }
+                }
+            }
+
+            ITM_Type Itm;
+            DWT_Type Dwt;
+            TPI_Type Tpi;
+            CoreDebug_Type CoreDebug;
+            uint32_t Primask = 0;
+            uint32_t Basepri = 0;
+            /**
+             * @brief Cycles added to `DWT_CYCCNT` by each `__WFI()`
+             */
+            uint32_t SleepCycles = 0;
+            /**
+             * @brief Number of `__WFI()` calls
+             */
+            uint32_t Sleeps = 0;
+
+        private:
+            bool unlimited() const
+            {
+                return fifo_.DrainPerAccess <= 0;
+            }
+
+            void access()
+            {
+                statistics_.Accesses++;
+                if(!unlimited())
+                {
+                    level_ = level_ > fifo_.DrainPerAccess ? level_ - fifo_.DrainPerAccess : 0;
+                }
+            }
+
+            FifoOptions fifo_;
+            double level_ = 0;
+            bool capture_ = false;
+            Statistics statistics_;
+            std::vector<uint8_t> output_[32];
+        };
+
+        /**
+         * @brief Simulated device used by `ITM`, `DWT`, `TPI` and `CoreDebug` macros
+         */
+        inline Simulator Device;
+
+        template <typename T>
+        PortAccess<T>& PortAccess<T>::operator=(T value)
+        {
+            Device.write(port_, value, sizeof(T));
+            return *this;
+        }
+
+        template <typename T>
+        PortAccess<T>::operator uint32_t()
+        {
+            return Device.poll(port_) ? 1U : 0U;
+        }
+    }
+}
+
+#define ITM (&::orbcode::sim::Device.Itm)
+#define DWT (&::orbcode::sim::Device.Dwt)
+#define TPI (&::orbcode::sim::Device.Tpi)
+#define CoreDebug (&::orbcode::sim::Device.CoreDebug)
+#define ORBCODE_TRACE_DWT_LAR (::orbcode::sim::Device.Dwt.LAR)
+
+// Register fields, values match core_cm3.h
+
+#define ITM_TCR_ITMENA_Pos 0U
+#define ITM_TCR_ITMENA_Msk (1UL << ITM_TCR_ITMENA_Pos)
+#define ITM_TCR_TSENA_Pos 1U
+#define ITM_TCR_TSENA_Msk (1UL << ITM_TCR_TSENA_Pos)
+#define ITM_TCR_SYNCENA_Pos 2U
+#define ITM_TCR_SYNCENA_Msk (1UL << ITM_TCR_SYNCENA_Pos)
+#define ITM_TCR_DWTENA_Pos 3U
+#define ITM_TCR_DWTENA_Msk (1UL << ITM_TCR_DWTENA_Pos)
+#define ITM_TCR_TSPrescale_Pos 8U
+#define ITM_TCR_TSPrescale_Msk (3UL << ITM_TCR_TSPrescale_Pos)
+#define ITM_TCR_GTSFREQ_Pos 10U
+#define ITM_TCR_GTSFREQ_Msk (3UL << ITM_TCR_GTSFREQ_Pos)
+#define ITM_TCR_TraceBusID_Pos 16U
+#define ITM_TCR_TraceBusID_Msk (0x7FUL << ITM_TCR_TraceBusID_Pos)
+#define ITM_TCR_BUSY_Pos 23U
+#define ITM_TCR_BUSY_Msk (1UL << ITM_TCR_BUSY_Pos)
+
+#define DWT_CTRL_NUMCOMP_Pos 28U
+#define DWT_CTRL_NUMCOMP_Msk (0xFUL << DWT_CTRL_NUMCOMP_Pos)
+#define DWT_CTRL_FOLDEVTENA_Pos 21U
+#define DWT_CTRL_FOLDEVTENA_Msk (0x1UL << DWT_CTRL_FOLDEVTENA_Pos)
+#define DWT_CTRL_LSUEVTENA_Pos 20U
+#define DWT_CTRL_LSUEVTENA_Msk (0x1UL << DWT_CTRL_LSUEVTENA_Pos)
+#define DWT_CTRL_SLEEPEVTENA_Pos 19U
+#define DWT_CTRL_SLEEPEVTENA_Msk (0x1UL << DWT_CTRL_SLEEPEVTENA_Pos)
+#define DWT_CTRL_EXCEVTENA_Pos 18U
+#define DWT_CTRL_EXCEVTENA_Msk (0x1UL << DWT_CTRL_EXCEVTENA_Pos)
+#define DWT_CTRL_CPIEVTENA_Pos 17U
+#define DWT_CTRL_CPIEVTENA_Msk (0x1UL << DWT_CTRL_CPIEVTENA_Pos)
+#define DWT_CTRL_EXCTRCENA_Pos 16U
+#define DWT_CTRL_EXCTRCENA_Msk (0x1UL << DWT_CTRL_EXCTRCENA_Pos)
+#define DWT_CTRL_PCSAMPLENA_Pos 12U
+#define DWT_CTRL_PCSAMPLENA_Msk (0x1UL << DWT_CTRL_PCSAMPLENA_Pos)
+#define DWT_CTRL_SYNCTAP_Pos 10U
+#define DWT_CTRL_SYNCTAP_Msk (0x3UL << DWT_CTRL_SYNCTAP_Pos)
+#define DWT_CTRL_CYCTAP_Pos 9U
+#define DWT_CTRL_CYCTAP_Msk (0x1UL << DWT_CTRL_CYCTAP_Pos)
+#define DWT_CTRL_POSTPRESET_Pos 1U
+#define DWT_CTRL_POSTPRESET_Msk (0xFUL << DWT_CTRL_POSTPRESET_Pos)
+#define DWT_CTRL_CYCCNTENA_Pos 0U
+#define DWT_CTRL_CYCCNTENA_Msk (0x1UL << DWT_CTRL_CYCCNTENA_Pos)
+
+#define DWT_CPICNT_CPICNT_Pos 0U
+#define DWT_CPICNT_CPICNT_Msk (0xFFUL << DWT_CPICNT_CPICNT_Pos)
+#define DWT_EXCCNT_EXCCNT_Pos 0U
+#define DWT_EXCCNT_EXCCNT_Msk (0xFFUL << DWT_EXCCNT_EXCCNT_Pos)
+#define DWT_SLEEPCNT_SLEEPCNT_Pos 0U
+#define DWT_SLEEPCNT_SLEEPCNT_Msk (0xFFUL << DWT_SLEEPCNT_SLEEPCNT_Pos)
+#define DWT_LSUCNT_LSUCNT_Pos 0U
+#define DWT_LSUCNT_LSUCNT_Msk (0xFFUL << DWT_LSUCNT_LSUCNT_Pos)
+#define DWT_FOLDCNT_FOLDCNT_Pos 0U
+#define DWT_FOLDCNT_FOLDCNT_Msk (0xFFUL << DWT_FOLDCNT_FOLDCNT_Pos)
+
+#define DWT_FUNCTION_MATCHED_Pos 24U
+#define DWT_FUNCTION_MATCHED_Msk (0x1UL << DWT_FUNCTION_MATCHED_Pos)
+#define DWT_FUNCTION_DATAVSIZE_Pos 10U
+#define DWT_FUNCTION_DATAVSIZE_Msk (0x3UL << DWT_FUNCTION_DATAVSIZE_Pos)
+#define DWT_FUNCTION_EMITRANGE_Pos 5U
+#define DWT_FUNCTION_EMITRANGE_Msk (0x1UL << DWT_FUNCTION_EMITRANGE_Pos)
+#define DWT_FUNCTION_FUNCTION_Pos 0U
+#define DWT_FUNCTION_FUNCTION_Msk (0xFUL << DWT_FUNCTION_FUNCTION_Pos)
+
+#define TPI_FFCR_EnFCont_Pos 1U
+#define TPI_FFCR_EnFCont_Msk (0x1UL << TPI_FFCR_EnFCont_Pos)
+
+#define CoreDebug_DEMCR_TRCENA_Pos 24U
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << CoreDebug_DEMCR_TRCENA_Pos)
+
+// Core intrinsics used by library, there are no interrupts or other cores on host
+
+#define __NOP() ((void)0)
+#define __COMPILER_BARRIER() __asm__ volatile("" ::: "memory")
+#define __DMB() __asm__ volatile("" ::: "memory")
+#define __DSB() __asm__ volatile("" ::: "memory")
+
+// Sleep returns immediately, as if interrupt was pending for Simulator::SleepCycles
+inline void __WFI(void)
+{
+    orbcode::sim::Device.Dwt.CYCCNT += orbcode::sim::Device.SleepCycles;
+    orbcode::sim::Device.Sleeps++;
+}
+
+inline uint32_t __get_PRIMASK(void)
+{
+    return orbcode::sim::Device.Primask;
+}
+
+inline void __set_PRIMASK(uint32_t value)
+{
+    orbcode::sim::Device.Primask = value;
+}
+
+inline void __disable_irq(void)
+{
+    orbcode::sim::Device.Primask = 1;
+}
+
+inline void __enable_irq(void)
+{
+    orbcode::sim::Device.Primask = 0;
+}
+
+inline uint32_t __get_BASEPRI(void)
+{
+    return orbcode::sim::Device.Basepri;
+}
+
+inline void __set_BASEPRI(uint32_t value)
+{
+    orbcode::sim::Device.Basepri = value;
+}
+
+inline void __set_BASEPRI_MAX(uint32_t value)
+{
+    uint32_t& basepri = orbcode::sim::Device.Basepri;
+    if(value != 0 && (basepri == 0 || value < basepri))
+    {
+        basepri = value;
+    }
+}
+
+inline uint32_t __LDREXW(volatile uint32_t* address)
+{
+    return *address;
+}
+
+inline uint32_t __STREXW(uint32_t value, volatile uint32_t* address)
+{
+    *address = value;
+    return 0;
+}
+
+inline void __CLREX(void)
+{
+}
+
+inline uint8_t __CLZ(uint32_t value)
+{
+    return value == 0 ? 32U : static_cast<uint8_t>(__builtin_clz(value));
+}
+
+/** @} */
@@ -0,0 +1,211 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#if !defined(__CORTEX_M)
+#    error \
+        "__CORTEX_M not defined. Include atomic.h AFTER core_cmX.h (typically after including device-specific header)"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup atomic Atomic operations
+     * @ingroup trace
+     *
+     * @brief Minimal set of atomic operations used by buffered trace output
+     *
+     * On cores with exclusive access instructions (ARMv7-M, ARMv8-M) operations are implemented with LDREX/STREX and never
+     * mask interrupts. On other cores (ARMv6-M) they fall back to short critical section implemented with PRIMASK.
+     *
+     * All operations act as compiler barrier.
+     *
+     * @{
+     */
+
+#if (defined(__ARM_ARCH_7M__) && (__ARM_ARCH_7M__ == 1)) || (defined(__ARM_ARCH_7EM__) && (__ARM_ARCH_7EM__ == 1)) || \
+    (defined(__ARM_ARCH_8M_MAIN__) && (__ARM_ARCH_8M_MAIN__ == 1)) ||                                                   \
+    (defined(__ARM_ARCH_8M_BASE__) && (__ARM_ARCH_8M_BASE__ == 1))
+/**
+ * @brief Defined to 1 when atomic operations are implemented with LDREX/STREX, 0 when they use PRIMASK critical section
+ */
+#    define ORBCODE_TRACE_HAS_EXCLUSIVE_ACCESS 1
+#else
+#    define ORBCODE_TRACE_HAS_EXCLUSIVE_ACCESS 0
+#endif
+
+#if (defined(__ARM_ARCH_7M__) && (__ARM_ARCH_7M__ == 1)) || (defined(__ARM_ARCH_7EM__) && (__ARM_ARCH_7EM__ == 1)) || \
+    (defined(__ARM_ARCH_8M_MAIN__) && (__ARM_ARCH_8M_MAIN__ == 1))
+/**
+ * @brief Defined to 1 when TraceMaskEnter() is implemented with BASEPRI, 0 when it uses PRIMASK
+ */
+#    define ORBCODE_TRACE_HAS_BASEPRI 1
+#else
+#    define ORBCODE_TRACE_HAS_BASEPRI 0
+#endif
+
+    /**
+     * @brief Atomically adds value to variable
+     *
+     * @param ptr Variable to modify
+     * @param value Value to be added (use two's complement to subtract)
+     * @return Value of variable after addition
+     */
+    static inline uint32_t TraceAtomicAdd(volatile uint32_t* ptr, uint32_t value);
+
+    /**
+     * @brief Atomically replaces variable with @p desired if it is equal to @p expected
+     *
+     * @param ptr Variable to modify
+     * @param expected Expected current value
+     * @param desired New value
+     * @return true Variable was equal to @p expected and has been replaced
+     * @return false Variable was not equal to @p expected and has not been modified
+     */
+    static inline bool TraceAtomicCompareExchange(volatile uint32_t* ptr, uint32_t expected, uint32_t desired);
+
+    /**
+     * @brief Enters critical section by disabling all maskable interrupts
+     *
+     * @return Previous interrupt mask state, must be passed to TraceCriticalExit()
+     */
+    static inline uint32_t TraceCriticalEnter(void);
+
+    /**
+     * @brief Leaves critical section entered with TraceCriticalEnter()
+     *
+     * @param state Value returned from matching TraceCriticalEnter() call
+     */
+    static inline void TraceCriticalExit(uint32_t state);
+
+    /**
+     * @brief Enters critical section masking only interrupts with priority @p priority or lower
+     *
+     * Interrupts with numerically lower (more urgent) priority than @p priority are still taken. Masking level is only
+     * raised, never lowered, so nested calls are safe. Priority 0 masks nothing.
+     *
+     * On cores without BASEPRI (ARMv6-M, ARMv8-M Baseline) any non-zero @p priority disables all maskable interrupts.
+     *
+     * @param priority Interrupt priority, same value as passed to `NVIC_SetPriority`
+     * @return Previous interrupt mask state, must be passed to TraceMaskExit()
+     */
+    static inline uint32_t TraceMaskEnter(uint32_t priority);
+
+    /**
+     * @brief Leaves critical section entered with TraceMaskEnter()
+     *
+     * @param state Value returned from matching TraceMaskEnter() call
+     */
+    static inline void TraceMaskExit(uint32_t state);
+
+    /** @} */
+
+    uint32_t TraceCriticalEnter(void)
+    {
+        uint32_t state = __get_PRIMASK();
+        __disable_irq();
+        __COMPILER_BARRIER();
+        return state;
+    }
+
+    void TraceCriticalExit(uint32_t state)
+    {
+        __COMPILER_BARRIER();
+        __set_PRIMASK(state);
+    }
+
+#if ORBCODE_TRACE_HAS_BASEPRI
+    uint32_t TraceMaskEnter(uint32_t priority)
+    {
+        uint32_t state = __get_BASEPRI();
+        if(priority != 0U)
+        {
+            __set_BASEPRI_MAX((priority << (8U - __NVIC_PRIO_BITS)) & 0xFFUL);
+        }
+        __COMPILER_BARRIER();
+        return state;
+    }
+
+    void TraceMaskExit(uint32_t state)
+    {
+        __COMPILER_BARRIER();
+        __set_BASEPRI(state);
+    }
+#else
+    uint32_t TraceMaskEnter(uint32_t priority)
+    {
+        uint32_t state = __get_PRIMASK();
+        if(priority != 0U)
+        {
+            __disable_irq();
+        }
+        __COMPILER_BARRIER();
+        return state;
+    }
+
+    void TraceMaskExit(uint32_t state)
+    {
+        __COMPILER_BARRIER();
+        __set_PRIMASK(state);
+    }
+#endif
+
+#if ORBCODE_TRACE_HAS_EXCLUSIVE_ACCESS
+    uint32_t TraceAtomicAdd(volatile uint32_t* ptr, uint32_t value)
+    {
+        uint32_t result;
+        __COMPILER_BARRIER();
+        do
+        {
+            result = __LDREXW(ptr) + value;
+        } while(__STREXW(result, ptr) != 0U);
+        __COMPILER_BARRIER();
+        return result;
+    }
+
+    bool TraceAtomicCompareExchange(volatile uint32_t* ptr, uint32_t expected, uint32_t desired)
+    {
+        __COMPILER_BARRIER();
+        do
+        {
+            if(__LDREXW(ptr) != expected)
+            {
+                __CLREX();
+                __COMPILER_BARRIER();
+                return false;
+            }
+        } while(__STREXW(desired, ptr) != 0U);
+        __COMPILER_BARRIER();
+        return true;
+    }
+#else
+    uint32_t TraceAtomicAdd(volatile uint32_t* ptr, uint32_t value)
+    {
+        uint32_t state = TraceCriticalEnter();
+        uint32_t result = *ptr + value;
+        *ptr = result;
+        TraceCriticalExit(state);
+        return result;
+    }
+
+    bool TraceAtomicCompareExchange(volatile uint32_t* ptr, uint32_t expected, uint32_t desired)
+    {
+        uint32_t state = TraceCriticalEnter();
+        bool match = (*ptr == expected);
+        if(match)
+        {
+            *ptr = desired;
+        }
+        TraceCriticalExit(state);
+        return match;
+    }
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,417 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "atomic.h"
+#include "itm.h"
+
+#if defined(TRACE_BENCH_PMU_COUNTERS) && TRACE_BENCH_PMU_COUNTERS > 0
+#    include "pmu.h"
+#endif
+
+#if !defined(DWT)
+#    error \
+        "DWT not defined. Include bench.h AFTER core_cmX.h (typically after including device-specific header)"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup bench Micro-benchmarks
+     * @ingroup trace
+     *
+     * @brief Measure short functions with DWT cycle counter and report results over ITM
+     *
+     * Each benchmark is a function called @ref TraceBenchmark#Runs times after a number of warm-up calls (filling
+     * caches, branch predictors and flash accelerators). Every call is measured separately with interrupts masked and
+     * cost of measurement itself is subtracted. Minimum, median and maximum number of cycles are reported.
+     *
+     * When counters are requested, `CPICNT` and `LSUCNT` increments are summed over all runs. These counters are 8 bits
+     * wide, so values are valid only for functions with less than 256 additional cycles per call. Event counters must
+     * be enabled by DWTSetup() (DWTOptions#CPICounterEvent, DWTOptions#LSUCounterEvent), cycle counter must be
+     * enabled too.
+     *
+     * On cores with PMU, increments of first @ref TRACE_BENCH_PMU_COUNTERS PMU counters (configured by PMUSetup()) are
+     * summed over all runs as well, with cost of measurement subtracted the same way.
+     *
+     * Results are sent to stimulus port as records decoded by host tool `orbcode-trace-bench`
+     * (little-endian words):
+     * | Word | Content |
+     * |------|---------|
+     * | 0    | @ref TRACE_BENCH_MAGIC |
+     * | 1    | bits 0-7: version (2), bits 8-15: name length L, bit 16: counters valid, bits 24-31: PMU counters P |
+     * | 2    | number of runs |
+     * | 3    | minimum cycles |
+     * | 4    | median cycles |
+     * | 5    | maximum cycles |
+     * | 6    | sum of `CPICNT` increments |
+     * | 7    | sum of `LSUCNT` increments |
+     * | 8..  | P pairs of words: PMU event number (`ARM_PMU_*`), sum of counter increments |
+     * | ..   | L bytes of name padded with zeros to multiple of 4 bytes |
+     *
+     * @code{.c}
+     * static void Filter(void* context)
+     * {
+     *     FirProcess((FirState*)context);
+     * }
+     *
+     * static const TraceBenchmark Benchmarks[] = {
+     *     {.Name = "fir", .Function = Filter, .Context = &FirState, .Runs = 32},
+     * };
+     *
+     * TraceBenchRun(8, Benchmarks, 1, 4, true);
+     * @endcode
+     *
+     * Library's own write paths are measured by `benchmarks` target (see `benchmarks/`).
+     *
+     * @{
+     */
+
+#ifndef TRACE_BENCH_MAX_RUNS
+/**
+ * @brief Maximum number of measured runs per benchmark
+ *
+ * Samples are kept on stack to compute median (4 bytes each). Can be overridden by defining it before including this
+ * header.
+ */
+#    define TRACE_BENCH_MAX_RUNS 64U
+#endif
+
+#ifndef TRACE_BENCH_PMU_COUNTERS
+/**
+ * @brief Number of PMU counters measured and reported with each benchmark (0 - @ref PMU_MAX_COUNTERS)
+ *
+ * Requires core with PMU (Cortex-M55, Cortex-M85). Defaults to 0 (no PMU counters). Can be overridden by defining it
+ * before including this header.
+ */
+#    define TRACE_BENCH_PMU_COUNTERS 0
+#endif
+
+#if TRACE_BENCH_PMU_COUNTERS > 0 && TRACE_BENCH_PMU_COUNTERS > PMU_MAX_COUNTERS
+#    error "TRACE_BENCH_PMU_COUNTERS exceeds number of chained PMU counters (PMU_MAX_COUNTERS)"
+#endif
+
+/**
+ * @brief First word of every benchmark result record
+ */
+#define TRACE_BENCH_MAGIC 0x48434E42UL
+
+/**
+ * @brief Version of benchmark result record format
+ */
+#define TRACE_BENCH_VERSION 2U
+
+/**
+ * @brief Flag in word 1 of result record set when counter sums are valid
+ */
+#define TRACE_BENCH_FLAG_COUNTERS (1UL << 16)
+
+    /**
+     * @brief Benchmarked function
+     *
+     * @param context Value of TraceBenchmark#Context
+     */
+    typedef void (*TraceBenchFunction)(void* context);
+
+    /**
+     * @brief Benchmark definition
+     */
+    typedef struct
+    {
+        /**
+         * @brief Name reported to host (up to 255 characters)
+         */
+        const char* Name;
+        /**
+         * @brief Measured function
+         */
+        TraceBenchFunction Function;
+        /**
+         * @brief Argument passed to function
+         */
+        void* Context;
+        /**
+         * @brief Number of measured runs (1 - @ref TRACE_BENCH_MAX_RUNS)
+         */
+        uint32_t Runs;
+    } TraceBenchmark;
+
+    /**
+     * @brief Benchmark result
+     */
+    typedef struct
+    {
+        /**
+         * @brief Number of measured runs
+         */
+        uint32_t Runs;
+        /**
+         * @brief Minimum number of cycles
+         */
+        uint32_t Min;
+        /**
+         * @brief Median number of cycles
+         */
+        uint32_t Median;
+        /**
+         * @brief Maximum number of cycles
+         */
+        uint32_t Max;
+        /**
+         * @brief Sum of `CPICNT` increments over all runs
+         */
+        uint32_t CPI;
+        /**
+         * @brief Sum of `LSUCNT` increments over all runs
+         */
+        uint32_t LSU;
+        /**
+         * @brief CPI and LSU sums were collected
+         */
+        bool Counters;
+#if TRACE_BENCH_PMU_COUNTERS > 0
+        /**
+         * @brief Events counted by PMU counters (`ARM_PMU_*`)
+         */
+        uint16_t PmuEvents[TRACE_BENCH_PMU_COUNTERS];
+        /**
+         * @brief Sums of PMU counter increments over all runs
+         */
+        uint32_t Pmu[TRACE_BENCH_PMU_COUNTERS];
+#endif
+    } TraceBenchResult;
+
+    /**
+     * @brief Measures single benchmark
+     *
+     * @param benchmark Benchmark
+     * @param warmupRuns Number of unmeasured calls before measurement
+     * @param counters Collect `CPICNT` and `LSUCNT` increments
+     * @param result Receives result
+     */
+    static inline void TraceBenchMeasure(const TraceBenchmark* benchmark, uint32_t warmupRuns, bool counters,
+                                         TraceBenchResult* result);
+
+    /**
+     * @brief Sends benchmark result record to stimulus port
+     *
+     * Waits for stimulus port FIFO like ITMWriteBuffer(). When @ref ITM_STALL_POLICY drops a word, rest of record is
+     * abandoned. Host decoder discards truncated record when magic word of next record arrives. Does nothing if stimulus
+     * port is disabled.
+     *
+     * @param port Stimulus port
+     * @param name Benchmark name
+     * @param result Result
+     */
+    static inline void TraceBenchReport(uint8_t port, const char* name, const TraceBenchResult* result);
+
+    /**
+     * @brief Measures benchmarks one by one and sends their results to stimulus port
+     *
+     * @param port Stimulus port for results
+     * @param benchmarks Benchmarks
+     * @param count Number of benchmarks
+     * @param warmupRuns Number of unmeasured calls before measurement of each benchmark
+     * @param counters Collect `CPICNT` and `LSUCNT` increments
+     */
+    static inline void TraceBenchRun(uint8_t port, const TraceBenchmark* benchmarks, size_t count, uint32_t warmupRuns,
+                                     bool counters);
+
+    /** @} */
+
+    // Internal helpers
+
+    static inline void TraceBenchNop(void* context)
+    {
+        (void)context;
+    }
+
+    // Number of PMU counter values passed between helpers, at least 1 to avoid zero-length array
+#define ORBCODE_TRACE_BENCH_PMU_SLOTS (TRACE_BENCH_PMU_COUNTERS > 0 ? TRACE_BENCH_PMU_COUNTERS : 1)
+
+    static inline uint32_t TraceBenchSample(TraceBenchFunction function, void* context, uint8_t* cpi, uint8_t* lsu,
+                                            uint32_t* pmu)
+    {
+        uint32_t state = TraceCriticalEnter();
+#if TRACE_BENCH_PMU_COUNTERS > 0
+        for(uint8_t i = 0; i < TRACE_BENCH_PMU_COUNTERS; i++)
+        {
+            pmu[i] = PMUReadCounter(i);
+        }
+#else
+        (void)pmu;
+#endif
+        const uint8_t cpiBefore = (uint8_t)DWT->CPICNT;
+        const uint8_t lsuBefore = (uint8_t)DWT->LSUCNT;
+        const uint32_t start = DWT->CYCCNT;
+        function(context);
+        const uint32_t end = DWT->CYCCNT;
+        *cpi = (uint8_t)((uint8_t)DWT->CPICNT - cpiBefore);
+        *lsu = (uint8_t)((uint8_t)DWT->LSUCNT - lsuBefore);
+#if TRACE_BENCH_PMU_COUNTERS > 0
+        for(uint8_t i = 0; i < TRACE_BENCH_PMU_COUNTERS; i++)
+        {
+            pmu[i] = PMUReadCounter(i) - pmu[i];
+        }
+#endif
+        TraceCriticalExit(state);
+        return end - start;
+    }
+
+    void TraceBenchMeasure(const TraceBenchmark* benchmark, uint32_t warmupRuns, bool counters,
+                           TraceBenchResult* result)
+    {
+        uint32_t samples[TRACE_BENCH_MAX_RUNS];
+        uint32_t runs = benchmark->Runs;
+        runs = runs < 1U ? 1U : (runs > TRACE_BENCH_MAX_RUNS ? TRACE_BENCH_MAX_RUNS : runs);
+        uint8_t cpi, lsu;
+        uint32_t pmu[ORBCODE_TRACE_BENCH_PMU_SLOTS];
+#if TRACE_BENCH_PMU_COUNTERS > 0
+        uint32_t overheadPmu[TRACE_BENCH_PMU_COUNTERS];
+        for(uint8_t i = 0; i < TRACE_BENCH_PMU_COUNTERS; i++)
+        {
+            overheadPmu[i] = UINT32_MAX;
+        }
+#endif
+
+        // Cost of measurement itself (call through pointer, counter reads) measured the same way
+        uint32_t overhead = UINT32_MAX;
+        uint8_t overheadCpi = 0xFF, overheadLsu = 0xFF;
+        for(uint32_t i = 0; i < 8; i++)
+        {
+            uint32_t cycles = TraceBenchSample(TraceBenchNop, NULL, &cpi, &lsu, pmu);
+            overhead = cycles < overhead ? cycles : overhead;
+            overheadCpi = cpi < overheadCpi ? cpi : overheadCpi;
+            overheadLsu = lsu < overheadLsu ? lsu : overheadLsu;
+#if TRACE_BENCH_PMU_COUNTERS > 0
+            for(uint8_t j = 0; j < TRACE_BENCH_PMU_COUNTERS; j++)
+            {
+                overheadPmu[j] = pmu[j] < overheadPmu[j] ? pmu[j] : overheadPmu[j];
+            }
+#endif
+        }
+
+        for(uint32_t i = 0; i < warmupRuns; i++)
+        {
+            benchmark->Function(benchmark->Context);
+        }
+
+        result->CPI = 0;
+        result->LSU = 0;
+#if TRACE_BENCH_PMU_COUNTERS > 0
+        for(uint8_t j = 0; j < TRACE_BENCH_PMU_COUNTERS; j++)
+        {
+            result->PmuEvents[j] = PMUCounterEvent(j);
+            result->Pmu[j] = 0;
+        }
+#endif
+        for(uint32_t i = 0; i < runs; i++)
+        {
+            uint32_t cycles = TraceBenchSample(benchmark->Function, benchmark->Context, &cpi, &lsu, pmu);
+            samples[i] = cycles > overhead ? cycles - overhead : 0;
+            result->CPI += cpi > overheadCpi ? (uint32_t)(cpi - overheadCpi) : 0U;
+            result->LSU += lsu > overheadLsu ? (uint32_t)(lsu - overheadLsu) : 0U;
+#if TRACE_BENCH_PMU_COUNTERS > 0
+            for(uint8_t j = 0; j < TRACE_BENCH_PMU_COUNTERS; j++)
+            {
+                result->Pmu[j] += pmu[j] > overheadPmu[j] ? pmu[j] - overheadPmu[j] : 0U;
+            }
+#endif
+        }
+
+        // Insertion sort, number of samples is small
+        for(uint32_t i = 1; i < runs; i++)
+        {
+            uint32_t value = samples[i];
+            uint32_t j = i;
+            for(; j > 0 && samples[j - 1] > value; j--)
+            {
+                samples[j] = samples[j - 1];
+            }
+            samples[j] = value;
+        }
+
+        result->Runs = runs;
+        result->Min = samples[0];
+        result->Median = samples[runs / 2];
+        result->Max = samples[runs - 1];
+        result->Counters = counters;
+        if(!counters)
+        {
+            result->CPI = 0;
+            result->LSU = 0;
+        }
+    }
+
+    void TraceBenchReport(uint8_t port, const char* name, const TraceBenchResult* result)
+    {
+        if(!ITMIsPortEnabled(port))
+        {
+            return;
+        }
+
+        size_t length = strlen(name);
+        length = length > 255U ? 255U : length;
+
+        uint32_t header[8 + 2 * TRACE_BENCH_PMU_COUNTERS] = {
+            TRACE_BENCH_MAGIC,
+            (uint32_t)(TRACE_BENCH_VERSION | ((uint32_t)length << 8) |
+                       (result->Counters ? TRACE_BENCH_FLAG_COUNTERS : 0U) |
+                       ((uint32_t)(TRACE_BENCH_PMU_COUNTERS) << 24)),
+            result->Runs,
+            result->Min,
+            result->Median,
+            result->Max,
+            result->CPI,
+            result->LSU,
+        };
+#if TRACE_BENCH_PMU_COUNTERS > 0
+        for(uint8_t i = 0; i < TRACE_BENCH_PMU_COUNTERS; i++)
+        {
+            header[8 + 2 * i] = result->PmuEvents[i];
+            header[9 + 2 * i] = result->Pmu[i];
+        }
+#endif
+
+        // Rest of record is abandoned at first dropped word
+        for(size_t i = 0; i < sizeof(header) / sizeof(header[0]); i++)
+        {
+            if(!ITMStore32(port, header[i]))
+            {
+                return;
+            }
+        }
+
+        for(size_t i = 0; i < length; i += 4)
+        {
+            uint32_t word = 0;
+            size_t chunk = length - i < 4 ? length - i : 4;
+            memcpy(&word, name + i, chunk);
+            if(!ITMStore32(port, word))
+            {
+                return;
+            }
+        }
+    }
+
+    void TraceBenchRun(uint8_t port, const TraceBenchmark* benchmarks, size_t count, uint32_t warmupRuns,
+                       bool counters)
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            TraceBenchResult result;
+            TraceBenchMeasure(&benchmarks[i], warmupRuns, counters, &result);
+            TraceBenchReport(port, benchmarks[i].Name, &result);
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,369 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dwt.h"
+#include "itm.h"
+#include "tpiu.h"
+
+// ARMv8.1-M CMSIS headers name TPI_ACPR prescaler field SWOSCALER and TPI_DEVID register TYPE (internal helpers)
+#if defined(TPI_ACPR_SWOSCALER_Msk)
+#    define ORBCODE_TRACE_TPI_ACPR_MAX TPI_ACPR_SWOSCALER_Msk
+#    define ORBCODE_TRACE_TPI_DEVID TYPE
+#else
+#    define ORBCODE_TRACE_TPI_ACPR_MAX TPI_ACPR_PRESCALER_Msk
+#    define ORBCODE_TRACE_TPI_DEVID DEVID
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup capabilities Capability discovery
+     * @ingroup trace
+     *
+     * @brief Read what trace components actually implement and configure them only with supported options
+     *
+     * TpiuSetup(), ITMSetup() and DWTSetup() write options to registers as they are. Unsupported options are silently
+     * ignored by hardware (e.g. PC sampling on MCU without trace packet support, parallel port wider than implemented).
+     * TraceProbeCapabilities() reads ID and configuration registers of TPIU, ITM and DWT, and checked setup functions
+     * use its result to adjust or reject options before configuring components. Options that were actually written are
+     * returned to caller.
+     *
+     * @code{.c}
+     * TraceCapabilities caps;
+     * TraceProbeCapabilities(&caps);
+     *
+     * DWTOptions requested = {.PCSampling = true, .SamplingPrescaler = 16};
+     * DWTOptions applied;
+     * if(DWTSetupChecked(&caps, &requested, &applied) != TraceSetupApplied && !applied.PCSampling)
+     * {
+     *     // PC sampling not available on this MCU
+     * }
+     * @endcode
+     *
+     * Capabilities that cannot be discovered from registers (e.g. maximum SWO frequency, pins routed to trace port)
+     * must still be checked with vendor documentation.
+     *
+     * @{
+     */
+
+    /**
+     * @brief Outcome of checked setup
+     */
+    typedef enum
+    {
+        /**
+         * @brief Component configured exactly as requested
+         */
+        TraceSetupApplied = 0,
+        /**
+         * @brief Component configured, but some options were adjusted to supported values
+         */
+        TraceSetupAdjusted = 1,
+        /**
+         * @brief Options cannot be supported, component was not configured
+         */
+        TraceSetupRejected = 2,
+    } TraceSetupStatus;
+
+    /**
+     * @brief Trace capabilities of MCU
+     */
+    typedef struct
+    {
+        /**
+         * @brief Number of DWT comparators (`DWT_CTRL.NUMCOMP`)
+         */
+        uint8_t ComparatorCount;
+        /**
+         * @brief DWT supports trace packets: PC sampling, exception trace, data trace (`DWT_CTRL.NOTRCPKT` clear)
+         */
+        bool TracePackets;
+        /**
+         * @brief DWT supports external match signals (`DWT_CTRL.NOEXTTRIG` clear)
+         */
+        bool ExternalTrigger;
+        /**
+         * @brief DWT implements cycle counter (`DWT_CTRL.NOCYCCNT` clear)
+         */
+        bool CycleCounter;
+        /**
+         * @brief DWT implements profiling (event) counters (`DWT_CTRL.NOPRFCNT` clear)
+         */
+        bool ProfilingCounters;
+        /**
+         * @brief Number of implemented ITM stimulus ports
+         */
+        uint8_t StimulusPortCount;
+        /**
+         * @brief ITM part number from peripheral ID registers
+         */
+        uint16_t ITMPartNumber;
+        /**
+         * @brief ITM revision from peripheral ID registers
+         */
+        uint8_t ITMRevision;
+        /**
+         * @brief Supported parallel trace port widths (`TPI_SSPSR`), bit N set when width N + 1 is supported
+         */
+        uint32_t TracePortWidths;
+        /**
+         * @brief TPIU supports parallel trace port (`TPI_DEVID.PTINVALID` clear)
+         */
+        bool ParallelPort;
+        /**
+         * @brief TPIU supports SWO with Manchester encoding (`TPI_DEVID.MANCVALID`)
+         */
+        bool SwoManchester;
+        /**
+         * @brief TPIU supports SWO with UART (NRZ) encoding (`TPI_DEVID.NRZVALID`)
+         */
+        bool SwoUart;
+        /**
+         * @brief Largest SWO prescaler accepted by TPIU
+         */
+        uint32_t MaxSwoPrescaler;
+    } TraceCapabilities;
+
+    /**
+     * @brief Reads capabilities of TPIU, ITM and DWT
+     *
+     * Enables trace (`DEMCR.TRCENA`) so that registers can be accessed. Number of stimulus ports is discovered by
+     * writing all ones to `ITM_TER` and reading it back, previous value of `ITM_TER` is restored afterwards.
+     *
+     * @param capabilities Receives capabilities
+     */
+    static inline void TraceProbeCapabilities(TraceCapabilities* capabilities);
+
+    /**
+     * @brief Configures TPIU with options supported by MCU
+     *
+     * Rejects protocols not implemented by TPIU. Parallel port width is reduced to widest supported width not larger
+     * than requested (or smallest supported width) and SWO prescaler is clamped to range supported by TPIU.
+     *
+     * @param capabilities Capabilities returned by TraceProbeCapabilities()
+     * @param options Requested configuration
+     * @param applied Receives configuration that was applied (can be NULL)
+     * @return Setup status
+     */
+    static inline TraceSetupStatus TpiuSetupChecked(const TraceCapabilities* capabilities, const TpiuOptions* options,
+                                                    TpiuOptions* applied);
+
+    /**
+     * @brief Configures ITM with options supported by MCU
+     *
+     * Rejects trace bus IDs outside of range 1-0x6F. Forwarding of DWT packets is disabled when DWT does not support
+     * trace packets, synchronization packets are disabled without cycle counter. ITMOptions#EnabledStimulusPorts is
+     * limited to implemented ports.
+     *
+     * @param capabilities Capabilities returned by TraceProbeCapabilities()
+     * @param options Requested configuration
+     * @param applied Receives configuration that was applied (can be NULL)
+     * @return Setup status
+     */
+    static inline TraceSetupStatus ITMSetupChecked(const TraceCapabilities* capabilities, const ITMOptions* options,
+                                                   ITMOptions* applied);
+
+    /**
+     * @brief Configures DWT with options supported by MCU
+     *
+     * PC sampling and exception trace are disabled without trace packet support, event counters without profiling
+     * counters, PC sampling and synchronization packets without cycle counter. Sampling prescaler is clamped to 1-16,
+     * which counts as adjustment only when PC sampling is enabled.
+     *
+     * @param capabilities Capabilities returned by TraceProbeCapabilities()
+     * @param options Requested configuration
+     * @param applied Receives configuration that was applied (can be NULL)
+     * @return Setup status
+     */
+    static inline TraceSetupStatus DWTSetupChecked(const TraceCapabilities* capabilities, const DWTOptions* options,
+                                                   DWTOptions* applied);
+
+    /** @} */
+
+    // Internal helper. Clears option in adjusted copy when it is not supported.
+    static inline void TraceSetupRequire(bool* option, bool supported, TraceSetupStatus* status)
+    {
+        if(*option && !supported)
+        {
+            *option = false;
+            *status = TraceSetupAdjusted;
+        }
+    }
+
+    void TraceProbeCapabilities(TraceCapabilities* capabilities)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable ITM and DWT
+
+        const uint32_t ctrl = DWT->CTRL;
+        capabilities->ComparatorCount = (uint8_t)((ctrl & DWT_CTRL_NUMCOMP_Msk) >> DWT_CTRL_NUMCOMP_Pos);
+        capabilities->TracePackets = (ctrl & DWT_CTRL_NOTRCPKT_Msk) == 0;
+        capabilities->ExternalTrigger = (ctrl & DWT_CTRL_NOEXTTRIG_Msk) == 0;
+        capabilities->CycleCounter = (ctrl & DWT_CTRL_NOCYCCNT_Msk) == 0;
+        capabilities->ProfilingCounters = (ctrl & DWT_CTRL_NOPRFCNT_Msk) == 0;
+
+        ITM->LAR = 0xC5ACCE55; // unlock ITM access (magic number)
+        const uint32_t ter = ITM->TER;
+        ITM->TER = 0xFFFFFFFFUL;
+        const uint32_t implemented = ITM->TER; // unimplemented ports read as zero
+        ITM->TER = ter;
+        capabilities->StimulusPortCount = (uint8_t)(32U - __CLZ(implemented));
+
+        capabilities->ITMPartNumber = (uint16_t)((ITM->PID0 & 0xFFU) | ((ITM->PID1 & 0x0FU) << 8));
+        capabilities->ITMRevision = (uint8_t)((ITM->PID2 >> 4) & 0x0FU);
+
+        const uint32_t devid = TPI->ORBCODE_TRACE_TPI_DEVID;
+        capabilities->TracePortWidths = TPI->SSPSR;
+        capabilities->ParallelPort = (devid & TPI_DEVID_PTINVALID_Msk) == 0 && capabilities->TracePortWidths != 0;
+        capabilities->SwoManchester = (devid & TPI_DEVID_MANCVALID_Msk) != 0;
+        capabilities->SwoUart = (devid & TPI_DEVID_NRZVALID_Msk) != 0;
+        capabilities->MaxSwoPrescaler = (uint32_t)ORBCODE_TRACE_TPI_ACPR_MAX + 1U;
+    }
+
+    TraceSetupStatus TpiuSetupChecked(const TraceCapabilities* capabilities, const TpiuOptions* options,
+                                      TpiuOptions* applied)
+    {
+        TpiuOptions result = *options;
+        TraceSetupStatus status = TraceSetupApplied;
+
+        switch(result.Protocol)
+        {
+            case TpiuProtocolParallel:
+            {
+                if(!capabilities->ParallelPort)
+                {
+                    return TraceSetupRejected;
+                }
+
+                uint32_t width = result.TracePortWidth;
+                if(width == 0 && capabilities->TracePortWidths != 0)
+                {
+                    // Widest supported width requested
+                    width = 32U - __CLZ(capabilities->TracePortWidths);
+                    result.TracePortWidth = (uint8_t)width;
+                }
+                else if(width < 1 || width > 32 || (capabilities->TracePortWidths & (1UL << (width - 1))) == 0)
+                {
+                    // Widest supported width not exceeding requested one, otherwise narrowest supported width
+                    uint32_t below = width >= 32 ? capabilities->TracePortWidths
+                                                 : capabilities->TracePortWidths & ((1UL << width) - 1U);
+                    uint32_t narrowest = capabilities->TracePortWidths & (0U - capabilities->TracePortWidths);
+                    width = 32U - __CLZ(below != 0 ? below : narrowest);
+                    result.TracePortWidth = (uint8_t)width;
+                    status = TraceSetupAdjusted;
+                }
+                break;
+            }
+            case TpiuProtocolSwoManchester:
+            case TpiuProtocolSwoUart:
+            {
+                const bool supported = result.Protocol == TpiuProtocolSwoManchester ? capabilities->SwoManchester
+                                                                                      : capabilities->SwoUart;
+                if(!supported)
+                {
+                    return TraceSetupRejected;
+                }
+
+                if(result.SwoPrescaler < 1)
+                {
+                    result.SwoPrescaler = 1;
+                    status = TraceSetupAdjusted;
+                }
+                else if((uint32_t)result.SwoPrescaler > capabilities->MaxSwoPrescaler)
+                {
+                    result.SwoPrescaler = (int)capabilities->MaxSwoPrescaler;
+                    status = TraceSetupAdjusted;
+                }
+                break;
+            }
+            default:
+                return TraceSetupRejected;
+        }
+
+        TpiuSetup(&result);
+        if(applied != NULL)
+        {
+            *applied = result;
+        }
+        return status;
+    }
+
+    TraceSetupStatus ITMSetupChecked(const TraceCapabilities* capabilities, const ITMOptions* options,
+                                     ITMOptions* applied)
+    {
+        // Trace IDs 0x00 and 0x70-0x7F are reserved by CoreSight
+        if(options->TraceBusID < 0x01 || options->TraceBusID > 0x6F)
+        {
+            return TraceSetupRejected;
+        }
+
+        ITMOptions result = *options;
+        TraceSetupStatus status = TraceSetupApplied;
+
+        TraceSetupRequire(&result.ForwardDWT, capabilities->TracePackets, &status);
+        TraceSetupRequire(&result.EnableSyncPacket, capabilities->CycleCounter, &status);
+
+        const uint32_t implemented =
+            capabilities->StimulusPortCount >= 32 ? 0xFFFFFFFFUL : (1UL << capabilities->StimulusPortCount) - 1U;
+        if((result.EnabledStimulusPorts & ~implemented) != 0)
+        {
+            result.EnabledStimulusPorts &= implemented;
+            status = TraceSetupAdjusted;
+        }
+
+        ITMSetup(&result);
+        if(applied != NULL)
+        {
+            *applied = result;
+        }
+        return status;
+    }
+
+    TraceSetupStatus DWTSetupChecked(const TraceCapabilities* capabilities, const DWTOptions* options,
+                                     DWTOptions* applied)
+    {
+        DWTOptions result = *options;
+        TraceSetupStatus status = TraceSetupApplied;
+
+        TraceSetupRequire(&result.PCSampling, capabilities->TracePackets && capabilities->CycleCounter, &status);
+        TraceSetupRequire(&result.ExceptionTrace, capabilities->TracePackets, &status);
+
+        TraceSetupRequire(&result.FoldedInstructionCounterEvent, capabilities->ProfilingCounters, &status);
+        TraceSetupRequire(&result.LSUCounterEvent, capabilities->ProfilingCounters, &status);
+        TraceSetupRequire(&result.SleepCounterEvent, capabilities->ProfilingCounters, &status);
+        TraceSetupRequire(&result.ExceptionOverheadCounterEvent, capabilities->ProfilingCounters, &status);
+        TraceSetupRequire(&result.CPICounterEvent, capabilities->ProfilingCounters, &status);
+
+        if(result.SyncTap != DWTSyncTapDisabled && !capabilities->CycleCounter)
+        {
+            result.SyncTap = DWTSyncTapDisabled;
+            status = TraceSetupAdjusted;
+        }
+
+        // Field is written even without PC sampling (e.g. zero-initialized options), so it is always clamped
+        if(result.SamplingPrescaler < 1 || result.SamplingPrescaler > 16)
+        {
+            result.SamplingPrescaler = result.SamplingPrescaler < 1 ? 1 : 16;
+            if(result.PCSampling)
+            {
+                status = TraceSetupAdjusted;
+            }
+        }
+
+        DWTSetup(&result);
+        if(applied != NULL)
+        {
+            *applied = result;
+        }
+        return status;
+    }
+
+#ifdef __cplusplus
+}
+#endif
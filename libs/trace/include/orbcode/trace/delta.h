@@ -0,0 +1,244 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "itm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup delta Delta-compressed samples
+     * @ingroup itm
+     *
+     * @brief Send slowly changing multi-channel samples as zigzag varint deltas
+     *
+     * Each call of TraceDeltaWrite() sends one record holding one sample of every channel of stream. Samples are
+     * coded as difference to previous sample of the same channel, mapped to unsigned value with zigzag coding (small
+     * positive and negative differences become small numbers) and written as varints (7 bits per byte, bit 7 set in
+     * all bytes but last). Typical telemetry changing by less than 64 in either direction between samples takes 1 byte
+     * per channel instead of 4. Encoding takes constant time per sample (at most 5 bytes) and state is fixed-size.
+     *
+     * Record layout:
+     * | Byte | Content |
+     * |------|---------|
+     * | 0    | bits 0-3: number of channels - 1, bits 4-6: stream ID, bit 7: @ref TRACE_DELTA_FLAG_KEY |
+     * | 1    | record sequence number (increments by one, wraps at 256) |
+     * | 2..  | one varint per channel |
+     *
+     * Key records (first one and then every TraceDeltaEncoder#KeyInterval -th) carry differences against zero, so
+     * host decoder `orbcode::decoder::DeltaDecoder` can start decoding in the middle of stream and recover after lost
+     * records (detected by gap in sequence numbers).
+     *
+     * Records are written back-to-back without any synchronization markers, so host cannot find start of next record
+     * after data loss in stimulus port stream. For lossy links set @ref ORBCODE_TRACE_DELTA_WRITE to ITMFrameWrite()
+     * (see @ref itm_frame).
+     *
+     * @code{.c}
+     * static TraceDeltaEncoder Imu;
+     *
+     * TraceDeltaInit(&Imu, 9, 0, 6, 64);
+     *
+     * void ImuSampleReady(const int16_t* accel, const int16_t* gyro)
+     * {
+     *     const int32_t samples[6] = {accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]};
+     *     TraceDeltaWrite(&Imu, samples);
+     * }
+     * @endcode
+     *
+     * Host tool `orbcode-trace-samples` prints decoded records as CSV.
+     *
+     * @{
+     */
+
+/**
+ * @brief Maximum number of channels in single stream
+ */
+#define TRACE_DELTA_MAX_CHANNELS 16U
+
+/**
+ * @brief Maximum number of streams sharing single stimulus port
+ */
+#define TRACE_DELTA_MAX_STREAMS 8U
+
+/**
+ * @brief Flag in record header set for key records
+ */
+#define TRACE_DELTA_FLAG_KEY 0x80U
+
+/**
+ * @brief Size of buffer large enough for any record of stream with given number of channels
+ */
+#define TRACE_DELTA_MAX_RECORD_SIZE(channels) (2U + 5U * (channels))
+
+#ifndef ORBCODE_TRACE_DELTA_WRITE
+/**
+ * @brief Writes single record
+ *
+ * Called as `ORBCODE_TRACE_DELTA_WRITE(port, data, size)`. Defaults to ITMWriteBuffer(). Can be overridden by
+ * defining it before including this header (e.g. to ITMFrameWrite()).
+ */
+#    define ORBCODE_TRACE_DELTA_WRITE(port, data, size) ITMWriteBuffer((port), (data), (size))
+#endif
+
+    /**
+     * @brief Encoder state of single stream
+     *
+     * All fields are managed by TraceDelta* functions. Encoder must not be used concurrently from multiple contexts.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Stimulus port
+         */
+        uint8_t Port;
+        /**
+         * @brief Stream ID (below @ref TRACE_DELTA_MAX_STREAMS)
+         */
+        uint8_t Stream;
+        /**
+         * @brief Number of channels (1 to @ref TRACE_DELTA_MAX_CHANNELS)
+         */
+        uint8_t Channels;
+        /**
+         * @brief Sequence number of next record
+         */
+        uint8_t Sequence;
+        /**
+         * @brief Every KeyInterval-th record is key record, 0 sends only first record as key record
+         */
+        uint16_t KeyInterval;
+        /**
+         * @brief Number of records until next key record
+         */
+        uint16_t UntilKey;
+        /**
+         * @brief Previous sample of each channel
+         */
+        uint32_t Previous[TRACE_DELTA_MAX_CHANNELS];
+    } TraceDeltaEncoder;
+
+    /**
+     * @brief Initializes encoder
+     *
+     * Values out of range are clamped. First record written is key record.
+     *
+     * @param encoder Encoder
+     * @param port Stimulus port
+     * @param stream Stream ID distinguishing streams on the same port
+     * @param channels Number of channels
+     * @param keyInterval Every @p keyInterval -th record is key record (0: only first one)
+     */
+    static inline void TraceDeltaInit(TraceDeltaEncoder* encoder, uint8_t port, uint8_t stream, uint8_t channels,
+                                      uint16_t keyInterval);
+
+    /**
+     * @brief Makes next record key record
+     *
+     * Useful when host decoder is known to have lost data (e.g. after reconnecting).
+     *
+     * @param encoder Encoder
+     */
+    static inline void TraceDeltaRequestKey(TraceDeltaEncoder* encoder);
+
+    /**
+     * @brief Encodes record into buffer without writing it
+     *
+     * @param encoder Encoder
+     * @param samples One sample per channel (unsigned values can be passed cast to `int32_t`)
+     * @param buffer Buffer of at least `TRACE_DELTA_MAX_RECORD_SIZE(channels)` bytes
+     * @return Size of record
+     */
+    static inline size_t TraceDeltaEncode(TraceDeltaEncoder* encoder, const int32_t* samples, uint8_t* buffer);
+
+    /**
+     * @brief Encodes record and writes it with @ref ORBCODE_TRACE_DELTA_WRITE
+     *
+     * Nothing is encoded when stimulus port is disabled, so stream continues with the same state once it is enabled.
+     *
+     * @param encoder Encoder
+     * @param samples One sample per channel
+     */
+    static inline void TraceDeltaWrite(TraceDeltaEncoder* encoder, const int32_t* samples);
+
+    /** @} */
+
+    void TraceDeltaInit(TraceDeltaEncoder* encoder, uint8_t port, uint8_t stream, uint8_t channels,
+                        uint16_t keyInterval)
+    {
+        channels = channels < 1U ? 1U : (channels > TRACE_DELTA_MAX_CHANNELS ? TRACE_DELTA_MAX_CHANNELS : channels);
+
+        encoder->Port = port;
+        encoder->Stream = (uint8_t)(stream & (TRACE_DELTA_MAX_STREAMS - 1U));
+        encoder->Channels = channels;
+        encoder->Sequence = 0;
+        encoder->KeyInterval = keyInterval;
+        encoder->UntilKey = 0;
+        for(uint8_t i = 0; i < TRACE_DELTA_MAX_CHANNELS; i++)
+        {
+            encoder->Previous[i] = 0;
+        }
+    }
+
+    void TraceDeltaRequestKey(TraceDeltaEncoder* encoder)
+    {
+        encoder->UntilKey = 0;
+    }
+
+    size_t TraceDeltaEncode(TraceDeltaEncoder* encoder, const int32_t* samples, uint8_t* buffer)
+    {
+        const bool key = encoder->UntilKey == 0;
+        if(key)
+        {
+            // Without interval UntilKey stays non-zero until TraceDeltaRequestKey()
+            encoder->UntilKey = encoder->KeyInterval == 0 ? 1U : (uint16_t)(encoder->KeyInterval - 1U);
+        }
+        else if(encoder->KeyInterval != 0)
+        {
+            encoder->UntilKey--;
+        }
+
+        buffer[0] = (uint8_t)((encoder->Channels - 1U) | ((uint32_t)encoder->Stream << 4) |
+                              (key ? TRACE_DELTA_FLAG_KEY : 0U));
+        buffer[1] = encoder->Sequence++;
+        size_t size = 2;
+
+        for(uint8_t i = 0; i < encoder->Channels; i++)
+        {
+            const uint32_t sample = (uint32_t)samples[i];
+            const uint32_t delta = sample - (key ? 0U : encoder->Previous[i]);
+            encoder->Previous[i] = sample;
+
+            uint32_t zigzag = (delta << 1) ^ (0U - (delta >> 31));
+            while(zigzag >= 0x80U)
+            {
+                buffer[size++] = (uint8_t)(zigzag | 0x80U);
+                zigzag >>= 7;
+            }
+            buffer[size++] = (uint8_t)zigzag;
+        }
+
+        return size;
+    }
+
+    void TraceDeltaWrite(TraceDeltaEncoder* encoder, const int32_t* samples)
+    {
+        if(!ITMIsPortEnabled(encoder->Port))
+        {
+            return;
+        }
+
+        // Word-aligned so that burst write uses 32-bit packets
+        uint32_t buffer[(TRACE_DELTA_MAX_RECORD_SIZE(TRACE_DELTA_MAX_CHANNELS) + 3U) / 4U];
+        const size_t size = TraceDeltaEncode(encoder, samples, (uint8_t*)buffer);
+        ORBCODE_TRACE_DELTA_WRITE(encoder->Port, buffer, size);
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,7 +15,7 @@
  * 2. Setting up TPIU responsible for pushing ITM and ETM data into physical layer (SWO or parallel trace) (See @ref tpiu).
  * 3. Configure ITM module (if needed) for outputing user-defined data by stimulus port or pass-through of DWT output (See @ref itm).
  * 4. Configure DWT module (if needed) for timestamping, PC sampling, watchpoints and various counters (See @ref dwt).
- * 5. Configure ETM module (if needed) for instruction-level tracing (not covered by this library yet).
+ * 5. Configure ETM module (if needed) for instruction-level tracing (See @ref etm).
  *
  * Once trace components are configured they can be used during normal program operations (e.g. outputing data via ITM stimulus ports) or will automatically output data (like DWT PC sampling, watchpoints or ETM instruction trace).
  *
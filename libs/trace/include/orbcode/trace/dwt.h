@@ -12,6 +12,18 @@
         "DWT not defined. Include dwt.h AFTER core_cmX.h (typically after including device-specific header)"
 #endif
 
+// ARMv8-M comparators use MATCH/ACTION/DATAVSIZE encoding and have no MASK register (internal helper)
+#if defined(DWT_FUNCTION_MATCH_Msk)
+#    define ORBCODE_TRACE_DWT_V8 1
+#else
+#    define ORBCODE_TRACE_DWT_V8 0
+#endif
+
+// Lock Access Register is not declared in DWT_Type of every core header (internal helper)
+#ifndef ORBCODE_TRACE_DWT_LAR
+#    define ORBCODE_TRACE_DWT_LAR (*(volatile uint32_t*)((uintptr_t)(DWT) + 0xFB0U))
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -34,11 +46,56 @@ extern "C"
      *
      * \image html trace/dwt_clocks.diagramsnet.svg "Relationships between DWT clocks and packets"
      *
+     * Comparators use different encoding on ARMv7-M (DWTEnableComparator()) and ARMv8-M/ARMv8.1-M (DWTSetComparator(),
+     * DWTWatchRange(), DWTWatchValue()). Only functions matching architecture of selected core are available.
+     *
      * Reference: ARMv7-M Architecture Reference Manual, chapter C1.8 The Data Watchpoint and Trace unit
      *
+     * Once configured with DWTSetup(), PC sampling, its prescaler and event counters can be changed at runtime with
+     * DWTPCSamplingStart(), DWTPCSamplingStop(), DWTSetSamplingPrescaler(), DWTEnableCounterEvents() and
+     * DWTDisableCounterEvents(). These functions only read-modify-write affected bits of `DWT_CTRL`, so cycle counter
+     * keeps counting and synchronization and timestamp packets are not disturbed, e.g. to sample only hot section:
+     *
+     * @code{.c}
+     * DWTPCSamplingStart();
+     * RunFilter();
+     * DWTPCSamplingStop();
+     * @endcode
+     *
      * @{
      */
 
+/**
+ * @brief Cycles-per-instruction counter event (`DWT_CTRL.CPIEVTENA`), for DWTEnableCounterEvents()
+ */
+#define DWT_COUNTER_EVENT_CPI DWT_CTRL_CPIEVTENA_Msk
+
+/**
+ * @brief Exception overhead counter event (`DWT_CTRL.EXCEVTENA`), for DWTEnableCounterEvents()
+ */
+#define DWT_COUNTER_EVENT_EXCEPTION DWT_CTRL_EXCEVTENA_Msk
+
+/**
+ * @brief Sleep counter event (`DWT_CTRL.SLEEPEVTENA`), for DWTEnableCounterEvents()
+ */
+#define DWT_COUNTER_EVENT_SLEEP DWT_CTRL_SLEEPEVTENA_Msk
+
+/**
+ * @brief Load/store counter event (`DWT_CTRL.LSUEVTENA`), for DWTEnableCounterEvents()
+ */
+#define DWT_COUNTER_EVENT_LSU DWT_CTRL_LSUEVTENA_Msk
+
+/**
+ * @brief Folded instruction counter event (`DWT_CTRL.FOLDEVTENA`), for DWTEnableCounterEvents()
+ */
+#define DWT_COUNTER_EVENT_FOLDED DWT_CTRL_FOLDEVTENA_Msk
+
+/**
+ * @brief All counter events
+ */
+#define DWT_COUNTER_EVENT_ALL                                                                              \
+    (DWT_COUNTER_EVENT_CPI | DWT_COUNTER_EVENT_EXCEPTION | DWT_COUNTER_EVENT_SLEEP | DWT_COUNTER_EVENT_LSU | \
+     DWT_COUNTER_EVENT_FOLDED)
 
     /**
      * @brief Interval of ITM synchronization packet
@@ -163,12 +220,59 @@ extern "C"
     static inline void DWTSetup(const DWTOptions* options);
 
     /**
-     * @brief Configures DWT comparator
+     * @brief Enables PC sampling without changing remaining DWT configuration
+     *
+     * Sampling interval is kept as configured by DWTSetup() or DWTSetSamplingPrescaler().
+     */
+    static inline void DWTPCSamplingStart(void);
+
+    /**
+     * @brief Disables PC sampling without changing remaining DWT configuration
+     */
+    static inline void DWTPCSamplingStop(void);
+
+    /**
+     * @brief Changes PC sampling prescaler without changing remaining DWT configuration
+     *
+     * New value is used from next reload of `POSTCNT` counter, PC sampling stays enabled or disabled.
+     *
+     * @param prescaler Prescaler (1 - 16, values out of range are clamped), see DWTOptions#SamplingPrescaler
+     */
+    static inline void DWTSetSamplingPrescaler(uint8_t prescaler);
+
+    /**
+     * @brief Enables event counters without changing remaining DWT configuration
+     *
+     * @param events Combination of `DWT_COUNTER_EVENT_*` values
+     */
+    static inline void DWTEnableCounterEvents(uint32_t events);
+
+    /**
+     * @brief Disables event counters without changing remaining DWT configuration
+     *
+     * Counter values are left as they are.
+     *
+     * @param events Combination of `DWT_COUNTER_EVENT_*` values
+     */
+    static inline void DWTDisableCounterEvents(uint32_t events);
+
+    /**
+     * @brief Returns number of comparators implemented by DWT
+     *
+     * Read from `DWT_CTRL.NUMCOMP`. All comparator functions ignore comparators above this number.
+     *
+     * @return Number of comparators (0-15)
+     */
+    static inline uint8_t DWTComparatorCount(void);
+
+#if !ORBCODE_TRACE_DWT_V8
+    /**
+     * @brief Configures DWT comparator (ARMv7-M)
      *
      * Comparator might issue a trace packet when specified memory range is accesses for read or write.
      *
-     * Number of comparators is vendor-specific, check with documention how many are available. This function does not
-     * check if specified comparator is available.
+     * Number of comparators is vendor-specific (see DWTComparatorCount()). Does nothing if specified comparator is
+     * not implemented.
      *
      * Comparator can monitor single byte in memory or range by ignoring specified number of least significant bits, e.g. to monitor single
      * uint32_t variable setup @p address parameter to variable address and @p ignoreBits parameter to 2
@@ -181,23 +285,196 @@ extern "C"
      */
     static inline void
         DWTEnableComparator(uint8_t comparator, uintptr_t address, uint8_t ignoreBits, bool emitRange, uint8_t function);
+#else
+    /**
+     * @brief Comparator match type (ARMv8-M `DWT_FUNCTION.MATCH`)
+     *
+     * See ARMv8-M Architecture Reference Manual, description of DWT_FUNCTIONn register for details
+     */
+    typedef enum
+    {
+        /**
+         * @brief Comparator disabled
+         */
+        DWTMatchDisabled = 0,
+        /**
+         * @brief Cycle counter equal to comparator value
+         */
+        DWTMatchCycleCounter = 1,
+        /**
+         * @brief Instruction address
+         */
+        DWTMatchInstructionAddress = 2,
+        /**
+         * @brief Upper limit of instruction address range started by previous comparator
+         */
+        DWTMatchInstructionAddressLimit = 3,
+        /**
+         * @brief Data address, read or write
+         */
+        DWTMatchDataAddress = 4,
+        /**
+         * @brief Data address, write
+         */
+        DWTMatchDataAddressWrite = 5,
+        /**
+         * @brief Data address, read
+         */
+        DWTMatchDataAddressRead = 6,
+        /**
+         * @brief Upper limit of data address range started by previous comparator
+         */
+        DWTMatchDataAddressLimit = 7,
+        /**
+         * @brief Data value, read or write
+         */
+        DWTMatchDataValue = 8,
+        /**
+         * @brief Data value, write
+         */
+        DWTMatchDataValueWrite = 9,
+        /**
+         * @brief Data value, read
+         */
+        DWTMatchDataValueRead = 10,
+        /**
+         * @brief Data value at address matched by previous comparator, read or write
+         */
+        DWTMatchLinkedDataValue = 11,
+        /**
+         * @brief Data value at address matched by previous comparator, write
+         */
+        DWTMatchLinkedDataValueWrite = 12,
+        /**
+         * @brief Data value at address matched by previous comparator, read
+         */
+        DWTMatchLinkedDataValueRead = 13,
+    } DWTMatch;
+
+    /**
+     * @brief Action taken on comparator match (ARMv8-M `DWT_FUNCTION.ACTION`)
+     *
+     * Exact trace packets generated by DWTActionTrace and DWTActionTraceData depend on match type, see ARMv8-M
+     * Architecture Reference Manual, description of DWT_FUNCTIONn register.
+     */
+    typedef enum
+    {
+        /**
+         * @brief Only signal match to other components (e.g. ETM) and set matched flag
+         */
+        DWTActionTrigger = 0,
+        /**
+         * @brief Generate debug event (halt or DebugMonitor exception)
+         */
+        DWTActionDebugEvent = 1,
+        /**
+         * @brief Generate data trace match (or data value) packet
+         */
+        DWTActionTrace = 2,
+        /**
+         * @brief Generate data trace packets with accessed data value, address or program counter
+         */
+        DWTActionTraceData = 3,
+    } DWTAction;
+
+    /**
+     * @brief Size of data access matched by comparator (ARMv8-M `DWT_FUNCTION.DATAVSIZE`)
+     */
+    typedef enum
+    {
+        /**
+         * @brief Byte
+         */
+        DWTDataSizeByte = 0,
+        /**
+         * @brief Halfword
+         */
+        DWTDataSizeHalfword = 1,
+        /**
+         * @brief Word
+         */
+        DWTDataSizeWord = 2,
+    } DWTDataSize;
+
+    /**
+     * @brief Configures single DWT comparator (ARMv8-M)
+     *
+     * For address matches @p size defines size of matched data item, @p value must be aligned to it.
+     *
+     * @param comparator Comparator to use
+     * @param value Address, data value or cycle count to match
+     * @param match Match type
+     * @param action Action on match
+     * @param size Size of matched data access
+     * @return true Comparator configured
+     * @return false Comparator not implemented
+     */
+    static inline bool
+        DWTSetComparator(uint8_t comparator, uint32_t value, DWTMatch match, DWTAction action, DWTDataSize size);
+
+    /**
+     * @brief Watches address range using pair of comparators (ARMv8-M)
+     *
+     * Comparator @p comparator holds start of range and @p comparator + 1 its limit. Implementations might support
+     * address limit only on selected comparators, check with vendor documentation.
+     *
+     * @param comparator First comparator of pair
+     * @param first First address of range
+     * @param last Last address of range (inclusive)
+     * @param match Address match type of range: DWTMatchInstructionAddress, DWTMatchDataAddress,
+     * DWTMatchDataAddressWrite or DWTMatchDataAddressRead
+     * @param action Action on match
+     * @return true Comparators configured
+     * @return false Comparator pair not implemented or invalid match type
+     */
+    static inline bool
+        DWTWatchRange(uint8_t comparator, uintptr_t first, uintptr_t last, DWTMatch match, DWTAction action);
+
+    /**
+     * @brief Watches for specific value accessed at specific address using pair of linked comparators (ARMv8-M)
+     *
+     * Comparator @p comparator matches address and @p comparator + 1 matches data value of accesses to that address.
+     *
+     * @param comparator First comparator of pair
+     * @param address Watched address, aligned to @p size
+     * @param value Data value
+     * @param size Size of watched data item
+     * @param match Linked value match type: DWTMatchLinkedDataValue, DWTMatchLinkedDataValueWrite or
+     * DWTMatchLinkedDataValueRead
+     * @param action Action on match
+     * @return true Comparators configured
+     * @return false Comparator pair not implemented or invalid match type
+     */
+    static inline bool DWTWatchValue(uint8_t comparator, uintptr_t address, uint32_t value, DWTDataSize size,
+                                     DWTMatch match, DWTAction action);
+#endif
 
     /**
      * @brief Disables DWT comparator
      *
-     * Number of comparators is vendor-specific, check with documention how many are available. This function does not
-     * check if specified comparator is available.
+     * Does nothing if specified comparator is not implemented.
      *
      * @param comparator Comparator to disable
      */
     static inline void DWTDisableComparator(uint8_t comparator);
 
+    /**
+     * @brief Checks if comparator matched since last call
+     *
+     * Reading clears matched flag of comparator.
+     *
+     * @param comparator Comparator
+     * @return true Comparator matched
+     * @return false No match or comparator not implemented
+     */
+    static inline bool DWTComparatorMatched(uint8_t comparator);
+
     /** @} */
 
     void DWTSetup(const DWTOptions* options)
     {
         CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable ITM and DWT
-        DWT->LAR = 0xC5ACCE55;                          // Unlock DWT access via magic number
+        ORBCODE_TRACE_DWT_LAR = 0xC5ACCE55;             // Unlock DWT access via magic number
 
         uint32_t ctrl = 0;
         ctrl |= (options->FoldedInstructionCounterEvent ? 1 : 0) << DWT_CTRL_FOLDEVTENA_Pos;
@@ -215,53 +492,157 @@ extern "C"
         DWT->CTRL = ctrl;
     }
 
+    void DWTPCSamplingStart(void)
+    {
+        DWT->CTRL |= DWT_CTRL_PCSAMPLENA_Msk;
+    }
+
+    void DWTPCSamplingStop(void)
+    {
+        DWT->CTRL &= ~DWT_CTRL_PCSAMPLENA_Msk;
+    }
+
+    void DWTSetSamplingPrescaler(uint8_t prescaler)
+    {
+        prescaler = prescaler < 1U ? 1U : (prescaler > 16U ? 16U : prescaler);
+        DWT->CTRL = (DWT->CTRL & ~DWT_CTRL_POSTPRESET_Msk) | ((uint32_t)(prescaler - 1U) << DWT_CTRL_POSTPRESET_Pos);
+    }
+
+    void DWTEnableCounterEvents(uint32_t events)
+    {
+        DWT->CTRL |= events & (uint32_t)(DWT_COUNTER_EVENT_ALL);
+    }
+
+    void DWTDisableCounterEvents(uint32_t events)
+    {
+        DWT->CTRL &= ~(events & (uint32_t)(DWT_COUNTER_EVENT_ALL));
+    }
+
+    // Internal helper. Comparators are laid out every 16 bytes starting at COMP0: COMPn, MASKn (ARMv7-M only),
+    // FUNCTIONn.
+    static inline volatile uint32_t* DWTComparatorRegisters(uint8_t comparator)
+    {
+        return &DWT->COMP0 + 4U * comparator;
+    }
+
+#define ORBCODE_TRACE_DWT_COMP 0
+#define ORBCODE_TRACE_DWT_MASK 1
+#define ORBCODE_TRACE_DWT_FUNCTION 2
+
+    uint8_t DWTComparatorCount(void)
+    {
+        return (uint8_t)((DWT->CTRL & DWT_CTRL_NUMCOMP_Msk) >> DWT_CTRL_NUMCOMP_Pos);
+    }
+
+#if !ORBCODE_TRACE_DWT_V8
     void DWTEnableComparator(uint8_t comparator, uintptr_t address, uint8_t ignoreBits, bool emitRange, uint8_t function)
     {
+        if(comparator >= DWTComparatorCount())
+        {
+            return;
+        }
+
         uint32_t funcRaw = ((function << DWT_FUNCTION_FUNCTION_Pos) & DWT_FUNCTION_FUNCTION_Msk) |
             ((emitRange ? 1 : 0) << DWT_FUNCTION_EMITRANGE_Pos);
 
-        switch(comparator)
+        volatile uint32_t* regs = DWTComparatorRegisters(comparator);
+        regs[ORBCODE_TRACE_DWT_COMP] = address;
+        regs[ORBCODE_TRACE_DWT_MASK] = ignoreBits;
+        regs[ORBCODE_TRACE_DWT_FUNCTION] = funcRaw;
+    }
+#else
+    // Internal helper
+    static inline uint32_t DWTFunctionValue(DWTMatch match, DWTAction action, DWTDataSize size)
+    {
+        // ACTION field is 2 bits wide, DWT_FUNCTION_ACTION_Msk in some CMSIS versions covers only one
+        return (((uint32_t)match << DWT_FUNCTION_MATCH_Pos) & DWT_FUNCTION_MATCH_Msk) |
+            (((uint32_t)action & 3U) << DWT_FUNCTION_ACTION_Pos) |
+            (((uint32_t)size << DWT_FUNCTION_DATAVSIZE_Pos) & DWT_FUNCTION_DATAVSIZE_Msk);
+    }
+
+    bool DWTSetComparator(uint8_t comparator, uint32_t value, DWTMatch match, DWTAction action, DWTDataSize size)
+    {
+        if(comparator >= DWTComparatorCount())
         {
-            case 0:
-                DWT->COMP0 = address;
-                DWT->MASK0 = ignoreBits;
-                DWT->FUNCTION0 = funcRaw;
-                break;
-            case 1:
-                DWT->COMP1 = address;
-                DWT->MASK1 = ignoreBits;
-                DWT->FUNCTION1 = funcRaw;
-                break;
-            case 2:
-                DWT->COMP2 = address;
-                DWT->MASK2 = ignoreBits;
-                DWT->FUNCTION2 = funcRaw;
+            return false;
+        }
+
+        volatile uint32_t* regs = DWTComparatorRegisters(comparator);
+        regs[ORBCODE_TRACE_DWT_FUNCTION] = 0; // disable while comparator value is changed
+        regs[ORBCODE_TRACE_DWT_COMP] = value;
+        regs[ORBCODE_TRACE_DWT_FUNCTION] = DWTFunctionValue(match, action, size);
+        return true;
+    }
+
+    bool DWTWatchRange(uint8_t comparator, uintptr_t first, uintptr_t last, DWTMatch match, DWTAction action)
+    {
+        DWTMatch limit;
+        switch(match)
+        {
+            case DWTMatchInstructionAddress:
+                limit = DWTMatchInstructionAddressLimit;
                 break;
-            case 3:
-                DWT->COMP3 = address;
-                DWT->MASK3 = ignoreBits;
-                DWT->FUNCTION3 = funcRaw;
+            case DWTMatchDataAddress:
+            case DWTMatchDataAddressWrite:
+            case DWTMatchDataAddressRead:
+                limit = DWTMatchDataAddressLimit;
                 break;
+            default:
+                return false;
+        }
+
+        if(comparator + 1U >= DWTComparatorCount())
+        {
+            return false;
         }
+
+        // Limit comparator is configured first so that range never matches with stale limit
+        DWTDisableComparator(comparator);
+        DWTSetComparator(comparator + 1U, (uint32_t)last, limit, DWTActionTrigger, DWTDataSizeByte);
+        DWTSetComparator(comparator, (uint32_t)first, match, action, DWTDataSizeByte);
+        return true;
     }
 
+    bool DWTWatchValue(uint8_t comparator, uintptr_t address, uint32_t value, DWTDataSize size, DWTMatch match,
+                       DWTAction action)
+    {
+        if(match != DWTMatchLinkedDataValue && match != DWTMatchLinkedDataValueWrite &&
+           match != DWTMatchLinkedDataValueRead)
+        {
+            return false;
+        }
+
+        if(comparator + 1U >= DWTComparatorCount())
+        {
+            return false;
+        }
+
+        // Address comparator only selects accesses, value comparator reports match
+        DWTDisableComparator(comparator + 1U);
+        DWTSetComparator(comparator, (uint32_t)address, DWTMatchDataAddress, DWTActionTrigger, size);
+        DWTSetComparator(comparator + 1U, value, match, action, size);
+        return true;
+    }
+#endif
+
     void DWTDisableComparator(uint8_t comparator)
     {
-        switch(comparator)
+        if(comparator >= DWTComparatorCount())
         {
-            case 0:
-                DWT->FUNCTION0 = 0;
-                break;
-            case 1:
-                DWT->FUNCTION1 = 0;
-                break;
-            case 2:
-                DWT->FUNCTION2 = 0;
-                break;
-            case 3:
-                DWT->FUNCTION3 = 0;
-                break;
+            return;
         }
+
+        DWTComparatorRegisters(comparator)[ORBCODE_TRACE_DWT_FUNCTION] = 0;
+    }
+
+    bool DWTComparatorMatched(uint8_t comparator)
+    {
+        if(comparator >= DWTComparatorCount())
+        {
+            return false;
+        }
+
+        return (DWTComparatorRegisters(comparator)[ORBCODE_TRACE_DWT_FUNCTION] & DWT_FUNCTION_MATCHED_Msk) != 0;
     }
 
 #ifdef __cplusplus
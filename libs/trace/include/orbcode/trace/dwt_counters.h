@@ -0,0 +1,257 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "dwt.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup dwt_counters Event counters
+     * @ingroup dwt
+     *
+     * @brief Read DWT profiling counters and extend them to 64 bits in software
+     *
+     * DWT provides 32-bit cycle counter (`CYCCNT`) and five 8-bit event counters enabled by DWTOptions fields:
+     * | Counter    | Counts                                                         | Enabled by                                 |
+     * |------------|----------------------------------------------------------------|--------------------------------------------|
+     * | `CPICNT`   | Additional cycles of multi-cycle instructions and fetch stalls | DWTOptions#CPICounterEvent                 |
+     * | `EXCCNT`   | Cycles spent in exception entry and exit                       | DWTOptions#ExceptionOverheadCounterEvent   |
+     * | `SLEEPCNT` | Cycles spent sleeping                                          | DWTOptions#SleepCounterEvent               |
+     * | `LSUCNT`   | Additional cycles of load/store instructions                   | DWTOptions#LSUCounterEvent                 |
+     * | `FOLDCNT`  | Folded (zero-cycle) instructions                               | DWTOptions#FoldedInstructionCounterEvent   |
+     *
+     * @ref DWTCounterAccumulator keeps 64-bit totals of all counters. Totals are correct as long as
+     * DWTCounterAccumulatorUpdate() (or DWTCounterAccumulatorRead()) is called before any 8-bit counter advances by 256
+     * and before cycle counter wraps, e.g. from periodic timer interrupt or at boundaries of measured code region.
+     * Event counters can wrap within a few hundred cycles, so regions measured this way should be short or updates must
+     * be frequent.
+     *
+     * @code{.c}
+     * static DWTCounterAccumulator Counters;
+     *
+     * void MeasureFilter(void)
+     * {
+     *     DWTCounters before, after;
+     *     DWTCounterAccumulatorRead(&Counters, &before);
+     *     RunFilter();
+     *     DWTCounterAccumulatorRead(&Counters, &after);
+     *
+     *     DWTCounters delta = DWTCountersDelta(&before, &after);
+     *     float cpi = (float)delta.Cycles / (float)DWTCountersInstructions(&delta);
+     *     float stallShare = (float)delta.LSU / (float)delta.Cycles;
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+    /**
+     * @brief Raw values of DWT counters read at the same time
+     */
+    typedef struct
+    {
+        /**
+         * @brief `DWT_CYCCNT`
+         */
+        uint32_t Cycles;
+        /**
+         * @brief `DWT_CPICNT`
+         */
+        uint8_t CPI;
+        /**
+         * @brief `DWT_EXCCNT`
+         */
+        uint8_t Exception;
+        /**
+         * @brief `DWT_SLEEPCNT`
+         */
+        uint8_t Sleep;
+        /**
+         * @brief `DWT_LSUCNT`
+         */
+        uint8_t LSU;
+        /**
+         * @brief `DWT_FOLDCNT`
+         */
+        uint8_t Folded;
+    } DWTCounterSnapshot;
+
+    /**
+     * @brief 64-bit counter totals or difference between two totals
+     */
+    typedef struct
+    {
+        /**
+         * @brief Cycles
+         */
+        uint64_t Cycles;
+        /**
+         * @brief Additional instruction cycles (`CPICNT`)
+         */
+        uint64_t CPI;
+        /**
+         * @brief Exception overhead cycles (`EXCCNT`)
+         */
+        uint64_t Exception;
+        /**
+         * @brief Sleep cycles (`SLEEPCNT`)
+         */
+        uint64_t Sleep;
+        /**
+         * @brief Additional load/store cycles (`LSUCNT`)
+         */
+        uint64_t LSU;
+        /**
+         * @brief Folded instructions (`FOLDCNT`)
+         */
+        uint64_t Folded;
+    } DWTCounters;
+
+    /**
+     * @brief Software extension of DWT counters to 64 bits
+     *
+     * All fields are managed by DWTCounterAccumulator* functions and must not be modified directly.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Counter values at last update
+         */
+        DWTCounterSnapshot Last;
+        /**
+         * @brief Totals since initialization
+         */
+        DWTCounters Total;
+    } DWTCounterAccumulator;
+
+    /**
+     * @brief Reads all DWT counters back-to-back
+     *
+     * @param snapshot Receives counter values
+     */
+    static inline void DWTReadCounters(DWTCounterSnapshot* snapshot);
+
+    /**
+     * @brief Initializes accumulator with current counter values and zero totals
+     *
+     * @param accumulator Accumulator
+     */
+    static inline void DWTCounterAccumulatorInit(DWTCounterAccumulator* accumulator);
+
+    /**
+     * @brief Adds counter increments since previous update to totals
+     *
+     * Safe to call from any context (uses short critical section).
+     *
+     * @param accumulator Accumulator
+     */
+    static inline void DWTCounterAccumulatorUpdate(DWTCounterAccumulator* accumulator);
+
+    /**
+     * @brief Updates accumulator and returns its totals
+     *
+     * Safe to call from any context (uses short critical section).
+     *
+     * @param accumulator Accumulator
+     * @param totals Receives totals since accumulator initialization
+     */
+    static inline void DWTCounterAccumulatorRead(DWTCounterAccumulator* accumulator, DWTCounters* totals);
+
+    /**
+     * @brief Computes difference between two totals
+     *
+     * @param before Totals at start of measured region
+     * @param after Totals at end of measured region
+     * @return Counter increments between @p before and @p after
+     */
+    static inline DWTCounters DWTCountersDelta(const DWTCounters* before, const DWTCounters* after);
+
+    /**
+     * @brief Estimates number of executed instructions
+     *
+     * Computed as `Cycles - CPI - Exception - Sleep - LSU + Folded` (see ARMv7-M Architecture Reference Manual, section
+     * C1.8.1). Valid only if all event counters were enabled during measured region.
+     *
+     * @param counters Counter totals or delta
+     * @return Number of instructions
+     */
+    static inline uint64_t DWTCountersInstructions(const DWTCounters* counters);
+
+    /** @} */
+
+    void DWTReadCounters(DWTCounterSnapshot* snapshot)
+    {
+        snapshot->Cycles = DWT->CYCCNT;
+        snapshot->CPI = (uint8_t)(DWT->CPICNT & DWT_CPICNT_CPICNT_Msk);
+        snapshot->Exception = (uint8_t)(DWT->EXCCNT & DWT_EXCCNT_EXCCNT_Msk);
+        snapshot->Sleep = (uint8_t)(DWT->SLEEPCNT & DWT_SLEEPCNT_SLEEPCNT_Msk);
+        snapshot->LSU = (uint8_t)(DWT->LSUCNT & DWT_LSUCNT_LSUCNT_Msk);
+        snapshot->Folded = (uint8_t)(DWT->FOLDCNT & DWT_FOLDCNT_FOLDCNT_Msk);
+    }
+
+    void DWTCounterAccumulatorInit(DWTCounterAccumulator* accumulator)
+    {
+        DWTReadCounters(&accumulator->Last);
+        accumulator->Total.Cycles = 0;
+        accumulator->Total.CPI = 0;
+        accumulator->Total.Exception = 0;
+        accumulator->Total.Sleep = 0;
+        accumulator->Total.LSU = 0;
+        accumulator->Total.Folded = 0;
+    }
+
+    void DWTCounterAccumulatorUpdate(DWTCounterAccumulator* accumulator)
+    {
+        uint32_t state = TraceCriticalEnter();
+
+        DWTCounterSnapshot now;
+        DWTReadCounters(&now);
+
+        // Unsigned subtraction truncated to counter width handles single wrap-around
+        accumulator->Total.Cycles += (uint32_t)(now.Cycles - accumulator->Last.Cycles);
+        accumulator->Total.CPI += (uint8_t)(now.CPI - accumulator->Last.CPI);
+        accumulator->Total.Exception += (uint8_t)(now.Exception - accumulator->Last.Exception);
+        accumulator->Total.Sleep += (uint8_t)(now.Sleep - accumulator->Last.Sleep);
+        accumulator->Total.LSU += (uint8_t)(now.LSU - accumulator->Last.LSU);
+        accumulator->Total.Folded += (uint8_t)(now.Folded - accumulator->Last.Folded);
+        accumulator->Last = now;
+
+        TraceCriticalExit(state);
+    }
+
+    void DWTCounterAccumulatorRead(DWTCounterAccumulator* accumulator, DWTCounters* totals)
+    {
+        uint32_t state = TraceCriticalEnter();
+        DWTCounterAccumulatorUpdate(accumulator);
+        *totals = accumulator->Total;
+        TraceCriticalExit(state);
+    }
+
+    DWTCounters DWTCountersDelta(const DWTCounters* before, const DWTCounters* after)
+    {
+        DWTCounters delta;
+        delta.Cycles = after->Cycles - before->Cycles;
+        delta.CPI = after->CPI - before->CPI;
+        delta.Exception = after->Exception - before->Exception;
+        delta.Sleep = after->Sleep - before->Sleep;
+        delta.LSU = after->LSU - before->LSU;
+        delta.Folded = after->Folded - before->Folded;
+        return delta;
+    }
+
+    uint64_t DWTCountersInstructions(const DWTCounters* counters)
+    {
+        return counters->Cycles - counters->CPI - counters->Exception - counters->Sleep - counters->LSU +
+            counters->Folded;
+    }
+
+#ifdef __cplusplus
+}
+#endif
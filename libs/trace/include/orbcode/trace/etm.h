@@ -0,0 +1,420 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dwt.h"
+
+#if !defined(__CORTEX_M)
+#    error \
+        "__CORTEX_M not defined. Include etm.h AFTER core_cmX.h (typically after including device-specific header)"
+#endif
+
+// Cortex-M3 and Cortex-M4 implement ETMv3.5, later cores ETMv4 (internal helper)
+#if(__CORTEX_M == 3U) || (__CORTEX_M == 4U)
+#    define ORBCODE_TRACE_ETM_V4 0
+#else
+#    define ORBCODE_TRACE_ETM_V4 1
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup etm Embedded Trace Macrocell
+     * @ingroup trace
+     *
+     * @brief Configure ETM for non-intrusive instruction trace
+     *
+     * Embedded Trace Macrocell outputs compressed program flow (taken branches, exceptions) without affecting timing
+     * of traced code. Decoder reconstructs executed instructions using program image, so ELF file of traced firmware is
+     * needed on host. Instruction trace produces lots of data and is usually received over parallel trace port with TPIU
+     * formatter enabled (TpiuOptions#FormattingEnabled), to separate it from ITM stream by ETMOptions#TraceBusID.
+     *
+     * Tracing only selected address ranges (e.g. hot loop) with ETMOptions#Ranges keeps trace bandwidth low enough to
+     * avoid overflows:
+     * * Cortex-M3 and Cortex-M4 (ETMv3.5) have no address comparators, ETM uses DWT comparators instead. Each range
+     *   occupies one DWT comparator (starting at ETMOptions#FirstComparator) matching smallest aligned power-of-two
+     *   block containing the range. Up to 2 ranges are supported.
+     * * Cortex-M7, Cortex-M23, Cortex-M33, Cortex-M55 and Cortex-M85 (ETMv4) use ETM address comparator pairs, their
+     *   number is implementation-defined (see ETMAddressRangeCount()).
+     *
+     * Other features (cycle-accurate mode, branch broadcast, timestamps) are optional too. ETMSetup() reads back
+     * configuration and fails if requested feature was not accepted by ETM.
+     *
+     * Reference: ARM Embedded Trace Macrocell Architecture Specification ETMv3 (IHI 0014) and ETMv4 (IHI 0064)
+     *
+     * @code{.c}
+     * extern const uint8_t FilterStart[], FilterEnd[]; // linker script symbols around hot code
+     *
+     * static const ETMAddressRange Ranges[] = {
+     *     {.Start = (uintptr_t)FilterStart, .End = (uintptr_t)FilterEnd - 1},
+     * };
+     *
+     * ETMOptions etm = {
+     *     .TraceBusID = 2,
+     *     .BranchBroadcast = true,
+     *     .Ranges = Ranges,
+     *     .RangeCount = 1,
+     *     .FirstComparator = 0,
+     * };
+     *
+     * TpiuSetup(&tpiu); // parallel trace port, formatter enabled
+     * ITMSetup(&itm);   // TraceBusID = 1
+     * if(!ETMSetup(&etm))
+     * {
+     *     // ETM not present or option not supported
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+#ifndef ETM_BASE
+/**
+ * @brief Base address of ETM registers
+ *
+ * Defaults to address used by all Cortex-M cores. Can be overridden by defining it before including this header.
+ */
+#    define ETM_BASE 0xE0041000UL
+#endif
+
+    /**
+     * @brief Traced address range
+     */
+    typedef struct
+    {
+        /**
+         * @brief Address of first traced instruction
+         */
+        uintptr_t Start;
+        /**
+         * @brief Last address of range (inclusive)
+         */
+        uintptr_t End;
+    } ETMAddressRange;
+
+    /**
+     * @brief ETM configuration options
+     */
+    typedef struct
+    {
+        /**
+         * @brief Trace bus ID (1-111), must differ from ITMOptions#TraceBusID
+         */
+        int TraceBusID;
+
+        /**
+         * @brief Enable cycle-accurate tracing
+         *
+         * Adds cycle counts to trace. Increases trace bandwidth considerably. Not implemented by every ETM (e.g.
+         * Cortex-M4).
+         */
+        bool CycleAccurate;
+
+        /**
+         * @brief Enable branch broadcasting
+         *
+         * Outputs address of every taken branch, not only of indirect ones. Allows decoding without program image at the
+         * cost of bandwidth.
+         */
+        bool BranchBroadcast;
+
+        /**
+         * @brief Enable timestamps
+         *
+         * Timestamps are inserted with synchronization packets. Timestamp source is implementation-defined, refer to
+         * vendor documentation.
+         */
+        bool Timestamps;
+
+        /**
+         * @brief Traced address ranges, NULL (or ETMOptions#RangeCount set to 0) traces everything
+         */
+        const ETMAddressRange* Ranges;
+
+        /**
+         * @brief Number of ranges in ETMOptions#Ranges
+         */
+        uint8_t RangeCount;
+
+        /**
+         * @brief First DWT comparator used for ranges (ETMv3.5 only)
+         */
+        uint8_t FirstComparator;
+    } ETMOptions;
+
+    /**
+     * @brief Checks if ETM is implemented
+     *
+     * @return true ETM registers are present
+     * @return false ETM is not implemented (ID register reads as zero)
+     */
+    static inline bool ETMIsPresent(void);
+
+    /**
+     * @brief Returns maximum number of address ranges supported by ETMOptions#Ranges
+     *
+     * @return Number of DWT comparators (up to 2) on ETMv3.5, number of address comparator pairs on ETMv4
+     */
+    static inline uint8_t ETMAddressRangeCount(void);
+
+    /**
+     * @brief Configures and enables ETM
+     *
+     * Unlocks and powers up ETM, programs it as requested and enables trace. On ETMv3.5 DWT comparators used for
+     * ranges are reprogrammed.
+     *
+     * @param options ETM configuration
+     * @return true ETM is tracing with requested configuration
+     * @return false ETM not present, did not respond, too many ranges or requested feature is not implemented (ETM is
+     * left disabled)
+     */
+    static inline bool ETMSetup(const ETMOptions* options);
+
+    /**
+     * @brief Stops instruction trace
+     *
+     * DWT comparators used for ranges on ETMv3.5 are left unchanged.
+     */
+    static inline void ETMDisable(void);
+
+    /** @} */
+
+    // Internal helpers
+
+#define ORBCODE_TRACE_ETM_REG(offset) (*(volatile uint32_t*)((uintptr_t)(ETM_BASE) + (offset)))
+#define ORBCODE_TRACE_ETM_LAR ORBCODE_TRACE_ETM_REG(0xFB0U)
+#define ORBCODE_TRACE_ETM_ID ORBCODE_TRACE_ETM_REG(0x1E4U) // ETMIDR (ETMv3.5), TRCIDR1 (ETMv4)
+#define ORBCODE_TRACE_ETM_TIMEOUT 100000U
+
+#if !ORBCODE_TRACE_ETM_V4
+#    define ORBCODE_TRACE_ETM_CR ORBCODE_TRACE_ETM_REG(0x000U)
+#    define ORBCODE_TRACE_ETM_TRIGGER ORBCODE_TRACE_ETM_REG(0x008U)
+#    define ORBCODE_TRACE_ETM_SR ORBCODE_TRACE_ETM_REG(0x010U)
+#    define ORBCODE_TRACE_ETM_TEEVR ORBCODE_TRACE_ETM_REG(0x020U)
+#    define ORBCODE_TRACE_ETM_TECR1 ORBCODE_TRACE_ETM_REG(0x024U)
+#    define ORBCODE_TRACE_ETM_TSEVR ORBCODE_TRACE_ETM_REG(0x1F8U)
+#    define ORBCODE_TRACE_ETM_TRACEIDR ORBCODE_TRACE_ETM_REG(0x200U)
+
+#    define ORBCODE_TRACE_ETM_CR_POWERDOWN (1UL << 0)
+#    define ORBCODE_TRACE_ETM_CR_BRANCHOUTPUT (1UL << 8)
+#    define ORBCODE_TRACE_ETM_CR_PROGRAMMING (1UL << 10)
+#    define ORBCODE_TRACE_ETM_CR_PORTSELECT (1UL << 11)
+#    define ORBCODE_TRACE_ETM_CR_CYCLEACCURATE (1UL << 12)
+#    define ORBCODE_TRACE_ETM_CR_TIMESTAMP (1UL << 28)
+#    define ORBCODE_TRACE_ETM_SR_PROGRAMMING (1UL << 1)
+
+// Event encoding: function in bits 14-16, resource B in bits 7-13, resource A in bits 0-6
+#    define ORBCODE_TRACE_ETM_RESOURCE_ALWAYS 0x6FUL
+#    define ORBCODE_TRACE_ETM_RESOURCE_WATCHPOINT(n) (0x20UL + (n))
+#    define ORBCODE_TRACE_ETM_EVENT_NEVER ((1UL << 14) | ORBCODE_TRACE_ETM_RESOURCE_ALWAYS)
+#    define ORBCODE_TRACE_ETM_EVENT_OR(a, b) ((5UL << 14) | ((uint32_t)(b) << 7) | (uint32_t)(a))
+#    define ORBCODE_TRACE_ETM_TECR1_EXCLUDE (1UL << 24)
+
+// DWT_FUNCTION value generating CMPMATCH (ETM resource) on instruction address match
+#    define ORBCODE_TRACE_ETM_DWT_FUNCTION 0x8U
+#    define ORBCODE_TRACE_ETM_MAX_RANGES 2U
+#else
+#    define ORBCODE_TRACE_ETM_PRGCTLR ORBCODE_TRACE_ETM_REG(0x004U)
+#    define ORBCODE_TRACE_ETM_STATR ORBCODE_TRACE_ETM_REG(0x00CU)
+#    define ORBCODE_TRACE_ETM_CONFIGR ORBCODE_TRACE_ETM_REG(0x010U)
+#    define ORBCODE_TRACE_ETM_EVENTCTL0R ORBCODE_TRACE_ETM_REG(0x020U)
+#    define ORBCODE_TRACE_ETM_EVENTCTL1R ORBCODE_TRACE_ETM_REG(0x024U)
+#    define ORBCODE_TRACE_ETM_STALLCTLR ORBCODE_TRACE_ETM_REG(0x02CU)
+#    define ORBCODE_TRACE_ETM_TSCTLR ORBCODE_TRACE_ETM_REG(0x030U)
+#    define ORBCODE_TRACE_ETM_CCCTLR ORBCODE_TRACE_ETM_REG(0x038U)
+#    define ORBCODE_TRACE_ETM_BBCTLR ORBCODE_TRACE_ETM_REG(0x03CU)
+#    define ORBCODE_TRACE_ETM_TRACEIDR ORBCODE_TRACE_ETM_REG(0x040U)
+#    define ORBCODE_TRACE_ETM_VICTLR ORBCODE_TRACE_ETM_REG(0x080U)
+#    define ORBCODE_TRACE_ETM_VIIECTLR ORBCODE_TRACE_ETM_REG(0x084U)
+#    define ORBCODE_TRACE_ETM_VISSCTLR ORBCODE_TRACE_ETM_REG(0x088U)
+#    define ORBCODE_TRACE_ETM_IDR3 ORBCODE_TRACE_ETM_REG(0x1ECU)
+#    define ORBCODE_TRACE_ETM_IDR4 ORBCODE_TRACE_ETM_REG(0x1F0U)
+#    define ORBCODE_TRACE_ETM_OSLAR ORBCODE_TRACE_ETM_REG(0x300U)
+#    define ORBCODE_TRACE_ETM_PDCR ORBCODE_TRACE_ETM_REG(0x310U)
+#    define ORBCODE_TRACE_ETM_ACVR(n) ORBCODE_TRACE_ETM_REG(0x400U + 8U * (n))
+#    define ORBCODE_TRACE_ETM_ACATR(n) ORBCODE_TRACE_ETM_REG(0x480U + 8U * (n))
+
+#    define ORBCODE_TRACE_ETM_STATR_IDLE (1UL << 0)
+#    define ORBCODE_TRACE_ETM_CONFIGR_BB (1UL << 3)
+#    define ORBCODE_TRACE_ETM_CONFIGR_CCI (1UL << 4)
+#    define ORBCODE_TRACE_ETM_CONFIGR_TS (1UL << 11)
+#    define ORBCODE_TRACE_ETM_PDCR_PU (1UL << 3)
+// ViewInst event: resource 1 (always true), start/stop logic in started state
+#    define ORBCODE_TRACE_ETM_VICTLR_ALWAYS ((1UL << 9) | 0x01UL)
+#endif
+
+    static inline bool ETMWaitStatus(volatile uint32_t* reg, uint32_t mask, bool set)
+    {
+        for(uint32_t i = 0; i < ORBCODE_TRACE_ETM_TIMEOUT; i++)
+        {
+            if(((*reg & mask) != 0UL) == set)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ETMIsPresent(void)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable trace components
+        return ORBCODE_TRACE_ETM_ID != 0UL;
+    }
+
+    uint8_t ETMAddressRangeCount(void)
+    {
+#if !ORBCODE_TRACE_ETM_V4
+        const uint8_t comparators = DWTComparatorCount();
+        return comparators < ORBCODE_TRACE_ETM_MAX_RANGES ? comparators : (uint8_t)ORBCODE_TRACE_ETM_MAX_RANGES;
+#else
+        return (uint8_t)(ORBCODE_TRACE_ETM_IDR4 & 0xFU);
+#endif
+    }
+
+#if !ORBCODE_TRACE_ETM_V4
+    bool ETMSetup(const ETMOptions* options)
+    {
+        if(!ETMIsPresent())
+        {
+            return false;
+        }
+
+        const uint8_t ranges = options->Ranges != NULL ? options->RangeCount : 0U;
+        if(ranges > ORBCODE_TRACE_ETM_MAX_RANGES || options->FirstComparator + ranges > DWTComparatorCount())
+        {
+            return false;
+        }
+
+        ORBCODE_TRACE_ETM_LAR = 0xC5ACCE55; // unlock ETM access (magic number)
+        ORBCODE_TRACE_ETM_CR = ORBCODE_TRACE_ETM_CR_PROGRAMMING;
+        if(!ETMWaitStatus(&ORBCODE_TRACE_ETM_SR, ORBCODE_TRACE_ETM_SR_PROGRAMMING, true))
+        {
+            return false;
+        }
+
+        // Port select routes trace to TPIU on Cortex-M
+        uint32_t cr = ORBCODE_TRACE_ETM_CR_PROGRAMMING | ORBCODE_TRACE_ETM_CR_PORTSELECT;
+        cr |= options->CycleAccurate ? ORBCODE_TRACE_ETM_CR_CYCLEACCURATE : 0U;
+        cr |= options->BranchBroadcast ? ORBCODE_TRACE_ETM_CR_BRANCHOUTPUT : 0U;
+        cr |= options->Timestamps ? ORBCODE_TRACE_ETM_CR_TIMESTAMP : 0U;
+        ORBCODE_TRACE_ETM_CR = cr;
+        // Only requested feature bits, other fields may read back differently
+        const uint32_t features =
+            ORBCODE_TRACE_ETM_CR_CYCLEACCURATE | ORBCODE_TRACE_ETM_CR_BRANCHOUTPUT | ORBCODE_TRACE_ETM_CR_TIMESTAMP;
+        if((ORBCODE_TRACE_ETM_CR & features) != (cr & features))
+        {
+            // Feature not implemented, leave ETM powered down
+            ORBCODE_TRACE_ETM_CR = ORBCODE_TRACE_ETM_CR_PROGRAMMING | ORBCODE_TRACE_ETM_CR_POWERDOWN;
+            return false;
+        }
+
+        ORBCODE_TRACE_ETM_TRACEIDR = (uint32_t)options->TraceBusID & 0x7FU;
+        ORBCODE_TRACE_ETM_TRIGGER = ORBCODE_TRACE_ETM_EVENT_NEVER;
+        ORBCODE_TRACE_ETM_TSEVR = ORBCODE_TRACE_ETM_EVENT_NEVER;
+        // No ETM address comparators, exclude mode with none selected leaves trace enable to event alone
+        ORBCODE_TRACE_ETM_TECR1 = ORBCODE_TRACE_ETM_TECR1_EXCLUDE;
+
+        uint32_t event = ORBCODE_TRACE_ETM_RESOURCE_ALWAYS;
+        for(uint8_t i = 0; i < ranges; i++)
+        {
+            const ETMAddressRange* range = &options->Ranges[i];
+            const uint8_t comparator = (uint8_t)(options->FirstComparator + i);
+
+            // Smallest aligned power-of-two block containing whole range
+            uint8_t ignoreBits = 0;
+            while(ignoreBits < 31U && (range->Start >> ignoreBits) != (range->End >> ignoreBits))
+            {
+                ignoreBits++;
+            }
+            DWTEnableComparator(comparator, range->Start, ignoreBits, false, ORBCODE_TRACE_ETM_DWT_FUNCTION);
+
+            event = i == 0 ? ORBCODE_TRACE_ETM_RESOURCE_WATCHPOINT(comparator)
+                           : ORBCODE_TRACE_ETM_EVENT_OR(event, ORBCODE_TRACE_ETM_RESOURCE_WATCHPOINT(comparator));
+        }
+        ORBCODE_TRACE_ETM_TEEVR = event;
+
+        ORBCODE_TRACE_ETM_CR = cr & ~ORBCODE_TRACE_ETM_CR_PROGRAMMING;
+        return ETMWaitStatus(&ORBCODE_TRACE_ETM_SR, ORBCODE_TRACE_ETM_SR_PROGRAMMING, false);
+    }
+
+    void ETMDisable(void)
+    {
+        ORBCODE_TRACE_ETM_CR |= ORBCODE_TRACE_ETM_CR_PROGRAMMING;
+        ORBCODE_TRACE_ETM_CR |= ORBCODE_TRACE_ETM_CR_POWERDOWN;
+    }
+#else
+    bool ETMSetup(const ETMOptions* options)
+    {
+        if(!ETMIsPresent())
+        {
+            return false;
+        }
+
+        const uint8_t ranges = options->Ranges != NULL ? options->RangeCount : 0U;
+        if(ranges > ETMAddressRangeCount() || ranges > 8U)
+        {
+            return false;
+        }
+
+        ORBCODE_TRACE_ETM_LAR = 0xC5ACCE55; // unlock ETM access (magic number)
+        ORBCODE_TRACE_ETM_OSLAR = 0;        // release OS lock
+        ORBCODE_TRACE_ETM_PDCR = ORBCODE_TRACE_ETM_PDCR_PU;
+
+        ORBCODE_TRACE_ETM_PRGCTLR = 0;
+        if(!ETMWaitStatus(&ORBCODE_TRACE_ETM_STATR, ORBCODE_TRACE_ETM_STATR_IDLE, true))
+        {
+            return false;
+        }
+
+        uint32_t config = 0;
+        config |= options->CycleAccurate ? ORBCODE_TRACE_ETM_CONFIGR_CCI : 0U;
+        config |= options->BranchBroadcast ? ORBCODE_TRACE_ETM_CONFIGR_BB : 0U;
+        config |= options->Timestamps ? ORBCODE_TRACE_ETM_CONFIGR_TS : 0U;
+        ORBCODE_TRACE_ETM_CONFIGR = config;
+        if(ORBCODE_TRACE_ETM_CONFIGR != config)
+        {
+            // Feature not implemented, ETM stays disabled
+            return false;
+        }
+
+        ORBCODE_TRACE_ETM_TRACEIDR = (uint32_t)options->TraceBusID & 0x7FU;
+        ORBCODE_TRACE_ETM_EVENTCTL0R = 0;
+        ORBCODE_TRACE_ETM_EVENTCTL1R = 0;
+        ORBCODE_TRACE_ETM_STALLCTLR = 0;
+        ORBCODE_TRACE_ETM_TSCTLR = 0;   // no timestamps on events (resource 0 is always false)
+        ORBCODE_TRACE_ETM_BBCTLR = 0;   // branch broadcast everywhere when enabled
+        ORBCODE_TRACE_ETM_CCCTLR = options->CycleAccurate ? (ORBCODE_TRACE_ETM_IDR3 & 0xFFFU) : 0U;
+
+        uint32_t include = 0;
+        for(uint8_t i = 0; i < ranges; i++)
+        {
+            // Instruction address comparison in all exception levels and security states
+            ORBCODE_TRACE_ETM_ACVR(2U * i) = (uint32_t)options->Ranges[i].Start;
+            ORBCODE_TRACE_ETM_ACATR(2U * i) = 0;
+            ORBCODE_TRACE_ETM_ACVR(2U * i + 1U) = (uint32_t)options->Ranges[i].End;
+            ORBCODE_TRACE_ETM_ACATR(2U * i + 1U) = 0;
+            include |= 1UL << i;
+        }
+        ORBCODE_TRACE_ETM_VICTLR = ORBCODE_TRACE_ETM_VICTLR_ALWAYS;
+        ORBCODE_TRACE_ETM_VIIECTLR = include;
+        ORBCODE_TRACE_ETM_VISSCTLR = 0;
+
+        ORBCODE_TRACE_ETM_PRGCTLR = 1;
+        return ETMWaitStatus(&ORBCODE_TRACE_ETM_STATR, ORBCODE_TRACE_ETM_STATR_IDLE, false);
+    }
+
+    void ETMDisable(void)
+    {
+        ORBCODE_TRACE_ETM_PRGCTLR = 0;
+    }
+#endif
+
+#ifdef __cplusplus
+}
+#endif
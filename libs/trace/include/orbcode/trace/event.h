@@ -0,0 +1,238 @@
+/** @file */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "itm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup event Structured events
+     * @ingroup trace
+     *
+     * @brief Send fixed-layout structs as raw bytes tagged with schema ID, decoded into typed rows on host
+     *
+     * @ref TRACE_EVENT_DEFINE registers struct type by placing schema record (struct size, name and field description)
+     * in dedicated linker section (@ref ORBCODE_TRACE_EVENT_SECTION) which, like format strings of @ref log, does not
+     * need to be loaded into MCU memory. @ref TRACE_EVENT sends header word with schema ID followed by struct bytes
+     * straight from caller's memory using burst write path of ITMWriteBufferUnchecked(), there is no serialization
+     * step. Host tool `orbcode-trace-events` reads schema records from ELF file and prints events as CSV rows.
+     *
+     * Field description lists fields in declaration order as `type name` separated by `;`, arrays are written as
+     * `type name[N]`. Supported types are `u8`, `i8`, `u16`, `i16`, `u32`, `i32`, `u64`, `i64`, `f32`, `f64` and
+     * `char` (arrays of `char` are printed as text). Host computes field offsets using natural alignment (as
+     * compilers for Cortex-M do for non-packed structs) and rejects schema whose computed size differs from
+     * `sizeof` of the struct.
+     *
+     * Event layout:
+     * | Bytes  | Content |
+     * |--------|---------|
+     * | 0-3    | bits 0-19: schema record address (masked with @ref TRACE_EVENT_ID_MASK), bits 20-31: struct size |
+     * | 4..    | struct bytes |
+     *
+     * Header and struct bytes are written with separate ITM writes, so events sent to the same stimulus port from
+     * multiple contexts must be serialized by caller (or use separate ports).
+     *
+     * Events are not framed, so host decodes every event by position in the stream: event cut short makes decoder read
+     * following header from the middle of truncated struct and lose synchronization. With @ref ITM_BACKEND_RAM whole
+     * event is dropped when ring does not have space for it. Hardware FIFO does not report free space, so with
+     * @ref ITM_STALL_SPIN or @ref ITM_STALL_DROP event ports should be left out of @ref ITM_STALL_PORT_MASK (writes
+     * block until accepted) unless losing the rest of capture after first dropped packet is acceptable.
+     *
+     * Linker script should place schema records in non-loaded section starting at address 0, e.g. for GNU ld:
+     *
+     * @code
+     * SECTIONS
+     * {
+     *     .orbcode_trace_evt 0 (INFO) :
+     *     {
+     *         KEEP(*(.orbcode_trace_evt))
+     *     }
+     * }
+     * @endcode
+     *
+     * @code{.c}
+     * typedef struct
+     * {
+     *     uint32_t Timestamp;
+     *     int16_t Current;
+     *     int16_t Voltage;
+     *     uint8_t State;
+     *     char Phase[3];
+     * } MotorSample;
+     *
+     * TRACE_EVENT_DEFINE(MotorSample, "u32 timestamp; i16 current; i16 voltage; u8 state; char phase[3]");
+     *
+     * void ControlLoop(const MotorSample* sample)
+     * {
+     *     TRACE_EVENT(4, MotorSample, sample);
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+#ifndef ORBCODE_TRACE_EVENT_SECTION
+/**
+ * @brief Name of linker section holding schema records
+ *
+ * Can be overridden by defining it before including this header.
+ */
+#    define ORBCODE_TRACE_EVENT_SECTION ".orbcode_trace_evt"
+#endif
+
+#ifndef ORBCODE_TRACE_EVENT_WRITE
+/**
+ * @brief Function used to send event
+ *
+ * Called as `ORBCODE_TRACE_EVENT_WRITE(port, header, event, size)`. Defaults to TraceEventWrite(). Can be overridden
+ * by defining it before including this header to route events through different output (e.g.
+ * TraceFlightRecorderWriteEvent() keeping them in RAM, see @ref flight_recorder).
+ */
+#    define ORBCODE_TRACE_EVENT_WRITE(port, header, event, size) TraceEventWrite((port), (header), (event), (size))
+#endif
+
+/**
+ * @brief Mask applied to schema record address to produce schema ID
+ */
+#define TRACE_EVENT_ID_MASK 0x000FFFFFUL
+
+/**
+ * @brief Position of struct size in event header
+ */
+#define TRACE_EVENT_SIZE_POS 20U
+
+/**
+ * @brief Maximum size of struct sent with @ref TRACE_EVENT
+ */
+#define TRACE_EVENT_MAX_SIZE 4095U
+
+/**
+ * @brief Registers struct type as event
+ *
+ * Use once per type at file scope of each translation unit sending events of this type. Every translation unit gets
+ * its own schema record (and ID), host tool knows all of them.
+ *
+ * @param type Struct type name (single identifier, e.g. typedef name)
+ * @param fields String literal describing fields, e.g. `"u32 timestamp; i16 current[3]"`
+ */
+#define TRACE_EVENT_DEFINE(type, fields)                                                                         \
+    static const struct                                                                                          \
+    {                                                                                                            \
+        uint32_t Size;                                                                                           \
+        char Name[sizeof(#type)];                                                                                \
+        char Fields[sizeof(fields)];                                                                             \
+    } orbcodeTraceEventSchema_##type __attribute__((section(ORBCODE_TRACE_EVENT_SECTION), used, aligned(4))) = { \
+        sizeof(type), #type, fields}
+
+/**
+ * @brief Sends event registered with @ref TRACE_EVENT_DEFINE
+ *
+ * No code is generated and @p event is not evaluated when @p port is constant disabled in
+ * @ref ITM_COMPILED_PORT_MASK. Struct larger than @ref TRACE_EVENT_MAX_SIZE fails to compile.
+ *
+ * @param port Stimulus port
+ * @param type Struct type name passed to @ref TRACE_EVENT_DEFINE
+ * @param event Pointer to struct
+ */
+#define TRACE_EVENT(port, type, event)                                                                         \
+    do                                                                                                         \
+    {                                                                                                          \
+        if(ITM_IS_PORT_COMPILED(port))                                                                         \
+        {                                                                                                      \
+            (void)sizeof(char[sizeof(type) <= TRACE_EVENT_MAX_SIZE ? 1 : -1]);                                 \
+            const type* orbcodeTraceEvent = (event);                                                           \
+            ORBCODE_TRACE_EVENT_WRITE((port), TraceEventHeader(&orbcodeTraceEventSchema_##type, sizeof(type)), \
+                                      orbcodeTraceEvent, sizeof(type));                                        \
+        }                                                                                                      \
+    } while(0)
+
+    /**
+     * @brief Builds event header word
+     *
+     * @param schema Schema record
+     * @param size Struct size
+     * @return Header word
+     */
+    static inline uint32_t TraceEventHeader(const void* schema, size_t size);
+
+    /**
+     * @brief Sends event header followed by struct bytes
+     *
+     * Used by @ref TRACE_EVENT. Does nothing if stimulus port is disabled. Struct bytes are not sent when header write
+     * is dropped by @ref ITM_STALL_POLICY. With @ref ITM_BACKEND_RAM and stall policy applied to port, event that does
+     * not fit into ring is dropped before its header is written (counted as ITMPortStatistics#Busy), otherwise whole
+     * event is stored with interrupts disabled. Header and struct bytes count as one ITMPortStatistics#Writes.
+     *
+     * @param port Stimulus port
+     * @param header Header word built with TraceEventHeader()
+     * @param event Struct bytes
+     * @param size Struct size
+     */
+    static inline void TraceEventWrite(uint8_t port, uint32_t header, const void* event, size_t size);
+
+    /** @} */
+
+    uint32_t TraceEventHeader(const void* schema, size_t size)
+    {
+        return ((uint32_t)(uintptr_t)schema & TRACE_EVENT_ID_MASK) | ((uint32_t)size << TRACE_EVENT_SIZE_POS);
+    }
+
+    void TraceEventWrite(uint8_t port, uint32_t header, const void* event, size_t size)
+    {
+        if(!ITMIsPortEnabled(port))
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
+            return;
+        }
+
+#if ITM_BACKEND == ITM_BACKEND_RAM && ITM_STALL_POLICY != ITM_STALL_BLOCK
+        if(ORBCODE_TRACE_ITM_STALL_APPLIES(port))
+        {
+            // Partial event would desynchronize host decoder, space check and stores must not be split by interrupt
+            const uint32_t state = TraceCriticalEnter();
+            if(!ITMRamFits(sizeof(header) + size))
+            {
+                TraceCriticalExit(state);
+                ORBCODE_TRACE_ITM_COUNT(port, Busy);
+                ITMRamMarkLost();
+                return;
+            }
+
+            (void)ITMRamPutValue(port, header, sizeof(header));
+            const uint8_t* body = (const uint8_t*)event;
+            size_t stored = 0;
+            while(stored < size)
+            {
+                const size_t chunk = ITMRamPut(port, body + stored, size - stored);
+                if(chunk == 0)
+                {
+                    break;
+                }
+                stored += chunk;
+            }
+            TraceCriticalExit(state);
+
+            ORBCODE_TRACE_ITM_COUNT_WRITE(port, sizeof(header) + stored);
+            return;
+        }
+#endif
+
+        if(!ITMStore32(port, header))
+        {
+            return;
+        }
+        // Header and body count as one write
+        const size_t stored = ITMWriteBufferPackets(port, event, size);
+        (void)stored; // Unused without statistics
+        ORBCODE_TRACE_ITM_COUNT_WRITE(port, sizeof(header) + stored);
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,113 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dwt.h"
+#include "itm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup exception_trace Exception latency tracing
+     * @ingroup dwt
+     *
+     * @brief Trace exception entry, exit and return with local timestamps for host-side latency analysis
+     *
+     * DWT emits exception trace packet when exception is entered, exited and when processor returns to exception (or
+     * thread mode). With local timestamps enabled, host tool `orbcode-trace-exceptions` reconstructs handler durations
+     * (with and without time spent in preempting handlers), preemption nesting and tail-chaining from raw ITM stream.
+     *
+     * Exception trace does not show when exception became pending. To measure entry latency, pend exception with
+     * TraceExceptionPend() (or call TraceExceptionMarkPending() at the moment event occurs, e.g. in capture interrupt
+     * of timer). Marker is written to stimulus port @ref TRACE_EXCEPTION_MARK_PORT and host measures time from marker
+     * to entry of marked exception.
+     *
+     * Exception trace produces 3 packets (plus timestamps) per exception, so SWO must be fast enough for interrupt rate
+     * (see @ref swo_planner). Overflow packets are reported by host tool and nesting state is rebuilt after them.
+     *
+     * @code{.c}
+     * ITMSetup(&itm);            // trace bus ID etc.
+     * DWTSetup(&dwt);
+     * TraceExceptionTraceEnable();
+     *
+     * TraceExceptionPend(EXTI0_IRQn); // measures latency of EXTI0_IRQHandler
+     * @endcode
+     *
+     * @{
+     */
+
+#ifndef TRACE_EXCEPTION_MARK_PORT
+/**
+ * @brief Stimulus port receiving pending markers
+ *
+ * Can be overridden by defining it before including this header. Host tool must use the same port.
+ */
+#    define TRACE_EXCEPTION_MARK_PORT 30
+#endif
+
+    /**
+     * @brief Enables exception trace with local timestamps
+     *
+     * Sets `DWT_CTRL.EXCTRCENA`, `ITM_TCR.DWTENA` and `ITM_TCR.TSENA` leaving remaining configuration (done by
+     * ITMSetup() and DWTSetup()) unchanged. Local timestamp prescaler should be left at
+     * ITMLocalTimestampPrescalerNoPrescaling for best resolution.
+     */
+    static inline void TraceExceptionTraceEnable(void);
+
+    /**
+     * @brief Disables exception trace
+     *
+     * Clears `DWT_CTRL.EXCTRCENA` only, DWT forwarding and timestamps stay enabled.
+     */
+    static inline void TraceExceptionTraceDisable(void);
+
+    /**
+     * @brief Records that exception became pending
+     *
+     * Host measures entry latency from this marker to next entry of @p exception.
+     *
+     * @param exception Exception number (IRQ number + 16)
+     */
+    static inline void TraceExceptionMarkPending(uint16_t exception);
+
+    /**
+     * @brief Pends interrupt and records pending marker
+     *
+     * @param irq Interrupt to pend
+     */
+    static inline void TraceExceptionPend(IRQn_Type irq);
+
+    /** @} */
+
+    void TraceExceptionTraceEnable(void)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable ITM and DWT
+        ITM->TCR |= ITM_TCR_DWTENA_Msk | ITM_TCR_TSENA_Msk;
+        DWT->CTRL |= DWT_CTRL_EXCTRCENA_Msk;
+    }
+
+    void TraceExceptionTraceDisable(void)
+    {
+        DWT->CTRL &= ~DWT_CTRL_EXCTRCENA_Msk;
+    }
+
+    void TraceExceptionMarkPending(uint16_t exception)
+    {
+        ITM_WRITE16(TRACE_EXCEPTION_MARK_PORT, exception);
+    }
+
+    void TraceExceptionPend(IRQn_Type irq)
+    {
+        // Marker is written first so that its timestamp never follows exception entry
+        TraceExceptionMarkPending((uint16_t)((int32_t)irq + 16));
+        NVIC_SetPendingIRQ(irq);
+    }
+
+#ifdef __cplusplus
+}
+#endif
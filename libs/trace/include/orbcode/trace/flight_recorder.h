@@ -0,0 +1,607 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "atomic.h"
+#include "event.h"
+#include "itm.h"
+
+#if defined(DWT)
+#    include "dwt_counters.h"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup flight_recorder Flight recorder
+     * @ingroup trace
+     *
+     * @brief Keep last log messages and events in RAM surviving warm reset, dump them after fault
+     *
+     * Units without SWO connected (or where streaming costs too much) can still collect @ref log messages and
+     * @ref event records: with @ref ORBCODE_TRACE_LOG_WRITE and @ref ORBCODE_TRACE_EVENT_WRITE routed to
+     * TraceFlightRecorderWrite() and TraceFlightRecorderWriteEvent(), every message is copied as single record into
+     * fixed RAM ring and nothing is written to ITM. When ring is full, oldest records are overwritten.
+     *
+     * Recorder state and storage are placed in section which is not initialized by startup code
+     * (@ref TRACE_FLIGHT_RECORDER_NOINIT), so they survive warm reset (watchdog, `NVIC_SystemReset()`, reset from
+     * fault handler). TraceFlightRecorderInit() validates retained state by walking all records and keeps them if
+     * they are consistent, otherwise (cold boot, different firmware, corruption) starts empty.
+     *
+     * HardFault handler or assert hook calls TraceFlightRecorderFreeze() which stops recording, so nothing overwrites
+     * records leading to the fault, and stores snapshot of DWT counters (@ref TraceFlightRecorderSnapshot) together
+     * with caller-defined reason. TraceFlightRecorderDump() passes snapshot and last N records to sink: over ITM with
+     * TraceFlightRecorderItmSink() (where probe is attached, directly from fault handler or after reset), or to
+     * application code e.g. storing them in flash. Records are sent on their original stimulus ports and decoded by
+     * `orbcode-trace-log` and `orbcode-trace-events` as if they were streamed live. Snapshot is sent as event, so
+     * `orbcode-trace-events` decodes it too.
+     *
+     * Record layout (each record starts at 4-byte boundary, records never wrap around end of storage):
+     * | Bytes  | Content |
+     * |--------|---------|
+     * | 0-3    | bits 0-15: data size, bits 16-23: stimulus port, bits 24-31: record tag |
+     * | 4..    | data, padded to multiple of 4 bytes |
+     *
+     * Linker script must provide section for @ref ORBCODE_TRACE_FLIGHT_RECORDER_SECTION not touched by startup code,
+     * e.g. for GNU ld:
+     *
+     * @code
+     * SECTIONS
+     * {
+     *     .noinit (NOLOAD) :
+     *     {
+     *         KEEP(*(.noinit))
+     *     } > RAM
+     * }
+     * @endcode
+     *
+     * @code{.c}
+     * #define ORBCODE_TRACE_LOG_WRITE(port, data, size) TraceFlightRecorderWrite(&Recorder, (port), (data), (size))
+     * #define ORBCODE_TRACE_EVENT_WRITE(port, header, event, size) \
+     *     TraceFlightRecorderWriteEvent(&Recorder, (port), (header), (event), (size))
+     * #include "orbcode/trace/flight_recorder.h"
+     * #include "orbcode/trace/log.h"
+     *
+     * TRACE_FLIGHT_RECORDER_NOINIT static TraceFlightRecorder Recorder;
+     * TRACE_FLIGHT_RECORDER_NOINIT static uint32_t RecorderStorage[1024];
+     *
+     * void HardFault_Handler(void)
+     * {
+     *     TraceFlightRecorderFreeze(&Recorder, SCB->CFSR);
+     *     NVIC_SystemReset();
+     * }
+     *
+     * int main(void)
+     * {
+     *     if(TraceFlightRecorderInit(&Recorder, RecorderStorage, sizeof(RecorderStorage)) &&
+     *        TraceFlightRecorderIsFrozen(&Recorder))
+     *     {
+     *         ITMSetup(&itm);
+     *         TraceFlightRecorderDump(&Recorder, 31, 64, TraceFlightRecorderItmSink, NULL);
+     *         TraceFlightRecorderClear(&Recorder);
+     *     }
+     *
+     *     TRACE_LOG(1, "Started");
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+#ifndef ORBCODE_TRACE_FLIGHT_RECORDER_SECTION
+/**
+ * @brief Name of linker section holding recorder state and storage
+ *
+ * Can be overridden by defining it before including this header.
+ */
+#    define ORBCODE_TRACE_FLIGHT_RECORDER_SECTION ".noinit"
+#endif
+
+/**
+ * @brief Places variable in @ref ORBCODE_TRACE_FLIGHT_RECORDER_SECTION
+ */
+#define TRACE_FLIGHT_RECORDER_NOINIT __attribute__((section(ORBCODE_TRACE_FLIGHT_RECORDER_SECTION)))
+
+/**
+ * @brief Value of TraceFlightRecorder#Magic of initialized recorder
+ */
+#define TRACE_FLIGHT_RECORDER_MAGIC 0x464C5452UL
+
+/**
+ * @brief Maximum size of data in single record
+ */
+#define TRACE_FLIGHT_RECORDER_MAX_RECORD_SIZE 0xFFFFU
+
+/**
+ * @brief Size of storage used by record with @p size bytes of data
+ */
+#define TRACE_FLIGHT_RECORDER_RECORD_SIZE(size) (4U + (((uint32_t)(size) + 3U) & ~3U))
+
+    /**
+     * @brief State at the moment recorder was frozen
+     */
+    typedef struct
+    {
+        /**
+         * @brief Reason passed to TraceFlightRecorderFreeze()
+         */
+        uint32_t Reason;
+        /**
+         * @brief Number of warm resets survived by recorder
+         */
+        uint32_t Resets;
+        /**
+         * @brief Number of records stored
+         */
+        uint32_t Records;
+        /**
+         * @brief Number of records overwritten by newer ones
+         */
+        uint32_t Overwritten;
+        /**
+         * @brief Number of records rejected because they were too large or recorder was frozen
+         */
+        uint32_t Dropped;
+        /**
+         * @brief `DWT_CYCCNT` (0 on cores without DWT)
+         */
+        uint32_t Cycles;
+        /**
+         * @brief `DWT_CPICNT`
+         */
+        uint8_t CPI;
+        /**
+         * @brief `DWT_EXCCNT`
+         */
+        uint8_t Exception;
+        /**
+         * @brief `DWT_SLEEPCNT`
+         */
+        uint8_t Sleep;
+        /**
+         * @brief `DWT_LSUCNT`
+         */
+        uint8_t LSU;
+        /**
+         * @brief `DWT_FOLDCNT`
+         */
+        uint8_t Folded;
+        /**
+         * @brief Always 0
+         */
+        uint8_t Reserved[3];
+    } TraceFlightRecorderSnapshot;
+
+    TRACE_EVENT_DEFINE(TraceFlightRecorderSnapshot,
+                       "u32 reason; u32 resets; u32 records; u32 overwritten; u32 dropped; u32 cycles; u8 cpi; "
+                       "u8 exception; u8 sleep; u8 lsu; u8 folded; u8 reserved[3]");
+
+    /**
+     * @brief Flight recorder state, must be placed in @ref ORBCODE_TRACE_FLIGHT_RECORDER_SECTION
+     *
+     * All fields are managed by TraceFlightRecorder* functions and must not be modified directly.
+     */
+    typedef struct
+    {
+        /**
+         * @brief @ref TRACE_FLIGHT_RECORDER_MAGIC when initialized
+         */
+        uint32_t Magic;
+        /**
+         * @brief Record storage
+         */
+        uint8_t* Storage;
+        /**
+         * @brief Size of storage in bytes (multiple of 4)
+         */
+        uint32_t Size;
+        /**
+         * @brief Offset at which next record is written
+         */
+        uint32_t Head;
+        /**
+         * @brief Offset of oldest record
+         */
+        uint32_t Tail;
+        /**
+         * @brief Number of records stored
+         */
+        uint32_t Records;
+        /**
+         * @brief Number of records overwritten by newer ones since last clear
+         */
+        uint32_t Overwritten;
+        /**
+         * @brief Number of records rejected since last clear
+         */
+        uint32_t Dropped;
+        /**
+         * @brief Number of warm resets survived
+         */
+        uint32_t Resets;
+        /**
+         * @brief Non-zero when recording is stopped by TraceFlightRecorderFreeze()
+         */
+        uint32_t Frozen;
+        /**
+         * @brief Snapshot taken by TraceFlightRecorderFreeze()
+         */
+        TraceFlightRecorderSnapshot Snapshot;
+    } TraceFlightRecorder;
+
+    /**
+     * @brief Receives dumped records
+     *
+     * @param port Stimulus port of record
+     * @param data Record data
+     * @param size Size of data in bytes
+     * @param context Passed to TraceFlightRecorderDump()
+     */
+    typedef void (*TraceFlightRecorderSink)(uint8_t port, const void* data, size_t size, void* context);
+
+    /**
+     * @brief Initializes recorder, keeping records retained across warm reset
+     *
+     * Retained state is kept only if it was created for the same storage and all records are consistent. Otherwise
+     * recorder starts empty. Recording state (frozen or not) is kept too, so records and snapshot leading to fault
+     * stay intact until TraceFlightRecorderClear() or TraceFlightRecorderResume().
+     *
+     * @param recorder Recorder placed in @ref ORBCODE_TRACE_FLIGHT_RECORDER_SECTION
+     * @param storage Record storage placed in @ref ORBCODE_TRACE_FLIGHT_RECORDER_SECTION, 4-byte aligned
+     * @param size Size of storage in bytes
+     * @return true Records retained from before reset
+     */
+    static inline bool TraceFlightRecorderInit(TraceFlightRecorder* recorder, void* storage, size_t size);
+
+    /**
+     * @brief Removes all records, clears counters (except number of resets) and resumes recording
+     *
+     * @param recorder Recorder
+     */
+    static inline void TraceFlightRecorderClear(TraceFlightRecorder* recorder);
+
+    /**
+     * @brief Stores record, overwriting oldest records if needed
+     *
+     * Safe to call from any context (interrupts are masked while record is copied). Matches
+     * @ref ORBCODE_TRACE_LOG_WRITE signature after binding recorder.
+     *
+     * @param recorder Recorder
+     * @param port Stimulus port on which record is dumped
+     * @param data Record data
+     * @param size Size of data in bytes
+     * @return true Record stored, false if recorder is frozen or record does not fit storage
+     */
+    static inline bool TraceFlightRecorderWrite(TraceFlightRecorder* recorder, uint8_t port, const void* data,
+                                                size_t size);
+
+    /**
+     * @brief Stores event header and struct bytes as single record
+     *
+     * Matches @ref ORBCODE_TRACE_EVENT_WRITE signature after binding recorder.
+     *
+     * @param recorder Recorder
+     * @param port Stimulus port on which record is dumped
+     * @param header Header word built with TraceEventHeader()
+     * @param event Struct bytes
+     * @param size Struct size
+     * @return true Record stored, false if recorder is frozen or record does not fit storage
+     */
+    static inline bool TraceFlightRecorderWriteEvent(TraceFlightRecorder* recorder, uint8_t port, uint32_t header,
+                                                     const void* event, size_t size);
+
+    /**
+     * @brief Stops recording and takes snapshot of DWT counters
+     *
+     * Intended for fault handlers and assert hooks. Only first call takes snapshot, following calls (e.g. nested
+     * fault) do nothing until recording is resumed.
+     *
+     * @param recorder Recorder
+     * @param reason Caller-defined reason (e.g. `SCB->CFSR` or assert line), stored in snapshot
+     */
+    static inline void TraceFlightRecorderFreeze(TraceFlightRecorder* recorder, uint32_t reason);
+
+    /**
+     * @brief Returns true if recording was stopped by TraceFlightRecorderFreeze()
+     *
+     * @param recorder Recorder
+     */
+    static inline bool TraceFlightRecorderIsFrozen(const TraceFlightRecorder* recorder);
+
+    /**
+     * @brief Resumes recording after TraceFlightRecorderFreeze(), keeping stored records
+     *
+     * @param recorder Recorder
+     */
+    static inline void TraceFlightRecorderResume(TraceFlightRecorder* recorder);
+
+    /**
+     * @brief Passes snapshot and last records to sink, oldest first
+     *
+     * Snapshot is passed only when recorder is frozen, as @ref event of type @ref TraceFlightRecorderSnapshot (header
+     * word followed by struct). Records are not removed. Recorder should be frozen while dumping, otherwise records
+     * written meanwhile can overwrite records being dumped.
+     *
+     * @param recorder Recorder
+     * @param snapshotPort Stimulus port passed to sink with snapshot
+     * @param count Maximum number of records, SIZE_MAX for all
+     * @param sink Receives snapshot and records
+     * @param context Passed to sink
+     * @return Number of records passed to sink
+     */
+    static inline size_t TraceFlightRecorderDump(const TraceFlightRecorder* recorder, uint8_t snapshotPort,
+                                                 size_t count, TraceFlightRecorderSink sink, void* context);
+
+    /**
+     * @brief Sink sending records to their stimulus ports with ITMWriteBuffer()
+     *
+     * ITM must be set up before dumping.
+     *
+     * @param port Stimulus port
+     * @param data Record data
+     * @param size Size of data in bytes
+     * @param context Unused
+     */
+    static inline void TraceFlightRecorderItmSink(uint8_t port, const void* data, size_t size, void* context);
+
+    /** @} */
+
+    // Internal helpers
+
+#define ORBCODE_TRACE_FLIGHT_RECORDER_TAG_POS 24U
+#define ORBCODE_TRACE_FLIGHT_RECORDER_TAG_RECORD 0xA5U
+#define ORBCODE_TRACE_FLIGHT_RECORDER_TAG_PADDING 0x5AU
+#define ORBCODE_TRACE_FLIGHT_RECORDER_PORT_POS 16U
+#define ORBCODE_TRACE_FLIGHT_RECORDER_SIZE_MASK 0xFFFFUL
+
+    static inline uint32_t TraceFlightRecorderHeaderAt(const TraceFlightRecorder* recorder, uint32_t offset)
+    {
+        uint32_t header;
+        memcpy(&header, recorder->Storage + offset, sizeof(header));
+        return header;
+    }
+
+    static inline uint32_t TraceFlightRecorderTag(uint32_t header)
+    {
+        return header >> ORBCODE_TRACE_FLIGHT_RECORDER_TAG_POS;
+    }
+
+    // Offset of record following the one ending at offset: records continue at 0 after padding or end of storage
+    static inline uint32_t TraceFlightRecorderSkip(const TraceFlightRecorder* recorder, uint32_t offset)
+    {
+        if(offset >= recorder->Size ||
+           TraceFlightRecorderTag(TraceFlightRecorderHeaderAt(recorder, offset)) ==
+               ORBCODE_TRACE_FLIGHT_RECORDER_TAG_PADDING)
+        {
+            return 0;
+        }
+        return offset;
+    }
+
+    // Overwrites oldest records starting within [start, end)
+    static inline void TraceFlightRecorderEvict(TraceFlightRecorder* recorder, uint32_t start, uint32_t end)
+    {
+        while(recorder->Records > 0 && recorder->Tail >= start && recorder->Tail < end)
+        {
+            const uint32_t header = TraceFlightRecorderHeaderAt(recorder, recorder->Tail);
+            recorder->Tail += TRACE_FLIGHT_RECORDER_RECORD_SIZE(header & ORBCODE_TRACE_FLIGHT_RECORDER_SIZE_MASK);
+            recorder->Records--;
+            recorder->Overwritten++;
+            if(recorder->Records > 0)
+            {
+                recorder->Tail = TraceFlightRecorderSkip(recorder, recorder->Tail);
+            }
+        }
+    }
+
+    static inline bool TraceFlightRecorderAppend(TraceFlightRecorder* recorder, uint8_t port, const void* prefix,
+                                                 size_t prefixSize, const void* data, size_t size)
+    {
+        const size_t total = prefixSize + size;
+        uint32_t state = TraceCriticalEnter();
+        if(recorder->Frozen != 0 || total > TRACE_FLIGHT_RECORDER_MAX_RECORD_SIZE ||
+           TRACE_FLIGHT_RECORDER_RECORD_SIZE(total) > recorder->Size)
+        {
+            recorder->Dropped++;
+            TraceCriticalExit(state);
+            return false;
+        }
+
+        const uint32_t recordSize = TRACE_FLIGHT_RECORDER_RECORD_SIZE(total);
+        if(recorder->Size - recorder->Head < recordSize)
+        {
+            TraceFlightRecorderEvict(recorder, recorder->Head, recorder->Size);
+            const uint32_t padding = (uint32_t)ORBCODE_TRACE_FLIGHT_RECORDER_TAG_PADDING
+                                     << ORBCODE_TRACE_FLIGHT_RECORDER_TAG_POS;
+            memcpy(recorder->Storage + recorder->Head, &padding, sizeof(padding));
+            recorder->Head = 0;
+        }
+        TraceFlightRecorderEvict(recorder, recorder->Head, recorder->Head + recordSize);
+
+        const uint32_t offset = recorder->Head;
+        const uint32_t header = ((uint32_t)ORBCODE_TRACE_FLIGHT_RECORDER_TAG_RECORD
+                                 << ORBCODE_TRACE_FLIGHT_RECORDER_TAG_POS) |
+                                ((uint32_t)port << ORBCODE_TRACE_FLIGHT_RECORDER_PORT_POS) | (uint32_t)total;
+        memcpy(recorder->Storage + offset, &header, sizeof(header));
+        if(prefixSize > 0)
+        {
+            memcpy(recorder->Storage + offset + sizeof(header), prefix, prefixSize);
+        }
+        if(size > 0)
+        {
+            memcpy(recorder->Storage + offset + sizeof(header) + prefixSize, data, size);
+        }
+
+        recorder->Head = offset + recordSize == recorder->Size ? 0U : offset + recordSize;
+        if(recorder->Records == 0)
+        {
+            recorder->Tail = offset;
+        }
+        recorder->Records++;
+        TraceCriticalExit(state);
+        return true;
+    }
+
+    static inline bool TraceFlightRecorderValid(const TraceFlightRecorder* recorder, const void* storage, size_t size)
+    {
+        if(recorder->Magic != TRACE_FLIGHT_RECORDER_MAGIC || recorder->Storage != storage ||
+           recorder->Size != (uint32_t)(size & ~(size_t)3U) || recorder->Head >= recorder->Size ||
+           recorder->Tail >= recorder->Size || (recorder->Head & 3U) != 0 || (recorder->Tail & 3U) != 0 ||
+           recorder->Records > recorder->Size / 4U)
+        {
+            return false;
+        }
+
+        uint32_t offset = recorder->Tail;
+        for(uint32_t i = 0; i < recorder->Records; i++)
+        {
+            if(i > 0)
+            {
+                offset = TraceFlightRecorderSkip(recorder, offset);
+            }
+            const uint32_t header = TraceFlightRecorderHeaderAt(recorder, offset);
+            if(TraceFlightRecorderTag(header) != ORBCODE_TRACE_FLIGHT_RECORDER_TAG_RECORD)
+            {
+                return false;
+            }
+            offset += TRACE_FLIGHT_RECORDER_RECORD_SIZE(header & ORBCODE_TRACE_FLIGHT_RECORDER_SIZE_MASK);
+            if(offset > recorder->Size)
+            {
+                return false;
+            }
+        }
+        return recorder->Records == 0 || (offset == recorder->Size ? 0U : offset) == recorder->Head;
+    }
+
+    bool TraceFlightRecorderInit(TraceFlightRecorder* recorder, void* storage, size_t size)
+    {
+        if(TraceFlightRecorderValid(recorder, storage, size))
+        {
+            recorder->Resets++;
+            return true;
+        }
+
+        recorder->Magic = TRACE_FLIGHT_RECORDER_MAGIC;
+        recorder->Storage = (uint8_t*)storage;
+        recorder->Size = (uint32_t)(size & ~(size_t)3U);
+        recorder->Resets = 0;
+        TraceFlightRecorderClear(recorder);
+        return false;
+    }
+
+    void TraceFlightRecorderClear(TraceFlightRecorder* recorder)
+    {
+        uint32_t state = TraceCriticalEnter();
+        recorder->Head = 0;
+        recorder->Tail = 0;
+        recorder->Records = 0;
+        recorder->Overwritten = 0;
+        recorder->Dropped = 0;
+        recorder->Frozen = 0;
+        memset(&recorder->Snapshot, 0, sizeof(recorder->Snapshot));
+        TraceCriticalExit(state);
+    }
+
+    bool TraceFlightRecorderWrite(TraceFlightRecorder* recorder, uint8_t port, const void* data, size_t size)
+    {
+        return TraceFlightRecorderAppend(recorder, port, NULL, 0, data, size);
+    }
+
+    bool TraceFlightRecorderWriteEvent(TraceFlightRecorder* recorder, uint8_t port, uint32_t header,
+                                       const void* event, size_t size)
+    {
+        return TraceFlightRecorderAppend(recorder, port, &header, sizeof(header), event, size);
+    }
+
+    void TraceFlightRecorderFreeze(TraceFlightRecorder* recorder, uint32_t reason)
+    {
+        uint32_t state = TraceCriticalEnter();
+        if(recorder->Frozen == 0)
+        {
+            TraceFlightRecorderSnapshot* snapshot = &recorder->Snapshot;
+            memset(snapshot, 0, sizeof(*snapshot));
+#if defined(DWT)
+            DWTCounterSnapshot counters;
+            DWTReadCounters(&counters);
+            snapshot->Cycles = counters.Cycles;
+            snapshot->CPI = counters.CPI;
+            snapshot->Exception = counters.Exception;
+            snapshot->Sleep = counters.Sleep;
+            snapshot->LSU = counters.LSU;
+            snapshot->Folded = counters.Folded;
+#endif
+            snapshot->Reason = reason;
+            snapshot->Resets = recorder->Resets;
+            snapshot->Records = recorder->Records;
+            snapshot->Overwritten = recorder->Overwritten;
+            snapshot->Dropped = recorder->Dropped;
+            recorder->Frozen = 1;
+        }
+        TraceCriticalExit(state);
+    }
+
+    bool TraceFlightRecorderIsFrozen(const TraceFlightRecorder* recorder)
+    {
+        return recorder->Frozen != 0;
+    }
+
+    void TraceFlightRecorderResume(TraceFlightRecorder* recorder)
+    {
+        recorder->Frozen = 0;
+    }
+
+    size_t TraceFlightRecorderDump(const TraceFlightRecorder* recorder, uint8_t snapshotPort, size_t count,
+                                   TraceFlightRecorderSink sink, void* context)
+    {
+        if(recorder->Frozen != 0)
+        {
+            struct
+            {
+                uint32_t Header;
+                TraceFlightRecorderSnapshot Snapshot;
+            } message;
+            message.Header = TraceEventHeader(&orbcodeTraceEventSchema_TraceFlightRecorderSnapshot,
+                                              sizeof(TraceFlightRecorderSnapshot));
+            message.Snapshot = recorder->Snapshot;
+            sink(snapshotPort, &message, sizeof(message), context);
+        }
+
+        const uint32_t records = recorder->Records;
+        const size_t skip = records > count ? records - count : 0U;
+        uint32_t offset = recorder->Tail;
+        size_t dumped = 0;
+        for(uint32_t i = 0; i < records; i++)
+        {
+            if(i > 0)
+            {
+                offset = TraceFlightRecorderSkip(recorder, offset);
+            }
+            const uint32_t header = TraceFlightRecorderHeaderAt(recorder, offset);
+            const uint32_t size = header & ORBCODE_TRACE_FLIGHT_RECORDER_SIZE_MASK;
+            if(i >= skip)
+            {
+                sink((uint8_t)(header >> ORBCODE_TRACE_FLIGHT_RECORDER_PORT_POS), recorder->Storage + offset + 4U,
+                     size, context);
+                dumped++;
+            }
+            offset += TRACE_FLIGHT_RECORDER_RECORD_SIZE(size);
+        }
+        return dumped;
+    }
+
+    void TraceFlightRecorderItmSink(uint8_t port, const void* data, size_t size, void* context)
+    {
+        (void)context;
+        ITMWriteBuffer(port, data, size);
+    }
+
+#ifdef __cplusplus
+}
+#endif
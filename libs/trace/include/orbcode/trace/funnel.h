@@ -0,0 +1,327 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup funnel Trace funnel
+     * @ingroup trace
+     *
+     * @brief Merge trace of several cores into one TPIU through CoreSight trace funnel
+     *
+     * On multi-core SoCs ITM and ETM of each core send trace over ATB bus to CoreSight Trace Funnel (CSTF), which
+     * arbitrates between its input ports and forwards data to single TPIU. TPIU formatter
+     * (TpiuOptions#FormattingEnabled) tags data with trace source ID of each source, so host can split merged stream
+     * again (`TpiuDeframer`, `orbcode-trace-demux`). For that to work every source needs unique ID:
+     * @ref TRACE_FUNNEL_TRACE_ID gives each core its own range of IDs (core 0 ITM is `0x10`, core 0 ETM `0x11`, core 1
+     * ITM `0x20` and so on), host tools use the same numbering to name streams.
+     *
+     * Funnel serves input ports by priority (lower value is served first) and keeps serving selected port for
+     * TraceFunnelOptions#HoldTime transactions. Longer hold time means fewer source ID changes in TPIU frames (less
+     * bandwidth overhead), but other sources wait longer and their FIFOs can overflow. TracePlanFunnel() selects
+     * priorities (sources with lower data rate, usually ITM, first - they have the smallest FIFOs) and the shortest
+     * hold time for which estimated traffic fits in trace port.
+     *
+     * Funnel base address and mapping of input ports to cores are SoC-specific, refer to vendor documentation (or
+     * CoreSight ROM table). Funnel is usually configured by one core, before trace sources are enabled. Each core
+     * configures its own ITM/ETM (they are private to the core) with ID from @ref TRACE_FUNNEL_TRACE_ID.
+     *
+     * Reference: CoreSight Components Technical Reference Manual (DDI 0314), chapter 7 Trace Funnel
+     *
+     * @code{.c}
+     * #define TRACE_FUNNEL_BASE 0xE00F3000UL // from SoC reference manual
+     *
+     * TpiuPortWidthSelection port;
+     * TpiuSelectPortWidth(TPIU_PORT_WIDTHS_ALL, 100000000, &port); // parallel trace port, formatter enabled
+     *
+     * TraceFunnelTargets targets = {
+     *     .PortRates = {[0] = 20000, [1] = 4000000, [2] = 10000}, // core 0 ITM, core 0 ETM, core 1 ITM
+     *     .Bandwidth = port.Bandwidth,
+     * };
+     * TraceFunnelOptions funnel = {.Base = TRACE_FUNNEL_BASE};
+     * TraceFunnelPlan plan;
+     * if(!TracePlanFunnel(&targets, &funnel, &plan) || !TraceFunnelSetup(&funnel))
+     * {
+     *     // trace port too slow or funnel has fewer ports
+     * }
+     *
+     * // On each core
+     * ITMOptions itm = {.TraceBusID = TRACE_FUNNEL_TRACE_ID(CoreIndex(), TraceSourceItm)};
+     * ITMSetup(&itm);
+     * @endcode
+     *
+     * @{
+     */
+
+/**
+ * @brief Maximum number of funnel input ports
+ */
+#define TRACE_FUNNEL_MAX_PORTS 8U
+
+/**
+ * @brief Maximum number of cores with IDs assigned by @ref TRACE_FUNNEL_TRACE_ID (IDs above `0x6F` are reserved)
+ */
+#define TRACE_FUNNEL_MAX_CORES 6U
+
+/**
+ * @brief Trace source ID of source on core (ITMOptions#TraceBusID, ETMOptions#TraceBusID)
+ *
+ * @param core Core index (0 - @ref TRACE_FUNNEL_MAX_CORES - 1)
+ * @param source Trace source on the core (@ref TraceSourceType or other number 0 - 15)
+ */
+#define TRACE_FUNNEL_TRACE_ID(core, source) ((int)((((uint32_t)(core) + 1U) << 4) | ((uint32_t)(source)&0xFU)))
+
+#ifndef TRACE_FUNNEL_ATB_BYTES
+/**
+ * @brief Data bytes in single ATB transaction, used to estimate source ID overhead
+ *
+ * Defaults to 1 (ITM and ETM of Cortex-M cores have 8-bit ATB interface). Can be overridden by defining it before
+ * including this header.
+ */
+#    define TRACE_FUNNEL_ATB_BYTES 1U
+#endif
+
+    /**
+     * @brief Trace sources of single core
+     */
+    typedef enum
+    {
+        /**
+         * @brief Instrumentation Trace Macrocell
+         */
+        TraceSourceItm = 0,
+        /**
+         * @brief Embedded Trace Macrocell
+         */
+        TraceSourceEtm = 1,
+    } TraceSourceType;
+
+    /**
+     * @brief Funnel configuration
+     */
+    typedef struct
+    {
+        /**
+         * @brief Base address of funnel registers (SoC-specific)
+         */
+        uintptr_t Base;
+        /**
+         * @brief Mask of enabled input ports (bit N enables port N)
+         */
+        uint8_t EnabledPorts;
+        /**
+         * @brief Priority of each input port (0 - 7, lower value is served first)
+         */
+        uint8_t Priorities[TRACE_FUNNEL_MAX_PORTS];
+        /**
+         * @brief Number of transactions (1 - 16) funnel keeps serving selected port, 0 keeps current value
+         */
+        uint8_t HoldTime;
+    } TraceFunnelOptions;
+
+    /**
+     * @brief Inputs of funnel planner
+     */
+    typedef struct
+    {
+        /**
+         * @brief Expected trace data of source connected to each input port in bytes per second, 0 if port is unused
+         */
+        uint32_t PortRates[TRACE_FUNNEL_MAX_PORTS];
+        /**
+         * @brief Bandwidth of trace port in bytes per second (e.g. TpiuPortWidthSelection#Bandwidth)
+         */
+        uint32_t Bandwidth;
+    } TraceFunnelTargets;
+
+    /**
+     * @brief Result of funnel planner
+     */
+    typedef struct
+    {
+        /**
+         * @brief Estimated traffic on trace port in bytes per second (with TPIU formatter and source ID overhead)
+         */
+        uint32_t Load;
+        /**
+         * @brief Bandwidth left in bytes per second (negative if trace port is overloaded)
+         */
+        int32_t Headroom;
+    } TraceFunnelPlan;
+
+    /**
+     * @brief Returns number of funnel input ports
+     *
+     * Reads `DEVID.PORTCOUNT`, funnels reporting invalid count are assumed to have @ref TRACE_FUNNEL_MAX_PORTS
+     * ports.
+     *
+     * @param base Base address of funnel registers
+     */
+    static inline uint8_t TraceFunnelPortCount(uintptr_t base);
+
+    /**
+     * @brief Configures funnel
+     *
+     * Unlocks funnel registers, programs port priorities, hold time and enables selected ports (other ports are
+     * disabled).
+     *
+     * @param options Funnel configuration
+     * @return true Funnel configured
+     * @return false Enabled port not implemented by funnel (nothing is changed)
+     */
+    static inline bool TraceFunnelSetup(const TraceFunnelOptions* options);
+
+    /**
+     * @brief Disables all funnel input ports
+     *
+     * @param base Base address of funnel registers
+     */
+    static inline void TraceFunnelDisable(uintptr_t base);
+
+    /**
+     * @brief Plans funnel configuration within trace port bandwidth
+     *
+     * Enables ports with non-zero rate, assigns priorities by ascending rate (ties by port number, unused ports get
+     * lowest priority) and selects the shortest hold time for which estimated load fits in trace port. Estimate
+     * assumes TPIU formatter (15 data bytes in 16-byte frame) and, with more than one active source, one source ID
+     * change every HoldTime transactions of @ref TRACE_FUNNEL_ATB_BYTES bytes. TraceFunnelOptions#Base is not
+     * modified.
+     *
+     * @param targets Data rates of sources and trace port bandwidth
+     * @param options Receives enabled ports, priorities and hold time
+     * @param plan Receives bandwidth estimate
+     * @return true Estimated traffic fits in trace port
+     * @return false Trace port overloaded even with longest hold time (hold time is set to 16)
+     */
+    static inline bool TracePlanFunnel(const TraceFunnelTargets* targets, TraceFunnelOptions* options,
+                                       TraceFunnelPlan* plan);
+
+    /** @} */
+
+    // Internal helpers
+
+#define ORBCODE_TRACE_FUNNEL_REG(base, offset) (*(volatile uint32_t*)((uintptr_t)(base) + (offset)))
+#define ORBCODE_TRACE_FUNNEL_CTRL(base) ORBCODE_TRACE_FUNNEL_REG(base, 0x000U)
+#define ORBCODE_TRACE_FUNNEL_PRIORITY(base) ORBCODE_TRACE_FUNNEL_REG(base, 0x004U)
+#define ORBCODE_TRACE_FUNNEL_LAR(base) ORBCODE_TRACE_FUNNEL_REG(base, 0xFB0U)
+#define ORBCODE_TRACE_FUNNEL_DEVID(base) ORBCODE_TRACE_FUNNEL_REG(base, 0xFC8U)
+
+#define ORBCODE_TRACE_FUNNEL_CTRL_HT_Pos 8U
+#define ORBCODE_TRACE_FUNNEL_CTRL_HT_Msk (0xFUL << ORBCODE_TRACE_FUNNEL_CTRL_HT_Pos)
+#define ORBCODE_TRACE_FUNNEL_PRIORITY_BITS 3U
+#define ORBCODE_TRACE_FUNNEL_LOWEST_PRIORITY 7U
+#define ORBCODE_TRACE_FUNNEL_MAX_HOLD_TIME 16U
+
+    uint8_t TraceFunnelPortCount(uintptr_t base)
+    {
+        const uint8_t ports = (uint8_t)(ORBCODE_TRACE_FUNNEL_DEVID(base) & 0xFU);
+        return ports < 2U || ports > TRACE_FUNNEL_MAX_PORTS ? (uint8_t)TRACE_FUNNEL_MAX_PORTS : ports;
+    }
+
+    bool TraceFunnelSetup(const TraceFunnelOptions* options)
+    {
+        const uintptr_t base = options->Base;
+        ORBCODE_TRACE_FUNNEL_LAR(base) = 0xC5ACCE55; // unlock funnel access (magic number)
+
+        const uint8_t ports = TraceFunnelPortCount(base);
+        if(((uint32_t)options->EnabledPorts >> ports) != 0U)
+        {
+            return false;
+        }
+
+        uint32_t priorities = 0;
+        for(uint32_t i = 0; i < TRACE_FUNNEL_MAX_PORTS; i++)
+        {
+            priorities |= ((uint32_t)options->Priorities[i] & ORBCODE_TRACE_FUNNEL_LOWEST_PRIORITY)
+                << (i * ORBCODE_TRACE_FUNNEL_PRIORITY_BITS);
+        }
+
+        uint32_t ctrl = options->EnabledPorts;
+        if(options->HoldTime == 0)
+        {
+            ctrl |= ORBCODE_TRACE_FUNNEL_CTRL(base) & ORBCODE_TRACE_FUNNEL_CTRL_HT_Msk;
+        }
+        else
+        {
+            const uint32_t hold = options->HoldTime > ORBCODE_TRACE_FUNNEL_MAX_HOLD_TIME
+                ? ORBCODE_TRACE_FUNNEL_MAX_HOLD_TIME
+                : options->HoldTime;
+            ctrl |= (hold - 1U) << ORBCODE_TRACE_FUNNEL_CTRL_HT_Pos;
+        }
+
+        // Priorities can be changed only while ports are disabled
+        ORBCODE_TRACE_FUNNEL_CTRL(base) = ORBCODE_TRACE_FUNNEL_CTRL(base) & ORBCODE_TRACE_FUNNEL_CTRL_HT_Msk;
+        ORBCODE_TRACE_FUNNEL_PRIORITY(base) = priorities;
+        ORBCODE_TRACE_FUNNEL_CTRL(base) = ctrl;
+        return true;
+    }
+
+    void TraceFunnelDisable(uintptr_t base)
+    {
+        ORBCODE_TRACE_FUNNEL_LAR(base) = 0xC5ACCE55; // unlock funnel access (magic number)
+        ORBCODE_TRACE_FUNNEL_CTRL(base) = ORBCODE_TRACE_FUNNEL_CTRL(base) & ORBCODE_TRACE_FUNNEL_CTRL_HT_Msk;
+    }
+
+    bool TracePlanFunnel(const TraceFunnelTargets* targets, TraceFunnelOptions* options, TraceFunnelPlan* plan)
+    {
+        uint64_t total = 0;
+        uint32_t active = 0;
+        options->EnabledPorts = 0;
+        for(uint32_t i = 0; i < TRACE_FUNNEL_MAX_PORTS; i++)
+        {
+            const uint32_t rate = targets->PortRates[i];
+            if(rate == 0)
+            {
+                options->Priorities[i] = ORBCODE_TRACE_FUNNEL_LOWEST_PRIORITY;
+                continue;
+            }
+
+            // Rank among active ports, lower rate (then lower port number) is served first
+            uint32_t rank = 0;
+            for(uint32_t j = 0; j < TRACE_FUNNEL_MAX_PORTS; j++)
+            {
+                const uint32_t other = targets->PortRates[j];
+                if(other != 0 && (other < rate || (other == rate && j < i)))
+                {
+                    rank++;
+                }
+            }
+            options->Priorities[i] = (uint8_t)(rank < ORBCODE_TRACE_FUNNEL_LOWEST_PRIORITY
+                                                   ? rank
+                                                   : ORBCODE_TRACE_FUNNEL_LOWEST_PRIORITY);
+            options->EnabledPorts |= (uint8_t)(1U << i);
+            total += rate;
+            active++;
+        }
+
+        const uint64_t formatted = (total * 16U + 14U) / 15U;
+        uint64_t load = formatted;
+        uint32_t hold = 1;
+        for(; hold <= ORBCODE_TRACE_FUNNEL_MAX_HOLD_TIME; hold++)
+        {
+            // Source ID change costs one byte in TPIU frame
+            const uint64_t idChanges = active > 1U ? total / ((uint64_t)hold * TRACE_FUNNEL_ATB_BYTES) : 0U;
+            load = formatted + idChanges;
+            if(load <= targets->Bandwidth || hold == ORBCODE_TRACE_FUNNEL_MAX_HOLD_TIME)
+            {
+                break;
+            }
+        }
+        options->HoldTime = (uint8_t)hold;
+
+        plan->Load = load > 0xFFFFFFFFU ? 0xFFFFFFFFU : (uint32_t)load;
+        const int64_t headroom = (int64_t)targets->Bandwidth - (int64_t)load;
+        plan->Headroom = headroom < INT32_MIN ? INT32_MIN : (int32_t)headroom;
+        return load <= targets->Bandwidth;
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,287 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "itm.h"
+#include "timestamp.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup histogram Latency histograms
+     * @ingroup trace
+     *
+     * @brief Fixed-memory histograms of cycle counts collected on target and sent periodically
+     *
+     * Instead of streaming every sample, samples are counted in buckets on target and whole histograms are sent with
+     * TraceHistogramFlush() from time to time. Host tool `orbcode-trace-histogram` prints percentiles.
+     *
+     * Buckets are logarithmic with linear sub-buckets (similar to HDR histograms): every power-of-two range of values
+     * is divided into `2^subBucketBits` equally wide buckets, so relative bucket width is at most `2^-subBucketBits`.
+     * Values below `2^(subBucketBits + 1)` have their own buckets. Covering whole 32-bit range needs
+     * @ref TRACE_HISTOGRAM_BUCKETS buckets, smaller histograms count larger values in the last bucket.
+     * `subBucketBits` = 0 gives plain log2 buckets.
+     *
+     * TraceHistogramRecord() takes constant time (count leading zeros, shift and atomic increment, no loops over
+     * buckets) and can be called from any context.
+     *
+     * @code{.c}
+     * static uint32_t IrqLatencyBuckets[TRACE_HISTOGRAM_BUCKETS(3)];
+     * static TraceHistogram IrqLatency;
+     *
+     * void Init(void)
+     * {
+     *     TraceHistogramInit(&IrqLatency, 1, 3, IrqLatencyBuckets, TRACE_HISTOGRAM_BUCKETS(3));
+     * }
+     *
+     * void EXTI0_IRQHandler(void)
+     * {
+     *     uint32_t start = DWTCycles();
+     *     HandleEvent();
+     *     TraceHistogramRecordSince(&IrqLatency, start);
+     * }
+     *
+     * void EverySecond(void)
+     * {
+     *     TraceHistogram* const all[] = {&IrqLatency};
+     *     TraceHistogramFlush(7, all, 1, true);
+     * }
+     * @endcode
+     *
+     * Serialized histogram (little-endian words):
+     * | Word     | Content |
+     * |----------|---------|
+     * | 0        | @ref TRACE_HISTOGRAM_MAGIC |
+     * | 1        | bits 0-15: histogram ID, bits 16-23: sub-bucket bits, bits 24-31: format version (1) |
+     * | 2        | bits 0-15: number of buckets, bits 16-31: number N of non-empty buckets |
+     * | 3..2N+2  | pairs of words: bucket index, bucket count |
+     *
+     * @{
+     */
+
+/**
+ * @brief Number of buckets needed to cover whole 32-bit range for given number of sub-bucket bits
+ */
+#define TRACE_HISTOGRAM_BUCKETS(subBucketBits) ((33U - (subBucketBits)) << (subBucketBits))
+
+/**
+ * @brief First word of every serialized histogram
+ */
+#define TRACE_HISTOGRAM_MAGIC 0x54534948UL
+
+/**
+ * @brief Version of serialized histogram format
+ */
+#define TRACE_HISTOGRAM_VERSION 1U
+
+    /**
+     * @brief Histogram
+     *
+     * All fields are managed by TraceHistogram* functions and must not be modified directly.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Bucket counters
+         */
+        volatile uint32_t* Buckets;
+        /**
+         * @brief Number of buckets
+         */
+        uint16_t BucketCount;
+        /**
+         * @brief Histogram ID sent to host
+         */
+        uint16_t Id;
+        /**
+         * @brief Number of linear sub-bucket bits
+         */
+        uint8_t SubBucketBits;
+    } TraceHistogram;
+
+    /**
+     * @brief Initializes histogram and clears all buckets
+     *
+     * @param histogram Histogram
+     * @param id Histogram ID sent to host
+     * @param subBucketBits Number of linear sub-bucket bits (0-8)
+     * @param storage Bucket counters, must outlive @p histogram
+     * @param bucketCount Number of elements in @p storage (1-65535, typically TRACE_HISTOGRAM_BUCKETS(subBucketBits))
+     * @return true Histogram initialized
+     * @return false Invalid parameters
+     */
+    static inline bool TraceHistogramInit(TraceHistogram* histogram, uint16_t id, uint8_t subBucketBits,
+                                          uint32_t* storage, size_t bucketCount);
+
+    /**
+     * @brief Returns bucket index for value
+     *
+     * @param value Value
+     * @param subBucketBits Number of linear sub-bucket bits
+     * @return Bucket index (not limited to number of buckets of any histogram)
+     */
+    static inline uint32_t TraceHistogramBucket(uint32_t value, uint8_t subBucketBits);
+
+    /**
+     * @brief Counts value in histogram
+     *
+     * @param histogram Histogram
+     * @param value Value (e.g. number of cycles)
+     */
+    static inline void TraceHistogramRecord(TraceHistogram* histogram, uint32_t value);
+
+    /**
+     * @brief Counts number of cycles elapsed since @p start
+     *
+     * @param histogram Histogram
+     * @param start Value returned earlier by DWTCycles()
+     */
+    static inline void TraceHistogramRecordSince(TraceHistogram* histogram, uint32_t start);
+
+    /**
+     * @brief Clears all buckets
+     *
+     * Values recorded concurrently with reset are preserved.
+     *
+     * @param histogram Histogram
+     */
+    static inline void TraceHistogramReset(TraceHistogram* histogram);
+
+    /**
+     * @brief Sends histograms to stimulus port
+     *
+     * Waits for stimulus port FIFO like ITMWriteBuffer(). When @ref ITM_STALL_POLICY drops a word, rest of flush is
+     * abandoned. Host decoder discards truncated histogram when magic word of next one arrives. With @p reset, buckets
+     * of abandoned histogram that were already sent are cleared, the rest keep their values for next flush. Does nothing
+     * if stimulus port is disabled.
+     *
+     * @param port Stimulus port
+     * @param histograms Histograms to send
+     * @param count Number of histograms
+     * @param reset Clear every histogram after it has been sent (samples recorded while sending are preserved)
+     */
+    static inline void TraceHistogramFlush(uint8_t port, TraceHistogram* const* histograms, size_t count, bool reset);
+
+    /** @} */
+
+    bool TraceHistogramInit(TraceHistogram* histogram, uint16_t id, uint8_t subBucketBits, uint32_t* storage,
+                            size_t bucketCount)
+    {
+        if(subBucketBits > 8 || bucketCount == 0 || bucketCount > 0xFFFFU)
+        {
+            return false;
+        }
+
+        histogram->Buckets = storage;
+        histogram->BucketCount = (uint16_t)bucketCount;
+        histogram->Id = id;
+        histogram->SubBucketBits = subBucketBits;
+
+        for(size_t i = 0; i < bucketCount; i++)
+        {
+            storage[i] = 0;
+        }
+        return true;
+    }
+
+    uint32_t TraceHistogramBucket(uint32_t value, uint8_t subBucketBits)
+    {
+        // shift = max(msb(value) - subBucketBits, 0) computed without branches
+        int32_t excess = (int32_t)(31U - __CLZ(value | 1U)) - (int32_t)subBucketBits;
+        uint32_t shift = (uint32_t)(excess & ~(excess >> 31));
+        return (shift << subBucketBits) + (value >> shift);
+    }
+
+    void TraceHistogramRecord(TraceHistogram* histogram, uint32_t value)
+    {
+        uint32_t bucket = TraceHistogramBucket(value, histogram->SubBucketBits);
+        uint32_t last = (uint32_t)histogram->BucketCount - 1U;
+        bucket = bucket < last ? bucket : last;
+        TraceAtomicAdd(&histogram->Buckets[bucket], 1);
+    }
+
+    void TraceHistogramRecordSince(TraceHistogram* histogram, uint32_t start)
+    {
+        TraceHistogramRecord(histogram, DWTElapsedCycles(start));
+    }
+
+    void TraceHistogramReset(TraceHistogram* histogram)
+    {
+        for(uint32_t i = 0; i < histogram->BucketCount; i++)
+        {
+            uint32_t value = histogram->Buckets[i];
+            if(value != 0)
+            {
+                TraceAtomicAdd(&histogram->Buckets[i], 0U - value);
+            }
+        }
+    }
+
+    void TraceHistogramFlush(uint8_t port, TraceHistogram* const* histograms, size_t count, bool reset)
+    {
+        if(!ITMIsPortEnabled(port))
+        {
+            return;
+        }
+
+        for(size_t h = 0; h < count; h++)
+        {
+            TraceHistogram* histogram = histograms[h];
+
+            // Snapshot of bucket values is taken while sending, so number of non-empty buckets is counted first and
+            // buckets that become non-empty in the meantime are sent in next flush
+            uint32_t used = 0;
+            for(uint32_t i = 0; i < histogram->BucketCount; i++)
+            {
+                used += histogram->Buckets[i] != 0 ? 1U : 0U;
+            }
+
+            if(!ITMStore32(port, TRACE_HISTOGRAM_MAGIC) ||
+               !ITMStore32(port, (uint32_t)histogram->Id | ((uint32_t)histogram->SubBucketBits << 16) |
+                                     (TRACE_HISTOGRAM_VERSION << 24)) ||
+               !ITMStore32(port, (uint32_t)histogram->BucketCount | (used << 16)))
+            {
+                return;
+            }
+
+            for(uint32_t i = 0; i < histogram->BucketCount && used > 0; i++)
+            {
+                uint32_t value = histogram->Buckets[i];
+                if(value == 0)
+                {
+                    continue;
+                }
+
+                if(!ITMStore32(port, i) || !ITMStore32(port, value))
+                {
+                    return;
+                }
+                used--;
+
+                if(reset)
+                {
+                    TraceAtomicAdd(&histogram->Buckets[i], 0U - value);
+                }
+            }
+
+            // Buckets emptied by concurrent reset are sent as zero to keep announced number of entries
+            for(; used > 0; used--)
+            {
+                if(!ITMStore32(port, 0) || !ITMStore32(port, 0))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,14 +5,63 @@
 #include <stdint.h>
 #include <string.h>
 
-#if !defined(ITM)
-#    error \
-        "ITM not defined. Include itm.h AFTER core_cmX.h (typically after including device-specific header)"
+/**
+ * @brief Stimulus port backend: ITM hardware
+ */
+#define ITM_BACKEND_HARDWARE 0
+
+/**
+ * @brief Stimulus port backend: ring buffer in RAM read by debug probe (see @ref itm_ram)
+ */
+#define ITM_BACKEND_RAM 1
+
+#ifndef ITM_BACKEND
+/**
+ * @brief Backend of stimulus port functions
+ *
+ * @ref ITM_BACKEND_HARDWARE when device header defines `ITM`, @ref ITM_BACKEND_RAM otherwise (ARMv6-M). Can be
+ * overridden by defining it before including this header (e.g. to use RAM backend on core whose trace pins are not
+ * connected). Value must be the same in all translation units.
+ */
+#    if defined(ITM)
+#        define ITM_BACKEND ITM_BACKEND_HARDWARE
+#    else
+#        define ITM_BACKEND ITM_BACKEND_RAM
+#    endif
+#endif
+
+#if ITM_BACKEND == ITM_BACKEND_RAM
+#    include "itm_ram.h"
+#else
+#    if !defined(ITM)
+#        error \
+            "ITM not defined. Include itm.h AFTER core_cmX.h (typically after including device-specific header)"
+#    endif
+
+#    if !defined(CoreDebug)
+#        error \
+            "CoreDebug not defined. Include itm.h AFTER core_cmX.h (typically after including device-specific header)"
+#    endif
+#endif
+
+// ARMv8-M CMSIS headers use upper-case names of ITM_TCR fields (internal helpers)
+#if defined(ITM_TCR_TraceBusID_Pos)
+#    define ORBCODE_TRACE_ITM_TCR_TRACEBUSID_Pos ITM_TCR_TraceBusID_Pos
+#else
+#    define ORBCODE_TRACE_ITM_TCR_TRACEBUSID_Pos ITM_TCR_TRACEBUSID_Pos
+#endif
+
+#if defined(ITM_TCR_TSPrescale_Pos)
+#    define ORBCODE_TRACE_ITM_TCR_TSPRESCALE_Pos ITM_TCR_TSPrescale_Pos
+#else
+#    define ORBCODE_TRACE_ITM_TCR_TSPRESCALE_Pos ITM_TCR_TSPRESCALE_Pos
 #endif
 
-#if !defined(CoreDebug)
-#    error \
-        "CoreDebug not defined. Include itm.h AFTER core_cmX.h (typically after including device-specific header)"
+// Lets compiler use word loads for data known to be aligned (internal helper)
+#if defined(__GNUC__) || defined(__clang__)
+#    define ORBCODE_TRACE_ASSUME_ALIGNED(ptr, alignment) __builtin_assume_aligned((ptr), (alignment))
+#else
+#    define ORBCODE_TRACE_ASSUME_ALIGNED(ptr, alignment) (ptr)
 #endif
 
 #ifdef __cplusplus
@@ -43,6 +92,168 @@ extern "C"
  */
 #define ITM_ENABLE_STIMULUS_PORTS_ALL 0xFFFFFFFF
 
+#ifndef ITM_COMPILED_PORT_MASK
+/**
+ * @brief Stimulus ports compiled into application
+ *
+ * Each bit corresponds to single stimulus port. Writes to ports with bit cleared are removed at compile time (when port
+ * number is a constant) and ITMIsPortEnabled() reports them as disabled without reading ITM registers. Ports left
+ * enabled here can still be enabled and disabled at runtime with ITMSetPortMask() or by debugger.
+ *
+ * Defaults to all ports. Can be overridden by defining it (e.g. `-DITM_COMPILED_PORT_MASK=0x00000003UL`) before
+ * including this header. Value must be integer constant usable in `#if` and the same in all translation units.
+ */
+#    define ITM_COMPILED_PORT_MASK 0xFFFFFFFFUL
+#endif
+
+/**
+ * @brief Checks if stimulus port is enabled in @ref ITM_COMPILED_PORT_MASK
+ *
+ * Constant expression when @p port is constant.
+ */
+#define ITM_IS_PORT_COMPILED(port) ((((uint32_t)(ITM_COMPILED_PORT_MASK) >> ((uint32_t)(port)&31U)) & 1UL) != 0UL)
+
+/**
+ * @brief Calls ITMWrite8() only if port is enabled in @ref ITM_COMPILED_PORT_MASK
+ *
+ * For disabled port nothing is generated and @p value is not evaluated.
+ */
+#define ITM_WRITE8(port, value)             \
+    do                                      \
+    {                                       \
+        if(ITM_IS_PORT_COMPILED(port))      \
+        {                                   \
+            ITMWrite8((port), (value));     \
+        }                                   \
+    } while(0)
+
+/**
+ * @brief Calls ITMWrite16() only if port is enabled in @ref ITM_COMPILED_PORT_MASK
+ *
+ * For disabled port nothing is generated and @p value is not evaluated.
+ */
+#define ITM_WRITE16(port, value)            \
+    do                                      \
+    {                                       \
+        if(ITM_IS_PORT_COMPILED(port))      \
+        {                                   \
+            ITMWrite16((port), (value));    \
+        }                                   \
+    } while(0)
+
+/**
+ * @brief Calls ITMWrite32() only if port is enabled in @ref ITM_COMPILED_PORT_MASK
+ *
+ * For disabled port nothing is generated and @p value is not evaluated.
+ */
+#define ITM_WRITE32(port, value)            \
+    do                                      \
+    {                                       \
+        if(ITM_IS_PORT_COMPILED(port))      \
+        {                                   \
+            ITMWrite32((port), (value));    \
+        }                                   \
+    } while(0)
+
+/**
+ * @brief Calls ITMWriteBuffer() only if port is enabled in @ref ITM_COMPILED_PORT_MASK
+ *
+ * For disabled port nothing is generated and arguments are not evaluated.
+ */
+#define ITM_WRITE_BUFFER(port, buffer, size)            \
+    do                                                  \
+    {                                                   \
+        if(ITM_IS_PORT_COMPILED(port))                  \
+        {                                               \
+            ITMWriteBuffer((port), (buffer), (size));   \
+        }                                               \
+    } while(0)
+
+#ifndef ITM_STATISTICS_ENABLED
+/**
+ * @brief Set to 1 to count writes, waits and dropped writes of every stimulus port
+ *
+ * Counters are stored in `ITMStatisticsData`, which application must define when statistics are enabled:
+ * @code{.c}
+ * ITMStatistics ITMStatisticsData;
+ * @endcode
+ *
+ * When disabled (default) no code is generated for counting, ITMStatisticsRead() returns zeros.
+ *
+ * Can be overridden by defining it before including this header. Value must be the same in all translation units.
+ */
+#    define ITM_STATISTICS_ENABLED 0
+#endif
+
+#ifndef ITM_STATISTICS_WAIT_CYCLES
+/**
+ * @brief Set to 1 to measure waiting for stimulus port FIFO in `DWT_CYCCNT` cycles instead of polling iterations
+ *
+ * Cycle counter must be enabled (DWTOptions#CycleCounter, not available on ARMv6-M). Can be overridden by defining it
+ * before including this header.
+ */
+#    define ITM_STATISTICS_WAIT_CYCLES 0
+#endif
+
+/**
+ * @brief Stall policy: wait for stimulus port FIFO as long as needed
+ */
+#define ITM_STALL_BLOCK 0
+
+/**
+ * @brief Stall policy: wait up to @ref ITM_STALL_SPIN_CYCLES cycles, then drop write
+ */
+#define ITM_STALL_SPIN 1
+
+/**
+ * @brief Stall policy: drop write immediately when stimulus port FIFO is full
+ */
+#define ITM_STALL_DROP 2
+
+#ifndef ITM_STALL_POLICY
+/**
+ * @brief Behavior of blocking writes when stimulus port FIFO is full
+ *
+ * One of @ref ITM_STALL_BLOCK (default, @ref ITM_STALL_DROP with @ref ITM_BACKEND_RAM), @ref ITM_STALL_SPIN or
+ * @ref ITM_STALL_DROP. Applies to ITMWrite8(), ITMWrite16(), ITMWrite32(), ITMWriteBuffer(), ITMPortWrite*(),
+ * `orbcode::trace::Port<N>` and everything built on top of them (e.g. logging), for ports in
+ * @ref ITM_STALL_PORT_MASK. Caps time spent in trace call sites when host is disconnected or trace link is saturated,
+ * at the cost of losing data. Dropped writes are counted as ITMPortStatistics#Busy.
+ *
+ * When packet of ITMWriteBuffer() is dropped, remaining part of buffer is dropped too. Records made of several writes
+ * (framed messages, histogram dumps, benchmark reports) are abandoned at first dropped packet, so host receives only
+ * leading part of record. Host decoders discard it when next record starts (at magic word of histograms and benchmark
+ * reports, at delimiter of framed messages).
+ *
+ * Can be overridden by defining it before including this header. Value must be the same in all translation units.
+ */
+#    if ITM_BACKEND == ITM_BACKEND_RAM
+#        define ITM_STALL_POLICY ITM_STALL_DROP
+#    else
+#        define ITM_STALL_POLICY ITM_STALL_BLOCK
+#    endif
+#endif
+
+#ifndef ITM_STALL_SPIN_CYCLES
+/**
+ * @brief Maximum number of cycles single packet waits for stimulus port FIFO with @ref ITM_STALL_SPIN policy
+ *
+ * Measured with `DWT_CYCCNT`. If cycle counter is not enabled, value is used as number of polling iterations.
+ * Can be overridden by defining it before including this header.
+ */
+#    define ITM_STALL_SPIN_CYCLES 1000UL
+#endif
+
+#ifndef ITM_STALL_PORT_MASK
+/**
+ * @brief Stimulus ports using @ref ITM_STALL_POLICY, remaining ports always block
+ *
+ * Each bit corresponds to single stimulus port. Defaults to all ports. Can be overridden by defining it before
+ * including this header.
+ */
+#    define ITM_STALL_PORT_MASK 0xFFFFFFFFUL
+#endif
+
     /**
      * @brief Global timestamp frequency
      *
@@ -135,19 +346,167 @@ extern "C"
         uint32_t EnabledStimulusPorts;
     } ITMOptions;
 
+    /**
+     * @brief Result of non-blocking write to stimulus port
+     *
+     * Returned by ITMTryWrite8(), ITMTryWrite16() and ITMTryWrite32().
+     */
+    typedef enum
+    {
+        /**
+         * @brief Value was written to stimulus port
+         */
+        ITMWriteStatusWritten = 0,
+        /**
+         * @brief Stimulus port FIFO was full, value was not written
+         */
+        ITMWriteStatusBusy = 1,
+        /**
+         * @brief ITM or stimulus port is disabled (or not available), value was not written
+         */
+        ITMWriteStatusPortDisabled = 2,
+    } ITMWriteStatus;
+
+    /**
+     * @brief Stimulus port handle
+     *
+     * Caches result of ITMIsPortEnabled() so writes through handle do not have to read ITM registers before each write.
+     * Handle must be refreshed with ITMPortRefresh() when configuration of ITM changes (e.g. debugger modifies enabled
+     * stimulus ports). Writing through stale handle of port that has been disabled might wait forever for FIFO on cores
+     * that report disabled port as not ready.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Stimulus port number
+         */
+        uint8_t Port;
+        /**
+         * @brief Cached enable state of stimulus port
+         */
+        bool Enabled;
+    } ITMPortHandle;
+
+    /**
+     * @brief Counters of single stimulus port
+     *
+     * Counters are updated without synchronization, increments done by interrupt preempting another update of the same
+     * port can be lost. Values are good enough for sizing trace link and log volume, not for exact accounting. All
+     * counters wrap around.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Number of write calls that reached stimulus port
+         *
+         * Each ITMWrite8(), ITMWrite16(), ITMWrite32(), ITMTryWrite*() and ITMPortWrite*() call counts as one write,
+         * whole buffer passed to ITMWriteBuffer() (or similar function, including `orbcode::trace::Port<N>` writes and
+         * framed messages) counts as one write too.
+         */
+        uint32_t Writes;
+        /**
+         * @brief Number of bytes written to stimulus port
+         *
+         * Bytes dropped by @ref ITM_STALL_POLICY or full RAM buffer are not counted.
+         */
+        uint32_t Bytes;
+        /**
+         * @brief Number of packets that had to wait for stimulus port FIFO
+         */
+        uint32_t Stalls;
+        /**
+         * @brief Time spent waiting for stimulus port FIFO
+         *
+         * Number of polling iterations, or cycles when @ref ITM_STATISTICS_WAIT_CYCLES is set.
+         */
+        uint32_t Waits;
+        /**
+         * @brief Number of writes rejected because FIFO was full
+         *
+         * Counts non-blocking writes (ITMTryWrite8() and similar) returning @ref ITMWriteStatusBusy and packets dropped
+         * by @ref ITM_STALL_POLICY.
+         */
+        uint32_t Busy;
+        /**
+         * @brief Number of write calls dropped because ITM or stimulus port was disabled
+         */
+        uint32_t Dropped;
+    } ITMPortStatistics;
+
+    /**
+     * @brief Counters of all stimulus ports
+     */
+    typedef struct
+    {
+        /**
+         * @brief Counters indexed by stimulus port number
+         */
+        ITMPortStatistics Ports[32];
+    } ITMStatistics;
+
+#if ITM_STATISTICS_ENABLED
+    /**
+     * @brief Statistics storage, must be defined by application when @ref ITM_STATISTICS_ENABLED is set
+     */
+    extern ITMStatistics ITMStatisticsData;
+#endif
+
     /**
      * @brief Configures ITM as requested.
      *
      * Note that there is no validation if specified configuration is valid (e.g. timestamp prescaler values) and there are no
      * checks to verify MCU capabilities (enabling timestamp when it is not implemented).
      *
+     * Stimulus ports are enabled according to ITMOptions#EnabledStimulusPorts (limited to @ref ITM_COMPILED_PORT_MASK).
+     * To change configuration at runtime without rewriting `ITM_TCR` use ITMEnablePorts(), ITMDisablePorts() and
+     * ITMSetPortMask().
+     *
      * @param options ITM configuration
      */
     static inline void ITMSetup(const ITMOptions* options);
 
+    /**
+     * @brief Enables and disables stimulus ports at runtime
+     *
+     * Ports disabled in @ref ITM_COMPILED_PORT_MASK cannot be enabled. Must be called from privileged code.
+     *
+     * @param mask Each bit corresponds to single stimulus port, set to 1 to enable port
+     */
+    static inline void ITMSetPortMask(uint32_t mask);
+
+    /**
+     * @brief Returns stimulus ports enabled at runtime
+     *
+     * @return Content of `ITM_TER` limited to @ref ITM_COMPILED_PORT_MASK
+     */
+    static inline uint32_t ITMGetPortMask(void);
+
+    /**
+     * @brief Enables stimulus ports leaving other ports unchanged
+     *
+     * Read-modify-write of `ITM_TER`, timestamps, synchronization and DWT forwarding are not affected. Ports disabled
+     * in @ref ITM_COMPILED_PORT_MASK cannot be enabled. Must be called from privileged code and must not race with
+     * other changes of enabled ports.
+     *
+     * @param mask Each bit corresponds to single stimulus port, set to 1 to enable port
+     */
+    static inline void ITMEnablePorts(uint32_t mask);
+
+    /**
+     * @brief Disables stimulus ports leaving other ports unchanged
+     *
+     * Read-modify-write of `ITM_TER`, see ITMEnablePorts(). Writes to disabled ports are ignored, so port can be
+     * silenced around hot section of code without changing code writing to it.
+     *
+     * @param mask Each bit corresponds to single stimulus port, set to 1 to disable port
+     */
+    static inline void ITMDisablePorts(uint32_t mask);
+
     /**
      * @brief Checks if stimulus port is enabled
      *
+     * Ports disabled in @ref ITM_COMPILED_PORT_MASK are always reported as disabled.
+     *
      * @param port Port to check
      * @return true Port is enabled
      * @return false Port is disabled (or not available)
@@ -181,10 +540,13 @@ extern "C"
     /**
      * @brief Writes buffer to stimulus port
      *
-     * Writes buffer to stimulus port using largest packet size possible - starts with 32-bit writes, followed by 16-bit writes and 8-bit write.
+     * Writes buffer to stimulus port using largest packet size possible. Leading 8-bit and/or 16-bit packet is written
+     * if needed to bring remaining data to 4-byte boundary, followed by 32-bit writes (aligned loads of 16-byte blocks,
+     * stopping at first dropped packet) and trailing 16-bit and 8-bit writes for what is left. With
+     * @ref ITM_BACKEND_RAM data is stored in chunks of up to @ref ITM_RAM_CHUNK_SIZE bytes instead.
      *
-     * Data from buffer are memcpy'ied which is subject to compiler optimization and might result in unaligned memory access if compiler 
-     * decides it is valid (e.g. on ARMv7-M platform).
+     * Stimulus port FIFO readiness is checked before every write as architecture does not expose number of free FIFO
+     * entries. When full FIFO makes @ref ITM_STALL_POLICY drop a packet, rest of buffer is dropped too.
      *
      * @param port Port
      * @param buffer Buffer to be written (must not be NULL)
@@ -192,18 +554,251 @@ extern "C"
      */
     static inline void ITMWriteBuffer(uint8_t port, const void* buffer, size_t size);
 
+    /**
+     * @brief Checks if stimulus port FIFO can accept write
+     *
+     * Performs single read of stimulus port register. Does not check if port is enabled.
+     *
+     * @param port Port to check
+     * @return true Stimulus port can accept at least one write
+     * @return false Stimulus port FIFO is full
+     */
+    static inline bool ITMIsPortReady(uint8_t port);
+
+    /**
+     * @brief Waits until stimulus port FIFO can accept write
+     *
+     * Does not check if port is enabled, waiting for disabled port might never finish.
+     *
+     * @param port Port to wait for
+     */
+    static inline void ITMWaitPortReady(uint8_t port);
+
+    /**
+     * @brief Waits until stimulus port FIFO can accept write according to @ref ITM_STALL_POLICY
+     *
+     * Does not check if port is enabled. Same as ITMWaitPortReady() for @ref ITM_STALL_BLOCK policy and for ports not
+     * in @ref ITM_STALL_PORT_MASK.
+     *
+     * @param port Port to wait for
+     * @return true Stimulus port can accept write
+     * @return false Write must be dropped (counted as ITMPortStatistics#Busy)
+     */
+    static inline bool ITMWaitPortReadyPolicy(uint8_t port);
+
+    /**
+     * @brief Writes 8-bit value to stimulus port without waiting
+     *
+     * Checks stimulus port FIFO once and returns immediately if it is full. Intended for code that must not be delayed by
+     * slow trace link (e.g. interrupt handlers with tight timing requirements).
+     *
+     * @param port Port
+     * @param value Value to be written
+     * @return Write status, see @ref ITMWriteStatus
+     */
+    static inline ITMWriteStatus ITMTryWrite8(uint8_t port, uint8_t value);
+
+    /**
+     * @brief Writes 16-bit value to stimulus port without waiting
+     *
+     * See ITMTryWrite8() for details.
+     *
+     * @param port Port
+     * @param value Value to be written
+     * @return Write status, see @ref ITMWriteStatus
+     */
+    static inline ITMWriteStatus ITMTryWrite16(uint8_t port, uint16_t value);
+
+    /**
+     * @brief Writes 32-bit value to stimulus port without waiting
+     *
+     * See ITMTryWrite8() for details.
+     *
+     * @param port Port
+     * @param value Value to be written
+     * @return Write status, see @ref ITMWriteStatus
+     */
+    static inline ITMWriteStatus ITMTryWrite32(uint8_t port, uint32_t value);
+
+    /**
+     * @brief Writes as much of buffer to stimulus port as possible without waiting
+     *
+     * Writes data with 32-bit packets followed by 16-bit and 8-bit packets for remaining bytes, but stops at first write
+     * that would have to wait for stimulus port FIFO. Caller can resume writing remaining part of buffer later.
+     *
+     * @param port Port
+     * @param buffer Buffer to be written (must not be NULL)
+     * @param size Size of buffer to be written
+     * @return Number of bytes written (0 if port is disabled)
+     */
+    static inline size_t ITMTryWriteBuffer(uint8_t port, const void* buffer, size_t size);
+
+    /**
+     * @brief Writes buffer to stimulus port without checking if port is enabled
+     *
+     * Same as ITMWriteBuffer() for callers that already know that port is enabled. Callers writing multi-part records
+     * use returned size to abandon rest of record when @ref ITM_STALL_POLICY dropped part of buffer.
+     *
+     * @param port Port
+     * @param buffer Buffer to be written (must not be NULL)
+     * @param size Size of buffer to be written
+     * @return Number of bytes written, less than @p size when rest of buffer was dropped
+     */
+    static inline size_t ITMWriteBufferUnchecked(uint8_t port, const void* buffer, size_t size);
+
+    /**
+     * @brief Initializes stimulus port handle
+     *
+     * Checks if port is enabled and caches result in handle.
+     *
+     * @param handle Handle to initialize
+     * @param port Stimulus port
+     * @return true Port is enabled
+     * @return false Port is disabled (or not available)
+     */
+    static inline bool ITMPortAcquire(ITMPortHandle* handle, uint8_t port);
+
+    /**
+     * @brief Updates cached enable state of stimulus port
+     *
+     * @param handle Handle
+     * @return true Port is enabled
+     * @return false Port is disabled (or not available)
+     */
+    static inline bool ITMPortRefresh(ITMPortHandle* handle);
+
+    /**
+     * @brief Writes 8-bit value to stimulus port described by handle
+     *
+     * @param handle Port handle
+     * @param value Value to be written
+     */
+    static inline void ITMPortWrite8(const ITMPortHandle* handle, uint8_t value);
+
+    /**
+     * @brief Writes 16-bit value to stimulus port described by handle
+     *
+     * @param handle Port handle
+     * @param value Value to be written
+     */
+    static inline void ITMPortWrite16(const ITMPortHandle* handle, uint16_t value);
+
+    /**
+     * @brief Writes 32-bit value to stimulus port described by handle
+     *
+     * @param handle Port handle
+     * @param value Value to be written
+     */
+    static inline void ITMPortWrite32(const ITMPortHandle* handle, uint32_t value);
+
+    /**
+     * @brief Writes buffer to stimulus port described by handle
+     *
+     * See ITMWriteBuffer() for details.
+     *
+     * @param handle Port handle
+     * @param buffer Buffer to be written (must not be NULL)
+     * @param size Size of buffer to be written
+     */
+    static inline void ITMPortWriteBuffer(const ITMPortHandle* handle, const void* buffer, size_t size);
+
+    /**
+     * @brief Reads counters of stimulus port
+     *
+     * Counters are copied without stopping writers, fields might come from slightly different moments when port is
+     * written concurrently.
+     *
+     * @param port Stimulus port
+     * @param statistics Receives counters (zeros when @ref ITM_STATISTICS_ENABLED is not set)
+     */
+    static inline void ITMStatisticsRead(uint8_t port, ITMPortStatistics* statistics);
+
+    /**
+     * @brief Resets counters of all stimulus ports
+     */
+    static inline void ITMStatisticsReset(void);
+
     /** @} */
 
+    // Internal helpers
+
+#if ITM_STATISTICS_ENABLED
+#    define ORBCODE_TRACE_ITM_STATISTICS(port) (&ITMStatisticsData.Ports[(port)&31U])
+#    define ORBCODE_TRACE_ITM_COUNT_WRITE(port, size)                       \
+        do                                                                  \
+        {                                                                   \
+            ITMPortStatistics* orbcodeStats = ORBCODE_TRACE_ITM_STATISTICS(port); \
+            orbcodeStats->Writes++;                                         \
+            orbcodeStats->Bytes += (uint32_t)(size);                        \
+        } while(0)
+#    define ORBCODE_TRACE_ITM_COUNT(port, counter) (ORBCODE_TRACE_ITM_STATISTICS(port)->counter++)
+#else
+#    define ORBCODE_TRACE_ITM_COUNT_WRITE(port, size) ((void)0)
+#    define ORBCODE_TRACE_ITM_COUNT(port, counter) ((void)0)
+#endif
+
+#if ITM_BACKEND == ITM_BACKEND_RAM
+#    define ORBCODE_TRACE_ITM_STORE8(port, value) ITMRamPutValue((port), (value), 1U)
+#    define ORBCODE_TRACE_ITM_STORE16(port, value) ITMRamPutValue((port), (value), 2U)
+#    define ORBCODE_TRACE_ITM_STORE32(port, value) ITMRamPutValue((port), (value), 4U)
+#    define ORBCODE_TRACE_ITM_PORT_READY(port) ((void)(port), ITMRamIsReady())
+#    define ORBCODE_TRACE_ITM_ENABLED() (ITMRamControl.Size != 0U)
+#    define ORBCODE_TRACE_ITM_TER (ITMRamControl.PortMask)
+#    define ORBCODE_TRACE_ITM_MARK_LOST(port) ((void)(port), ITMRamMarkLost())
+#else
+#    define ORBCODE_TRACE_ITM_STORE8(port, value) (ITM->PORT[(port)].u8 = (value))
+#    define ORBCODE_TRACE_ITM_STORE16(port, value) (ITM->PORT[(port)].u16 = (value))
+#    define ORBCODE_TRACE_ITM_STORE32(port, value) (ITM->PORT[(port)].u32 = (value))
+#    define ORBCODE_TRACE_ITM_PORT_READY(port) (ITM->PORT[(port)].u32 != 0UL)
+#    define ORBCODE_TRACE_ITM_ENABLED() ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0UL)
+#    define ORBCODE_TRACE_ITM_TER (ITM->TER)
+#    define ORBCODE_TRACE_ITM_MARK_LOST(port) ((void)(port))
+#endif
+
+// Cycle counter used by stall policy and statistics, iterations are counted instead on cores without DWT
+#if defined(DWT)
+#    define ORBCODE_TRACE_ITM_CYCLES_RUNNING() ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0UL)
+#    define ORBCODE_TRACE_ITM_CYCCNT() (DWT->CYCCNT)
+#else
+#    define ORBCODE_TRACE_ITM_CYCLES_RUNNING() false
+#    define ORBCODE_TRACE_ITM_CYCCNT() 0UL
+#    if ITM_STATISTICS_WAIT_CYCLES
+#        error "ITM_STATISTICS_WAIT_CYCLES requires DWT cycle counter"
+#    endif
+#endif
+
+#define ORBCODE_TRACE_ITM_STALL_APPLIES(port) \
+    ((((uint32_t)(ITM_STALL_PORT_MASK) >> ((uint32_t)(port)&31U)) & 1UL) != 0UL)
+
+    static inline size_t ITMTryWriteBufferUnchecked(uint8_t port, const void* buffer, size_t size);
+
+    // Writes buffer as packets without updating statistics, returns number of bytes written
+    static inline size_t ITMWriteBufferPackets(uint8_t port, const void* buffer, size_t size);
+
+    // Single packet stored once stall policy allows it, false when packet was dropped
+    static inline bool ITMStore8(uint8_t port, uint8_t value);
+    static inline bool ITMStore16(uint8_t port, uint16_t value);
+    static inline bool ITMStore32(uint8_t port, uint32_t value);
+
+    // Single packet stored only if stimulus port is ready right now, false when it was not stored
+    static inline bool ITMTryStore8(uint8_t port, uint8_t value);
+    static inline bool ITMTryStore16(uint8_t port, uint16_t value);
+    static inline bool ITMTryStore32(uint8_t port, uint32_t value);
+
     void ITMSetup(const ITMOptions* options)
     {
+#if ITM_BACKEND == ITM_BACKEND_RAM
+        // Only stimulus ports have meaning for RAM backend
+        ITMSetPortMask(options->EnabledStimulusPorts);
+#else
         CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable ITM and DWT
         ITM->LAR = 0xC5ACCE55;                          // unlock ITM access (magic number)
 
         uint32_t tcr = 0;
 
-        tcr |= options->TraceBusID << ITM_TCR_TraceBusID_Pos;
+        tcr |= options->TraceBusID << ORBCODE_TRACE_ITM_TCR_TRACEBUSID_Pos;
         tcr |= ((int)options->GlobalTimestampFrequency) << ITM_TCR_GTSFREQ_Pos;
-        tcr |= ((int)options->LocalTimestampPrescaler) << ITM_TCR_TSPrescale_Pos;
+        tcr |= ((int)options->LocalTimestampPrescaler) << ORBCODE_TRACE_ITM_TCR_TSPRESCALE_Pos;
         tcr |= (options->ForwardDWT ? 1 : 0) << ITM_TCR_DWTENA_Pos;
         tcr |= (options->EnableSyncPacket ? 1 : 0) << ITM_TCR_SYNCENA_Pos;
         tcr |= (options->EnableLocalTimestamp ? 1 : 0) << ITM_TCR_TSENA_Pos;
@@ -211,104 +806,575 @@ extern "C"
 
         ITM->TCR = tcr;
 
-        ITM->TER = 0xFFFFFFFF; // Enable all stimulus ports
+        ITMSetPortMask(options->EnabledStimulusPorts);
+#endif
+    }
+
+    void ITMSetPortMask(uint32_t mask)
+    {
+        ORBCODE_TRACE_ITM_TER = mask & (uint32_t)(ITM_COMPILED_PORT_MASK);
+    }
+
+    uint32_t ITMGetPortMask(void)
+    {
+        return ORBCODE_TRACE_ITM_TER & (uint32_t)(ITM_COMPILED_PORT_MASK);
+    }
+
+    void ITMEnablePorts(uint32_t mask)
+    {
+        ORBCODE_TRACE_ITM_TER |= mask & (uint32_t)(ITM_COMPILED_PORT_MASK);
+    }
+
+    void ITMDisablePorts(uint32_t mask)
+    {
+        ORBCODE_TRACE_ITM_TER &= ~mask;
     }
 
     bool ITMIsPortEnabled(uint8_t port)
     {
-        return ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0UL) && /* ITM enabled */
-            ((ITM->TER & (1 << port)) != 0UL);             /* ITM Port enabled */
+#if ITM_COMPILED_PORT_MASK != 0xFFFFFFFFUL
+        if(!ITM_IS_PORT_COMPILED(port))
+        {
+            return false;
+        }
+#endif
+
+        return ORBCODE_TRACE_ITM_ENABLED() &&                      /* ITM enabled */
+            ((ORBCODE_TRACE_ITM_TER & (1UL << port)) != 0UL);    /* ITM Port enabled */
     }
 
     void ITMWrite8(uint8_t port, uint8_t value)
     {
         if(!ITMIsPortEnabled(port))
         {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
             return;
         }
 
-        while(ITM->PORT[port].u32 == 0UL)
+        if(ITMStore8(port, value))
         {
-            __NOP();
+            ORBCODE_TRACE_ITM_COUNT_WRITE(port, 1);
         }
-        ITM->PORT[port].u8 = value;
     }
 
     void ITMWrite16(uint8_t port, uint16_t value)
     {
         if(!ITMIsPortEnabled(port))
         {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
             return;
         }
 
-        while(ITM->PORT[port].u32 == 0UL)
+        if(ITMStore16(port, value))
         {
-            __NOP();
+            ORBCODE_TRACE_ITM_COUNT_WRITE(port, 2);
         }
-        ITM->PORT[port].u16 = value;
     }
 
     void ITMWrite32(uint8_t port, uint32_t value)
     {
         if(!ITMIsPortEnabled(port))
         {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
             return;
         }
 
-        while(ITM->PORT[port].u32 == 0UL)
+        if(ITMStore32(port, value))
         {
-            __NOP();
+            ORBCODE_TRACE_ITM_COUNT_WRITE(port, 4);
         }
-        ITM->PORT[port].u32 = value;
     }
 
     void ITMWriteBuffer(uint8_t port, const void* buffer, size_t size)
     {
         if(!ITMIsPortEnabled(port))
         {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
             return;
         }
 
+        ITMWriteBufferUnchecked(port, buffer, size);
+    }
+
+    size_t ITMWriteBufferUnchecked(uint8_t port, const void* buffer, size_t size)
+    {
+        // Only bytes that reached stimulus port are counted
+        const size_t written = ITMWriteBufferPackets(port, buffer, size);
+        if(written > 0)
+        {
+            ORBCODE_TRACE_ITM_COUNT_WRITE(port, written);
+        }
+        return written;
+    }
+
+    size_t ITMWriteBufferPackets(uint8_t port, const void* buffer, size_t size)
+    {
         const uint8_t* buf8 = (const uint8_t*)buffer;
+        const size_t total = size;
+
+#if ITM_BACKEND == ITM_BACKEND_RAM
+        // Packets stored in chunks, one critical section each
+        while(size > 0)
+        {
+            if(!ITMWaitPortReadyPolicy(port))
+            {
+                break;
+            }
+            const size_t stored = ITMRamPut(port, buf8, size);
+            if(stored == 0)
+            {
+                break;
+            }
+            buf8 += stored;
+            size -= stored;
+        }
+        return total - size;
+#else
+
+        if((((uintptr_t)buf8) & 1) != 0 && size >= 1)
+        {
+            if(!ITMStore8(port, *buf8))
+            {
+                return total - size;
+            }
+            buf8++;
+            size--;
+        }
+
+        if((((uintptr_t)buf8) & 2) != 0 && size >= 2)
+        {
+            uint16_t v;
+            memcpy(&v, ORBCODE_TRACE_ASSUME_ALIGNED(buf8, 2), sizeof(v));
+            if(!ITMStore16(port, v))
+            {
+                return total - size;
+            }
+            buf8 += sizeof(v);
+            size -= sizeof(v);
+        }
+
+        // buf8 is now 4-byte aligned (if anything is left to write)
+        while(size >= 16)
+        {
+            uint32_t v[4];
+            memcpy(v, ORBCODE_TRACE_ASSUME_ALIGNED(buf8, 4), sizeof(v));
+
+            size_t stored = 0;
+            while(stored < 4 && ITMStore32(port, v[stored]))
+            {
+                stored++;
+            }
+            if(stored < 4)
+            {
+                return total - size + stored * sizeof(v[0]);
+            }
+
+            buf8 += sizeof(v);
+            size -= sizeof(v);
+        }
+
         while(size >= 4)
         {
             uint32_t v;
-            memcpy(&v, buf8, sizeof(v));
-            while(ITM->PORT[port].u32 == 0UL)
+            memcpy(&v, ORBCODE_TRACE_ASSUME_ALIGNED(buf8, 4), sizeof(v));
+            if(!ITMStore32(port, v))
             {
-                __NOP();
+                return total - size;
             }
-            ITM->PORT[port].u32 = v;
 
             buf8 += sizeof(v);
             size -= sizeof(v);
         }
 
-        while(size >= 2)
+        if(size >= 2)
         {
             uint16_t v;
-            memcpy(&v, buf8, sizeof(v));
-            memcpy(&v, buf8, sizeof(v));
-            while(ITM->PORT[port].u32 == 0UL)
+            memcpy(&v, ORBCODE_TRACE_ASSUME_ALIGNED(buf8, 2), sizeof(v));
+            if(!ITMStore16(port, v))
             {
-                __NOP();
+                return total - size;
             }
-            ITM->PORT[port].u16 = v;
 
             buf8 += sizeof(v);
             size -= sizeof(v);
         }
 
-        while(size > 0)
+        if(size > 0 && !ITMStore8(port, *buf8))
+        {
+            return total - size;
+        }
+        return total;
+#endif
+    }
+
+    bool ITMIsPortReady(uint8_t port)
+    {
+        return ORBCODE_TRACE_ITM_PORT_READY(port);
+    }
+
+    void ITMWaitPortReady(uint8_t port)
+    {
+#if ITM_STATISTICS_ENABLED
+        if(ORBCODE_TRACE_ITM_PORT_READY(port))
+        {
+            return;
+        }
+
+        ITMPortStatistics* stats = ORBCODE_TRACE_ITM_STATISTICS(port);
+        stats->Stalls++;
+#    if ITM_STATISTICS_WAIT_CYCLES
+        const uint32_t start = ORBCODE_TRACE_ITM_CYCCNT();
+        while(!ORBCODE_TRACE_ITM_PORT_READY(port))
+        {
+            __NOP();
+        }
+        stats->Waits += ORBCODE_TRACE_ITM_CYCCNT() - start;
+#    else
+        uint32_t spins = 0;
+        while(!ORBCODE_TRACE_ITM_PORT_READY(port))
+        {
+            spins++;
+            __NOP();
+        }
+        stats->Waits += spins;
+#    endif
+#else
+        while(!ORBCODE_TRACE_ITM_PORT_READY(port))
         {
-            while(ITM->PORT[port].u32 == 0UL)
+            __NOP();
+        }
+#endif
+    }
+
+    bool ITMWaitPortReadyPolicy(uint8_t port)
+    {
+#if ITM_STALL_POLICY == ITM_STALL_BLOCK
+        ITMWaitPortReady(port);
+        return true;
+#else
+        if(ORBCODE_TRACE_ITM_PORT_READY(port))
+        {
+            return true;
+        }
+
+        if(!ORBCODE_TRACE_ITM_STALL_APPLIES(port))
+        {
+            ITMWaitPortReady(port);
+            return true;
+        }
+
+#    if ITM_STALL_POLICY == ITM_STALL_SPIN
+        ORBCODE_TRACE_ITM_COUNT(port, Stalls);
+        // Without running cycle counter limit is applied to number of polling iterations
+        const bool cycles = ORBCODE_TRACE_ITM_CYCLES_RUNNING();
+        const uint32_t start = ORBCODE_TRACE_ITM_CYCCNT();
+        uint32_t spins = 0;
+        bool ready = false;
+        while(!ready)
+        {
+            const uint32_t elapsed = cycles ? ORBCODE_TRACE_ITM_CYCCNT() - start : spins;
+            if(elapsed >= (uint32_t)(ITM_STALL_SPIN_CYCLES))
             {
-                __NOP();
+                break;
             }
-            ITM->PORT[port].u8 = *(buf8++);
+            spins++;
+            ready = ORBCODE_TRACE_ITM_PORT_READY(port);
+        }
+#        if ITM_STATISTICS_ENABLED
+        ORBCODE_TRACE_ITM_STATISTICS(port)->Waits +=
+            (ITM_STATISTICS_WAIT_CYCLES && cycles) ? ORBCODE_TRACE_ITM_CYCCNT() - start : spins;
+#        endif
+        if(ready)
+        {
+            return true;
+        }
+#    endif
 
-            size--;
+        ORBCODE_TRACE_ITM_COUNT(port, Busy);
+        ORBCODE_TRACE_ITM_MARK_LOST(port);
+        return false;
+#endif
+    }
+
+    bool ITMStore8(uint8_t port, uint8_t value)
+    {
+        if(!ITMWaitPortReadyPolicy(port))
+        {
+            return false;
+        }
+#if ITM_BACKEND == ITM_BACKEND_RAM
+        // Space can be taken by interrupt between readiness check and store
+        return ITMRamPutValue(port, value, 1U);
+#else
+        ORBCODE_TRACE_ITM_STORE8(port, value);
+        return true;
+#endif
+    }
+
+    bool ITMStore16(uint8_t port, uint16_t value)
+    {
+        if(!ITMWaitPortReadyPolicy(port))
+        {
+            return false;
+        }
+#if ITM_BACKEND == ITM_BACKEND_RAM
+        // Space can be taken by interrupt between readiness check and store
+        return ITMRamPutValue(port, value, 2U);
+#else
+        ORBCODE_TRACE_ITM_STORE16(port, value);
+        return true;
+#endif
+    }
+
+    bool ITMStore32(uint8_t port, uint32_t value)
+    {
+        if(!ITMWaitPortReadyPolicy(port))
+        {
+            return false;
         }
+#if ITM_BACKEND == ITM_BACKEND_RAM
+        // Space can be taken by interrupt between readiness check and store
+        return ITMRamPutValue(port, value, 4U);
+#else
+        ORBCODE_TRACE_ITM_STORE32(port, value);
+        return true;
+#endif
+    }
+
+    bool ITMTryStore8(uint8_t port, uint8_t value)
+    {
+        if(!ITMIsPortReady(port))
+        {
+            return false;
+        }
+#if ITM_BACKEND == ITM_BACKEND_RAM
+        // Space can be taken by interrupt between readiness check and store
+        return ITMRamPutValue(port, value, 1U);
+#else
+        ORBCODE_TRACE_ITM_STORE8(port, value);
+        return true;
+#endif
+    }
+
+    bool ITMTryStore16(uint8_t port, uint16_t value)
+    {
+        if(!ITMIsPortReady(port))
+        {
+            return false;
+        }
+#if ITM_BACKEND == ITM_BACKEND_RAM
+        // Space can be taken by interrupt between readiness check and store
+        return ITMRamPutValue(port, value, 2U);
+#else
+        ORBCODE_TRACE_ITM_STORE16(port, value);
+        return true;
+#endif
+    }
+
+    bool ITMTryStore32(uint8_t port, uint32_t value)
+    {
+        if(!ITMIsPortReady(port))
+        {
+            return false;
+        }
+#if ITM_BACKEND == ITM_BACKEND_RAM
+        // Space can be taken by interrupt between readiness check and store
+        return ITMRamPutValue(port, value, 4U);
+#else
+        ORBCODE_TRACE_ITM_STORE32(port, value);
+        return true;
+#endif
+    }
+
+    ITMWriteStatus ITMTryWrite8(uint8_t port, uint8_t value)
+    {
+        if(!ITMIsPortEnabled(port))
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
+            return ITMWriteStatusPortDisabled;
+        }
+
+        if(!ITMTryStore8(port, value))
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Busy);
+            return ITMWriteStatusBusy;
+        }
+        ORBCODE_TRACE_ITM_COUNT_WRITE(port, 1);
+        return ITMWriteStatusWritten;
+    }
+
+    ITMWriteStatus ITMTryWrite16(uint8_t port, uint16_t value)
+    {
+        if(!ITMIsPortEnabled(port))
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
+            return ITMWriteStatusPortDisabled;
+        }
+
+        if(!ITMTryStore16(port, value))
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Busy);
+            return ITMWriteStatusBusy;
+        }
+        ORBCODE_TRACE_ITM_COUNT_WRITE(port, 2);
+        return ITMWriteStatusWritten;
+    }
+
+    ITMWriteStatus ITMTryWrite32(uint8_t port, uint32_t value)
+    {
+        if(!ITMIsPortEnabled(port))
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
+            return ITMWriteStatusPortDisabled;
+        }
+
+        if(!ITMTryStore32(port, value))
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Busy);
+            return ITMWriteStatusBusy;
+        }
+        ORBCODE_TRACE_ITM_COUNT_WRITE(port, 4);
+        return ITMWriteStatusWritten;
+    }
+
+    size_t ITMTryWriteBuffer(uint8_t port, const void* buffer, size_t size)
+    {
+        if(!ITMIsPortEnabled(port))
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Dropped);
+            return 0;
+        }
+
+        const size_t written = ITMTryWriteBufferUnchecked(port, buffer, size);
+        if(written > 0)
+        {
+            ORBCODE_TRACE_ITM_COUNT_WRITE(port, written);
+        }
+        if(written < size)
+        {
+            ORBCODE_TRACE_ITM_COUNT(port, Busy);
+        }
+        return written;
+    }
+
+    size_t ITMTryWriteBufferUnchecked(uint8_t port, const void* buffer, size_t size)
+    {
+        const uint8_t* buf8 = (const uint8_t*)buffer;
+        size_t written = 0;
+        while(size - written >= 4)
+        {
+            uint32_t v;
+            memcpy(&v, buf8 + written, sizeof(v));
+            if(!ITMTryStore32(port, v))
+            {
+                return written;
+            }
+            written += sizeof(v);
+        }
+
+        if(size - written >= 2)
+        {
+            uint16_t v;
+            memcpy(&v, buf8 + written, sizeof(v));
+            if(!ITMTryStore16(port, v))
+            {
+                return written;
+            }
+            written += sizeof(v);
+        }
+
+        if(size - written > 0)
+        {
+            if(!ITMTryStore8(port, buf8[written]))
+            {
+                return written;
+            }
+            written++;
+        }
+
+        return written;
+    }
+
+    bool ITMPortAcquire(ITMPortHandle* handle, uint8_t port)
+    {
+        handle->Port = port;
+        return ITMPortRefresh(handle);
+    }
+
+    bool ITMPortRefresh(ITMPortHandle* handle)
+    {
+        handle->Enabled = ITMIsPortEnabled(handle->Port);
+        return handle->Enabled;
+    }
+
+    void ITMPortWrite8(const ITMPortHandle* handle, uint8_t value)
+    {
+        if(!handle->Enabled)
+        {
+            ORBCODE_TRACE_ITM_COUNT(handle->Port, Dropped);
+            return;
+        }
+
+        if(ITMStore8(handle->Port, value))
+        {
+            ORBCODE_TRACE_ITM_COUNT_WRITE(handle->Port, 1);
+        }
+    }
+
+    void ITMPortWrite16(const ITMPortHandle* handle, uint16_t value)
+    {
+        if(!handle->Enabled)
+        {
+            ORBCODE_TRACE_ITM_COUNT(handle->Port, Dropped);
+            return;
+        }
+
+        if(ITMStore16(handle->Port, value))
+        {
+            ORBCODE_TRACE_ITM_COUNT_WRITE(handle->Port, 2);
+        }
+    }
+
+    void ITMPortWrite32(const ITMPortHandle* handle, uint32_t value)
+    {
+        if(!handle->Enabled)
+        {
+            ORBCODE_TRACE_ITM_COUNT(handle->Port, Dropped);
+            return;
+        }
+
+        if(ITMStore32(handle->Port, value))
+        {
+            ORBCODE_TRACE_ITM_COUNT_WRITE(handle->Port, 4);
+        }
+    }
+
+    void ITMPortWriteBuffer(const ITMPortHandle* handle, const void* buffer, size_t size)
+    {
+        if(!handle->Enabled)
+        {
+            ORBCODE_TRACE_ITM_COUNT(handle->Port, Dropped);
+            return;
+        }
+
+        ITMWriteBufferUnchecked(handle->Port, buffer, size);
+    }
+
+    void ITMStatisticsRead(uint8_t port, ITMPortStatistics* statistics)
+    {
+#if ITM_STATISTICS_ENABLED
+        *statistics = *ORBCODE_TRACE_ITM_STATISTICS(port);
+#else
+        (void)port;
+        memset(statistics, 0, sizeof(*statistics));
+#endif
+    }
+
+    void ITMStatisticsReset(void)
+    {
+#if ITM_STATISTICS_ENABLED
+        memset(&ITMStatisticsData, 0, sizeof(ITMStatisticsData));
+#endif
     }
 
 #ifdef __cplusplus
@@ -0,0 +1,301 @@
+/** @file */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#include "itm.h"
+
+namespace orbcode
+{
+    namespace trace
+    {
+        /**
+         * @defgroup itm_cpp C++ interface
+         * @ingroup itm
+         *
+         * @brief Thin C++ wrappers over ITM functions
+         *
+         * @{
+         */
+
+        /**
+         * @brief Checks if stimulus port is enabled in @ref ITM_COMPILED_PORT_MASK
+         *
+         * @param port Stimulus port number
+         * @return true Port is compiled into application
+         * @return false Writes to port are removed at compile time
+         */
+        constexpr bool isPortCompiled(uint8_t port)
+        {
+            return ((static_cast<uint32_t>(ITM_COMPILED_PORT_MASK) >> (port & 31U)) & 1UL) != 0UL;
+        }
+
+        /**
+         * @brief Stimulus port with cached enable state
+         *
+         * Wraps @ref ITMPortHandle. Enable state is checked once on construction and then only when refresh() is called.
+         *
+         * @code{.cpp}
+         * orbcode::trace::ITMPort log(4);
+         *
+         * void Loop()
+         * {
+         *     log.write32(sample); // No ITM register reads apart from FIFO status
+         * }
+         * @endcode
+         */
+        class ITMPort
+        {
+        public:
+            /**
+             * @brief Acquires stimulus port
+             *
+             * @param port Stimulus port number
+             */
+            explicit ITMPort(uint8_t port)
+            {
+                ITMPortAcquire(&handle_, port);
+            }
+
+            /**
+             * @brief Updates cached enable state, see ITMPortRefresh()
+             *
+             * @return true Port is enabled
+             * @return false Port is disabled (or not available)
+             */
+            bool refresh()
+            {
+                return ITMPortRefresh(&handle_);
+            }
+
+            /**
+             * @brief Returns cached enable state
+             */
+            bool enabled() const
+            {
+                return handle_.Enabled;
+            }
+
+            /**
+             * @brief Returns stimulus port number
+             */
+            uint8_t port() const
+            {
+                return handle_.Port;
+            }
+
+            /**
+             * @brief Returns underlying C handle
+             */
+            const ITMPortHandle* handle() const
+            {
+                return &handle_;
+            }
+
+            /**
+             * @brief Writes 8-bit value, see ITMPortWrite8()
+             */
+            void write8(uint8_t value) const
+            {
+                ITMPortWrite8(&handle_, value);
+            }
+
+            /**
+             * @brief Writes 16-bit value, see ITMPortWrite16()
+             */
+            void write16(uint16_t value) const
+            {
+                ITMPortWrite16(&handle_, value);
+            }
+
+            /**
+             * @brief Writes 32-bit value, see ITMPortWrite32()
+             */
+            void write32(uint32_t value) const
+            {
+                ITMPortWrite32(&handle_, value);
+            }
+
+            /**
+             * @brief Writes buffer, see ITMPortWriteBuffer()
+             */
+            void write(const void* buffer, size_t size) const
+            {
+                ITMPortWriteBuffer(&handle_, buffer, size);
+            }
+
+        private:
+            ITMPortHandle handle_;
+        };
+
+        /**
+         * @brief Stimulus port selected at compile time
+         *
+         * Stimulus port address and enable bit are constants, so every write compiles to the same code as hand-written
+         * register access. Width of each store is selected from size of written value: 1, 2 and 4-byte values use single
+         * 8, 16 or 32-bit store, larger values are split into 32-bit stores followed by 16 and 8-bit tail. Values larger
+         * than @ref UnrollLimit are written with ITMWriteBufferUnchecked().
+         *
+         * Enable state is checked on every write (no caching), use @ref ITMPort when that matters. When port is disabled in
+         * @ref ITM_COMPILED_PORT_MASK all writes compile to nothing.
+         *
+         * @code{.cpp}
+         * struct Sample
+         * {
+         *     uint16_t Channel;
+         *     int32_t Value;
+         * };
+         *
+         * using SamplePort = orbcode::trace::Port<5>;
+         *
+         * void OnSample(const Sample& sample)
+         * {
+         *     SamplePort::write(sample); // two 32-bit stores
+         *     SamplePort::write(uint8_t{0x55}); // single 8-bit store
+         * }
+         * @endcode
+         *
+         * @tparam N Stimulus port number (0-31)
+         */
+        template <uint8_t N>
+        class Port
+        {
+            static_assert(N < 32, "ITM has 32 stimulus ports");
+
+        public:
+            /**
+             * @brief Stimulus port number
+             */
+            static constexpr uint8_t Number = N;
+
+            /**
+             * @brief Bit of port in `ITM_TER` register
+             */
+            static constexpr uint32_t EnableMask = 1UL << N;
+
+            /**
+             * @brief Port is enabled in @ref ITM_COMPILED_PORT_MASK
+             */
+            static constexpr bool Compiled = isPortCompiled(N);
+
+            /**
+             * @brief Values up to this size are written with unrolled sequence of stores
+             */
+            static constexpr size_t UnrollLimit = 32;
+
+            /**
+             * @brief Checks if ITM and stimulus port are enabled, see ITMIsPortEnabled()
+             */
+            static bool enabled()
+            {
+                return Compiled && ORBCODE_TRACE_ITM_ENABLED() && ((ORBCODE_TRACE_ITM_TER & EnableMask) != 0UL);
+            }
+
+            /**
+             * @brief Checks if stimulus port can accept write, see ITMIsPortReady()
+             */
+            static bool ready()
+            {
+                return ORBCODE_TRACE_ITM_PORT_READY(N);
+            }
+
+            /**
+             * @brief Writes value if port is enabled
+             *
+             * @tparam T Trivially copyable type
+             * @param value Value to be written
+             */
+            template <typename T>
+            static void write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written");
+
+                if(!enabled())
+                {
+                    ORBCODE_TRACE_ITM_COUNT(N, Dropped);
+                    return;
+                }
+
+                const size_t written = writeValue(reinterpret_cast<const uint8_t*>(&value),
+                                                  std::integral_constant<bool, (sizeof(T) <= UnrollLimit)>{},
+                                                  std::integral_constant<size_t, sizeof(T)>{});
+                if(written > 0)
+                {
+                    ORBCODE_TRACE_ITM_COUNT_WRITE(N, written);
+                }
+            }
+
+            /**
+             * @brief Writes buffer if port is enabled, see ITMWriteBuffer()
+             */
+            static void write(const void* buffer, size_t size)
+            {
+                if(!enabled())
+                {
+                    ORBCODE_TRACE_ITM_COUNT(N, Dropped);
+                    return;
+                }
+
+                ITMWriteBufferUnchecked(N, buffer, size);
+            }
+
+        private:
+            template <size_t Size>
+            static size_t writeValue(const uint8_t* data, std::false_type, std::integral_constant<size_t, Size>)
+            {
+                return ITMWriteBufferPackets(N, data, Size);
+            }
+
+            template <size_t Size>
+            static size_t writeValue(const uint8_t* data, std::true_type, std::integral_constant<size_t, Size> size)
+            {
+                return unrolled(data, size);
+            }
+
+            // Each overload returns number of bytes stored, stores following dropped one are skipped like in
+            // ITMWriteBuffer()
+            static size_t unrolled(const uint8_t*, std::integral_constant<size_t, 0>)
+            {
+                return 0;
+            }
+
+            static size_t unrolled(const uint8_t* data, std::integral_constant<size_t, 1>)
+            {
+                return ITMStore8(N, data[0]) ? 1 : 0;
+            }
+
+            static size_t unrolled(const uint8_t* data, std::integral_constant<size_t, 2>)
+            {
+                uint16_t value;
+                memcpy(&value, data, sizeof(value));
+                return ITMStore16(N, value) ? 2 : 0;
+            }
+
+            static size_t unrolled(const uint8_t* data, std::integral_constant<size_t, 3>)
+            {
+                if(unrolled(data, std::integral_constant<size_t, 2>{}) == 0)
+                {
+                    return 0;
+                }
+                return 2 + unrolled(data + 2, std::integral_constant<size_t, 1>{});
+            }
+
+            template <size_t Size>
+            static size_t unrolled(const uint8_t* data, std::integral_constant<size_t, Size>)
+            {
+                uint32_t value;
+                memcpy(&value, data, sizeof(value));
+                if(!ITMStore32(N, value))
+                {
+                    return 0;
+                }
+                return 4 + unrolled(data + 4, std::integral_constant<size_t, Size - 4>{});
+            }
+        };
+
+        /** @} */
+    }
+}
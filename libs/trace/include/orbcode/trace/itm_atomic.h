@@ -0,0 +1,187 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "itm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup itm_atomic Atomic messages
+     * @ingroup itm
+     *
+     * @brief Write multi-word messages to stimulus port without interleaving them with writes from other contexts
+     *
+     * Every stimulus port shared between contexts (tasks, interrupts) is represented by @ref ITMAtomicPort object that
+     * all writers must use. While message is written port is claimed (with LDREX/STREX on ARMv7-M and ARMv8-M) and
+     * interrupts with priority @ref ITM_ATOMIC_PRIORITY or lower are masked with BASEPRI, so they are only delayed by
+     * duration of a single message. Interrupts with higher priority are never masked. If such interrupt tries to write
+     * to claimed port its message is dropped (@ref ITMWriteStatusBusy) instead of corrupting message being written.
+     *
+     * With @ref ITM_ATOMIC_PRIORITY set to 0 (default) no interrupts are masked and port claim alone protects messages.
+     *
+     * @code{.c}
+     * static ITMAtomicPort EventPort;
+     *
+     * void Init(void)
+     * {
+     *     ITMAtomicPortInit(&EventPort, 4);
+     * }
+     *
+     * void TIM2_IRQHandler(void)
+     * {
+     *     const uint32_t event[3] = {EVENT_TIMER, TIM2->CNT, TIM2->SR};
+     *     ITMAtomicWrite(&EventPort, event, sizeof(event));
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+#ifndef ITM_ATOMIC_PRIORITY
+/**
+ * @brief Interrupts with this priority (`NVIC_SetPriority` value) or lower are masked while message is written
+ *
+ * Interrupts with numerically lower (more urgent) priority are never masked. 0 disables masking altogether. On cores
+ * without BASEPRI (ARMv6-M, ARMv8-M Baseline) any non-zero value masks all interrupts.
+ *
+ * Can be overridden by defining it before including this header.
+ */
+#    define ITM_ATOMIC_PRIORITY 0
+#endif
+
+    /**
+     * @brief Stimulus port shared by multiple contexts
+     *
+     * All fields are managed by ITMAtomic* functions and must not be modified directly.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Stimulus port
+         */
+        uint8_t Port;
+        /**
+         * @brief Non-zero while message is being written
+         */
+        volatile uint32_t Claimed;
+        /**
+         * @brief Number of messages dropped because port was claimed by preempted context
+         */
+        volatile uint32_t Collisions;
+    } ITMAtomicPort;
+
+    /**
+     * @brief Initializes shared stimulus port
+     *
+     * @param port Shared port state
+     * @param stimulusPort Stimulus port
+     */
+    static inline void ITMAtomicPortInit(ITMAtomicPort* port, uint8_t stimulusPort);
+
+    /**
+     * @brief Starts message
+     *
+     * Claims port and masks interrupts according to @ref ITM_ATOMIC_PRIORITY. When @ref ITMWriteStatusWritten is returned
+     * caller writes message with ITMWrite8(), ITMWrite16(), ITMWrite32() or ITMWriteBufferUnchecked() and then calls
+     * ITMAtomicEnd(). Any other status means nothing has been claimed and ITMAtomicEnd() must not be called.
+     *
+     * @param port Shared port state
+     * @param state Receives interrupt mask state to be passed to ITMAtomicEnd()
+     * @return ITMWriteStatusWritten Port claimed
+     * @return ITMWriteStatusBusy Port is claimed by preempted context, message must be dropped
+     * @return ITMWriteStatusPortDisabled ITM or stimulus port is disabled
+     */
+    static inline ITMWriteStatus ITMAtomicBegin(ITMAtomicPort* port, uint32_t* state);
+
+    /**
+     * @brief Finishes message started with ITMAtomicBegin()
+     *
+     * @param port Shared port state
+     * @param state Value received from ITMAtomicBegin()
+     */
+    static inline void ITMAtomicEnd(ITMAtomicPort* port, uint32_t state);
+
+    /**
+     * @brief Writes whole buffer to shared port as single message
+     *
+     * @param port Shared port state
+     * @param buffer Buffer to be written
+     * @param size Size of buffer
+     * @return Status, see ITMAtomicBegin(), @ref ITMWriteStatusBusy also when @ref ITM_STALL_POLICY dropped part of
+     * message
+     */
+    static inline ITMWriteStatus ITMAtomicWrite(ITMAtomicPort* port, const void* buffer, size_t size);
+
+    /**
+     * @brief Returns number of messages dropped because port was claimed by preempted context
+     *
+     * @param port Shared port state
+     * @return Number of dropped messages
+     */
+    static inline uint32_t ITMAtomicGetCollisions(const ITMAtomicPort* port);
+
+    /** @} */
+
+    void ITMAtomicPortInit(ITMAtomicPort* port, uint8_t stimulusPort)
+    {
+        port->Port = stimulusPort;
+        port->Claimed = 0;
+        port->Collisions = 0;
+    }
+
+    ITMWriteStatus ITMAtomicBegin(ITMAtomicPort* port, uint32_t* state)
+    {
+        if(!ITMIsPortEnabled(port->Port))
+        {
+            return ITMWriteStatusPortDisabled;
+        }
+
+        *state = TraceMaskEnter(ITM_ATOMIC_PRIORITY);
+
+        if(!TraceAtomicCompareExchange(&port->Claimed, 0, 1))
+        {
+            TraceMaskExit(*state);
+            TraceAtomicAdd(&port->Collisions, 1);
+            return ITMWriteStatusBusy;
+        }
+
+        return ITMWriteStatusWritten;
+    }
+
+    void ITMAtomicEnd(ITMAtomicPort* port, uint32_t state)
+    {
+        __COMPILER_BARRIER();
+        port->Claimed = 0;
+        TraceMaskExit(state);
+    }
+
+    ITMWriteStatus ITMAtomicWrite(ITMAtomicPort* port, const void* buffer, size_t size)
+    {
+        uint32_t state;
+        ITMWriteStatus status = ITMAtomicBegin(port, &state);
+        if(status != ITMWriteStatusWritten)
+        {
+            return status;
+        }
+
+        const size_t written = ITMWriteBufferUnchecked(port->Port, buffer, size);
+        ITMAtomicEnd(port, state);
+        return written == size ? ITMWriteStatusWritten : ITMWriteStatusBusy;
+    }
+
+    uint32_t ITMAtomicGetCollisions(const ITMAtomicPort* port)
+    {
+        return port->Collisions;
+    }
+
+#ifdef __cplusplus
+}
+#endif
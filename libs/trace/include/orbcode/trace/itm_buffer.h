@@ -0,0 +1,358 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "atomic.h"
+#include "itm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup itm_buffer Buffered ITM output
+     * @ingroup itm
+     *
+     * @brief Decouple producers of trace data from speed of trace link
+     *
+     * Writing directly to stimulus port stalls the CPU whenever stimulus port FIFO is full. Buffered output replaces
+     * that stall with a copy into RAM ring buffer. Ring buffer content is sent to stimulus port later by calling
+     * ITMBufferDrain() from a context where waiting for trace link is acceptable (idle loop, PendSV, low-priority task).
+     *
+     * Any number of producers (thread mode code and interrupt handlers of any priority) can write to the same buffer
+     * concurrently. Each ITMBufferWrite() call is either stored completely and contiguously or dropped completely, so
+     * messages from different producers are never interleaved. Dropped bytes are counted (see ITMBufferGetDropped()).
+     * Only one context can drain a buffer.
+     *
+     * Producers never wait for each other: a producer interrupted in the middle of writing its message leaves visibility
+     * of newer messages to whichever producer finishes last. This relies on strictly nested preemption of a single core
+     * and is not suitable for sharing a buffer between multiple cores.
+     *
+     * @code{.c}
+     * static uint8_t TraceStorage[1024];
+     * static ITMBuffer TraceBuffer;
+     *
+     * void Init(void)
+     * {
+     *     ITMBufferInit(&TraceBuffer, 1, TraceStorage, sizeof(TraceStorage));
+     * }
+     *
+     * void ADC_IRQHandler(void)
+     * {
+     *     uint16_t sample = ReadADC();
+     *     ITMBufferWrite(&TraceBuffer, &sample, sizeof(sample)); // RAM copy only
+     * }
+     *
+     * void Idle(void)
+     * {
+     *     ITMBufferDrain(&TraceBuffer, ITM_BUFFER_DRAIN_ALL);
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+/**
+ * @brief Drain whole buffer content
+ *
+ * Pass as @p maxSize argument to ITMBufferDrain() to send everything that was committed to buffer at the time of the call.
+ */
+#define ITM_BUFFER_DRAIN_ALL ((size_t)-1)
+
+    /**
+     * @brief Ring buffer state
+     *
+     * All fields are managed by ITMBuffer* functions and must not be modified directly. Positions are free-running byte
+     * counters, wrapped into storage using @ref Mask.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Ring buffer storage
+         */
+        uint8_t* Storage;
+        /**
+         * @brief Storage size minus one (storage size is power of 2)
+         */
+        uint32_t Mask;
+        /**
+         * @brief Stimulus port used by ITMBufferDrain()
+         */
+        uint8_t Port;
+        /**
+         * @brief End of space reserved by producers
+         */
+        volatile uint32_t Head;
+        /**
+         * @brief End of data fully written by producers and available to ITMBufferDrain()
+         */
+        volatile uint32_t Committed;
+        /**
+         * @brief End of data already sent to stimulus port
+         */
+        volatile uint32_t Tail;
+        /**
+         * @brief Number of producers currently between ITMBufferReserve() and ITMBufferCommit()
+         */
+        volatile uint32_t Writers;
+        /**
+         * @brief Number of bytes dropped because buffer was full or ITMBufferDrain() could not send them
+         */
+        volatile uint32_t Dropped;
+    } ITMBuffer;
+
+    /**
+     * @brief Space reserved in ring buffer
+     *
+     * Reserved space may wrap around end of storage, hence it is described by two contiguous regions. @ref Second is
+     * used only when @ref FirstSize is smaller than requested size.
+     */
+    typedef struct
+    {
+        /**
+         * @brief First region of reserved space
+         */
+        uint8_t* First;
+        /**
+         * @brief Size of first region
+         */
+        size_t FirstSize;
+        /**
+         * @brief Second region of reserved space (beginning of storage)
+         */
+        uint8_t* Second;
+        /**
+         * @brief Size of second region
+         */
+        size_t SecondSize;
+    } ITMBufferSpan;
+
+    /**
+     * @brief Initializes ring buffer
+     *
+     * @param buffer Buffer to initialize
+     * @param port Stimulus port that will receive buffered data
+     * @param storage Memory for ring buffer, must outlive @p buffer
+     * @param size Size of @p storage, must be power of 2
+     * @return true Buffer initialized
+     * @return false @p size is not power of 2
+     */
+    static inline bool ITMBufferInit(ITMBuffer* buffer, uint8_t port, void* storage, size_t size);
+
+    /**
+     * @brief Reserves space in ring buffer
+     *
+     * Every successful call must be followed by ITMBufferCommit() once reserved space is filled. Reserved space is not
+     * visible to ITMBufferDrain() until all producers that were writing at the same time have committed. Keep time between
+     * reserve and commit short.
+     *
+     * If there is not enough free space, nothing is reserved and @p size is added to dropped bytes counter.
+     *
+     * @param buffer Buffer
+     * @param size Number of bytes to reserve
+     * @param span Reserved space
+     * @return true Space reserved
+     * @return false Not enough free space (ITMBufferCommit() must not be called)
+     */
+    static inline bool ITMBufferReserve(ITMBuffer* buffer, size_t size, ITMBufferSpan* span);
+
+    /**
+     * @brief Commits space previously reserved with ITMBufferReserve()
+     *
+     * @param buffer Buffer
+     */
+    static inline void ITMBufferCommit(ITMBuffer* buffer);
+
+    /**
+     * @brief Copies data into ring buffer
+     *
+     * Safe to call from any context. Data is stored completely or not at all.
+     *
+     * @param buffer Buffer
+     * @param data Data to be written (must not be NULL)
+     * @param size Size of data
+     * @return true Data stored in buffer
+     * @return false Not enough free space, data dropped
+     */
+    static inline bool ITMBufferWrite(ITMBuffer* buffer, const void* data, size_t size);
+
+    /**
+     * @brief Sends buffered data to stimulus port
+     *
+     * Uses ITMWriteBuffer() so it waits for stimulus port FIFO and data is sent using 32-bit writes whenever possible. Must
+     * be called from single context only (never concurrently for the same buffer).
+     *
+     * Data is removed from buffer even when it is not sent: when stimulus port is disabled or @ref ITM_STALL_POLICY drops
+     * part of it, unsent bytes are counted as dropped (see ITMBufferGetDropped()).
+     *
+     * @param buffer Buffer
+     * @param maxSize Maximum number of bytes to send, use @ref ITM_BUFFER_DRAIN_ALL to send all committed data
+     * @return Number of bytes removed from buffer
+     */
+    static inline size_t ITMBufferDrain(ITMBuffer* buffer, size_t maxSize);
+
+    /**
+     * @brief Returns number of bytes waiting in buffer (including space reserved but not yet committed)
+     *
+     * @param buffer Buffer
+     * @return Number of bytes
+     */
+    static inline size_t ITMBufferGetUsed(const ITMBuffer* buffer);
+
+    /**
+     * @brief Returns number of bytes dropped since buffer initialization
+     *
+     * Counts bytes dropped by producers because buffer was full and bytes ITMBufferDrain() could not send.
+     *
+     * Counter wraps around after 2^32 bytes.
+     *
+     * @param buffer Buffer
+     * @return Number of dropped bytes
+     */
+    static inline uint32_t ITMBufferGetDropped(const ITMBuffer* buffer);
+
+    /** @} */
+
+    bool ITMBufferInit(ITMBuffer* buffer, uint8_t port, void* storage, size_t size)
+    {
+        if(size == 0 || (size & (size - 1)) != 0)
+        {
+            return false;
+        }
+
+        buffer->Storage = (uint8_t*)storage;
+        buffer->Mask = (uint32_t)(size - 1);
+        buffer->Port = port;
+        buffer->Head = 0;
+        buffer->Committed = 0;
+        buffer->Tail = 0;
+        buffer->Writers = 0;
+        buffer->Dropped = 0;
+        return true;
+    }
+
+    bool ITMBufferReserve(ITMBuffer* buffer, size_t size, ITMBufferSpan* span)
+    {
+        TraceAtomicAdd(&buffer->Writers, 1);
+
+        uint32_t head;
+        do
+        {
+            head = buffer->Head;
+            uint32_t available = buffer->Mask + 1 - (head - buffer->Tail);
+            if(size > available)
+            {
+                TraceAtomicAdd(&buffer->Dropped, (uint32_t)size);
+                ITMBufferCommit(buffer);
+                return false;
+            }
+        } while(!TraceAtomicCompareExchange(&buffer->Head, head, head + (uint32_t)size));
+
+        uint32_t offset = head & buffer->Mask;
+        size_t untilEnd = buffer->Mask + 1 - offset;
+        span->First = buffer->Storage + offset;
+        span->FirstSize = size < untilEnd ? size : untilEnd;
+        span->Second = buffer->Storage;
+        span->SecondSize = size - span->FirstSize;
+        return true;
+    }
+
+    void ITMBufferCommit(ITMBuffer* buffer)
+    {
+        if(TraceAtomicAdd(&buffer->Writers, (uint32_t)-1) != 0)
+        {
+            // Preempted producer is still writing, it will publish our data when it commits
+            return;
+        }
+
+        // No producer is in the middle of writing, everything up to Head is complete. Producers that preempt us from now
+        // on publish their own data, so only move Committed forward.
+        for(;;)
+        {
+            uint32_t committed = buffer->Committed;
+            uint32_t head = buffer->Head;
+            if((int32_t)(head - committed) <= 0)
+            {
+                return;
+            }
+
+            if(TraceAtomicCompareExchange(&buffer->Committed, committed, head))
+            {
+                return;
+            }
+        }
+    }
+
+    bool ITMBufferWrite(ITMBuffer* buffer, const void* data, size_t size)
+    {
+        ITMBufferSpan span;
+        if(!ITMBufferReserve(buffer, size, &span))
+        {
+            return false;
+        }
+
+        memcpy(span.First, data, span.FirstSize);
+        memcpy(span.Second, (const uint8_t*)data + span.FirstSize, span.SecondSize);
+
+        ITMBufferCommit(buffer);
+        return true;
+    }
+
+    size_t ITMBufferDrain(ITMBuffer* buffer, size_t maxSize)
+    {
+        uint32_t tail = buffer->Tail;
+        size_t size = buffer->Committed - tail;
+        if(size > maxSize)
+        {
+            size = maxSize;
+        }
+
+        if(size == 0)
+        {
+            return 0;
+        }
+
+        __COMPILER_BARRIER();
+
+        uint32_t offset = tail & buffer->Mask;
+        size_t untilEnd = buffer->Mask + 1 - offset;
+        size_t first = size < untilEnd ? size : untilEnd;
+
+        // Data is removed from buffer either way, bytes that were not sent are counted as dropped
+        size_t sent = 0;
+        if(ITMIsPortEnabled(buffer->Port))
+        {
+            sent = ITMWriteBufferUnchecked(buffer->Port, buffer->Storage + offset, first);
+            if(sent == first && first < size)
+            {
+                sent += ITMWriteBufferUnchecked(buffer->Port, buffer->Storage, size - first);
+            }
+        }
+        if(sent < size)
+        {
+            TraceAtomicAdd(&buffer->Dropped, (uint32_t)(size - sent));
+        }
+
+        __COMPILER_BARRIER();
+        buffer->Tail = tail + (uint32_t)size;
+        return size;
+    }
+
+    size_t ITMBufferGetUsed(const ITMBuffer* buffer)
+    {
+        return buffer->Head - buffer->Tail;
+    }
+
+    uint32_t ITMBufferGetDropped(const ITMBuffer* buffer)
+    {
+        return buffer->Dropped;
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,305 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "itm.h"
+
+#if ITM_BACKEND == ITM_BACKEND_RAM
+#    error "DMA output requires ITM hardware, RAM backend stores data to buffer directly"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup itm_dma DMA output
+     * @ingroup itm
+     *
+     * @brief Send large buffers to stimulus port in background using vendor DMA controller
+     *
+     * Library takes care of ITM side of transfer (port enable check, stimulus port address, bytes that cannot be
+     * transferred as 32-bit words, completion tracking) while DMA controller is programmed by user-provided hook
+     * (@ref ITMDmaHooks) as vendor-specific memory-to-peripheral transfer.
+     *
+     * **Important:** ITM silently ignores writes to stimulus port when its FIFO is full and DMA controllers cannot poll
+     * FIFO status. Transfer must be paced so that words are not written faster than trace link sends them, typically by
+     * triggering DMA requests from a timer running at or below link rate (e.g. \f$\frac{Baudrate}{10 \cdot 4}\f$ words
+     * per second for SWO UART, leaving margin for other ITM traffic).
+     *
+     * @code{.c}
+     * static bool StartDma(void* context, const uint32_t* source, volatile uint32_t* destination, size_t words)
+     * {
+     *     // Program timer-triggered DMA channel: source incrementing, destination fixed, 32-bit transfers
+     *     return VendorDmaStart(source, (uint32_t)destination, words);
+     * }
+     *
+     * static const ITMDmaHooks Hooks = {.Start = StartDma, .Context = NULL};
+     * static ITMDma Dma;
+     *
+     * void VendorDmaCompleteIRQHandler(void)
+     * {
+     *     ITMDmaTransferComplete(&Dma);
+     * }
+     *
+     * void DumpFrame(const uint8_t* frame, size_t size)
+     * {
+     *     ITMDmaInit(&Dma, 5, &Hooks);
+     *     ITMDmaWriteAsync(&Dma, frame, size); // returns immediately, frame must stay valid until transfer completes
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+#ifndef ITM_DMA_MIN_SIZE
+/**
+ * @brief Buffers smaller than this size are written synchronously by CPU instead of starting DMA transfer
+ *
+ * Can be overridden by defining it before including this header.
+ */
+#    define ITM_DMA_MIN_SIZE 32
+#endif
+
+    /**
+     * @brief Result of ITMDmaWriteAsync()
+     */
+    typedef enum
+    {
+        /**
+         * @brief DMA transfer started, completion will be signaled by ITMDmaTransferComplete()
+         */
+        ITMDmaStatusStarted = 0,
+        /**
+         * @brief Buffer was small enough to be written synchronously, nothing is pending
+         */
+        ITMDmaStatusCompleted = 1,
+        /**
+         * @brief Previous transfer is still in progress, nothing was written
+         */
+        ITMDmaStatusBusy = 2,
+        /**
+         * @brief ITM or stimulus port is disabled, nothing was written
+         */
+        ITMDmaStatusPortDisabled = 3,
+        /**
+         * @brief DMA hook refused to start transfer, buffer was written synchronously by CPU instead
+         */
+        ITMDmaStatusFailed = 4,
+    } ITMDmaStatus;
+
+    /**
+     * @brief Vendor-specific DMA operations
+     */
+    typedef struct
+    {
+        /**
+         * @brief Starts memory-to-peripheral transfer
+         *
+         * Transfer must copy @p words 32-bit words from incrementing @p source address to fixed @p destination address
+         * and must be paced to trace link rate (see @ref itm_dma). Once transfer is complete ITMDmaTransferComplete() must
+         * be called (typically from DMA interrupt handler).
+         *
+         * @param context Value of @ref Context
+         * @param source First word to transfer (4-byte aligned)
+         * @param destination Stimulus port register
+         * @param words Number of words (at least 1)
+         * @return true Transfer started
+         * @return false Transfer could not be started
+         */
+        bool (*Start)(void* context, const uint32_t* source, volatile uint32_t* destination, size_t words);
+
+        /**
+         * @brief Optional callback invoked (from ITMDmaTransferComplete() context) when whole buffer has been written
+         *
+         * @param context Value of @ref Context
+         */
+        void (*Completed)(void* context);
+
+        /**
+         * @brief User-defined value passed to hooks
+         */
+        void* Context;
+    } ITMDmaHooks;
+
+    /**
+     * @brief DMA output state
+     *
+     * All fields are managed by ITMDma* functions and must not be modified directly.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Vendor-specific DMA operations
+         */
+        const ITMDmaHooks* Hooks;
+        /**
+         * @brief Stimulus port
+         */
+        uint8_t Port;
+        /**
+         * @brief Non-zero while transfer is in progress, claimed atomically by ITMDmaWriteAsync() and cleared by
+         * ITMDmaTransferComplete() (typically from DMA interrupt)
+         */
+        volatile uint32_t Busy;
+        /**
+         * @brief Bytes following DMA-transferred words, written by CPU on completion
+         */
+        const uint8_t* Tail;
+        /**
+         * @brief Number of bytes in @ref Tail (0-3)
+         */
+        size_t TailSize;
+    } ITMDma;
+
+    /**
+     * @brief Initializes DMA output
+     *
+     * @param dma DMA output state
+     * @param port Stimulus port
+     * @param hooks Vendor-specific DMA operations (must outlive @p dma)
+     */
+    static inline void ITMDmaInit(ITMDma* dma, uint8_t port, const ITMDmaHooks* hooks);
+
+    /**
+     * @brief Starts writing buffer to stimulus port in background
+     *
+     * Leading bytes needed to reach 4-byte alignment are written by CPU immediately, aligned words are transferred by DMA
+     * and remaining 1-3 bytes are written by CPU in ITMDmaTransferComplete(). Buffer must not be modified until transfer
+     * is complete.
+     *
+     * Buffers smaller than @ref ITM_DMA_MIN_SIZE are written synchronously with ITMWriteBuffer(). Can be called from
+     * several contexts, call made while another one is in progress returns @ref ITMDmaStatusBusy.
+     *
+     * @param dma DMA output state
+     * @param buffer Buffer to be written (must not be NULL)
+     * @param size Size of buffer
+     * @return Status, see @ref ITMDmaStatus
+     */
+    static inline ITMDmaStatus ITMDmaWriteAsync(ITMDma* dma, const void* buffer, size_t size);
+
+    /**
+     * @brief Completes transfer
+     *
+     * Must be called when transfer started by @ref ITMDmaHooks::Start is finished. Writes trailing bytes, marks DMA
+     * output as idle and invokes @ref ITMDmaHooks::Completed.
+     *
+     * @param dma DMA output state
+     */
+    static inline void ITMDmaTransferComplete(ITMDma* dma);
+
+    /**
+     * @brief Checks if transfer is in progress
+     *
+     * @param dma DMA output state
+     * @return true Transfer in progress
+     * @return false DMA output is idle
+     */
+    static inline bool ITMDmaIsBusy(const ITMDma* dma);
+
+    /**
+     * @brief Waits until transfer is complete and ITM has sent all data
+     *
+     * Waits for ITMDmaTransferComplete() and then for ITM to stop processing (`ITM_TCR.BUSY` cleared). Must not be called
+     * from context that would block interrupt invoking ITMDmaTransferComplete().
+     *
+     * @param dma DMA output state
+     */
+    static inline void ITMDmaFlush(const ITMDma* dma);
+
+    /** @} */
+
+    void ITMDmaInit(ITMDma* dma, uint8_t port, const ITMDmaHooks* hooks)
+    {
+        dma->Hooks = hooks;
+        dma->Port = port;
+        dma->Busy = 0;
+        dma->Tail = NULL;
+        dma->TailSize = 0;
+    }
+
+    ITMDmaStatus ITMDmaWriteAsync(ITMDma* dma, const void* buffer, size_t size)
+    {
+        // Claimed atomically, caller interrupted between check and claim must not start second transfer
+        if(!TraceAtomicCompareExchange(&dma->Busy, 0, 1))
+        {
+            return ITMDmaStatusBusy;
+        }
+
+        if(!ITMIsPortEnabled(dma->Port))
+        {
+            dma->Busy = 0;
+            return ITMDmaStatusPortDisabled;
+        }
+
+        const uint8_t* buf8 = (const uint8_t*)buffer;
+        size_t head = (size_t)((4U - ((uintptr_t)buf8 & 3U)) & 3U);
+        if(size < ITM_DMA_MIN_SIZE || size < head + 4)
+        {
+            ITMWriteBufferUnchecked(dma->Port, buf8, size);
+            dma->Busy = 0;
+            return ITMDmaStatusCompleted;
+        }
+
+        size_t words = (size - head) / 4;
+
+        dma->Tail = buf8 + head + words * 4;
+        dma->TailSize = size - head - words * 4;
+
+        // Bytes written before DMA starts so they stay in order
+        ITMWriteBufferUnchecked(dma->Port, buf8, head);
+
+        if(!dma->Hooks->Start(dma->Hooks->Context, (const uint32_t*)(const void*)(buf8 + head), &ITM->PORT[dma->Port].u32,
+                              words))
+        {
+            ITMWriteBufferUnchecked(dma->Port, buf8 + head, size - head);
+            dma->Busy = 0;
+            return ITMDmaStatusFailed;
+        }
+
+        return ITMDmaStatusStarted;
+    }
+
+    void ITMDmaTransferComplete(ITMDma* dma)
+    {
+        if(dma->TailSize > 0)
+        {
+            ITMWriteBufferUnchecked(dma->Port, dma->Tail, dma->TailSize);
+        }
+
+        dma->TailSize = 0;
+        __COMPILER_BARRIER();
+        dma->Busy = 0;
+
+        if(dma->Hooks->Completed != NULL)
+        {
+            dma->Hooks->Completed(dma->Hooks->Context);
+        }
+    }
+
+    bool ITMDmaIsBusy(const ITMDma* dma)
+    {
+        return dma->Busy != 0U;
+    }
+
+    void ITMDmaFlush(const ITMDma* dma)
+    {
+        while(dma->Busy)
+        {
+            __NOP();
+        }
+
+        while((ITM->TCR & ITM_TCR_BUSY_Msk) != 0UL)
+        {
+            __NOP();
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,420 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "itm.h"
+#include "itm_atomic.h"
+#include "itm_buffer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup itm_frame Framed messages
+     * @ingroup itm
+     *
+     * @brief Self-synchronizing message boundaries on stimulus port
+     *
+     * Each message is encoded with Consistent Overhead Byte Stuffing (COBS) so that encoded data never contains
+     * @ref ITM_FRAME_DELIMITER byte, and is terminated by delimiter. Receiver that lost data (dropped bytes, ITM
+     * overflow, late attach) discards everything up to next delimiter and decodes following frame correctly.
+     *
+     * When @ref ITM_FRAME_CRC is enabled, CRC-8 of message is appended before encoding so that frames damaged by lost
+     * bytes are detected. Overhead is 2 bytes per message (3 with CRC) plus 1 byte per 254 bytes of message.
+     *
+     * Messages can be written directly to stimulus port (ITMFrameWrite(), message bytes are sent from caller's buffer
+     * without intermediate copy), stored in ring buffer (ITMFrameBufferWrite()) or written as atomic message
+     * (ITMFrameAtomicWrite()). All methods produce the same byte stream. Host-side decoder is available as
+     * `orbcode::decoder::FrameDecoder`.
+     *
+     * Encoding (COBS): message is split at each zero byte into runs of non-zero bytes. Every run is preceded by code
+     * byte equal to run length plus one and zero bytes are dropped. Runs longer than 254 bytes are split, code byte 0xFF
+     * means that run is not followed by zero.
+     *
+     * @code{.c}
+     * const Sample sample = {.Channel = 2, .Value = adc};
+     * ITMFrameWrite(3, &sample, sizeof(sample));
+     * @endcode
+     *
+     * @{
+     */
+
+#ifndef ITM_FRAME_CRC
+/**
+ * @brief Append CRC-8 (polynomial 0x07, initial value 0) of message to each frame
+ *
+ * Set to 0 to disable. Receiver must use the same setting. Should stay enabled when @ref ITM_STALL_POLICY drops data,
+ * only CRC detects abandoned frame whose terminator was dropped too (see ITMFrameWrite()). Can be overridden by defining
+ * it before including this header.
+ */
+#    define ITM_FRAME_CRC 1
+#endif
+
+/**
+ * @brief Byte terminating each frame, never present inside encoded frame
+ */
+#define ITM_FRAME_DELIMITER 0x00U
+
+/**
+ * @brief Maximum length of single COBS run
+ */
+#define ITM_FRAME_MAX_RUN 254U
+
+/**
+ * @brief Worst-case size of encoded frame (including delimiter) for message of @p size bytes
+ *
+ * Use to size buffers passed to ITMFrameEncode(). ITMFrameEncodedSize() gives exact size.
+ */
+#define ITM_FRAME_MAX_ENCODED_SIZE(size) \
+    ((size) + (ITM_FRAME_CRC ? 1U : 0U) + ((size) + (ITM_FRAME_CRC ? 1U : 0U)) / ITM_FRAME_MAX_RUN + 2U)
+
+    /**
+     * @brief Computes CRC-8 (polynomial 0x07, initial value 0, no reflection) used by frames
+     *
+     * @param data Data
+     * @param size Size of data
+     * @return CRC of data
+     */
+    static inline uint8_t ITMFrameCrc8(const void* data, size_t size);
+
+    /**
+     * @brief Computes exact size of encoded frame (including delimiter)
+     *
+     * @param data Message
+     * @param size Size of message
+     * @return Size of frame
+     */
+    static inline size_t ITMFrameEncodedSize(const void* data, size_t size);
+
+    /**
+     * @brief Encodes message into frame
+     *
+     * @param destination Memory for frame, at least ITMFrameEncodedSize() bytes
+     * @param data Message (must not overlap @p destination)
+     * @param size Size of message
+     * @return Size of frame
+     */
+    static inline size_t ITMFrameEncode(void* destination, const void* data, size_t size);
+
+    /**
+     * @brief Writes message as frame to stimulus port
+     *
+     * Waits for stimulus port FIFO according to @ref ITM_STALL_POLICY, same as ITMWriteBuffer(). When policy drops any
+     * byte, rest of frame is not written. Partial frame is instead terminated by run shorter than its code byte claims
+     * and delimiter, so receiver discards it (also without @ref ITM_FRAME_CRC) instead of accepting message with
+     * missing bytes. Terminator is subject to the same policy, if it is dropped too, receiver joins partial frame with
+     * next one and only @ref ITM_FRAME_CRC rejects result. Does nothing if stimulus port is disabled.
+     *
+     * @param port Stimulus port
+     * @param data Message
+     * @param size Size of message
+     * @return true Frame written
+     * @return false Port is disabled or frame was abandoned
+     */
+    static inline bool ITMFrameWrite(uint8_t port, const void* data, size_t size);
+
+    /**
+     * @brief Writes message as frame to stimulus port without checking if port is enabled
+     *
+     * @param port Stimulus port
+     * @param data Message
+     * @param size Size of message
+     * @return true Frame written
+     * @return false Frame was abandoned, see ITMFrameWrite()
+     */
+    static inline bool ITMFrameWriteUnchecked(uint8_t port, const void* data, size_t size);
+
+    /**
+     * @brief Stores message as frame in ring buffer
+     *
+     * Frame is encoded directly into reserved ring buffer space. Frame is stored completely or not at all (see
+     * ITMBufferWrite()).
+     *
+     * @param buffer Ring buffer
+     * @param data Message
+     * @param size Size of message
+     * @return true Frame stored in buffer
+     * @return false Not enough free space, frame dropped
+     */
+    static inline bool ITMFrameBufferWrite(ITMBuffer* buffer, const void* data, size_t size);
+
+    /**
+     * @brief Writes message as frame to shared stimulus port, see ITMAtomicWrite()
+     *
+     * @param port Shared port state
+     * @param data Message
+     * @param size Size of message
+     * @return Status, see ITMAtomicBegin(), @ref ITMWriteStatusBusy also when frame was abandoned (see ITMFrameWrite())
+     */
+    static inline ITMWriteStatus ITMFrameAtomicWrite(ITMAtomicPort* port, const void* data, size_t size);
+
+    /** @} */
+
+    // Internal helpers. Message is followed by CRC byte (when enabled) and encoded as single sequence of `total` bytes.
+
+    static inline uint8_t ITMFrameByte(const uint8_t* data, size_t size, uint8_t crc, size_t index)
+    {
+        return index < size ? data[index] : crc;
+    }
+
+    static inline size_t ITMFrameNextRun(const uint8_t* data, size_t size, uint8_t crc, size_t pos, size_t total)
+    {
+        size_t end = pos;
+        while(end < total && (end - pos) < ITM_FRAME_MAX_RUN && ITMFrameByte(data, size, crc, end) != 0U)
+        {
+            end++;
+        }
+        return end - pos;
+    }
+
+    // Returns position of next run or `total + 1` when frame is complete
+    static inline size_t ITMFrameAdvance(size_t pos, size_t run, size_t total)
+    {
+        pos += run;
+        if(pos == total)
+        {
+            return total + 1;
+        }
+        // Zero byte following run shorter than maximum is implied by code byte
+        return run == ITM_FRAME_MAX_RUN ? pos : pos + 1;
+    }
+
+    static inline uint8_t ITMFrameMessageCrc(const void* data, size_t size)
+    {
+#if ITM_FRAME_CRC
+        return ITMFrameCrc8(data, size);
+#else
+        (void)data;
+        (void)size;
+        return 0;
+#endif
+    }
+
+    static inline void ITMFrameSpanCopy(const ITMBufferSpan* span, size_t offset, const void* data, size_t size)
+    {
+        const uint8_t* data8 = (const uint8_t*)data;
+        if(offset < span->FirstSize)
+        {
+            size_t first = span->FirstSize - offset;
+            if(first > size)
+            {
+                first = size;
+            }
+            memcpy(span->First + offset, data8, first);
+            data8 += first;
+            size -= first;
+            offset += first;
+        }
+        if(size > 0)
+        {
+            memcpy(span->Second + (offset - span->FirstSize), data8, size);
+        }
+    }
+
+    static inline size_t ITMFrameSize(const uint8_t* data, size_t size, uint8_t crc, size_t total)
+    {
+        size_t encoded = 1; // delimiter
+        for(size_t pos = 0; pos <= total;)
+        {
+            size_t run = ITMFrameNextRun(data, size, crc, pos, total);
+            encoded += 1 + run;
+            pos = ITMFrameAdvance(pos, run, total);
+        }
+        return encoded;
+    }
+
+    // Ends abandoned frame with run shorter than its code byte claims, so that receiver rejects it even without CRC
+    static inline void ITMFrameAbort(uint8_t port, bool inRun, size_t* sent)
+    {
+        if(*sent == 0)
+        {
+            return; // Nothing of frame reached stimulus port
+        }
+        // Delimiter alone would end frame at run boundary as valid shorter message
+        if(!inRun)
+        {
+            if(!ITMStore8(port, 0x02U))
+            {
+                return;
+            }
+            (*sent)++;
+        }
+        if(ITMStore8(port, ITM_FRAME_DELIMITER))
+        {
+            (*sent)++;
+        }
+    }
+
+    static inline bool ITMFrameSend(uint8_t port, const uint8_t* data, size_t size, size_t* sent)
+    {
+        const uint8_t crc = ITMFrameMessageCrc(data, size);
+        const size_t total = size + (ITM_FRAME_CRC ? 1U : 0U);
+
+        for(size_t pos = 0; pos <= total;)
+        {
+            size_t run = ITMFrameNextRun(data, size, crc, pos, total);
+
+            if(!ITMStore8(port, (uint8_t)(run + 1)))
+            {
+                ITMFrameAbort(port, false, sent);
+                return false;
+            }
+            (*sent)++;
+
+            // Run bytes are sent straight from message, only CRC byte (if part of run) is sent separately
+            // Empty run after zero CRC byte starts past end of message
+            size_t fromData = pos >= size ? 0 : ((pos + run <= size) ? run : size - pos);
+            const size_t stored = ITMWriteBufferPackets(port, data + pos, fromData);
+            *sent += stored;
+            if(stored != fromData)
+            {
+                ITMFrameAbort(port, true, sent);
+                return false;
+            }
+            if(fromData < run)
+            {
+                if(!ITMStore8(port, crc))
+                {
+                    ITMFrameAbort(port, true, sent);
+                    return false;
+                }
+                (*sent)++;
+            }
+
+            pos = ITMFrameAdvance(pos, run, total);
+        }
+
+        if(!ITMStore8(port, ITM_FRAME_DELIMITER))
+        {
+            ITMFrameAbort(port, false, sent);
+            return false;
+        }
+        (*sent)++;
+        return true;
+    }
+
+    uint8_t ITMFrameCrc8(const void* data, size_t size)
+    {
+        const uint8_t* data8 = (const uint8_t*)data;
+        uint8_t crc = 0;
+        for(size_t i = 0; i < size; i++)
+        {
+            crc ^= data8[i];
+            for(int bit = 0; bit < 8; bit++)
+            {
+                crc = (uint8_t)((crc & 0x80U) != 0U ? ((unsigned)crc << 1) ^ 0x07U : (unsigned)crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    size_t ITMFrameEncodedSize(const void* data, size_t size)
+    {
+        return ITMFrameSize((const uint8_t*)data, size, ITMFrameMessageCrc(data, size),
+                            size + (ITM_FRAME_CRC ? 1U : 0U));
+    }
+
+    size_t ITMFrameEncode(void* destination, const void* data, size_t size)
+    {
+        const uint8_t* data8 = (const uint8_t*)data;
+        uint8_t* out = (uint8_t*)destination;
+        const uint8_t crc = ITMFrameMessageCrc(data, size);
+        const size_t total = size + (ITM_FRAME_CRC ? 1U : 0U);
+
+        for(size_t pos = 0; pos <= total;)
+        {
+            size_t run = ITMFrameNextRun(data8, size, crc, pos, total);
+            *out++ = (uint8_t)(run + 1);
+            for(size_t i = 0; i < run; i++)
+            {
+                *out++ = ITMFrameByte(data8, size, crc, pos + i);
+            }
+            pos = ITMFrameAdvance(pos, run, total);
+        }
+        *out++ = ITM_FRAME_DELIMITER;
+        return (size_t)(out - (uint8_t*)destination);
+    }
+
+    bool ITMFrameWrite(uint8_t port, const void* data, size_t size)
+    {
+        if(!ITMIsPortEnabled(port))
+        {
+            return false;
+        }
+
+        return ITMFrameWriteUnchecked(port, data, size);
+    }
+
+    bool ITMFrameWriteUnchecked(uint8_t port, const void* data, size_t size)
+    {
+        size_t sent = 0;
+        const bool written = ITMFrameSend(port, (const uint8_t*)data, size, &sent);
+        // Whole frame counts as one write, abandoned frame only with bytes that reached stimulus port
+        if(sent > 0)
+        {
+            ORBCODE_TRACE_ITM_COUNT_WRITE(port, sent);
+        }
+        return written;
+    }
+
+    bool ITMFrameBufferWrite(ITMBuffer* buffer, const void* data, size_t size)
+    {
+        const uint8_t* data8 = (const uint8_t*)data;
+        const uint8_t crc = ITMFrameMessageCrc(data, size);
+        const size_t total = size + (ITM_FRAME_CRC ? 1U : 0U);
+
+        ITMBufferSpan span;
+        if(!ITMBufferReserve(buffer, ITMFrameSize(data8, size, crc, total), &span))
+        {
+            return false;
+        }
+
+        size_t offset = 0;
+        for(size_t pos = 0; pos <= total;)
+        {
+            size_t run = ITMFrameNextRun(data8, size, crc, pos, total);
+            const uint8_t code = (uint8_t)(run + 1);
+            ITMFrameSpanCopy(&span, offset++, &code, 1);
+
+            // Empty run after zero CRC byte starts past end of message
+            size_t fromData = pos >= size ? 0 : ((pos + run <= size) ? run : size - pos);
+            ITMFrameSpanCopy(&span, offset, data8 + pos, fromData);
+            offset += fromData;
+            if(fromData < run)
+            {
+                ITMFrameSpanCopy(&span, offset++, &crc, 1);
+            }
+
+            pos = ITMFrameAdvance(pos, run, total);
+        }
+
+        const uint8_t delimiter = ITM_FRAME_DELIMITER;
+        ITMFrameSpanCopy(&span, offset, &delimiter, 1);
+
+        ITMBufferCommit(buffer);
+        return true;
+    }
+
+    ITMWriteStatus ITMFrameAtomicWrite(ITMAtomicPort* port, const void* data, size_t size)
+    {
+        uint32_t state;
+        ITMWriteStatus status = ITMAtomicBegin(port, &state);
+        if(status != ITMWriteStatusWritten)
+        {
+            return status;
+        }
+
+        const bool written = ITMFrameWriteUnchecked(port->Port, data, size);
+        ITMAtomicEnd(port, state);
+        return written ? ITMWriteStatusWritten : ITMWriteStatusBusy;
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,366 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "atomic.h"
+#include "itm.h"
+#include "itm_buffer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup itm_lowpower Low-power buffered output
+     * @ingroup itm
+     *
+     * @brief Batch buffered trace into bursts sent just before sleep, keeping trace clock off in between
+     *
+     * Every write to stimulus port keeps SWO/trace clock running and delays entering sleep until ITM FIFO drains. In
+     * low-power mode producers only copy data into @ref ITMBuffer (ITMBufferWrite() and friends, unchanged). Idle loop
+     * calls ITMLowPowerSleep() instead of `__WFI()`, which sends everything collected while the core was active in
+     * single burst and then sleeps. ITMLowPowerPoll() sends burst early once buffer reaches
+     * ITMLowPowerOptions#Watermark, so long active periods do not overflow buffer.
+     *
+     * ITMLowPowerOptions#ClockGate is called with `true` before each burst and with `false` once ITM finished sending
+     * it (`ITM_TCR.BUSY` cleared), so application can gate trace clock and SWO pin between bursts (vendor-specific,
+     * e.g. trace clock enable in RCC/DBGMCU). Bytes still in TPIU FIFO at that point are sent by the hook before
+     * gating if required (e.g. by polling `TPI_FFSR`). With trace clock gated, writes directly to stimulus ports and
+     * DWT packets (PC sampling, exception trace) cannot be sent, so all trace should go through the buffer.
+     *
+     * Energy cost of trace is bounded by number of bursts (at most one per sleep plus one per watermark) and their size
+     * (at most buffer size), both reported by ITMLowPowerReadStatistics() together with sleep ratio. Sleep time is
+     * measured across `WFI` with timebase ITMLowPowerOptions#Timebase, by default DWT cycle counter (which must be
+     * enabled, see DWTOptions). DWT `SLEEPCNT` (DWTOptions#SleepCounterEvent) is only 8 bits wide and wraps every 256
+     * sleep cycles, which makes it unusable for sleeps longer than that. When core clock stops in deep sleep, cycle
+     * counter stops too - use low-power timer as timebase then.
+     *
+     * @code{.c}
+     * static uint8_t TraceStorage[2048];
+     * static ITMBuffer TraceBuffer;
+     * static ITMLowPower TracePower;
+     *
+     * static void TraceClockGate(bool enabled, void* context)
+     * {
+     *     EnableTraceClock(enabled); // vendor-specific
+     * }
+     *
+     * void Init(void)
+     * {
+     *     ITMBufferInit(&TraceBuffer, 1, TraceStorage, sizeof(TraceStorage));
+     *     ITMLowPowerOptions options = {
+     *         .Buffer = &TraceBuffer,
+     *         .Watermark = sizeof(TraceStorage) * 3 / 4,
+     *         .ClockGate = TraceClockGate,
+     *     };
+     *     ITMLowPowerInit(&TracePower, &options);
+     * }
+     *
+     * void Idle(void)
+     * {
+     *     for(;;)
+     *     {
+     *         ITMLowPowerSleep(&TracePower);
+     *     }
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+    /**
+     * @brief Hook gating trace clock between bursts
+     *
+     * @param enabled true before burst is sent, false after it was sent
+     * @param context ITMLowPowerOptions#Context
+     */
+    typedef void (*ITMLowPowerClockGate)(bool enabled, void* context);
+
+    /**
+     * @brief Timebase used to measure active and sleep time
+     *
+     * @param context ITMLowPowerOptions#Context
+     * @return Free-running 32-bit time in any unit
+     */
+    typedef uint32_t (*ITMLowPowerTimebase)(void* context);
+
+    /**
+     * @brief Low-power output configuration
+     */
+    typedef struct
+    {
+        /**
+         * @brief Buffer collecting trace data, drained only by ITMLowPower* functions
+         */
+        ITMBuffer* Buffer;
+        /**
+         * @brief Number of buffered bytes at which ITMLowPowerPoll() sends burst, 0 sends bursts only before sleep
+         */
+        size_t Watermark;
+        /**
+         * @brief Called around every burst, NULL if trace clock is not gated
+         */
+        ITMLowPowerClockGate ClockGate;
+        /**
+         * @brief Time source, NULL uses DWT cycle counter (`DWT_CYCCNT`)
+         */
+        ITMLowPowerTimebase Timebase;
+        /**
+         * @brief Passed to ITMLowPowerOptions#ClockGate and ITMLowPowerOptions#Timebase
+         */
+        void* Context;
+    } ITMLowPowerOptions;
+
+    /**
+     * @brief Low-power output state
+     *
+     * All fields are managed by ITMLowPower* functions and must not be modified directly.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Configuration
+         */
+        ITMLowPowerOptions Options;
+        /**
+         * @brief Timebase value at end of last sleep (or initialization)
+         */
+        uint32_t LastTime;
+        /**
+         * @brief Time spent outside of ITMLowPowerSleep() `WFI`
+         */
+        uint64_t ActiveTime;
+        /**
+         * @brief Time spent in ITMLowPowerSleep() `WFI`
+         */
+        uint64_t SleepTime;
+        /**
+         * @brief Number of bursts
+         */
+        uint32_t Bursts;
+        /**
+         * @brief Number of bytes sent in bursts
+         */
+        uint64_t BurstBytes;
+        /**
+         * @brief Size of largest burst in bytes
+         */
+        uint32_t LargestBurst;
+    } ITMLowPower;
+
+    /**
+     * @brief Sleep ratio and trace cost reported by ITMLowPowerReadStatistics()
+     */
+    typedef struct
+    {
+        /**
+         * @brief Time spent active (timebase units)
+         */
+        uint64_t ActiveTime;
+        /**
+         * @brief Time spent sleeping in ITMLowPowerSleep() (timebase units)
+         */
+        uint64_t SleepTime;
+        /**
+         * @brief Share of sleep time in total time, in 1/1000 (0 when no time elapsed)
+         */
+        uint16_t SleepPermille;
+        /**
+         * @brief Number of bursts
+         */
+        uint32_t Bursts;
+        /**
+         * @brief Number of bytes sent in bursts
+         */
+        uint64_t BurstBytes;
+        /**
+         * @brief Size of largest burst in bytes
+         */
+        uint32_t LargestBurst;
+        /**
+         * @brief Bytes dropped by buffer because it was full since buffer initialization (see ITMBufferGetDropped())
+         */
+        uint32_t Dropped;
+    } ITMLowPowerStatistics;
+
+    /**
+     * @brief Initializes low-power output and gates trace clock
+     *
+     * @param power State to initialize
+     * @param options Configuration, copied
+     */
+    static inline void ITMLowPowerInit(ITMLowPower* power, const ITMLowPowerOptions* options);
+
+    /**
+     * @brief Returns true when buffered data reached ITMLowPowerOptions#Watermark
+     *
+     * Safe to call from any context, e.g. from producer to wake up context calling ITMLowPowerPoll().
+     *
+     * @param power State
+     */
+    static inline bool ITMLowPowerFlushNeeded(const ITMLowPower* power);
+
+    /**
+     * @brief Sends all buffered data in single burst
+     *
+     * Ungates trace clock, drains buffer, waits until ITM finished sending and gates trace clock again. Does nothing
+     * if buffer is empty. Must be called from the context draining the buffer only.
+     *
+     * @param power State
+     * @return Number of bytes sent
+     */
+    static inline size_t ITMLowPowerFlush(ITMLowPower* power);
+
+    /**
+     * @brief Sends burst if buffered data reached ITMLowPowerOptions#Watermark
+     *
+     * @param power State
+     * @return Number of bytes sent
+     */
+    static inline size_t ITMLowPowerPoll(ITMLowPower* power);
+
+    /**
+     * @brief Sends buffered data and sleeps until next interrupt
+     *
+     * Interrupts are masked (`PRIMASK`) around `WFI`, so time of interrupt that woke the core is counted as active.
+     * Interrupt handler runs before this function returns. Data written by interrupts meanwhile is sent before next
+     * sleep.
+     *
+     * @param power State
+     */
+    static inline void ITMLowPowerSleep(ITMLowPower* power);
+
+    /**
+     * @brief Returns sleep ratio and burst statistics
+     *
+     * Must be called from the same context as ITMLowPowerSleep().
+     *
+     * @param power State
+     * @param statistics Receives statistics since initialization or last reset
+     * @param reset Start new measurement period
+     */
+    static inline void ITMLowPowerReadStatistics(ITMLowPower* power, ITMLowPowerStatistics* statistics, bool reset);
+
+    /** @} */
+
+    // Internal helpers
+
+#if ITM_BACKEND == ITM_BACKEND_HARDWARE
+#    define ORBCODE_TRACE_ITM_LOWPOWER_BUSY() ((ITM->TCR & ITM_TCR_BUSY_Msk) != 0UL)
+#else
+#    define ORBCODE_TRACE_ITM_LOWPOWER_BUSY() false
+#endif
+
+    static inline uint32_t ITMLowPowerNow(const ITMLowPower* power)
+    {
+        if(power->Options.Timebase != NULL)
+        {
+            return power->Options.Timebase(power->Options.Context);
+        }
+#if defined(DWT)
+        return ORBCODE_TRACE_ITM_CYCCNT();
+#else
+        return 0;
+#endif
+    }
+
+    static inline void ITMLowPowerGate(const ITMLowPower* power, bool enabled)
+    {
+        if(power->Options.ClockGate != NULL)
+        {
+            power->Options.ClockGate(enabled, power->Options.Context);
+        }
+    }
+
+    void ITMLowPowerInit(ITMLowPower* power, const ITMLowPowerOptions* options)
+    {
+        power->Options = *options;
+        power->ActiveTime = 0;
+        power->SleepTime = 0;
+        power->Bursts = 0;
+        power->BurstBytes = 0;
+        power->LargestBurst = 0;
+        power->LastTime = ITMLowPowerNow(power);
+        ITMLowPowerGate(power, false);
+    }
+
+    bool ITMLowPowerFlushNeeded(const ITMLowPower* power)
+    {
+        return power->Options.Watermark > 0 && ITMBufferGetUsed(power->Options.Buffer) >= power->Options.Watermark;
+    }
+
+    size_t ITMLowPowerFlush(ITMLowPower* power)
+    {
+        ITMBuffer* buffer = power->Options.Buffer;
+        if(buffer->Committed == buffer->Tail)
+        {
+            return 0;
+        }
+
+        ITMLowPowerGate(power, true);
+        const size_t size = ITMBufferDrain(buffer, ITM_BUFFER_DRAIN_ALL);
+        while(ORBCODE_TRACE_ITM_LOWPOWER_BUSY())
+        {
+        }
+        ITMLowPowerGate(power, false);
+
+        power->Bursts++;
+        power->BurstBytes += size;
+        power->LargestBurst = size > power->LargestBurst ? (uint32_t)size : power->LargestBurst;
+        return size;
+    }
+
+    size_t ITMLowPowerPoll(ITMLowPower* power)
+    {
+        return ITMLowPowerFlushNeeded(power) ? ITMLowPowerFlush(power) : 0U;
+    }
+
+    void ITMLowPowerSleep(ITMLowPower* power)
+    {
+        ITMLowPowerFlush(power);
+
+        // WFI wakes up on pending interrupt even with PRIMASK set, handler runs after time is read
+        uint32_t state = TraceCriticalEnter();
+        const uint32_t start = ITMLowPowerNow(power);
+        __DSB();
+        __WFI();
+        const uint32_t end = ITMLowPowerNow(power);
+
+        power->ActiveTime += (uint32_t)(start - power->LastTime);
+        power->SleepTime += (uint32_t)(end - start);
+        power->LastTime = end;
+        TraceCriticalExit(state);
+    }
+
+    void ITMLowPowerReadStatistics(ITMLowPower* power, ITMLowPowerStatistics* statistics, bool reset)
+    {
+        const uint32_t now = ITMLowPowerNow(power);
+        power->ActiveTime += (uint32_t)(now - power->LastTime);
+        power->LastTime = now;
+
+        statistics->ActiveTime = power->ActiveTime;
+        statistics->SleepTime = power->SleepTime;
+        const uint64_t total = power->ActiveTime + power->SleepTime;
+        statistics->SleepPermille = total == 0 ? 0U : (uint16_t)(power->SleepTime * 1000U / total);
+        statistics->Bursts = power->Bursts;
+        statistics->BurstBytes = power->BurstBytes;
+        statistics->LargestBurst = power->LargestBurst;
+        statistics->Dropped = ITMBufferGetDropped(power->Options.Buffer);
+
+        if(reset)
+        {
+            power->ActiveTime = 0;
+            power->SleepTime = 0;
+            power->Bursts = 0;
+            power->BurstBytes = 0;
+            power->LargestBurst = 0;
+        }
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,328 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "atomic.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup itm_ram RAM backend of stimulus ports
+     * @ingroup trace
+     *
+     * @brief Stimulus port writes stored in RAM ring buffer read by debug probe, for cores without ITM
+     *
+     * ARMv6-M cores (Cortex-M0, M0+, M1) have no ITM. When @ref ITM_BACKEND is @ref ITM_BACKEND_RAM (default when
+     * device header does not define `ITM`), all functions of @ref itm keep their API and everything built on them
+     * (ring buffer, framing, logging, structured events, delta compression) compiles unchanged, but writes are stored
+     * in RAM buffer which debug probe reads in background, similar to SEGGER RTT.
+     *
+     * Every write is stored as ITM stimulus port packet (header byte `port << 3 | size code` followed by 1, 2 or 4
+     * little-endian bytes), so data read from buffer is decoded by the same host tools as SWO output (e.g.
+     * `orbcode-trace-itm --synchronized`). Packets are stored in short critical sections (PRIMASK), ITMWriteBuffer()
+     * stores up to @ref ITM_RAM_CHUNK_SIZE bytes per critical section.
+     *
+     * Buffer behaves like ITM FIFO: ITMIsPortReady() reports whether largest packet fits and
+     * @ref ITM_STALL_POLICY decides what happens when it does not. Policy defaults to @ref ITM_STALL_DROP with this
+     * backend, as nothing drains buffer when probe is not attached. Lost writes are counted in
+     * ITMRamControlBlock#Lost and single ITM overflow packet (`0x70`) is stored before next packet that fits, so host
+     * sees where data is missing.
+     *
+     * Control block has fixed layout (little-endian words) so that probe can find it by scanning RAM for ID (or using
+     * address of `ITMRamControl` symbol from ELF file):
+     * | Offset | Content |
+     * |--------|---------|
+     * | 0      | ID @ref ITM_RAM_ID (16 bytes with terminating zeros), written last by ITMRamInit() |
+     * | 16     | format version (@ref ITM_RAM_VERSION) |
+     * | 20     | buffer address |
+     * | 24     | buffer size N |
+     * | 28     | write offset (0 - N-1), updated by target |
+     * | 32     | read offset (0 - N-1), updated by probe |
+     * | 36     | enabled stimulus ports (like `ITM_TER`), can be changed by probe |
+     * | 40     | number of lost writes |
+     * | 44     | flags (internal) |
+     *
+     * Probe copies bytes from read offset up to write offset (wrapping at N) and then stores write offset as new read
+     * offset. On cores with data cache buffer and control block must be placed in non-cacheable memory.
+     *
+     * @code{.c}
+     * #include "ARMCM0plus.h"
+     * #include "orbcode/trace/itm.h"
+     *
+     * ITMRamControlBlock ITMRamControl;
+     * static uint8_t TraceRam[1024];
+     *
+     * void Init(void)
+     * {
+     *     ITMRamInit(TraceRam, sizeof(TraceRam));
+     *
+     *     ITMOptions options = {.EnabledStimulusPorts = ITM_ENABLE_STIMULUS_PORTS_ALL}; // other options are ignored
+     *     ITMSetup(&options);
+     * }
+     *
+     * void Sample(uint32_t value)
+     * {
+     *     ITMWrite32(1, value); // same code as on cores with ITM
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+/**
+ * @brief Control block ID searched for by probe
+ */
+#define ITM_RAM_ID "ORBCODE ITM RAM"
+
+/**
+ * @brief Version of control block layout
+ */
+#define ITM_RAM_VERSION 1U
+
+/**
+ * @brief Bytes needed for largest packet and pending overflow packet, ITMIsPortReady() threshold
+ */
+#define ITM_RAM_PACKET_RESERVE 6U
+
+#ifndef ITM_RAM_CHUNK_SIZE
+/**
+ * @brief Maximum number of data bytes stored by ITMWriteBuffer() in single critical section
+ *
+ * Limits time with interrupts disabled to copying this many bytes. Can be overridden by defining it before including
+ * this header.
+ */
+#    define ITM_RAM_CHUNK_SIZE 64U
+#endif
+
+    /**
+     * @brief Control block of RAM backend
+     *
+     * Fields are managed by ITMRam* functions and stimulus port functions, except ITMRamControlBlock#Read and
+     * ITMRamControlBlock#PortMask which are written by probe too.
+     */
+    typedef struct
+    {
+        /**
+         * @brief @ref ITM_RAM_ID when block is initialized
+         */
+        char Id[16];
+        /**
+         * @brief Layout version (@ref ITM_RAM_VERSION)
+         */
+        uint32_t Version;
+        /**
+         * @brief Ring buffer
+         */
+        uint8_t* Buffer;
+        /**
+         * @brief Size of ring buffer in bytes
+         */
+        uint32_t Size;
+        /**
+         * @brief Offset where target stores next byte
+         */
+        volatile uint32_t Write;
+        /**
+         * @brief Offset of next byte to be read by probe
+         */
+        volatile uint32_t Read;
+        /**
+         * @brief Enabled stimulus ports, same meaning as `ITM_TER`
+         */
+        volatile uint32_t PortMask;
+        /**
+         * @brief Number of writes lost because buffer was full (wraps around)
+         */
+        volatile uint32_t Lost;
+        /**
+         * @brief Internal flags
+         */
+        volatile uint32_t Flags;
+    } ITMRamControlBlock;
+
+    /**
+     * @brief Control block, must be defined by application when RAM backend is used
+     */
+    extern ITMRamControlBlock ITMRamControl;
+
+    /**
+     * @brief Initializes control block with empty buffer
+     *
+     * All stimulus ports are left disabled, enable them with ITMSetup() or ITMSetPortMask() (or from probe).
+     *
+     * @param buffer Ring buffer, must outlive control block
+     * @param size Size of buffer (at least 8 bytes), one byte is always left unused
+     */
+    static inline void ITMRamInit(void* buffer, size_t size);
+
+    /**
+     * @brief Returns number of bytes that can be stored before buffer is full
+     */
+    static inline size_t ITMRamGetFree(void);
+
+    /**
+     * @brief Checks if buffer has space for @p size bytes written to stimulus port
+     *
+     * Data is stored as packets of up to 4 bytes, each preceded by packet header. Result is valid until another write
+     * takes the space (e.g. from interrupt).
+     *
+     * @param size Number of data bytes
+     * @return true All bytes fit into buffer
+     * @return false Some bytes would be lost
+     */
+    static inline bool ITMRamFits(size_t size);
+
+    /**
+     * @brief Returns number of writes lost because buffer was full
+     */
+    static inline uint32_t ITMRamGetLost(void);
+
+    /** @} */
+
+    // Internal helpers
+
+#define ORBCODE_TRACE_ITM_RAM_OVERFLOW 0x70U
+#define ORBCODE_TRACE_ITM_RAM_FLAG_OVERFLOW 1UL
+
+    // Free bytes for given offsets, probe may update read offset at any time so it is read once by caller
+    static inline size_t ITMRamFreeBytes(uint32_t write, uint32_t read)
+    {
+        const uint32_t used = write >= read ? write - read : ITMRamControl.Size - read + write;
+        return (size_t)(ITMRamControl.Size - 1U - used);
+    }
+
+    static inline uint32_t ITMRamStoreByte(uint32_t write, uint8_t value)
+    {
+        ITMRamControl.Buffer[write] = value;
+        write++;
+        return write == ITMRamControl.Size ? 0U : write;
+    }
+
+    // Must be called in critical section
+    static inline void ITMRamMarkLostLocked(void)
+    {
+        ITMRamControl.Lost++;
+        ITMRamControl.Flags |= ORBCODE_TRACE_ITM_RAM_FLAG_OVERFLOW;
+    }
+
+    static inline void ITMRamMarkLost(void)
+    {
+        const uint32_t state = TraceCriticalEnter();
+        ITMRamMarkLostLocked();
+        TraceCriticalExit(state);
+    }
+
+    static inline bool ITMRamIsReady(void)
+    {
+        return ITMRamGetFree() >= ITM_RAM_PACKET_RESERVE;
+    }
+
+    // Stores as many packets of data as fit, returns number of data bytes stored (0 when nothing fit)
+    static inline size_t ITMRamPut(uint8_t port, const uint8_t* data, size_t size)
+    {
+        size = size > ITM_RAM_CHUNK_SIZE ? ITM_RAM_CHUNK_SIZE : size;
+        const uint32_t state = TraceCriticalEnter();
+
+        uint32_t write = ITMRamControl.Write;
+        size_t available = ITMRamControl.Size == 0U ? 0U : ITMRamFreeBytes(write, ITMRamControl.Read);
+        const bool overflow = (ITMRamControl.Flags & ORBCODE_TRACE_ITM_RAM_FLAG_OVERFLOW) != 0UL;
+        if(overflow)
+        {
+            available = available > 0U ? available - 1U : 0U;
+        }
+
+        size_t stored = 0;
+        while(stored < size)
+        {
+            const size_t left = size - stored;
+            const size_t packet = left >= 4U ? 4U : (left >= 2U ? 2U : 1U);
+            if(available < packet + 1U)
+            {
+                break;
+            }
+
+            if(stored == 0 && overflow)
+            {
+                write = ITMRamStoreByte(write, ORBCODE_TRACE_ITM_RAM_OVERFLOW);
+                ITMRamControl.Flags &= ~ORBCODE_TRACE_ITM_RAM_FLAG_OVERFLOW;
+            }
+
+            write = ITMRamStoreByte(write, (uint8_t)(((uint32_t)port << 3) | (packet == 4U ? 3U : packet)));
+            for(size_t i = 0; i < packet; i++)
+            {
+                write = ITMRamStoreByte(write, data[stored + i]);
+            }
+            available -= packet + 1U;
+            stored += packet;
+        }
+
+        if(stored == 0 && size > 0)
+        {
+            ITMRamMarkLostLocked();
+        }
+        else
+        {
+            // Data must be visible to probe before write offset
+            __DMB();
+            ITMRamControl.Write = write;
+        }
+
+        TraceCriticalExit(state);
+        return stored;
+    }
+
+    static inline bool ITMRamPutValue(uint8_t port, uint32_t value, size_t size)
+    {
+        const uint8_t bytes[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16),
+                                  (uint8_t)(value >> 24)};
+        return ITMRamPut(port, bytes, size) == size;
+    }
+
+    void ITMRamInit(void* buffer, size_t size)
+    {
+        ITMRamControl.Id[0] = 0;
+        __DMB();
+
+        ITMRamControl.Version = ITM_RAM_VERSION;
+        ITMRamControl.Buffer = (uint8_t*)buffer;
+        ITMRamControl.Size = (uint32_t)size;
+        ITMRamControl.Write = 0;
+        ITMRamControl.Read = 0;
+        ITMRamControl.PortMask = 0;
+        ITMRamControl.Lost = 0;
+        ITMRamControl.Flags = 0;
+
+        // ID last, probe must not find half-initialized block
+        __DMB();
+        memcpy(ITMRamControl.Id, ITM_RAM_ID, sizeof(ITM_RAM_ID));
+        __DMB();
+    }
+
+    size_t ITMRamGetFree(void)
+    {
+        return ITMRamControl.Size == 0U ? 0U : ITMRamFreeBytes(ITMRamControl.Write, ITMRamControl.Read);
+    }
+
+    bool ITMRamFits(size_t size)
+    {
+        const size_t packets = size / 4U + ((size & 2U) != 0U ? 1U : 0U) + ((size & 1U) != 0U ? 1U : 0U);
+        // Pending overflow packet takes one more byte
+        const size_t overflow = (ITMRamControl.Flags & ORBCODE_TRACE_ITM_RAM_FLAG_OVERFLOW) != 0UL ? 1U : 0U;
+        return ITMRamGetFree() >= size + packets + overflow;
+    }
+
+    uint32_t ITMRamGetLost(void)
+    {
+        return ITMRamControl.Lost;
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,248 @@
+/** @file */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "itm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup log Deferred-formatting logging
+     * @ingroup trace
+     *
+     * @brief printf-like logging that sends only format string ID and raw arguments over ITM
+     *
+     * Format strings passed to @ref TRACE_LOG are placed in dedicated linker section (@ref ORBCODE_TRACE_LOG_SECTION)
+     * which does not need to be loaded into MCU memory. Only a header word identifying format string followed by argument
+     * words is sent to stimulus port and text is rebuilt on host from ELF file (see `orbcode-trace-log` tool).
+     *
+     * Message layout (all words little-endian, written with single ITMWriteBuffer() call):
+     * | Word | Content |
+     * |------|---------|
+     * | 0    | bits 0-27: format string address (masked with @ref TRACE_LOG_ID_MASK), bits 28-31: number of arguments |
+     * | 1..N | arguments, each converted to `uint32_t` |
+     *
+     * Arguments are converted to `uint32_t`, so only integer, character and pointer arguments of up to 32 bits are
+     * supported. Use TraceLogFloat() to pass `float` values (formatted with `%f`, `%e` or `%g` on host). `%s` works for
+     * strings stored in ELF file (e.g. string literals), host tool reads them from ELF.
+     *
+     * Linker script should place format strings in non-loaded section starting at address 0, e.g. for GNU ld:
+     *
+     * @code
+     * SECTIONS
+     * {
+     *     .orbcode_trace_fmt 0 (INFO) :
+     *     {
+     *         KEEP(*(.orbcode_trace_fmt))
+     *     }
+     * }
+     * @endcode
+     *
+     * Without this rule linker places format strings in flash as regular read-only data which works as long as their
+     * addresses are unique within @ref TRACE_LOG_ID_MASK.
+     *
+     * @code{.c}
+     * TRACE_LOG(1, "ADC channel %u: %d mV", channel, millivolts);
+     * TRACE_LOG(1, "Temperature %.1f", TraceLogFloat(temperature));
+     * @endcode
+     *
+     * @{
+     */
+
+#ifndef ORBCODE_TRACE_LOG_SECTION
+/**
+ * @brief Name of linker section holding format strings
+ *
+ * Can be overridden by defining it before including this header.
+ */
+#    define ORBCODE_TRACE_LOG_SECTION ".orbcode_trace_fmt"
+#endif
+
+#ifndef ORBCODE_TRACE_LOG_WRITE
+/**
+ * @brief Function used to send encoded message
+ *
+ * Called as `ORBCODE_TRACE_LOG_WRITE(port, data, size)`. Defaults to ITMWriteBuffer(). Can be overridden by defining it
+ * before including this header to route messages through different output (e.g. buffered output, ITMFrameWrite()
+ * for framed output decoded with `orbcode-trace-log --framed`, or TraceFlightRecorderWrite() keeping messages in RAM).
+ */
+#    define ORBCODE_TRACE_LOG_WRITE(port, data, size) ITMWriteBuffer((port), (data), (size))
+#endif
+
+/**
+ * @brief Mask applied to format string address to produce message ID
+ */
+#define TRACE_LOG_ID_MASK 0x0FFFFFFFUL
+
+/**
+ * @brief Position of argument count in message header
+ */
+#define TRACE_LOG_ARGC_POS 28U
+
+/**
+ * @brief Maximum number of arguments accepted by @ref TRACE_LOG
+ */
+#define TRACE_LOG_MAX_ARGS 8
+
+// Internal helpers: pick format string and convert each following argument to uint32_t. Format string is part of
+// variadic arguments so that calls without arguments are valid in standard C and C++.
+#define ORBCODE_TRACE_LOG_FORMAT(...) ORBCODE_TRACE_LOG_FORMAT_(__VA_ARGS__, 0)
+#define ORBCODE_TRACE_LOG_FORMAT_(format, ...) format
+#define ORBCODE_TRACE_LOG_NARGS(...) ORBCODE_TRACE_LOG_NARGS_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0, 0)
+#define ORBCODE_TRACE_LOG_NARGS_(format, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define ORBCODE_TRACE_LOG_CONCAT(a, b) ORBCODE_TRACE_LOG_CONCAT_(a, b)
+#define ORBCODE_TRACE_LOG_CONCAT_(a, b) a##b
+#define ORBCODE_TRACE_LOG_ARGS(...) \
+    ORBCODE_TRACE_LOG_CONCAT(ORBCODE_TRACE_LOG_ARGS_, ORBCODE_TRACE_LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define ORBCODE_TRACE_LOG_ARGS_0(f)
+#define ORBCODE_TRACE_LOG_ARGS_1(f, a) , (uint32_t)(a)
+#define ORBCODE_TRACE_LOG_ARGS_2(f, a, ...) , (uint32_t)(a) ORBCODE_TRACE_LOG_ARGS_1(f, __VA_ARGS__)
+#define ORBCODE_TRACE_LOG_ARGS_3(f, a, ...) , (uint32_t)(a) ORBCODE_TRACE_LOG_ARGS_2(f, __VA_ARGS__)
+#define ORBCODE_TRACE_LOG_ARGS_4(f, a, ...) , (uint32_t)(a) ORBCODE_TRACE_LOG_ARGS_3(f, __VA_ARGS__)
+#define ORBCODE_TRACE_LOG_ARGS_5(f, a, ...) , (uint32_t)(a) ORBCODE_TRACE_LOG_ARGS_4(f, __VA_ARGS__)
+#define ORBCODE_TRACE_LOG_ARGS_6(f, a, ...) , (uint32_t)(a) ORBCODE_TRACE_LOG_ARGS_5(f, __VA_ARGS__)
+#define ORBCODE_TRACE_LOG_ARGS_7(f, a, ...) , (uint32_t)(a) ORBCODE_TRACE_LOG_ARGS_6(f, __VA_ARGS__)
+#define ORBCODE_TRACE_LOG_ARGS_8(f, a, ...) , (uint32_t)(a) ORBCODE_TRACE_LOG_ARGS_7(f, __VA_ARGS__)
+
+/**
+ * @brief Sends log message with deferred formatting
+ *
+ * Called as `TRACE_LOG(port, format, args...)` where `format` is printf-like format string literal followed by up to
+ * @ref TRACE_LOG_MAX_ARGS arguments.
+ *
+ * No code is generated and arguments are not evaluated when @p port is constant disabled in
+ * @ref ITM_COMPILED_PORT_MASK.
+ *
+ * @param port Stimulus port
+ * @param ... Format string literal and arguments
+ */
+#define TRACE_LOG(port, ...)                                                                                      \
+    do                                                                                                            \
+    {                                                                                                             \
+        if(ITM_IS_PORT_COMPILED(port))                                                                            \
+        {                                                                                                         \
+            static const char orbcodeTraceFormat[] __attribute__((section(ORBCODE_TRACE_LOG_SECTION), used)) =    \
+                ORBCODE_TRACE_LOG_FORMAT(__VA_ARGS__);                                                            \
+            const uint32_t orbcodeTraceMessage[] = {                                                              \
+                TraceLogHeader(orbcodeTraceFormat, ORBCODE_TRACE_LOG_NARGS(__VA_ARGS__))                          \
+                    ORBCODE_TRACE_LOG_ARGS(__VA_ARGS__)};                                                         \
+            ORBCODE_TRACE_LOG_WRITE((port), orbcodeTraceMessage, sizeof(orbcodeTraceMessage));                    \
+        }                                                                                                         \
+    } while(0)
+
+/**
+ * @brief Log level: logging disabled
+ */
+#define TRACE_LOG_LEVEL_NONE 0
+
+/**
+ * @brief Log level: errors
+ */
+#define TRACE_LOG_LEVEL_ERROR 1
+
+/**
+ * @brief Log level: warnings
+ */
+#define TRACE_LOG_LEVEL_WARNING 2
+
+/**
+ * @brief Log level: informational messages
+ */
+#define TRACE_LOG_LEVEL_INFO 3
+
+/**
+ * @brief Log level: debug messages
+ */
+#define TRACE_LOG_LEVEL_DEBUG 4
+
+#ifndef TRACE_LOG_LEVEL
+/**
+ * @brief Most verbose log level compiled into application
+ *
+ * Messages sent with level macros (@ref TRACE_LOG_ERROR, @ref TRACE_LOG_WARNING, @ref TRACE_LOG_INFO,
+ * @ref TRACE_LOG_DEBUG) above this level are removed by preprocessor together with their format strings and arguments.
+ * Defaults to @ref TRACE_LOG_LEVEL_DEBUG. Can be overridden by defining it before including this header.
+ */
+#    define TRACE_LOG_LEVEL TRACE_LOG_LEVEL_DEBUG
+#endif
+
+#if TRACE_LOG_LEVEL >= TRACE_LOG_LEVEL_ERROR
+/**
+ * @brief Sends error message with @ref TRACE_LOG, removed at compile time when @ref TRACE_LOG_LEVEL is below
+ * @ref TRACE_LOG_LEVEL_ERROR
+ */
+#    define TRACE_LOG_ERROR(port, ...) TRACE_LOG(port, __VA_ARGS__)
+#else
+#    define TRACE_LOG_ERROR(port, ...) ((void)0)
+#endif
+
+#if TRACE_LOG_LEVEL >= TRACE_LOG_LEVEL_WARNING
+/**
+ * @brief Sends warning message with @ref TRACE_LOG, removed at compile time when @ref TRACE_LOG_LEVEL is below
+ * @ref TRACE_LOG_LEVEL_WARNING
+ */
+#    define TRACE_LOG_WARNING(port, ...) TRACE_LOG(port, __VA_ARGS__)
+#else
+#    define TRACE_LOG_WARNING(port, ...) ((void)0)
+#endif
+
+#if TRACE_LOG_LEVEL >= TRACE_LOG_LEVEL_INFO
+/**
+ * @brief Sends informational message with @ref TRACE_LOG, removed at compile time when @ref TRACE_LOG_LEVEL is below
+ * @ref TRACE_LOG_LEVEL_INFO
+ */
+#    define TRACE_LOG_INFO(port, ...) TRACE_LOG(port, __VA_ARGS__)
+#else
+#    define TRACE_LOG_INFO(port, ...) ((void)0)
+#endif
+
+#if TRACE_LOG_LEVEL >= TRACE_LOG_LEVEL_DEBUG
+/**
+ * @brief Sends debug message with @ref TRACE_LOG, removed at compile time when @ref TRACE_LOG_LEVEL is below
+ * @ref TRACE_LOG_LEVEL_DEBUG
+ */
+#    define TRACE_LOG_DEBUG(port, ...) TRACE_LOG(port, __VA_ARGS__)
+#else
+#    define TRACE_LOG_DEBUG(port, ...) ((void)0)
+#endif
+
+    /**
+     * @brief Builds message header word
+     *
+     * @param format Format string placed in @ref ORBCODE_TRACE_LOG_SECTION
+     * @param argc Number of argument words following header
+     * @return Header word
+     */
+    static inline uint32_t TraceLogHeader(const char* format, uint32_t argc);
+
+    /**
+     * @brief Converts float to argument word preserving its bit pattern
+     *
+     * @param value Value to be logged
+     * @return Argument word
+     */
+    static inline uint32_t TraceLogFloat(float value);
+
+    /** @} */
+
+    uint32_t TraceLogHeader(const char* format, uint32_t argc)
+    {
+        return ((uint32_t)(uintptr_t)format & TRACE_LOG_ID_MASK) | (argc << TRACE_LOG_ARGC_POS);
+    }
+
+    uint32_t TraceLogFloat(float value)
+    {
+        uint32_t raw;
+        memcpy(&raw, &value, sizeof(raw));
+        return raw;
+    }
+
+#ifdef __cplusplus
+}
+#endif
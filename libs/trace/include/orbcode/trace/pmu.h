@@ -0,0 +1,335 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "atomic.h"
+
+#if !defined(PMU)
+#    error \
+        "PMU not defined. Include pmu.h AFTER core_cmX.h of core with PMU (__PMU_PRESENT set by device-specific header)"
+#endif
+
+#if !defined(CoreDebug)
+#    error \
+        "CoreDebug not defined. Include pmu.h AFTER core_cmX.h (typically after including device-specific header)"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup pmu Performance Monitoring Unit
+     * @ingroup trace
+     *
+     * @brief Count microarchitectural events (cache misses, mispredicted branches, MVE stalls, ...) on ARMv8.1-M cores
+     *
+     * Cortex-M55 and Cortex-M85 PMU has 32-bit cycle counter (`PMU_CCNTR`) and `__PMU_NUM_EVENTCNT` 16-bit event
+     * counters, each counting one event selected by its `PMU_EVTYPER` register (`ARM_PMU_*` event numbers from
+     * `pmu_armv8.h` and core header). 16-bit counters wrap too quickly for profiling, so library always chains pairs of
+     * them: even counter counts selected event and following odd counter counts its overflows (`ARM_PMU_CHAIN`). This
+     * gives @ref PMU_MAX_COUNTERS 32-bit counters, numbered 0 to @ref PMU_MAX_COUNTERS - 1, read by PMUReadCounter().
+     *
+     * @ref PMUCounterAccumulator extends counters to 64 bits in software, the same way as @ref DWTCounterAccumulator.
+     * Totals are correct as long as PMUCounterAccumulatorUpdate() is called before any counter advances by `2^32`.
+     *
+     * Scope profiler (@ref TRACE_PROFILE_PMU_COUNTERS) and benchmark harness (@ref TRACE_BENCH_PMU_COUNTERS) can report
+     * deltas of first counters together with cycles.
+     *
+     * @code{.c}
+     * PMUOptions options = {
+     *     .Events = {ARM_PMU_L1D_CACHE_REFILL, ARM_PMU_BR_MIS_PRED, ARM_PMU_MVE_STALL, ARM_PMU_BUS_ACCESS},
+     *     .Count = 4,
+     *     .CycleCounter = true,
+     * };
+     * PMUSetup(&options);
+     *
+     * uint32_t misses = PMUReadCounter(0);
+     * RunKernel();
+     * misses = PMUReadCounter(0) - misses;
+     * @endcode
+     *
+     * @{
+     */
+
+/**
+ * @brief Number of 32-bit (chained) event counters
+ */
+#define PMU_MAX_COUNTERS ((__PMU_NUM_EVENTCNT) / 2U)
+
+    /**
+     * @brief PMU configuration
+     */
+    typedef struct
+    {
+        /**
+         * @brief Event counted by each counter (`ARM_PMU_*`)
+         */
+        uint16_t Events[PMU_MAX_COUNTERS];
+        /**
+         * @brief Number of used entries in PMUOptions#Events (0 - @ref PMU_MAX_COUNTERS)
+         */
+        uint8_t Count;
+        /**
+         * @brief Enable cycle counter (`PMU_CCNTR`)
+         */
+        bool CycleCounter;
+    } PMUOptions;
+
+    /**
+     * @brief Raw values of PMU counters read at the same time
+     */
+    typedef struct
+    {
+        /**
+         * @brief `PMU_CCNTR`
+         */
+        uint32_t Cycles;
+        /**
+         * @brief Chained event counters
+         */
+        uint32_t Events[PMU_MAX_COUNTERS];
+    } PMUCounterSnapshot;
+
+    /**
+     * @brief 64-bit counter totals or difference between two totals
+     */
+    typedef struct
+    {
+        /**
+         * @brief Cycles
+         */
+        uint64_t Cycles;
+        /**
+         * @brief Events counted by each counter
+         */
+        uint64_t Events[PMU_MAX_COUNTERS];
+    } PMUCounters;
+
+    /**
+     * @brief Software extension of PMU counters to 64 bits
+     *
+     * All fields are managed by PMUCounterAccumulator* functions and must not be modified directly.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Number of event counters tracked
+         */
+        uint8_t Count;
+        /**
+         * @brief Counter values at last update
+         */
+        PMUCounterSnapshot Last;
+        /**
+         * @brief Totals since initialization
+         */
+        PMUCounters Total;
+    } PMUCounterAccumulator;
+
+    /**
+     * @brief Configures and starts PMU
+     *
+     * Enables trace (`DEMCR.TRCENA`), programs event counters in chained pairs, resets all counters and enables PMU.
+     * Counters not used by @p options are disabled.
+     *
+     * @param options Configuration
+     */
+    static inline void PMUSetup(const PMUOptions* options);
+
+    /**
+     * @brief Stops all PMU counters, counter values are kept
+     */
+    static inline void PMUStop(void);
+
+    /**
+     * @brief Returns event number counted by counter
+     *
+     * @param counter Counter number (0 - @ref PMU_MAX_COUNTERS - 1)
+     * @return `ARM_PMU_*` event number
+     */
+    static inline uint16_t PMUCounterEvent(uint8_t counter);
+
+    /**
+     * @brief Reads chained 32-bit event counter
+     *
+     * Upper half is read before and after lower half, so value is consistent even if lower half overflows meanwhile.
+     *
+     * @param counter Counter number (0 - @ref PMU_MAX_COUNTERS - 1)
+     * @return Counter value
+     */
+    static inline uint32_t PMUReadCounter(uint8_t counter);
+
+    /**
+     * @brief Returns current value of PMU cycle counter
+     */
+    static inline uint32_t PMUCycles(void);
+
+    /**
+     * @brief Reads cycle counter and first @p count event counters back-to-back
+     *
+     * @param snapshot Receives counter values, remaining event counters are set to zero
+     * @param count Number of event counters to read
+     */
+    static inline void PMUReadCounters(PMUCounterSnapshot* snapshot, uint8_t count);
+
+    /**
+     * @brief Initializes accumulator with current counter values and zero totals
+     *
+     * @param accumulator Accumulator
+     * @param count Number of event counters to track (usually PMUOptions#Count)
+     */
+    static inline void PMUCounterAccumulatorInit(PMUCounterAccumulator* accumulator, uint8_t count);
+
+    /**
+     * @brief Adds counter increments since previous update to totals
+     *
+     * Safe to call from any context (uses short critical section).
+     *
+     * @param accumulator Accumulator
+     */
+    static inline void PMUCounterAccumulatorUpdate(PMUCounterAccumulator* accumulator);
+
+    /**
+     * @brief Updates accumulator and returns its totals
+     *
+     * Safe to call from any context (uses short critical section).
+     *
+     * @param accumulator Accumulator
+     * @param totals Receives totals since accumulator initialization
+     */
+    static inline void PMUCounterAccumulatorRead(PMUCounterAccumulator* accumulator, PMUCounters* totals);
+
+    /**
+     * @brief Computes difference between two totals
+     *
+     * @param before Totals at start of measured region
+     * @param after Totals at end of measured region
+     * @return Counter increments between @p before and @p after
+     */
+    static inline PMUCounters PMUCountersDelta(const PMUCounters* before, const PMUCounters* after);
+
+    /** @} */
+
+    // Internal helpers
+
+#define ORBCODE_TRACE_PMU_EVENT_MASK 0xFFFFUL
+#define ORBCODE_TRACE_PMU_PAIR_MASK(count) ((uint32_t)((1ULL << (2U * (uint32_t)(count))) - 1U))
+
+    void PMUSetup(const PMUOptions* options)
+    {
+        const uint8_t count = options->Count > PMU_MAX_COUNTERS ? (uint8_t)PMU_MAX_COUNTERS : options->Count;
+
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // PMU is part of debug and trace logic
+
+        PMU->CTRL &= ~PMU_CTRL_ENABLE_Msk;
+        PMU->CNTENCLR = ORBCODE_TRACE_PMU_PAIR_MASK(PMU_MAX_COUNTERS) | PMU_CNTENSET_CCNTR_ENABLE_Msk;
+
+        for(uint8_t i = 0; i < count; i++)
+        {
+            PMU->EVTYPER[2U * i] = options->Events[i] & ORBCODE_TRACE_PMU_EVENT_MASK;
+            PMU->EVTYPER[2U * i + 1U] = ARM_PMU_CHAIN;
+        }
+
+        PMU->OVSCLR = ORBCODE_TRACE_PMU_PAIR_MASK(PMU_MAX_COUNTERS) | PMU_CNTENSET_CCNTR_ENABLE_Msk;
+        PMU->CTRL |= PMU_CTRL_EVENTCNT_RESET_Msk | PMU_CTRL_CYCCNT_RESET_Msk;
+
+        PMU->CNTENSET =
+            ORBCODE_TRACE_PMU_PAIR_MASK(count) | (options->CycleCounter ? PMU_CNTENSET_CCNTR_ENABLE_Msk : 0U);
+        PMU->CTRL |= PMU_CTRL_ENABLE_Msk;
+    }
+
+    void PMUStop(void)
+    {
+        PMU->CTRL &= ~PMU_CTRL_ENABLE_Msk;
+    }
+
+    uint16_t PMUCounterEvent(uint8_t counter)
+    {
+        return (uint16_t)(PMU->EVTYPER[2U * counter] & ORBCODE_TRACE_PMU_EVENT_MASK);
+    }
+
+    uint32_t PMUReadCounter(uint8_t counter)
+    {
+        const uint32_t low = 2U * counter;
+        uint32_t high = PMU->EVCNTR[low + 1U] & PMU_EVCNTR_CNT_Msk;
+        for(;;)
+        {
+            const uint32_t value = PMU->EVCNTR[low] & PMU_EVCNTR_CNT_Msk;
+            const uint32_t check = PMU->EVCNTR[low + 1U] & PMU_EVCNTR_CNT_Msk;
+            if(check == high)
+            {
+                return (high << 16) | value;
+            }
+            high = check;
+        }
+    }
+
+    uint32_t PMUCycles(void)
+    {
+        return PMU->CCNTR;
+    }
+
+    void PMUReadCounters(PMUCounterSnapshot* snapshot, uint8_t count)
+    {
+        snapshot->Cycles = PMU->CCNTR;
+        for(uint8_t i = 0; i < PMU_MAX_COUNTERS; i++)
+        {
+            snapshot->Events[i] = i < count ? PMUReadCounter(i) : 0U;
+        }
+    }
+
+    void PMUCounterAccumulatorInit(PMUCounterAccumulator* accumulator, uint8_t count)
+    {
+        accumulator->Count = count > PMU_MAX_COUNTERS ? (uint8_t)PMU_MAX_COUNTERS : count;
+        PMUReadCounters(&accumulator->Last, accumulator->Count);
+        accumulator->Total.Cycles = 0;
+        for(uint8_t i = 0; i < PMU_MAX_COUNTERS; i++)
+        {
+            accumulator->Total.Events[i] = 0;
+        }
+    }
+
+    void PMUCounterAccumulatorUpdate(PMUCounterAccumulator* accumulator)
+    {
+        uint32_t state = TraceCriticalEnter();
+
+        PMUCounterSnapshot now;
+        PMUReadCounters(&now, accumulator->Count);
+
+        // Unsigned subtraction handles single wrap-around
+        accumulator->Total.Cycles += (uint32_t)(now.Cycles - accumulator->Last.Cycles);
+        for(uint8_t i = 0; i < accumulator->Count; i++)
+        {
+            accumulator->Total.Events[i] += (uint32_t)(now.Events[i] - accumulator->Last.Events[i]);
+        }
+        accumulator->Last = now;
+
+        TraceCriticalExit(state);
+    }
+
+    void PMUCounterAccumulatorRead(PMUCounterAccumulator* accumulator, PMUCounters* totals)
+    {
+        uint32_t state = TraceCriticalEnter();
+        PMUCounterAccumulatorUpdate(accumulator);
+        *totals = accumulator->Total;
+        TraceCriticalExit(state);
+    }
+
+    PMUCounters PMUCountersDelta(const PMUCounters* before, const PMUCounters* after)
+    {
+        PMUCounters delta;
+        delta.Cycles = after->Cycles - before->Cycles;
+        for(uint8_t i = 0; i < PMU_MAX_COUNTERS; i++)
+        {
+            delta.Events[i] = after->Events[i] - before->Events[i];
+        }
+        return delta;
+    }
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,254 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "itm_buffer.h"
+#include "timestamp.h"
+
+#if defined(TRACE_PROFILE_PMU_COUNTERS) && TRACE_PROFILE_PMU_COUNTERS > 0
+#    include "pmu.h"
+#endif
+
+#if !defined(DWT)
+#    error \
+        "DWT not defined. Include profile.h AFTER core_cmX.h (typically after including device-specific header)"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup profile Scope profiler
+     * @ingroup trace
+     *
+     * @brief Per-scope timing measured with DWT cycle counter
+     *
+     * Every profiled scope emits enter record when it starts and exit record with its duration in cycles when it ends.
+     * Records are stored in ring buffer (see @ref itm_buffer) so that recording costs one RAM copy and are sent to
+     * stimulus port when buffer is drained. Stimulus port of the buffer should be dedicated to profiler records.
+     *
+     * Cycle counter must be enabled (DWTSetup() enables it). Records are decoded on host by `orbcode-trace-profile`
+     * tool.
+     *
+     * Record layout (8 bytes, little-endian words):
+     * | Word | Content |
+     * |------|---------|
+     * | 0    | bits 0-23: scope ID, bits 24-31: record type (@ref TRACE_PROFILE_RECORD_ENTER, @ref TRACE_PROFILE_RECORD_EXIT) |
+     * | 1    | Enter: `DWT_CYCCNT` at scope entry, Exit: scope duration in cycles |
+     *
+     * When @ref TRACE_PROFILE_PMU_COUNTERS is set, exit records have type @ref TRACE_PROFILE_RECORD_EXIT_PMU and
+     * N = @ref TRACE_PROFILE_PMU_COUNTERS more words:
+     * | Word    | Content |
+     * |---------|---------|
+     * | 2       | N |
+     * | 3 - N+2 | increments of PMU counters 0 to N-1 (see @ref pmu) during scope |
+     *
+     * By default records are written to ring buffer `TraceProfileBuffer` which application must define and initialize:
+     *
+     * @code{.c}
+     * static uint8_t ProfileStorage[512];
+     * ITMBuffer TraceProfileBuffer;
+     *
+     * void Init(void)
+     * {
+     *     ITMBufferInit(&TraceProfileBuffer, 6, ProfileStorage, sizeof(ProfileStorage));
+     * }
+     *
+     * void ProcessFrame(void)
+     * {
+     *     TRACE_SCOPE(FRAME_SCOPE_ID); // exit record emitted when function returns
+     *     ...
+     * }
+     *
+     * void Idle(void)
+     * {
+     *     ITMBufferDrain(&TraceProfileBuffer, ITM_BUFFER_DRAIN_ALL);
+     * }
+     * @endcode
+     *
+     * C++ code can use `orbcode::trace::ProfileScope` (profile.hpp).
+     *
+     * @{
+     */
+
+#ifndef TRACE_PROFILE_ENABLED
+/**
+ * @brief Set to 0 to remove all @ref TRACE_SCOPE instrumentation at compile time
+ *
+ * Can be overridden by defining it before including this header.
+ */
+#    define TRACE_PROFILE_ENABLED 1
+#endif
+
+#ifndef TRACE_PROFILE_PMU_COUNTERS
+/**
+ * @brief Number of PMU counters reported in exit records (0 - @ref PMU_MAX_COUNTERS)
+ *
+ * Deltas of chained PMU counters 0 to `TRACE_PROFILE_PMU_COUNTERS - 1` (configured by PMUSetup()) are reported with
+ * duration of every scope, e.g. D-cache refills of each profiled DSP kernel. Requires core with PMU (Cortex-M55,
+ * Cortex-M85). Defaults to 0 (no PMU counters). Can be overridden by defining it before including this header, value
+ * must be the same in all translation units.
+ */
+#    define TRACE_PROFILE_PMU_COUNTERS 0
+#endif
+
+#if TRACE_PROFILE_PMU_COUNTERS > 0 && TRACE_PROFILE_PMU_COUNTERS > PMU_MAX_COUNTERS
+#    error "TRACE_PROFILE_PMU_COUNTERS exceeds number of chained PMU counters (PMU_MAX_COUNTERS)"
+#endif
+
+#ifndef ORBCODE_TRACE_PROFILE_WRITE
+/**
+ * @brief Writes single profiler record
+ *
+ * Called as `ORBCODE_TRACE_PROFILE_WRITE(data, size)`. Defaults to ITMBufferWrite() to `TraceProfileBuffer`. Can be
+ * overridden by defining it before including this header (e.g. to use different buffer).
+ */
+#    define ORBCODE_TRACE_PROFILE_WRITE(data, size) ITMBufferWrite(&TraceProfileBuffer, (data), (size))
+
+    /**
+     * @brief Ring buffer receiving profiler records, must be defined by application
+     */
+    extern ITMBuffer TraceProfileBuffer;
+#endif
+
+/**
+ * @brief Record type emitted on scope entry
+ */
+#define TRACE_PROFILE_RECORD_ENTER 1U
+
+/**
+ * @brief Record type emitted on scope exit
+ */
+#define TRACE_PROFILE_RECORD_EXIT 2U
+
+/**
+ * @brief Record type emitted on scope exit when @ref TRACE_PROFILE_PMU_COUNTERS is set
+ */
+#define TRACE_PROFILE_RECORD_EXIT_PMU 3U
+
+/**
+ * @brief Mask of scope ID in record header
+ */
+#define TRACE_PROFILE_ID_MASK 0x00FFFFFFUL
+
+/**
+ * @brief Position of record type in record header
+ */
+#define TRACE_PROFILE_TYPE_POS 24U
+
+#define ORBCODE_TRACE_PROFILE_CONCAT(a, b) ORBCODE_TRACE_PROFILE_CONCAT_(a, b)
+#define ORBCODE_TRACE_PROFILE_CONCAT_(a, b) a##b
+
+#if TRACE_PROFILE_ENABLED
+/**
+ * @brief Profiles enclosing scope
+ *
+ * Emits enter record immediately and exit record when execution leaves enclosing block (including `return`, `break`
+ * and `goto`). Uses GCC/Clang `cleanup` attribute. Can be used once per line.
+ *
+ * @param id Scope ID (24 bits)
+ */
+#    define TRACE_SCOPE(id)                                                        \
+        TraceScope ORBCODE_TRACE_PROFILE_CONCAT(orbcodeTraceScope, __LINE__)       \
+            __attribute__((cleanup(TraceScopeExit), unused)) = TraceScopeEnter(id)
+#else
+#    define TRACE_SCOPE(id) ((void)0)
+#endif
+
+    /**
+     * @brief Profiled scope
+     */
+    typedef struct
+    {
+        /**
+         * @brief Scope ID
+         */
+        uint32_t Id;
+        /**
+         * @brief `DWT_CYCCNT` at scope entry
+         */
+        uint32_t Start;
+#if TRACE_PROFILE_PMU_COUNTERS > 0
+        /**
+         * @brief PMU counters at scope entry
+         */
+        uint32_t Pmu[TRACE_PROFILE_PMU_COUNTERS];
+#endif
+    } TraceScope;
+
+    /**
+     * @brief Starts profiled scope and emits enter record
+     *
+     * @param id Scope ID (24 bits)
+     * @return Scope to be passed to TraceScopeExit()
+     */
+    static inline TraceScope TraceScopeEnter(uint32_t id);
+
+    /**
+     * @brief Finishes profiled scope and emits exit record with scope duration
+     *
+     * @param scope Scope returned from TraceScopeEnter()
+     */
+    static inline void TraceScopeExit(TraceScope* scope);
+
+    /**
+     * @brief Builds record header word
+     *
+     * @param type Record type
+     * @param id Scope ID
+     * @return Header word
+     */
+    static inline uint32_t TraceProfileHeader(uint32_t type, uint32_t id);
+
+    /** @} */
+
+    uint32_t TraceProfileHeader(uint32_t type, uint32_t id)
+    {
+        return (type << TRACE_PROFILE_TYPE_POS) | (id & TRACE_PROFILE_ID_MASK);
+    }
+
+    TraceScope TraceScopeEnter(uint32_t id)
+    {
+        TraceScope scope;
+        scope.Id = id;
+        scope.Start = DWTCycles();
+
+        const uint32_t record[2] = {TraceProfileHeader(TRACE_PROFILE_RECORD_ENTER, id), scope.Start};
+        ORBCODE_TRACE_PROFILE_WRITE(record, sizeof(record));
+
+#if TRACE_PROFILE_PMU_COUNTERS > 0
+        // Read after enter record, so that its cost is not counted
+        for(uint8_t i = 0; i < TRACE_PROFILE_PMU_COUNTERS; i++)
+        {
+            scope.Pmu[i] = PMUReadCounter(i);
+        }
+#endif
+        return scope;
+    }
+
+    void TraceScopeExit(TraceScope* scope)
+    {
+        const uint32_t duration = DWTElapsedCycles(scope->Start);
+
+#if TRACE_PROFILE_PMU_COUNTERS > 0
+        uint32_t record[3 + TRACE_PROFILE_PMU_COUNTERS];
+        for(uint8_t i = 0; i < TRACE_PROFILE_PMU_COUNTERS; i++)
+        {
+            record[3 + i] = PMUReadCounter(i) - scope->Pmu[i];
+        }
+        record[0] = TraceProfileHeader(TRACE_PROFILE_RECORD_EXIT_PMU, scope->Id);
+        record[1] = duration;
+        record[2] = TRACE_PROFILE_PMU_COUNTERS;
+#else
+        const uint32_t record[2] = {TraceProfileHeader(TRACE_PROFILE_RECORD_EXIT, scope->Id), duration};
+#endif
+        ORBCODE_TRACE_PROFILE_WRITE(record, sizeof(record));
+    }
+
+#ifdef __cplusplus
+}
+#endif
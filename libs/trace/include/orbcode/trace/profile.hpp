@@ -0,0 +1,66 @@
+/** @file */
+
+#pragma once
+#include <stdint.h>
+
+#include "profile.h"
+
+namespace orbcode
+{
+    namespace trace
+    {
+        /**
+         * @addtogroup profile
+         * @{
+         */
+
+        /**
+         * @brief Profiles lifetime of object, C++ counterpart of @ref TRACE_SCOPE
+         *
+         * @code{.cpp}
+         * void ProcessFrame()
+         * {
+         *     orbcode::trace::ProfileScope scope(FRAME_SCOPE_ID);
+         *     ...
+         * }
+         * @endcode
+         */
+        class ProfileScope
+        {
+        public:
+            /**
+             * @brief Emits enter record
+             *
+             * @param id Scope ID (24 bits)
+             */
+            explicit ProfileScope(uint32_t id)
+            {
+#if TRACE_PROFILE_ENABLED
+                scope_ = TraceScopeEnter(id);
+#else
+                (void)id;
+#endif
+            }
+
+            /**
+             * @brief Emits exit record
+             */
+            ~ProfileScope()
+            {
+#if TRACE_PROFILE_ENABLED
+                TraceScopeExit(&scope_);
+#endif
+            }
+
+            ProfileScope(const ProfileScope&) = delete;
+            ProfileScope& operator=(const ProfileScope&) = delete;
+
+        private:
+#if TRACE_PROFILE_ENABLED
+            TraceScope scope_;
+#endif
+        };
+
+        /** @} */
+    }
+}
@@ -0,0 +1,288 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dwt.h"
+#include "itm.h"
+#include "tpiu.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup swo_planner SWO bandwidth planner
+     * @ingroup trace
+     *
+     * @brief Derive SWO prescaler, PC sampling and timestamp settings from bandwidth targets
+     *
+     * TracePlanSwo() selects SWO baudrate closest to (but not above) receiver limit and estimates link capacity in
+     * bytes per second. Then it picks the highest PC sampling rate not exceeding requested one and the finest local
+     * timestamp resolution for which estimated trace traffic still fits in the link.
+     *
+     * Estimate is based on packet sizes from ARMv7-M Architecture Reference Manual, appendix D4:
+     * * SWO byte costs 10 bits in UART mode (start and stop bit) and 8 bits in Manchester mode
+     * * TPIU formatter (if enabled) sends 15 bytes of data in 16-byte frames
+     * * Stimulus port data is written in 4-byte packets (5 bytes with header)
+     * * PC sample packet takes 5 bytes
+     * * Synchronization packet takes 6 bytes
+     * * Local timestamp packet follows trace packets and takes 1-5 bytes depending on time since previous one
+     *
+     * Estimate assumes evenly distributed traffic, bursts still need buffering in ITM FIFO. Leave some headroom (e.g.
+     * 20%) for overflow-free trace.
+     *
+     * @code{.c}
+     * TpiuOptions tpiu = {.Protocol = TpiuProtocolSwoUart, .FormattingEnabled = false};
+     * ITMOptions itm = {.TraceBusID = 1, .ForwardDWT = true, .EnableSyncPacket = true, .EnableLocalTimestamp = true};
+     * DWTOptions dwt = {.ExceptionTrace = false};
+     *
+     * TraceSwoTargets targets = {
+     *     .TraceClock = 64000000,
+     *     .CoreClock = 64000000,
+     *     .MaxBaudrate = 4000000,
+     *     .PCSampleRate = 20000,
+     *     .ITMPayloadRate = 50000,
+     * };
+     * TraceSwoPlan plan;
+     * TracePlanSwo(&targets, &tpiu, &itm, &dwt, &plan);
+     *
+     * TpiuSetup(&tpiu);
+     * ITMSetup(&itm);
+     * DWTSetup(&dwt);
+     * @endcode
+     *
+     * @{
+     */
+
+    /**
+     * @brief Inputs of SWO planner
+     */
+    typedef struct
+    {
+        /**
+         * @brief TPIU trace clock in Hz (clock divided by SWO prescaler)
+         */
+        uint32_t TraceClock;
+        /**
+         * @brief Core clock in Hz (drives DWT and ITM timestamps)
+         */
+        uint32_t CoreClock;
+        /**
+         * @brief Maximum baudrate supported by receiver
+         */
+        uint32_t MaxBaudrate;
+        /**
+         * @brief Desired PC samples per second, 0 disables PC sampling
+         */
+        uint32_t PCSampleRate;
+        /**
+         * @brief Expected stimulus port data in bytes per second
+         */
+        uint32_t ITMPayloadRate;
+    } TraceSwoTargets;
+
+    /**
+     * @brief Result of SWO planner
+     */
+    typedef struct
+    {
+        /**
+         * @brief Selected SWO baudrate (UART receiver must use exactly this baudrate)
+         */
+        uint32_t Baudrate;
+        /**
+         * @brief Estimated link capacity in bytes per second
+         */
+        uint32_t Capacity;
+        /**
+         * @brief Estimated trace traffic in bytes per second
+         */
+        uint32_t Load;
+        /**
+         * @brief Selected PC sampling rate (0 if disabled)
+         */
+        uint32_t PCSampleRate;
+        /**
+         * @brief Capacity left in bytes per second (negative if link is overloaded)
+         */
+        int32_t Headroom;
+    } TraceSwoPlan;
+
+    /**
+     * @brief Plans SWO trace configuration within link capacity
+     *
+     * Only planner-related fields of options are modified, application sets the rest before or after planning.
+     * Fields used as inputs: TpiuOptions#Protocol (SWO protocols only), TpiuOptions#FormattingEnabled,
+     * ITMOptions#EnableLocalTimestamp and ITMOptions#EnableSyncPacket. Fields set by planner:
+     * TpiuOptions#SwoPrescaler, DWTOptions#PCSampling, DWTOptions#CycleTap, DWTOptions#SamplingPrescaler,
+     * DWTOptions#SyncTap and ITMOptions#LocalTimestampPrescaler.
+     *
+     * If PC sampling at lowest rate does not fit in link, PC sampling is disabled.
+     *
+     * @param targets Clocks and required rates
+     * @param tpiu TPIU options
+     * @param itm ITM options
+     * @param dwt DWT options
+     * @param plan Receives selected rates and bandwidth estimate
+     * @return true Estimated traffic fits in link
+     * @return false Link overloaded even with PC sampling disabled and coarsest timestamps (or invalid clocks)
+     */
+    static inline bool TracePlanSwo(const TraceSwoTargets* targets, TpiuOptions* tpiu, ITMOptions* itm, DWTOptions* dwt,
+                                    TraceSwoPlan* plan);
+
+    /** @} */
+
+    // Internal helpers
+
+    // Bytes of local timestamp packet for given delta (1 byte for small deltas, then 7 bits per continuation byte)
+    static inline uint32_t TraceSwoTimestampSize(uint64_t delta)
+    {
+        if(delta <= 6)
+        {
+            return 1;
+        }
+        uint32_t size = 2;
+        for(uint64_t limit = 1U << 7; delta >= limit && size < 5; limit <<= 7)
+        {
+            size++;
+        }
+        return size;
+    }
+
+    static inline uint64_t TraceSwoLoad(const TraceSwoTargets* targets, const ITMOptions* itm, uint32_t syncRate,
+                                        uint64_t pcRate, uint32_t timestampDivider, bool formatting)
+    {
+        const uint64_t itmPackets = ((uint64_t)targets->ITMPayloadRate + 3U) / 4U;
+        uint64_t load = itmPackets * 5U + pcRate * 5U;
+
+        if(itm->EnableSyncPacket)
+        {
+            load += (uint64_t)syncRate * 6U;
+        }
+
+        if(itm->EnableLocalTimestamp)
+        {
+            const uint64_t packets = itmPackets + pcRate;
+            const uint64_t ticks = targets->CoreClock / timestampDivider;
+            if(packets > 0)
+            {
+                // At most one timestamp per timestamp tick
+                const uint64_t timestamps = packets < ticks ? packets : ticks;
+                load += timestamps * TraceSwoTimestampSize(ticks / packets);
+            }
+        }
+
+        if(formatting)
+        {
+            load = (load * 16U + 14U) / 15U;
+        }
+        return load;
+    }
+
+    bool TracePlanSwo(const TraceSwoTargets* targets, TpiuOptions* tpiu, ITMOptions* itm, DWTOptions* dwt,
+                      TraceSwoPlan* plan)
+    {
+        if(targets->TraceClock == 0 || targets->CoreClock == 0 || targets->MaxBaudrate == 0)
+        {
+            return false;
+        }
+
+        // Lowest prescaler not exceeding receiver baudrate
+        uint32_t prescaler = (uint32_t)(((uint64_t)targets->TraceClock + targets->MaxBaudrate - 1U) /
+                                        targets->MaxBaudrate);
+        prescaler = prescaler < 1U ? 1U : prescaler;
+        tpiu->SwoPrescaler = (int)prescaler;
+
+        plan->Baudrate = targets->TraceClock / prescaler;
+        const uint32_t bitsPerByte = tpiu->Protocol == TpiuProtocolSwoManchester ? 8U : 10U;
+        const uint64_t capacity = plan->Baudrate / bitsPerByte;
+        plan->Capacity = (uint32_t)capacity;
+
+        // Most frequent synchronization packets taking at most 1% of link
+        static const DWTSyncTap syncTaps[] = {DWTSyncTap24, DWTSyncTap26, DWTSyncTap28};
+        static const uint8_t syncBits[] = {24, 26, 28};
+        uint32_t syncRate = 0;
+        dwt->SyncTap = DWTSyncTap28;
+        for(uint32_t i = 0; i < 3; i++)
+        {
+            syncRate = targets->CoreClock >> syncBits[i];
+            if((uint64_t)syncRate * 6U * 100U <= capacity)
+            {
+                dwt->SyncTap = syncTaps[i];
+                break;
+            }
+        }
+
+        static const ITMLocalTimestampPrescaler timestampPrescalers[] = {
+            ITMLocalTimestampPrescalerNoPrescaling,
+            ITMLocalTimestampPrescalerDivideBy4,
+            ITMLocalTimestampPrescalerDivideBy10,
+            ITMLocalTimestampPrescalerDivideBy64,
+        };
+        static const uint8_t timestampDividers[] = {1, 4, 16, 64}; // `DivideBy10` divides by 16
+
+        // Highest PC sampling rate (0 = disabled) that fits with finest timestamp resolution that fits
+        uint64_t bestRate = 0;
+        uint32_t bestTimestamp = 3;
+        uint64_t bestLoad = 0;
+        bool found = false;
+        DWTCycleTap bestTap = DWTCycleTap10;
+        uint8_t bestSampling = 16;
+
+        for(uint32_t tap = 0; tap < 2; tap++)
+        {
+            for(uint32_t sampling = 0; sampling <= 16; sampling++)
+            {
+                // sampling == 0 evaluates disabled PC sampling (once)
+                if(sampling == 0 && tap != 0)
+                {
+                    continue;
+                }
+
+                const uint64_t rate = sampling == 0 ? 0 : targets->CoreClock / ((tap == 0 ? 64U : 1024U) * sampling);
+                if(rate > targets->PCSampleRate || (found && rate <= bestRate))
+                {
+                    continue;
+                }
+
+                for(uint32_t ts = 0; ts < 4; ts++)
+                {
+                    const uint64_t load = TraceSwoLoad(targets, itm, syncRate, rate, timestampDividers[ts],
+                                                       tpiu->FormattingEnabled);
+                    if(load <= capacity)
+                    {
+                        found = true;
+                        bestRate = rate;
+                        bestTimestamp = ts;
+                        bestLoad = load;
+                        bestTap = tap == 0 ? DWTCycleTap6 : DWTCycleTap10;
+                        bestSampling = (uint8_t)(sampling == 0 ? 16 : sampling);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if(!found)
+        {
+            bestLoad = TraceSwoLoad(targets, itm, syncRate, 0, timestampDividers[3], tpiu->FormattingEnabled);
+        }
+
+        dwt->PCSampling = bestRate > 0;
+        dwt->CycleTap = bestTap;
+        dwt->SamplingPrescaler = bestSampling;
+        itm->LocalTimestampPrescaler = timestampPrescalers[bestTimestamp];
+
+        plan->PCSampleRate = (uint32_t)bestRate;
+        plan->Load = bestLoad > 0xFFFFFFFFU ? 0xFFFFFFFFU : (uint32_t)bestLoad;
+        const int64_t headroom = (int64_t)capacity - (int64_t)bestLoad;
+        plan->Headroom = headroom < INT32_MIN ? INT32_MIN : (int32_t)headroom;
+        return found;
+    }
+
+#ifdef __cplusplus
+}
+#endif
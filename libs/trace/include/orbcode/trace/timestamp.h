@@ -0,0 +1,171 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "atomic.h"
+
+#if !defined(DWT)
+#    error \
+        "DWT not defined. Include timestamp.h AFTER core_cmX.h (typically after including device-specific header)"
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup timestamp Timestamps
+     * @ingroup dwt
+     *
+     * @brief Cycle counter based time measurement
+     *
+     * DWTCycles() and DWTElapsedCycles() measure intervals shorter than `2^32` cycles (about 9 seconds at 480 MHz)
+     * directly with 32-bit cycle counter.
+     *
+     * @ref DWTTimestamp extends cycle counter to monotonic 64-bit timestamp. It tracks every half of cycle counter
+     * period, so DWTTimestampNow() must be called at least once per `2^31` cycles (about 4.4 seconds at 480 MHz), e.g.
+     * from periodic timer interrupt. DWTTimestampNow() is lock-free and can be called from any context, including
+     * interrupts preempting another DWTTimestampNow() call.
+     *
+     * Cycle counter must be enabled (DWTSetup() enables it).
+     *
+     * @code{.c}
+     * static DWTTimestamp Clock;
+     *
+     * void SysTick_Handler(void)
+     * {
+     *     DWTTimestampNow(&Clock); // keeps timestamp valid when not used for longer periods
+     * }
+     *
+     * void Work(void)
+     * {
+     *     uint64_t start = DWTTimestampNow(&Clock);
+     *     LongOperation();
+     *     uint64_t us = DWTCyclesToUs(DWTTimestampNow(&Clock) - start, SystemCoreClock);
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+    /**
+     * @brief 64-bit timestamp state
+     *
+     * All fields are managed by DWTTimestamp* functions and must not be modified directly.
+     */
+    typedef struct
+    {
+        /**
+         * @brief Number of cycle counter half-periods (`2^31` cycles) elapsed since cycle counter value 0
+         *
+         * Lowest bit always matches bit 31 of cycle counter as of last DWTTimestampNow() call.
+         */
+        volatile uint32_t Epoch;
+    } DWTTimestamp;
+
+    /**
+     * @brief Returns current value of cycle counter
+     */
+    static inline uint32_t DWTCycles(void);
+
+    /**
+     * @brief Returns number of cycles since @p start
+     *
+     * Correct for intervals shorter than `2^32` cycles, wrap-around of cycle counter is handled.
+     *
+     * @param start Value returned earlier by DWTCycles()
+     * @return Elapsed cycles
+     */
+    static inline uint32_t DWTElapsedCycles(uint32_t start);
+
+    /**
+     * @brief Initializes 64-bit timestamp
+     *
+     * Timestamp starts at current cycle counter value.
+     *
+     * @param timestamp Timestamp state
+     */
+    static inline void DWTTimestampInit(DWTTimestamp* timestamp);
+
+    /**
+     * @brief Returns current 64-bit timestamp in cycles
+     *
+     * @param timestamp Timestamp state
+     * @return Cycles
+     */
+    static inline uint64_t DWTTimestampNow(DWTTimestamp* timestamp);
+
+    /**
+     * @brief Converts cycles to nanoseconds
+     *
+     * @param cycles Number of cycles
+     * @param coreClock Core clock frequency in Hz
+     * @return Nanoseconds (rounded down)
+     */
+    static inline uint64_t DWTCyclesToNs(uint64_t cycles, uint32_t coreClock);
+
+    /**
+     * @brief Converts cycles to microseconds
+     *
+     * @param cycles Number of cycles
+     * @param coreClock Core clock frequency in Hz
+     * @return Microseconds (rounded down)
+     */
+    static inline uint64_t DWTCyclesToUs(uint64_t cycles, uint32_t coreClock);
+
+    /** @} */
+
+    uint32_t DWTCycles(void)
+    {
+        return DWT->CYCCNT;
+    }
+
+    uint32_t DWTElapsedCycles(uint32_t start)
+    {
+        return DWT->CYCCNT - start;
+    }
+
+    void DWTTimestampInit(DWTTimestamp* timestamp)
+    {
+        timestamp->Epoch = DWT->CYCCNT >> 31;
+    }
+
+    uint64_t DWTTimestampNow(DWTTimestamp* timestamp)
+    {
+        for(;;)
+        {
+            // Epoch must be read before cycle counter so that counter value is never older than epoch
+            uint32_t epoch = timestamp->Epoch;
+            __COMPILER_BARRIER();
+            uint32_t cycles = DWT->CYCCNT;
+
+            if((cycles >> 31) == (epoch & 1U))
+            {
+                return ((uint64_t)(epoch >> 1) << 32) | cycles;
+            }
+
+            // Counter entered next half-period. Whoever advances epoch first wins, others retry with new epoch.
+            if(TraceAtomicCompareExchange(&timestamp->Epoch, epoch, epoch + 1))
+            {
+                return ((uint64_t)((epoch + 1) >> 1) << 32) | cycles;
+            }
+        }
+    }
+
+    uint64_t DWTCyclesToNs(uint64_t cycles, uint32_t coreClock)
+    {
+        // Split to avoid overflow of cycles * 10^9
+        return (cycles / coreClock) * 1000000000ULL + ((cycles % coreClock) * 1000000000ULL) / coreClock;
+    }
+
+    uint64_t DWTCyclesToUs(uint64_t cycles, uint32_t coreClock)
+    {
+        return (cycles / coreClock) * 1000000ULL + ((cycles % coreClock) * 1000000ULL) / coreClock;
+    }
+
+#ifdef __cplusplus
+}
+#endif
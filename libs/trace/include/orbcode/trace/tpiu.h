@@ -9,6 +9,13 @@
         "TPI not defined. Include tpiu.h AFTER core_cmX.h (typically after including device-specific header)"
 #endif
 
+// Some ARMv8.1-M CMSIS headers define only two-bit EnFmt field, continuous formatting is its bit 1 (internal helper)
+#if defined(TPI_FFCR_EnFCont_Msk)
+#    define ORBCODE_TRACE_TPI_FFCR_ENFCONT_Msk TPI_FFCR_EnFCont_Msk
+#else
+#    define ORBCODE_TRACE_TPI_FFCR_ENFCONT_Msk (0x2UL << TPI_FFCR_EnFmt_Pos)
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -27,6 +34,19 @@ extern "C"
      * @{
      */
 
+/**
+ * @brief Bit of parallel trace port width in `TPI_SSPSR` format
+ *
+ * Used to build mask of widths for TpiuSelectPortWidth(), e.g. `TPIU_PORT_WIDTH_MASK(4) | TPIU_PORT_WIDTH_MASK(2)`
+ * when only 2 or 4 trace data pins are routed.
+ */
+#define TPIU_PORT_WIDTH_MASK(width) (1UL << ((uint32_t)(width)-1U))
+
+/**
+ * @brief Mask allowing every parallel trace port width supported by TPIU
+ */
+#define TPIU_PORT_WIDTHS_ALL 0xFFFFFFFFUL
+
     /**
      * @brief Available trace protocols
      */
@@ -90,10 +110,29 @@ extern "C"
          * @brief Number of bits in parallel trace port
          *
          * When using parallel trace protocol it is possible to define number of data lines used to outputing data.
+         * Set to 0 to use widest port supported by TPIU (see TpiuSelectPortWidth() to limit widths to routed pins).
          */
         uint8_t TracePortWidth;
     } TpiuOptions;
 
+    /**
+     * @brief Parallel trace port width selected by TpiuSelectPortWidth()
+     */
+    typedef struct
+    {
+        /**
+         * @brief Number of trace data pins (1-32)
+         */
+        uint8_t Width;
+        /**
+         * @brief Theoretical bandwidth of trace port in bytes per second
+         *
+         * Port outputs @ref Width bits on both edges of `TRACECLK` (half of trace clock), i.e. @ref Width bits per
+         * trace clock cycle. With formatter enabled 15 of 16 bytes carry trace data.
+         */
+        uint32_t Bandwidth;
+    } TpiuPortWidthSelection;
+
     /**
      * @brief Configure TPIU component.
      *
@@ -106,6 +145,22 @@ extern "C"
      */
     static inline void TpiuSetup(const TpiuOptions* options);
 
+    /**
+     * @brief Selects widest parallel trace port width allowed by caller and supported by TPIU
+     *
+     * Reads supported widths from `TPI_SSPSR`, picks widest one present in @p allowedWidths and writes it to
+     * `TPI_CSPSR`. When no allowed width is supported, `TPI_CSPSR` is left unchanged.
+     *
+     * @param allowedWidths Widths usable by board (e.g. routed trace data pins), built with @ref TPIU_PORT_WIDTH_MASK
+     * or @ref TPIU_PORT_WIDTHS_ALL
+     * @param traceClock TPIU trace clock (`TRACECLKIN`) in Hz, used only to compute TpiuPortWidthSelection#Bandwidth
+     * @param selection Receives selected width and bandwidth, can be NULL
+     * @return true Width selected and programmed
+     * @return false None of allowed widths is supported
+     */
+    static inline bool TpiuSelectPortWidth(uint32_t allowedWidths, uint32_t traceClock,
+                                           TpiuPortWidthSelection* selection);
+
     /** @} */
 
     void TpiuSetup(const TpiuOptions* options)
@@ -114,16 +169,45 @@ extern "C"
 
         TPI->ACPR = options->SwoPrescaler - 1;
         TPI->SPPR = (int)options->Protocol;
-        TPI->CSPSR = 1 << (options->TracePortWidth - 1);
+        if(options->TracePortWidth == 0)
+        {
+            TpiuSelectPortWidth(TPIU_PORT_WIDTHS_ALL, 0, NULL);
+        }
+        else
+        {
+            TPI->CSPSR = TPIU_PORT_WIDTH_MASK(options->TracePortWidth);
+        }
 
         if(options->FormattingEnabled)
         {
-            TPI->FFCR |= TPI_FFCR_EnFCont_Msk;
+            TPI->FFCR |= ORBCODE_TRACE_TPI_FFCR_ENFCONT_Msk;
         }
         else
         {
-            TPI->FFCR &= ~TPI_FFCR_EnFCont_Msk;
+            TPI->FFCR &= ~ORBCODE_TRACE_TPI_FFCR_ENFCONT_Msk;
+        }
+    }
+
+    bool TpiuSelectPortWidth(uint32_t allowedWidths, uint32_t traceClock, TpiuPortWidthSelection* selection)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable ITM and DWT
+
+        const uint32_t widths = TPI->SSPSR & allowedWidths;
+        if(widths == 0)
+        {
+            return false;
+        }
+
+        const uint8_t width = (uint8_t)(32U - __CLZ(widths));
+        TPI->CSPSR = TPIU_PORT_WIDTH_MASK(width);
+
+        if(selection != NULL)
+        {
+            const uint64_t bandwidth = (uint64_t)traceClock * width / 8U;
+            selection->Width = width;
+            selection->Bandwidth = bandwidth > 0xFFFFFFFFU ? 0xFFFFFFFFU : (uint32_t)bandwidth;
         }
+        return true;
     }
 
 #ifdef __cplusplus
@@ -0,0 +1,263 @@
+/** @file */
+
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dwt.h"
+#include "itm.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @defgroup watch_rotation Watchpoint rotation
+     * @ingroup dwt
+     *
+     * @brief Cycle many memory regions through few DWT comparators to build statistical data-access heatmaps
+     *
+     * DWT has only a handful of comparators (usually 4 on ARMv7-M). Rotation assigns consecutive regions from a list
+     * to available comparators and on each call of TraceWatchRotationStep() (typically from periodic timer interrupt)
+     * moves them to the next regions, wrapping around at the end of the list. Every region is watched for the same
+     * share of time, so access counts collected over many rotations are comparable between regions.
+     *
+     * Every time comparator is reprogrammed, tag word is written to stimulus port TraceWatchRotationOptions#TagPort:
+     * | Bits  | Content |
+     * |-------|---------|
+     * | 0-15  | index of region in TraceWatchRotationOptions#Regions |
+     * | 16-19 | comparator number |
+     * | 24-31 | @ref TRACE_WATCH_TAG_MARKER |
+     *
+     * Host tool `orbcode-trace-heatmap` attributes data trace packets of each comparator to region from last tag and
+     * normalizes access counts by number of rotation steps region was watched for.
+     *
+     * On ARMv7-M each region uses single comparator matching smallest aligned power-of-two block containing the region
+     * (block can be larger than region and catch accesses to neighbouring data, place regions accordingly). Accesses
+     * are reported as data address offset packets. On ARMv8-M each region uses pair of comparators (see
+     * DWTWatchRange()) and accesses are reported as data trace packets with address and/or PC.
+     *
+     * Each watched access generates trace packet, so frequently accessed regions can overflow ITM. Overflows are
+     * reported by host tool.
+     *
+     * @code{.c}
+     * static const TraceWatchRegion Regions[] = {
+     *     {.Address = (uintptr_t)&SharedQueue, .Size = sizeof(SharedQueue)},
+     *     {.Address = (uintptr_t)&MotorState, .Size = sizeof(MotorState)},
+     *     // ...
+     * };
+     *
+     * static TraceWatchRotation Rotation;
+     *
+     * TraceWatchRotationOptions options = {
+     *     .Regions = Regions,
+     *     .RegionCount = sizeof(Regions) / sizeof(Regions[0]),
+     *     .FirstComparator = 0,
+     *     .ComparatorCount = 0, // all implemented comparators
+     *     .TagPort = 29,
+     * };
+     * TraceWatchRotationStart(&Rotation, &options);
+     *
+     * void TIM6_IRQHandler(void)
+     * {
+     *     TraceWatchRotationStep(&Rotation);
+     * }
+     * @endcode
+     *
+     * @{
+     */
+
+/**
+ * @brief Value of bits 24-31 of every rotation tag word
+ */
+#define TRACE_WATCH_TAG_MARKER 0x57UL
+
+    /**
+     * @brief Watched memory region
+     */
+    typedef struct
+    {
+        /**
+         * @brief First byte of region
+         */
+        uintptr_t Address;
+        /**
+         * @brief Size of region in bytes (at least 1)
+         */
+        uint32_t Size;
+    } TraceWatchRegion;
+
+    /**
+     * @brief Rotation configuration
+     */
+    typedef struct
+    {
+        /**
+         * @brief Regions to watch, array must remain valid while rotation is running
+         */
+        const TraceWatchRegion* Regions;
+        /**
+         * @brief Number of regions (up to 65535)
+         */
+        uint16_t RegionCount;
+        /**
+         * @brief First comparator used by rotation
+         */
+        uint8_t FirstComparator;
+        /**
+         * @brief Number of comparators used by rotation, 0 uses all implemented comparators from
+         * TraceWatchRotationOptions#FirstComparator
+         */
+        uint8_t ComparatorCount;
+        /**
+         * @brief Stimulus port receiving tag words
+         */
+        uint8_t TagPort;
+    } TraceWatchRotationOptions;
+
+    /**
+     * @brief Rotation state
+     */
+    typedef struct
+    {
+        /**
+         * @brief Configuration
+         */
+        TraceWatchRotationOptions Options;
+        /**
+         * @brief Number of regions watched at the same time
+         */
+        uint8_t Slots;
+        /**
+         * @brief Index of region assigned to first slot by next step
+         */
+        uint16_t Next;
+    } TraceWatchRotation;
+
+    /**
+     * @brief Starts rotation and assigns first regions to comparators
+     *
+     * DWT and ITM must be configured with data trace forwarding enabled (ITMOptions#ForwardDWT) before.
+     *
+     * @param rotation Rotation state
+     * @param options Configuration (copied)
+     * @return true Rotation started
+     * @return false No regions or no comparators available
+     */
+    static inline bool TraceWatchRotationStart(TraceWatchRotation* rotation, const TraceWatchRotationOptions* options);
+
+    /**
+     * @brief Moves comparators to next regions
+     *
+     * Call periodically, e.g. from timer interrupt. Must not be called concurrently with other rotation functions.
+     *
+     * @param rotation Rotation state
+     */
+    static inline void TraceWatchRotationStep(TraceWatchRotation* rotation);
+
+    /**
+     * @brief Disables comparators used by rotation
+     *
+     * @param rotation Rotation state
+     */
+    static inline void TraceWatchRotationStop(TraceWatchRotation* rotation);
+
+    /** @} */
+
+    // Internal helpers
+
+#if !ORBCODE_TRACE_DWT_V8
+#    define ORBCODE_TRACE_WATCH_COMPARATORS_PER_SLOT 1U
+#else
+#    define ORBCODE_TRACE_WATCH_COMPARATORS_PER_SLOT 2U
+#endif
+
+    static inline void TraceWatchRotationAssign(uint8_t comparator, const TraceWatchRegion* region)
+    {
+        const uintptr_t first = region->Address;
+        const uintptr_t last = region->Address + (region->Size > 0 ? region->Size - 1U : 0U);
+#if !ORBCODE_TRACE_DWT_V8
+        // Smallest aligned power-of-two block containing whole region
+        uint8_t ignoreBits = 0;
+        while(ignoreBits < 31U && (first >> ignoreBits) != (last >> ignoreBits))
+        {
+            ignoreBits++;
+        }
+        DWTEnableComparator(comparator, first, ignoreBits, true, 0x1);
+#else
+        DWTWatchRange(comparator, first, last, DWTMatchDataAddress, DWTActionTraceData);
+#endif
+    }
+
+    bool TraceWatchRotationStart(TraceWatchRotation* rotation, const TraceWatchRotationOptions* options)
+    {
+        rotation->Options = *options;
+        rotation->Slots = 0;
+        rotation->Next = 0;
+
+        const uint8_t implemented = DWTComparatorCount();
+        if(options->Regions == NULL || options->RegionCount == 0 || options->FirstComparator >= implemented)
+        {
+            return false;
+        }
+
+        uint8_t comparators = (uint8_t)(implemented - options->FirstComparator);
+        if(options->ComparatorCount != 0 && options->ComparatorCount < comparators)
+        {
+            comparators = options->ComparatorCount;
+        }
+
+        uint32_t slots = comparators / ORBCODE_TRACE_WATCH_COMPARATORS_PER_SLOT;
+        slots = slots > options->RegionCount ? options->RegionCount : slots;
+        if(slots == 0)
+        {
+            return false;
+        }
+
+        rotation->Slots = (uint8_t)slots;
+        TraceWatchRotationStep(rotation);
+        return true;
+    }
+
+    void TraceWatchRotationStep(TraceWatchRotation* rotation)
+    {
+        const TraceWatchRotationOptions* options = &rotation->Options;
+        uint32_t index = rotation->Next;
+
+        for(uint8_t slot = 0; slot < rotation->Slots; slot++)
+        {
+            const uint8_t comparator =
+                (uint8_t)(options->FirstComparator + slot * ORBCODE_TRACE_WATCH_COMPARATORS_PER_SLOT);
+
+            // Tag is written between disabling and enabling comparator so that every data trace packet of
+            // comparator follows tag of its region
+            DWTDisableComparator(comparator);
+            ITM_WRITE32(options->TagPort, (TRACE_WATCH_TAG_MARKER << 24) | ((uint32_t)(comparator & 0xFU) << 16) |
+                                              index);
+            TraceWatchRotationAssign(comparator, &options->Regions[index]);
+
+            index = index + 1U >= options->RegionCount ? 0U : index + 1U;
+        }
+
+        rotation->Next = (uint16_t)index;
+    }
+
+    void TraceWatchRotationStop(TraceWatchRotation* rotation)
+    {
+        for(uint8_t slot = 0; slot < rotation->Slots; slot++)
+        {
+            const uint8_t comparator =
+                (uint8_t)(rotation->Options.FirstComparator + slot * ORBCODE_TRACE_WATCH_COMPARATORS_PER_SLOT);
+            for(uint8_t i = 0; i < ORBCODE_TRACE_WATCH_COMPARATORS_PER_SLOT; i++)
+            {
+                DWTDisableComparator((uint8_t)(comparator + i));
+            }
+        }
+        rotation->Slots = 0;
+    }
+
+#ifdef __cplusplus
+}
+#endif
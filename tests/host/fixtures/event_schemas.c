@@ -0,0 +1,30 @@
+// Schema records laid out the same way as TRACE_EVENT_DEFINE does, used by event_test
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t Timestamp;
+    int16_t Current[3];
+    char Phase[2];
+} Motor;
+
+typedef struct
+{
+    uint8_t State;
+    double Level;
+} Tank;
+
+__attribute__((section(".orbcode_trace_evt"), used, aligned(4))) static const struct
+{
+    uint32_t Size;
+    char Name[sizeof("Motor")];
+    char Fields[sizeof("u32 timestamp; i16 current[3]; char phase[2]")];
+} MotorSchema = {sizeof(Motor), "Motor", "u32 timestamp; i16 current[3]; char phase[2]"};
+
+__attribute__((section(".orbcode_trace_evt"), used, aligned(4))) static const struct
+{
+    uint32_t Size;
+    char Name[sizeof("Tank")];
+    char Fields[sizeof("u8 state; f64 level")];
+} TankSchema = {sizeof(Tank), "Tank", "u8 state; f64 level"};
@@ -0,0 +1,4 @@
+// Format strings placed the same way as TRACE_LOG does, used by elf_test
+
+__attribute__((section(".orbcode_trace_fmt"), used)) static const char First[] = "first %d";
+__attribute__((section(".orbcode_trace_fmt"), used)) static const char Second[] = "second %s";
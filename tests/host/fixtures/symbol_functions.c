@@ -0,0 +1,22 @@
+// Functions at known source lines, built with debug information and symbolized by symbols_test
+
+volatile int FixtureSink;
+
+int FixtureSquare(int value)
+{
+    return value * value;
+}
+
+void FixtureLoop(int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        FixtureSink += FixtureSquare(i);
+    }
+}
+
+int main(void)
+{
+    FixtureLoop(3);
+    return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Minimal assertion helpers for host tests
+
+#define CHECK(condition)                                                                      \
+    do                                                                                        \
+    {                                                                                         \
+        if(!(condition))                                                                      \
+        {                                                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                                     \
+        }                                                                                     \
+    } while(0)
+
+#define CHECK_EQ(actual, expected)                                                                               \
+    do                                                                                                           \
+    {                                                                                                            \
+        if(!((actual) == (expected)))                                                                            \
+        {                                                                                                        \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed\n", __FILE__, __LINE__, #actual, #expected); \
+            std::exit(1);                                                                                        \
+        }                                                                                                        \
+    } while(0)
+
+// Appends word in stimulus port byte order (little-endian), for building streams of 32-bit records
+inline void pushWord(std::vector<uint8_t>& stream, uint32_t word)
+{
+    for(int i = 0; i < 4; i++)
+    {
+        stream.push_back(static_cast<uint8_t>(word >> (8 * i)));
+    }
+}
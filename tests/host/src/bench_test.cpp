@@ -0,0 +1,116 @@
+#include <cstring>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/bench.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    // Same layout as TraceBenchReport()
+    void pushResult(std::vector<uint8_t>& stream, const char* name, uint32_t median, bool counters,
+                    const std::vector<BenchPmuCounter>& pmu = {}, uint8_t version = BenchVersion)
+    {
+        const size_t length = std::strlen(name);
+        pushWord(stream, BenchMagic);
+        pushWord(stream, version | (static_cast<uint32_t>(length) << 8) | (counters ? 1U << 16 : 0U) |
+                             (static_cast<uint32_t>(pmu.size()) << 24));
+        pushWord(stream, 32);
+        pushWord(stream, median - 2);
+        pushWord(stream, median);
+        pushWord(stream, median + 40);
+        pushWord(stream, counters ? 17 : 0);
+        pushWord(stream, counters ? 5 : 0);
+        for(const BenchPmuCounter& counter : pmu)
+        {
+            pushWord(stream, counter.Event);
+            pushWord(stream, counter.Sum);
+        }
+        for(size_t i = 0; i < length; i += 4)
+        {
+            uint32_t word = 0;
+            for(size_t j = 0; j < 4 && i + j < length; j++)
+            {
+                word |= static_cast<uint32_t>(static_cast<uint8_t>(name[i + j])) << (8 * j);
+            }
+            pushWord(stream, word);
+        }
+    }
+}
+
+int main()
+{
+    // Garbage before first record, record with unsupported version, truncated record
+    std::vector<uint8_t> stream = {0x42, 0x4E, 0x43};
+    pushResult(stream, "ITMWrite32", 12, true);
+    pushWord(stream, BenchMagic);
+    pushWord(stream, 7);
+    pushResult(stream, "ITMWriteBuffer/16/+1", 85, false);
+    pushResult(stream, "", 3, false);
+    pushResult(stream, "V1", 20, true, {}, 1);
+    pushResult(stream, "FIR/MVE", 900, true, {{0x0003, 12}, {0x02CC, 340}});
+    pushWord(stream, BenchMagic);
+    pushWord(stream, BenchVersion | (8 << 8));
+
+    std::vector<BenchResult> results;
+    BenchDecoder decoder([&results](const BenchResult& result) { results.push_back(result); });
+    for(uint8_t byte : stream)
+    {
+        decoder.feed(&byte, 1);
+    }
+
+    CHECK_EQ(results.size(), 5U);
+    CHECK(results[0].Name == "ITMWrite32");
+    CHECK_EQ(results[0].Runs, 32U);
+    CHECK_EQ(results[0].Min, 10U);
+    CHECK_EQ(results[0].Median, 12U);
+    CHECK_EQ(results[0].Max, 52U);
+    CHECK(results[0].Counters);
+    CHECK_EQ(results[0].CPI, 17U);
+    CHECK_EQ(results[0].LSU, 5U);
+
+    CHECK(results[1].Name == "ITMWriteBuffer/16/+1");
+    CHECK_EQ(results[1].Median, 85U);
+    CHECK(!results[1].Counters);
+
+    CHECK(results[2].Name.empty());
+    CHECK_EQ(results[2].Median, 3U);
+
+    // Version 1 record has no PMU counters
+    CHECK(results[3].Name == "V1");
+    CHECK_EQ(results[3].LSU, 5U);
+    CHECK(results[3].Pmu.empty());
+
+    CHECK(results[4].Name == "FIR/MVE");
+    CHECK_EQ(results[4].Median, 900U);
+    CHECK_EQ(results[4].Pmu.size(), 2U);
+    CHECK_EQ(results[4].Pmu[0].Event, 0x0003U);
+    CHECK_EQ(results[4].Pmu[0].Sum, 12U);
+    CHECK_EQ(results[4].Pmu[1].Event, 0x02CCU);
+    CHECK_EQ(results[4].Pmu[1].Sum, 340U);
+
+    // Records abandoned by target in header, PMU counters and name are discarded, following ones are decoded
+    std::vector<uint8_t> truncated;
+    pushResult(truncated, "Abandoned", 40, true);
+    stream.assign(truncated.begin(), truncated.begin() + 5 * 4);
+    pushResult(stream, "First", 50, false);
+    truncated.clear();
+    pushResult(truncated, "PMU", 60, true, {{0x0003, 12}, {0x02CC, 340}});
+    stream.insert(stream.end(), truncated.begin(), truncated.begin() + 10 * 4);
+    truncated.clear();
+    pushResult(truncated, "LongName/Abandoned", 70, true);
+    stream.insert(stream.end(), truncated.begin(), truncated.end() - 4);
+    pushResult(stream, "Second", 80, true, {{0x0003, 12}});
+
+    results.clear();
+    decoder.feed(stream.data(), stream.size());
+    CHECK_EQ(results.size(), 2U);
+    CHECK(results[0].Name == "First");
+    CHECK_EQ(results[0].Median, 50U);
+    CHECK(results[1].Name == "Second");
+    CHECK_EQ(results[1].Median, 80U);
+    CHECK_EQ(results[1].Pmu.size(), 1U);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/delta.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    // Same encoding as TraceDeltaEncode()
+    struct Encoder
+    {
+        uint8_t Stream;
+        uint8_t Channels;
+        uint16_t KeyInterval;
+        uint8_t Sequence = 0;
+        uint16_t UntilKey = 0;
+        uint32_t Previous[DeltaMaxChannels] = {};
+
+        std::vector<uint8_t> encode(const std::vector<int32_t>& samples)
+        {
+            const bool key = UntilKey == 0;
+            if(key)
+            {
+                UntilKey = KeyInterval == 0 ? 1 : static_cast<uint16_t>(KeyInterval - 1);
+            }
+            else if(KeyInterval != 0)
+            {
+                UntilKey--;
+            }
+
+            std::vector<uint8_t> record = {
+                static_cast<uint8_t>((Channels - 1) | (Stream << 4) | (key ? DeltaFlagKey : 0)), Sequence++};
+            for(size_t i = 0; i < Channels; i++)
+            {
+                const uint32_t sample = static_cast<uint32_t>(samples[i]);
+                const uint32_t delta = sample - (key ? 0U : Previous[i]);
+                Previous[i] = sample;
+
+                uint32_t zigzag = (delta << 1) ^ (0U - (delta >> 31));
+                while(zigzag >= 0x80)
+                {
+                    record.push_back(static_cast<uint8_t>(zigzag | 0x80));
+                    zigzag >>= 7;
+                }
+                record.push_back(static_cast<uint8_t>(zigzag));
+            }
+            return record;
+        }
+    };
+
+    void append(std::vector<uint8_t>& stream, const std::vector<uint8_t>& record)
+    {
+        stream.insert(stream.end(), record.begin(), record.end());
+    }
+}
+
+int main()
+{
+    // Slowly changing telemetry, round trip and compression ratio
+    {
+        Encoder encoder{0, 8, 64};
+        std::vector<std::vector<int32_t>> sent;
+        std::vector<uint8_t> stream;
+        std::vector<int32_t> samples = {2048, -1000, 0, 16000, -32000, 123456, 7, 100};
+        uint32_t seed = 1;
+        for(int i = 0; i < 1000; i++)
+        {
+            for(int32_t& sample : samples)
+            {
+                seed = seed * 1103515245U + 12345U;
+                sample += static_cast<int32_t>((seed >> 16) % 61) - 30;
+            }
+            sent.push_back(samples);
+            append(stream, encoder.encode(samples));
+        }
+        // Extremes survive wrap-around of differences
+        sent.push_back({INT32_MIN, INT32_MAX, -1, 0, INT32_MAX, INT32_MIN, 1, 2});
+        append(stream, encoder.encode(sent.back()));
+
+        // At least 3x smaller than raw 32-bit samples
+        CHECK(stream.size() * 3 < sent.size() * 8 * 4);
+
+        std::vector<std::vector<int32_t>> received;
+        DeltaDecoder decoder([&received](const DeltaRecord& record) { received.push_back(record.Samples); });
+        for(size_t offset = 0; offset < stream.size(); offset += 7)
+        {
+            decoder.feed(stream.data() + offset, std::min<size_t>(7, stream.size() - offset));
+        }
+        CHECK(received == sent);
+        CHECK_EQ(decoder.statistics().Records, uint64_t{1001});
+        CHECK_EQ(decoder.statistics().Errors, uint64_t{0});
+    }
+
+    // Lost record stops stream until next key record, other streams are unaffected
+    {
+        Encoder a{1, 2, 4};
+        Encoder b{5, 1, 0};
+        std::vector<uint8_t> stream;
+        for(int i = 0; i < 10; i++)
+        {
+            const std::vector<uint8_t> record = a.encode({i, -i});
+            if(i != 2)
+            {
+                append(stream, record);
+            }
+            append(stream, b.encode({100 + i}));
+        }
+
+        std::vector<DeltaRecord> records;
+        DeltaDecoder decoder([&records](const DeltaRecord& record) { records.push_back(record); });
+        decoder.feed(stream.data(), stream.size());
+
+        std::vector<int32_t> streamA;
+        std::vector<int32_t> streamB;
+        for(const DeltaRecord& record : records)
+        {
+            (record.Stream == 1 ? streamA : streamB).push_back(record.Samples[0]);
+        }
+        CHECK((streamA == std::vector<int32_t>{0, 1, 4, 5, 6, 7, 8, 9}));
+        CHECK_EQ(streamB.size(), size_t{10});
+        CHECK_EQ(streamB.back(), 109);
+        CHECK(records[0].Key);
+        CHECK_EQ(decoder.statistics().Lost, uint64_t{1});
+        CHECK_EQ(decoder.statistics().Skipped, uint64_t{1});
+    }
+
+    // Decoding starts at first key record, malformed varint is reported
+    {
+        Encoder encoder{0, 1, 3};
+        encoder.encode({1});
+        std::vector<uint8_t> stream = encoder.encode({2});
+        append(stream, encoder.encode({3}));
+        append(stream, encoder.encode({4}));
+        append(stream, {0x00, 0x04, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF});
+
+        std::vector<int32_t> samples;
+        DeltaDecoder decoder([&samples](const DeltaRecord& record) { samples.push_back(record.Samples[0]); });
+        decoder.feed(stream.data(), stream.size());
+        CHECK((samples == std::vector<int32_t>{4}));
+        CHECK_EQ(decoder.statistics().Skipped, uint64_t{2});
+        CHECK_EQ(decoder.statistics().Errors, uint64_t{1});
+    }
+
+    return 0;
+}
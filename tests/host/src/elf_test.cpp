@@ -0,0 +1,37 @@
+#include <string>
+
+#include "check.hpp"
+#include "orbcode/decoder/elf.hpp"
+#include "orbcode/decoder/log.hpp"
+
+using namespace orbcode::decoder;
+
+int main(int argc, char** argv)
+{
+    CHECK(argc == 2);
+
+    const ElfFile elf = ElfFile::load(argv[1]);
+    const ElfSection* section = elf.findSection(".orbcode_trace_fmt");
+    CHECK(section != nullptr);
+
+    const LogFormatTable formats = LogFormatTable::fromElf(elf);
+    CHECK_EQ(formats.size(), 2U);
+
+    // Relocatable object: section starts at address 0, order of strings is up to compiler
+    const std::string* first = formats.find(0);
+    CHECK(first != nullptr);
+    CHECK(*first == "first %d" || *first == "second %s");
+
+    bool threw = false;
+    try
+    {
+        ElfFile::parse({'n', 'o', 't', ' ', 'e', 'l', 'f'});
+    }
+    catch(const ElfError&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/event.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void appendWord(std::vector<uint8_t>& out, uint32_t word)
+    {
+        for(unsigned i = 0; i < 4; i++)
+        {
+            out.push_back(static_cast<uint8_t>(word >> (8 * i)));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    CHECK(argc == 2);
+
+    // Layout with natural alignment and trailing padding
+    const EventSchema motor = parseEventSchema("Motor", 12, "u32 timestamp; i16 current[3];char phase[2] ;");
+    CHECK(motor.valid());
+    CHECK_EQ(motor.Fields.size(), 3U);
+    CHECK_EQ(motor.Fields[1].Offset, 4U);
+    CHECK_EQ(motor.Fields[1].Count, 3U);
+    CHECK_EQ(motor.Fields[2].Offset, 10U);
+    CHECK(eventCsvHeader(motor) == "timestamp,current[0],current[1],current[2],phase");
+
+    CHECK(parseEventSchema("Padded", 16, "u8 state; f64 level").valid());
+    CHECK(!parseEventSchema("Packed", 9, "u8 state; f64 level").valid());
+    CHECK(!parseEventSchema("Bad", 4, "float value").valid());
+    CHECK(!parseEventSchema("Bad", 4, "u8 value[x]").valid());
+    CHECK(!parseEventSchema("Bad", 4, "").valid());
+
+    // Records placed by fixture, relocatable object has section at address 0
+    const ElfFile elf = ElfFile::load(argv[1]);
+    const EventSchemaTable fromElf = EventSchemaTable::fromElf(elf);
+    CHECK_EQ(fromElf.size(), 2U);
+    for(const auto& entry : fromElf.schemas())
+    {
+        CHECK(entry.second.valid());
+        CHECK(entry.second.Name == "Motor" || entry.second.Name == "Tank");
+    }
+
+    EventSchemaTable table;
+    table.add(0x40, motor);
+
+    std::vector<uint8_t> stream;
+    appendWord(stream, 0x40 | (12U << EventSizePos));
+    appendWord(stream, 123456);
+    for(int16_t current : {-5, 300, 0})
+    {
+        stream.push_back(static_cast<uint8_t>(current));
+        stream.push_back(static_cast<uint8_t>(static_cast<uint16_t>(current) >> 8));
+    }
+    stream.push_back('A');
+    stream.push_back(0);
+
+    // Unknown schema is skipped using size from header
+    appendWord(stream, 0x80 | (3U << EventSizePos));
+    stream.insert(stream.end(), {1, 2, 3});
+
+    // Size differs from schema
+    appendWord(stream, 0x40 | (4U << EventSizePos));
+    appendWord(stream, 0);
+
+    std::vector<std::string> rows;
+    EventDecoder decoder(table, [&rows](const Event& event) {
+        if(event.Schema != nullptr)
+        {
+            rows.push_back(formatEventCsv(*event.Schema, event.Data.data()));
+        }
+    });
+
+    // Byte by byte, data can be split at any point
+    for(uint8_t byte : stream)
+    {
+        decoder.feed(&byte, 1);
+    }
+
+    CHECK_EQ(rows.size(), 1U);
+    CHECK(rows[0] == "123456,-5,300,0,\"A\"");
+    CHECK_EQ(decoder.statistics().Events, 1U);
+    CHECK_EQ(decoder.statistics().Unknown, 1U);
+    CHECK_EQ(decoder.statistics().Mismatched, 1U);
+
+    // Partial event discarded by reset
+    decoder.reset();
+    decoder.feed(stream.data(), 6);
+    decoder.reset();
+    decoder.feed(stream.data(), 16);
+    CHECK_EQ(rows.size(), 2U);
+    CHECK(rows[1] == rows[0]);
+
+    return 0;
+}
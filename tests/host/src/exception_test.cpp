@@ -0,0 +1,83 @@
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/exception.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void pushTimestamp(std::vector<uint8_t>& stream, uint8_t delta)
+    {
+        stream.push_back(0xC0);
+        stream.push_back(delta);
+    }
+
+    void pushException(std::vector<uint8_t>& stream, uint16_t exception, uint8_t function)
+    {
+        stream.push_back(0x0E);
+        stream.push_back(static_cast<uint8_t>(exception));
+        stream.push_back(static_cast<uint8_t>((exception >> 8) | (function << 4)));
+    }
+
+    void pushMarker(std::vector<uint8_t>& stream, uint16_t exception)
+    {
+        stream.push_back((ExceptionMarkPort << 3) | 0x02);
+        stream.push_back(static_cast<uint8_t>(exception));
+        stream.push_back(static_cast<uint8_t>(exception >> 8));
+    }
+}
+
+int main()
+{
+    std::vector<uint8_t> stream;
+    pushMarker(stream, 21);
+    pushTimestamp(stream, 10);
+    pushException(stream, 21, ExceptionFunctionEnter);
+    pushTimestamp(stream, 20);
+    pushException(stream, 15, ExceptionFunctionEnter); // SysTick preempts IRQ 5
+    pushTimestamp(stream, 10);
+    pushException(stream, 15, ExceptionFunctionExit);
+    pushException(stream, 21, ExceptionFunctionReturn);
+    pushTimestamp(stream, 10);
+    pushException(stream, 21, ExceptionFunctionExit);
+    pushException(stream, 14, ExceptionFunctionEnter); // PendSV tail-chained
+    pushTimestamp(stream, 30);
+    pushException(stream, 14, ExceptionFunctionExit);
+    pushException(stream, 0, ExceptionFunctionReturn);
+    pushTimestamp(stream, 10);
+    stream.push_back(0x70);
+    pushException(stream, 21, ExceptionFunctionExit); // Entry lost in overflow
+    pushTimestamp(stream, 10);
+
+    ExceptionAnalyzer analyzer;
+    ItmPacketDecoder decoder([&analyzer](const ItmPacket& packet) { analyzer.add(packet); }, true);
+    decoder.feed(stream.data(), stream.size());
+
+    const auto& exceptions = analyzer.exceptions();
+    CHECK_EQ(exceptions.size(), 3u);
+    CHECK_EQ(analyzer.overflows(), 1u);
+
+    const ExceptionStatistics& irq = exceptions.at(21);
+    CHECK_EQ(irq.Entries, 1u);
+    CHECK_EQ(irq.Preempted, 1u);
+    CHECK_EQ(irq.MaxDepth, 1u);
+    CHECK_EQ(irq.Duration.Count, 1u);
+    CHECK_EQ(irq.Duration.Max, 50u);
+    CHECK_EQ(irq.Self.Max, 40u);
+    CHECK_EQ(irq.Latency.Count, 1u);
+    CHECK_EQ(irq.Latency.Max, 20u);
+
+    const ExceptionStatistics& systick = exceptions.at(15);
+    CHECK_EQ(systick.Preempting, 1u);
+    CHECK_EQ(systick.MaxDepth, 2u);
+    CHECK_EQ(systick.Duration.Max, 10u);
+    CHECK_EQ(systick.Latency.Count, 0u);
+
+    const ExceptionStatistics& pendsv = exceptions.at(14);
+    CHECK_EQ(pendsv.TailChained, 1u);
+    CHECK_EQ(pendsv.Preempting, 0u);
+    CHECK_EQ(pendsv.Duration.Max, 10u);
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include "orbcode/sim/device.hpp"
+
+#define ORBCODE_TRACE_LOG_WRITE(port, data, size) TraceFlightRecorderWrite(&Recorder, (port), (data), (size))
+#define ORBCODE_TRACE_EVENT_WRITE(port, header, event, size) \
+    TraceFlightRecorderWriteEvent(&Recorder, (port), (header), (event), (size))
+#include "orbcode/trace/flight_recorder.h"
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/log.h"
+
+#include <cstring>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/event.hpp"
+
+using orbcode::sim::Device;
+
+namespace
+{
+    TraceFlightRecorder Recorder;
+    uint32_t Storage[16];
+
+    struct Sample
+    {
+        uint16_t Current;
+        uint8_t State;
+    };
+
+    TRACE_EVENT_DEFINE(Sample, "u16 current; u8 state");
+
+    struct Dumped
+    {
+        uint8_t Port;
+        std::vector<uint8_t> Data;
+    };
+
+    void collect(uint8_t port, const void* data, size_t size, void* context)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        static_cast<std::vector<Dumped>*>(context)->push_back(Dumped{port, std::vector<uint8_t>(bytes, bytes + size)});
+    }
+
+    std::vector<Dumped> dump(size_t count)
+    {
+        std::vector<Dumped> dumped;
+        const size_t records = TraceFlightRecorderDump(&Recorder, 31, count, collect, &dumped);
+        CHECK_EQ(records + (TraceFlightRecorderIsFrozen(&Recorder) ? 1U : 0U), dumped.size());
+        return dumped;
+    }
+
+    uint32_t word(const std::vector<uint8_t>& data, size_t index)
+    {
+        uint32_t value;
+        std::memcpy(&value, data.data() + 4 * index, sizeof(value));
+        return value;
+    }
+}
+
+int main()
+{
+    Device.reset();
+    Device.capture(true);
+    ITMOptions itm = {};
+    itm.EnabledStimulusPorts = ITM_ENABLE_STIMULUS_PORTS_ALL;
+    ITMSetup(&itm);
+
+    // Cold boot: retained memory holds garbage
+    std::memset(&Recorder, 0xA5, sizeof(Recorder));
+    std::memset(Storage, 0x5A, sizeof(Storage));
+    CHECK(!TraceFlightRecorderInit(&Recorder, Storage, sizeof(Storage)));
+    CHECK_EQ(Recorder.Records, 0U);
+    CHECK(dump(SIZE_MAX).empty());
+
+    // 12-byte records, 5 fit in 64 bytes, later ones wrap and overwrite oldest, nothing sent to ITM
+    for(uint32_t i = 0; i < 12; i++)
+    {
+        TRACE_LOG(1, "value %u", i);
+    }
+    CHECK_EQ(Device.statistics().Bytes, 0U);
+    CHECK_EQ(Recorder.Records, 5U);
+    CHECK_EQ(Recorder.Overwritten, 7U);
+
+    std::vector<Dumped> dumped = dump(3);
+    CHECK_EQ(dumped.size(), 3U);
+    for(uint32_t i = 0; i < 3; i++)
+    {
+        CHECK_EQ(dumped[i].Port, 1U);
+        CHECK_EQ(dumped[i].Data.size(), 8U);
+        CHECK_EQ(word(dumped[i].Data, 0) >> TRACE_LOG_ARGC_POS, 1U);
+        CHECK_EQ(word(dumped[i].Data, 1), 9U + i);
+    }
+    CHECK_EQ(dump(SIZE_MAX).size(), 5U);
+
+    // Event header and struct kept as one record
+    const Sample sample = {1200, 3};
+    TRACE_EVENT(4, Sample, &sample);
+    dumped = dump(1);
+    CHECK_EQ(dumped.size(), 1U);
+    CHECK_EQ(dumped[0].Port, 4U);
+    CHECK_EQ(dumped[0].Data.size(), 4U + sizeof(Sample));
+    CHECK_EQ(word(dumped[0].Data, 0), TraceEventHeader(&orbcodeTraceEventSchema_Sample, sizeof(Sample)));
+    CHECK(std::memcmp(dumped[0].Data.data() + 4, &sample, sizeof(Sample)) == 0);
+
+    const uint8_t large[64] = {};
+    CHECK(!TraceFlightRecorderWrite(&Recorder, 2, large, sizeof(large)));
+    CHECK(TraceFlightRecorderWrite(&Recorder, 2, large, sizeof(large) - 4));
+    CHECK_EQ(Recorder.Records, 1U);
+    CHECK(TraceFlightRecorderWrite(&Recorder, 2, nullptr, 0));
+    CHECK_EQ(Recorder.Records, 1U);
+    CHECK_EQ(dump(SIZE_MAX)[0].Data.size(), 0U);
+    TRACE_LOG(1, "value %u", 20U);
+    TRACE_LOG(1, "value %u", 21U);
+
+    // Fault: snapshot of counters, first reason kept, later writes rejected
+    Device.Dwt.CYCCNT = 123456;
+    Device.Dwt.CPICNT = 0x105;
+    Device.Dwt.FOLDCNT = 7;
+    TraceFlightRecorderFreeze(&Recorder, 0x8200);
+    TraceFlightRecorderFreeze(&Recorder, 1);
+    CHECK(TraceFlightRecorderIsFrozen(&Recorder));
+    TRACE_LOG(1, "after fault");
+    CHECK_EQ(Recorder.Records, 3U);
+
+    const orbcode::decoder::EventSchema schema =
+        orbcode::decoder::parseEventSchema("TraceFlightRecorderSnapshot", sizeof(TraceFlightRecorderSnapshot),
+                                           orbcodeTraceEventSchema_TraceFlightRecorderSnapshot.Fields);
+    CHECK(schema.valid());
+
+    dumped = dump(2);
+    CHECK_EQ(dumped.size(), 3U);
+    CHECK_EQ(dumped[0].Port, 31U);
+    CHECK_EQ(dumped[0].Data.size(), 4U + sizeof(TraceFlightRecorderSnapshot));
+    CHECK_EQ(word(dumped[0].Data, 0), TraceEventHeader(&orbcodeTraceEventSchema_TraceFlightRecorderSnapshot,
+                                                       sizeof(TraceFlightRecorderSnapshot)));
+    TraceFlightRecorderSnapshot snapshot;
+    std::memcpy(&snapshot, dumped[0].Data.data() + 4, sizeof(snapshot));
+    CHECK_EQ(snapshot.Reason, 0x8200U);
+    CHECK_EQ(snapshot.Cycles, 123456U);
+    CHECK_EQ(snapshot.CPI, 5U);
+    CHECK_EQ(snapshot.Folded, 7U);
+    CHECK_EQ(snapshot.Records, 3U);
+    CHECK_EQ(snapshot.Overwritten, 14U);
+    CHECK_EQ(snapshot.Dropped, 1U);
+    CHECK_EQ(snapshot.Resets, 0U);
+    CHECK_EQ(word(dumped[1].Data, 1), 20U);
+    CHECK_EQ(word(dumped[2].Data, 1), 21U);
+
+    // Warm reset keeps records and frozen state, dump over ITM sends records on their ports
+    CHECK(TraceFlightRecorderInit(&Recorder, Storage, sizeof(Storage)));
+    CHECK_EQ(Recorder.Resets, 1U);
+    CHECK(TraceFlightRecorderIsFrozen(&Recorder));
+    CHECK_EQ(TraceFlightRecorderDump(&Recorder, 31, SIZE_MAX, TraceFlightRecorderItmSink, nullptr), 3U);
+    CHECK_EQ(Device.output(31).size(), 4U + sizeof(TraceFlightRecorderSnapshot));
+    CHECK(Device.output(2).empty());
+    CHECK_EQ(Device.output(1).size(), 16U);
+    CHECK(std::memcmp(Device.output(1).data() + 8, dumped[2].Data.data(), 8) == 0);
+
+    TraceFlightRecorderResume(&Recorder);
+    TRACE_LOG(1, "value %u", 22U);
+    CHECK_EQ(Recorder.Records, 4U);
+    CHECK(dump(SIZE_MAX).size() == 4U);
+
+    // Warm reset without fault keeps recording
+    CHECK(TraceFlightRecorderInit(&Recorder, Storage, sizeof(Storage)));
+    CHECK_EQ(Recorder.Resets, 2U);
+    CHECK(!TraceFlightRecorderIsFrozen(&Recorder));
+    TraceFlightRecorderClear(&Recorder);
+    CHECK_EQ(Recorder.Records, 0U);
+    CHECK_EQ(Recorder.Resets, 2U);
+
+    // Corrupted record or different storage discard retained state
+    TRACE_LOG(1, "value %u", 23U);
+    TRACE_LOG(1, "value %u", 24U);
+    CHECK(TraceFlightRecorderInit(&Recorder, Storage, sizeof(Storage)));
+    reinterpret_cast<uint8_t*>(Storage)[12 + 3] = 0;
+    CHECK(!TraceFlightRecorderInit(&Recorder, Storage, sizeof(Storage)));
+    CHECK_EQ(Recorder.Records, 0U);
+    CHECK_EQ(Recorder.Resets, 0U);
+    TRACE_LOG(1, "value %u", 25U);
+    CHECK(!TraceFlightRecorderInit(&Recorder, Storage, sizeof(Storage) - 4));
+
+    return 0;
+}
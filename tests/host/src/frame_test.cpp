@@ -0,0 +1,121 @@
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/frame.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    using Bytes = std::vector<uint8_t>;
+
+    Bytes encode(const Bytes& message, bool crc)
+    {
+        return encodeFrame(message.data(), message.size(), crc);
+    }
+}
+
+int main()
+{
+    const std::string check = "123456789";
+    CHECK_EQ(frameCrc8(reinterpret_cast<const uint8_t*>(check.data()), check.size()), 0xF4);
+
+    // Reference COBS vectors
+    CHECK(encode({}, false) == (Bytes{0x01, 0x00}));
+    CHECK(encode({0x00}, false) == (Bytes{0x01, 0x01, 0x00}));
+    CHECK(encode({0x11, 0x22, 0x00, 0x33}, false) == (Bytes{0x03, 0x11, 0x22, 0x02, 0x33, 0x00}));
+    CHECK(encode({0x11, 0x00, 0x00, 0x00}, false) == (Bytes{0x02, 0x11, 0x01, 0x01, 0x01, 0x00}));
+
+    Bytes run254(254);
+    for(size_t i = 0; i < run254.size(); i++)
+    {
+        run254[i] = static_cast<uint8_t>(i + 1);
+    }
+    Bytes expected254{0xFF};
+    expected254.insert(expected254.end(), run254.begin(), run254.end());
+    expected254.push_back(0x00);
+    CHECK(encode(run254, false) == expected254);
+
+    Bytes run255 = run254;
+    run255.push_back(0xFF);
+    const Bytes encoded255 = encode(run255, false);
+    CHECK_EQ(encoded255.size(), 258U);
+    CHECK_EQ(encoded255[255], 0x02);
+    CHECK_EQ(encoded255[256], 0xFF);
+
+    const std::vector<Bytes> messages = {{}, {0x00}, {0x01, 0x02, 0x03}, run254, run255, {0x00, 0x00, 0x07}, {0x10, 0x00}};
+
+    for(bool crc : {false, true})
+    {
+        Bytes stream;
+        for(const auto& message : messages)
+        {
+            const Bytes frame = encode(message, crc);
+            stream.insert(stream.end(), frame.begin(), frame.end());
+        }
+
+        // Byte-by-byte feeding decodes every message
+        std::vector<Bytes> decoded;
+        FrameDecoder decoder([&decoded](const uint8_t* data, size_t size) { decoded.emplace_back(data, data + size); },
+                             crc);
+        for(uint8_t byte : stream)
+        {
+            decoder.feed(&byte, 1);
+        }
+        CHECK(decoded == messages);
+        CHECK_EQ(decoder.statistics().Errors, 0U);
+    }
+
+    // Lost byte damages only its own frame
+    {
+        Bytes stream;
+        for(const auto& message : messages)
+        {
+            const Bytes frame = encode(message, true);
+            stream.insert(stream.end(), frame.begin(), frame.end());
+        }
+        const Bytes firstFrame = encode(messages[0], true);
+        const Bytes secondFrame = encode(messages[1], true);
+        stream.erase(stream.begin() + static_cast<long>(firstFrame.size() + secondFrame.size() + 2));
+
+        std::vector<Bytes> decoded;
+        FrameDecoder decoder([&decoded](const uint8_t* data, size_t size) { decoded.emplace_back(data, data + size); });
+        decoder.feed(stream.data(), stream.size());
+        CHECK_EQ(decoder.statistics().Errors, 1U);
+        CHECK_EQ(decoded.size(), messages.size() - 1);
+        CHECK(decoded[0] == messages[0]);
+        CHECK(decoded[1] == messages[1]);
+        CHECK(decoded[2] == messages[3]);
+    }
+
+    // Late attach: reset() skips partial frame
+    {
+        const Bytes frame = encode({0x41, 0x42}, false);
+        Bytes stream(frame.begin() + 1, frame.end());
+        stream.insert(stream.end(), frame.begin(), frame.end());
+
+        std::vector<Bytes> decoded;
+        FrameDecoder decoder([&decoded](const uint8_t* data, size_t size) { decoded.emplace_back(data, data + size); },
+                             false);
+        decoder.reset();
+        decoder.feed(stream.data(), stream.size());
+        CHECK_EQ(decoded.size(), 1U);
+        CHECK(decoded[0] == (Bytes{0x41, 0x42}));
+        CHECK_EQ(decoder.statistics().SkippedBytes, frame.size() - 1);
+    }
+
+    // Oversized frame is dropped
+    {
+        size_t frames = 0;
+        FrameDecoder decoder([&frames](const uint8_t*, size_t) { frames++; }, false, 8);
+        const Bytes big = encode(Bytes(32, 0x55), false);
+        const Bytes small = encode({0x01}, false);
+        decoder.feed(big.data(), big.size());
+        decoder.feed(small.data(), small.size());
+        CHECK_EQ(frames, 1U);
+        CHECK_EQ(decoder.statistics().Errors, 1U);
+    }
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Funnel registers need no core header, target code runs against register block in RAM
+#include "orbcode/trace/funnel.h"
+
+#include <map>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/funnel.hpp"
+#include "orbcode/decoder/tpiu.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    uint32_t Registers[0x1000 / 4];
+
+    uint32_t& reg(uint32_t offset)
+    {
+        return Registers[offset / 4];
+    }
+
+    // Frame of single source: ID change followed by 14 data bytes (same encoding as TPIU formatter)
+    void pushFrame(std::vector<uint8_t>& stream, uint8_t id, const uint8_t* data)
+    {
+        uint8_t aux = 0;
+        stream.push_back(static_cast<uint8_t>((id << 1) | 1));
+        for(size_t i = 1; i < 15; i++)
+        {
+            const uint8_t value = data[i - 1];
+            if(i % 2 == 1)
+            {
+                stream.push_back(value);
+            }
+            else
+            {
+                stream.push_back(value & 0xFE);
+                aux |= static_cast<uint8_t>((value & 1) << (i / 2));
+            }
+        }
+        stream.push_back(aux);
+    }
+}
+
+int main()
+{
+    // Trace source IDs match on target and host
+    static_assert(traceFunnelId(0, FunnelSourceItm) == 0x10, "core 0 ITM");
+    CHECK_EQ(TRACE_FUNNEL_TRACE_ID(0, TraceSourceItm), traceFunnelId(0, FunnelSourceItm));
+    CHECK_EQ(TRACE_FUNNEL_TRACE_ID(1, TraceSourceEtm), traceFunnelId(1, FunnelSourceEtm));
+    CHECK_EQ(TRACE_FUNNEL_TRACE_ID(TRACE_FUNNEL_MAX_CORES - 1, 15), 0x6F);
+
+    CHECK(traceSourceName(0x10) == "core0-itm");
+    CHECK(traceSourceName(0x21) == "core1-etm");
+    CHECK(traceSourceName(0x25) == "core1-src5");
+    CHECK(traceSourceName(1) == "id1");
+    uint8_t id = 0;
+    CHECK(parseTraceSource("core2-etm", id) && id == 0x31);
+    CHECK(parseTraceSource("core1-src5", id) && id == 0x25);
+    CHECK(parseTraceSource("id3", id) && id == 3);
+    CHECK(parseTraceSource("0x20", id) && id == 0x20);
+    CHECK(!parseTraceSource("core6-itm", id));
+    CHECK(!parseTraceSource("core0-dwt", id));
+    CHECK(!parseTraceSource("0x70", id));
+    for(uint8_t i = 1; i <= 0x6F; i++)
+    {
+        CHECK(parseTraceSource(traceSourceName(i), id) && id == i);
+    }
+
+    // Setup programs priorities and hold time, rejects ports funnel does not have
+    const uintptr_t base = reinterpret_cast<uintptr_t>(Registers);
+    reg(0xFC8) = 0x34; // 4 ports
+    reg(0x000) = 0x3U << 8;
+    CHECK_EQ(TraceFunnelPortCount(base), 4U);
+
+    TraceFunnelOptions options = {};
+    options.Base = base;
+    options.EnabledPorts = 0x13;
+    CHECK(!TraceFunnelSetup(&options));
+    CHECK_EQ(reg(0x000), 0x3U << 8);
+    CHECK_EQ(reg(0xFB0), 0xC5ACCE55U);
+
+    options.EnabledPorts = 0x05;
+    options.Priorities[0] = 1;
+    options.Priorities[2] = 0;
+    options.Priorities[3] = 9;
+    CHECK(TraceFunnelSetup(&options));
+    CHECK_EQ(reg(0x000), 0x305U);
+    CHECK_EQ(reg(0x004), (1U << 0) | (1U << 9));
+
+    options.HoldTime = 16;
+    CHECK(TraceFunnelSetup(&options));
+    CHECK_EQ(reg(0x000), 0xF05U);
+
+    TraceFunnelDisable(base);
+    CHECK_EQ(reg(0x000), 0xF00U);
+
+    reg(0xFC8) = 0;
+    CHECK_EQ(TraceFunnelPortCount(base), TRACE_FUNNEL_MAX_PORTS);
+
+    // Planner: core 0 ITM, core 0 ETM, core 1 ITM on 4-bit port at 50 MHz (25 MB/s)
+    TraceFunnelTargets targets = {};
+    targets.PortRates[0] = 200000;
+    targets.PortRates[1] = 8000000;
+    targets.PortRates[3] = 100000;
+    targets.Bandwidth = 25000000;
+    TraceFunnelPlan plan;
+    CHECK(TracePlanFunnel(&targets, &options, &plan));
+    CHECK_EQ(options.Base, base);
+    CHECK_EQ(options.EnabledPorts, 0x0BU);
+    CHECK_EQ(options.Priorities[3], 0U);
+    CHECK_EQ(options.Priorities[0], 1U);
+    CHECK_EQ(options.Priorities[1], 2U);
+    CHECK_EQ(options.Priorities[2], 7U);
+    CHECK_EQ(options.HoldTime, 1U);
+    CHECK(plan.Headroom > 0);
+    CHECK_EQ(static_cast<int64_t>(plan.Load) + plan.Headroom, 25000000);
+
+    // Slower port needs longer hold time to fit
+    targets.Bandwidth = 11000000;
+    CHECK(TracePlanFunnel(&targets, &options, &plan));
+    CHECK(options.HoldTime > 1U);
+    CHECK(plan.Load <= targets.Bandwidth);
+
+    // Single source has no ID change overhead
+    TraceFunnelTargets single = {};
+    single.PortRates[2] = 1500000;
+    single.Bandwidth = 1600000;
+    CHECK(TracePlanFunnel(&single, &options, &plan));
+    CHECK_EQ(options.EnabledPorts, 0x04U);
+    CHECK_EQ(plan.Load, 1600000U);
+
+    // Overloaded port
+    targets.Bandwidth = 8000000;
+    CHECK(!TracePlanFunnel(&targets, &options, &plan));
+    CHECK_EQ(options.HoldTime, 16U);
+    CHECK(plan.Headroom < 0);
+
+    // Merged stream of two cores is split per core
+    std::vector<uint8_t> stream = {0xFF, 0xFF, 0xFF, 0x7F};
+    std::map<uint8_t, std::vector<uint8_t>> expected;
+    for(uint8_t frame = 0; frame < 6; frame++)
+    {
+        const uint8_t source = traceFunnelId(frame % 3 == 2 ? 1 : 0, FunnelSourceItm);
+        uint8_t data[14];
+        for(uint8_t i = 0; i < sizeof(data); i++)
+        {
+            data[i] = static_cast<uint8_t>(frame * 16 + i);
+        }
+        pushFrame(stream, source, data);
+        expected[source].insert(expected[source].end(), data, data + sizeof(data));
+    }
+
+    std::map<uint8_t, std::vector<uint8_t>> outputs;
+    TpiuDeframer deframer([&outputs](uint8_t source, const uint8_t* data, size_t size) {
+        outputs[source].insert(outputs[source].end(), data, data + size);
+    });
+    deframer.feed(stream.data(), stream.size());
+    CHECK(outputs == expected);
+    CHECK_EQ(outputs.size(), 2U);
+    CHECK_EQ(outputs[0x20].size(), 28U);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/histogram.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    // Same mapping as TraceHistogramBucket()
+    uint32_t bucketOf(uint32_t value, uint8_t subBucketBits)
+    {
+        int msb = 31;
+        while(msb > 0 && (value & (1U << msb)) == 0)
+        {
+            msb--;
+        }
+        const int excess = msb - subBucketBits;
+        const uint32_t shift = excess > 0 ? static_cast<uint32_t>(excess) : 0;
+        return (shift << subBucketBits) + (value >> shift);
+    }
+}
+
+int main()
+{
+    // Bucket bounds are inverse of target mapping for whole 32-bit range
+    for(uint8_t bits : {0, 3})
+    {
+        Histogram layout;
+        layout.SubBucketBits = bits;
+        layout.Buckets.resize((33U - bits) << bits);
+
+        for(uint64_t value = 0; value <= UINT32_MAX; value = value * 3 / 2 + 1)
+        {
+            const uint32_t bucket = bucketOf(static_cast<uint32_t>(value), bits);
+            CHECK(bucket < layout.Buckets.size());
+            CHECK(layout.lowerBound(bucket) <= value);
+            CHECK(layout.upperBound(bucket) >= value);
+        }
+        CHECK_EQ(bucketOf(UINT32_MAX, bits), layout.Buckets.size() - 1);
+        CHECK_EQ(layout.upperBound(layout.Buckets.size() - 1), UINT32_MAX);
+    }
+
+    // Two histograms, stream starts with garbage
+    std::vector<uint8_t> stream = {0x12, 0x34, 0x56};
+    pushWord(stream, HistogramMagic);
+    pushWord(stream, 5 | (3 << 16) | (1U << 24));
+    pushWord(stream, 240 | (2 << 16));
+    pushWord(stream, bucketOf(100, 3));
+    pushWord(stream, 990);
+    pushWord(stream, bucketOf(5000, 3));
+    pushWord(stream, 10);
+    pushWord(stream, HistogramMagic);
+    pushWord(stream, 6 | (0 << 16) | (1U << 24));
+    pushWord(stream, 1 | (0 << 16));
+
+    std::vector<Histogram> histograms;
+    HistogramDecoder decoder([&histograms](const Histogram& histogram) { histograms.push_back(histogram); });
+    for(uint8_t byte : stream)
+    {
+        decoder.feed(&byte, 1);
+    }
+
+    CHECK_EQ(histograms.size(), 2U);
+    const Histogram& latency = histograms[0];
+    CHECK_EQ(latency.Id, 5);
+    CHECK_EQ(latency.total(), 1000U);
+    CHECK(latency.percentile(0.5) >= 100 && latency.percentile(0.5) < 100 + 100 / 8);
+    CHECK(latency.percentile(0.99) >= 100 && latency.percentile(0.99) < 100 + 100 / 8);
+    CHECK(latency.percentile(0.999) >= 5000 && latency.percentile(0.999) < 5000 + 5000 / 8);
+    CHECK_EQ(histograms[1].Id, 6);
+    CHECK_EQ(histograms[1].total(), 0U);
+    CHECK_EQ(histograms[1].percentile(0.5), 0U);
+
+    Histogram sum = latency;
+    CHECK(sum.merge(latency));
+    CHECK_EQ(sum.total(), 2000U);
+    CHECK(!sum.merge(histograms[1]));
+
+    // Histogram abandoned by target after second bucket word is discarded, following one is decoded
+    stream.clear();
+    pushWord(stream, HistogramMagic);
+    pushWord(stream, 7 | (3 << 16) | (1U << 24));
+    pushWord(stream, 240 | (3 << 16));
+    pushWord(stream, bucketOf(100, 3));
+    pushWord(stream, 990);
+    pushWord(stream, bucketOf(200, 3));
+    pushWord(stream, HistogramMagic);
+    pushWord(stream, 8 | (3 << 16) | (1U << 24));
+    pushWord(stream, 240 | (1 << 16));
+    pushWord(stream, bucketOf(300, 3));
+    pushWord(stream, 4);
+    histograms.clear();
+    decoder.feed(stream.data(), stream.size());
+    CHECK_EQ(histograms.size(), 1U);
+    CHECK_EQ(histograms[0].Id, 8);
+    CHECK_EQ(histograms[0].total(), 4U);
+    CHECK_EQ(histograms[0].Buckets[bucketOf(300, 3)], 4U);
+
+    // Histogram missing a word in the middle of header is discarded too
+    stream.clear();
+    pushWord(stream, HistogramMagic);
+    pushWord(stream, 9 | (3 << 16) | (1U << 24));
+    pushWord(stream, HistogramMagic);
+    pushWord(stream, 10 | (0 << 16) | (1U << 24));
+    pushWord(stream, 1 | (0 << 16));
+    histograms.clear();
+    decoder.feed(stream.data(), stream.size());
+    CHECK_EQ(histograms.size(), 1U);
+    CHECK_EQ(histograms[0].Id, 10);
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "orbcode/sim/device.hpp"
+
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/itm_lowpower.h"
+
+#include <vector>
+
+#include "check.hpp"
+
+using orbcode::sim::Device;
+
+namespace
+{
+    struct GateCall
+    {
+        bool Enabled;
+        uint64_t Bytes; // sent to stimulus port before the call
+    };
+
+    std::vector<GateCall> Gates;
+
+    void gate(bool enabled, void* context)
+    {
+        (void)context;
+        Gates.push_back(GateCall{enabled, Device.statistics().Bytes});
+    }
+
+    uint32_t Ticks = 0;
+
+    uint32_t timebase(void* context)
+    {
+        return *static_cast<uint32_t*>(context);
+    }
+}
+
+int main()
+{
+    Device.reset();
+    Device.capture(true);
+    ITMOptions itm = {};
+    itm.EnabledStimulusPorts = ITM_ENABLE_STIMULUS_PORTS_ALL;
+    ITMSetup(&itm);
+
+    static uint8_t storage[64];
+    ITMBuffer buffer;
+    CHECK(ITMBufferInit(&buffer, 2, storage, sizeof(storage)));
+
+    ITMLowPowerOptions options = {};
+    options.Buffer = &buffer;
+    options.Watermark = 32;
+    options.ClockGate = gate;
+    ITMLowPower power;
+    Device.Dwt.CYCCNT = 1000;
+    ITMLowPowerInit(&power, &options);
+    CHECK_EQ(Gates.size(), 1U);
+    CHECK(!Gates[0].Enabled);
+
+    // Nothing sent while active and below watermark, empty buffer does not ungate clock
+    const uint8_t data[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    CHECK(ITMBufferWrite(&buffer, data, sizeof(data)));
+    CHECK(!ITMLowPowerFlushNeeded(&power));
+    CHECK_EQ(ITMLowPowerPoll(&power), 0U);
+    CHECK_EQ(Device.statistics().Bytes, 0U);
+    CHECK_EQ(Gates.size(), 1U);
+
+    // Single burst before sleep, clock ungated only around it
+    Device.Dwt.CYCCNT = 1300;
+    Device.SleepCycles = 700;
+    ITMLowPowerSleep(&power);
+    CHECK_EQ(Device.Sleeps, 1U);
+    CHECK_EQ(Device.Primask, 0U);
+    CHECK(Device.output(2) == std::vector<uint8_t>(data, data + sizeof(data)));
+    CHECK_EQ(Gates.size(), 3U);
+    CHECK(Gates[1].Enabled);
+    CHECK_EQ(Gates[1].Bytes, 0U);
+    CHECK(!Gates[2].Enabled);
+    CHECK_EQ(Gates[2].Bytes, sizeof(data));
+
+    Device.Dwt.CYCCNT += 100;
+    ITMLowPowerSleep(&power);
+    CHECK_EQ(Device.Sleeps, 2U);
+    CHECK_EQ(Gates.size(), 3U);
+
+    // Watermark sends burst early
+    for(int i = 0; i < 3; i++)
+    {
+        CHECK(ITMBufferWrite(&buffer, data, sizeof(data)));
+    }
+    CHECK(ITMLowPowerFlushNeeded(&power));
+    CHECK_EQ(ITMLowPowerPoll(&power), 36U);
+    CHECK(!ITMLowPowerFlushNeeded(&power));
+    CHECK_EQ(Device.output(2).size(), 48U);
+    CHECK_EQ(Gates.size(), 5U);
+
+    // 300 active + 700 asleep, 100 active + 700 asleep, 200 active
+    Device.Dwt.CYCCNT += 200;
+    ITMLowPowerStatistics statistics;
+    ITMLowPowerReadStatistics(&power, &statistics, true);
+    CHECK_EQ(statistics.ActiveTime, 600U);
+    CHECK_EQ(statistics.SleepTime, 1400U);
+    CHECK_EQ(statistics.SleepPermille, 700U);
+    CHECK_EQ(statistics.Bursts, 2U);
+    CHECK_EQ(statistics.BurstBytes, 48U);
+    CHECK_EQ(statistics.LargestBurst, 36U);
+    CHECK_EQ(statistics.Dropped, 0U);
+
+    ITMLowPowerReadStatistics(&power, &statistics, false);
+    CHECK_EQ(statistics.ActiveTime + statistics.SleepTime, 0U);
+    CHECK_EQ(statistics.SleepPermille, 0U);
+    CHECK_EQ(statistics.Bursts, 0U);
+
+    // Custom timebase (e.g. low-power timer running in deep sleep), no clock gating
+    options.ClockGate = nullptr;
+    options.Timebase = timebase;
+    options.Context = &Ticks;
+    options.Watermark = 0;
+    ITMLowPowerInit(&power, &options);
+    int written = 0;
+    for(int i = 0; i < 10; i++)
+    {
+        written += ITMBufferWrite(&buffer, data, sizeof(data)) ? 1 : 0;
+    }
+    CHECK_EQ(written, 5);
+    CHECK_EQ(ITMBufferGetDropped(&buffer), 12U * 5U);
+    CHECK(!ITMLowPowerFlushNeeded(&power));
+    Ticks = 10;
+    ITMLowPowerSleep(&power);
+    ITMLowPowerReadStatistics(&power, &statistics, false);
+    CHECK_EQ(statistics.ActiveTime, 10U);
+    CHECK_EQ(statistics.SleepTime, 0U);
+    CHECK_EQ(statistics.BurstBytes, 60U);
+    CHECK_EQ(statistics.Dropped, 60U);
+    CHECK_EQ(Gates.size(), 5U);
+
+    return 0;
+}
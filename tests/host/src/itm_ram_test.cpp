@@ -0,0 +1,196 @@
+#include "orbcode/sim/device.hpp"
+
+// Simulated device has ITM, RAM backend selected explicitly
+#define ITM_BACKEND ITM_BACKEND_RAM
+#include "orbcode/trace/event.h"
+#include "orbcode/trace/histogram.h"
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/itm_frame.h"
+
+#include <cstring>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/frame.hpp"
+#include "orbcode/decoder/itm.hpp"
+
+using namespace orbcode::decoder;
+
+ITMRamControlBlock ITMRamControl;
+
+namespace
+{
+    uint8_t TraceRam[64];
+
+    // Reads like debug probe: everything from read offset to write offset
+    std::vector<uint8_t> drain()
+    {
+        std::vector<uint8_t> out;
+        uint32_t read = ITMRamControl.Read;
+        while(read != ITMRamControl.Write)
+        {
+            out.push_back(ITMRamControl.Buffer[read]);
+            read = (read + 1) % ITMRamControl.Size;
+        }
+        ITMRamControl.Read = read;
+        return out;
+    }
+
+    std::vector<ItmPacket> decode(const std::vector<uint8_t>& data)
+    {
+        std::vector<ItmPacket> packets;
+        ItmPacketDecoder decoder([&packets](const ItmPacket& packet) { packets.push_back(packet); }, true);
+        decoder.feed(data.data(), data.size());
+        return packets;
+    }
+
+    void reset()
+    {
+        ITMRamInit(TraceRam, sizeof(TraceRam));
+        ITMOptions options = {};
+        options.EnabledStimulusPorts = ITM_ENABLE_STIMULUS_PORTS_ALL;
+        ITMSetup(&options);
+    }
+}
+
+int main()
+{
+    // Not initialized, nothing is written
+    CHECK(!ITMIsPortEnabled(1));
+    CHECK_EQ(ITMRamGetFree(), 0U);
+    ITMWrite8(1, 0x55);
+
+    reset();
+    CHECK(std::memcmp(ITMRamControl.Id, ITM_RAM_ID, sizeof(ITM_RAM_ID)) == 0);
+    CHECK(ITMIsPortEnabled(1));
+    CHECK_EQ(ITMRamGetFree(), sizeof(TraceRam) - 1);
+
+    // Each write is one stimulus packet, buffers split into largest packets
+    const uint8_t bytes[7] = {1, 2, 3, 4, 5, 6, 7};
+    ITMWrite8(1, 0xAB);
+    ITMWrite16(2, 0x1234);
+    ITMWrite32(3, 0xDEADBEEF);
+    ITMWriteBuffer(4, bytes, sizeof(bytes));
+    std::vector<ItmPacket> packets = decode(drain());
+    CHECK_EQ(packets.size(), 6U);
+    CHECK(packets[0].Type == ItmPacketType::Stimulus);
+    CHECK_EQ(packets[0].Address, 1U);
+    CHECK_EQ(packets[0].Size, 1U);
+    CHECK_EQ(packets[0].Value, 0xABU);
+    CHECK_EQ(packets[1].Address, 2U);
+    CHECK_EQ(packets[1].Value, 0x1234U);
+    CHECK_EQ(packets[2].Size, 4U);
+    CHECK_EQ(packets[2].Value, 0xDEADBEEFU);
+    CHECK_EQ(packets[3].Address, 4U);
+    CHECK_EQ(packets[3].Value, 0x04030201U);
+    CHECK_EQ(packets[4].Value, 0x0605U);
+    CHECK_EQ(packets[5].Value, 0x07U);
+
+    // Probe controls enabled ports too
+    ITMRamControl.PortMask = 1UL << 1;
+    ITMWrite8(2, 0xAB);
+    CHECK(drain().empty());
+    ITMSetPortMask(ITM_ENABLE_STIMULUS_PORTS_ALL);
+
+    // Full buffer drops writes, overflow packet marks gap once space is available
+    for(uint32_t i = 0; i < 20; i++)
+    {
+        ITMWrite32(1, i);
+    }
+    CHECK(!ITMIsPortReady(1));
+    CHECK_EQ(ITMRamGetLost(), 8U);
+    packets = decode(drain());
+    CHECK_EQ(packets.size(), 12U);
+    CHECK_EQ(packets[11].Value, 11U);
+    ITMWrite8(1, 0x42);
+    packets = decode(drain());
+    CHECK_EQ(packets.size(), 2U);
+    CHECK(packets[0].Type == ItmPacketType::Overflow);
+    CHECK_EQ(packets[1].Value, 0x42U);
+
+    // Frames wrap around end of buffer many times
+    std::vector<uint8_t> decoded;
+    FrameDecoder frames([&decoded](const uint8_t* frame, size_t size) { decoded.assign(frame, frame + size); },
+                        ITM_FRAME_CRC != 0);
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        uint8_t payload[11];
+        for(size_t j = 0; j < sizeof(payload); j++)
+        {
+            payload[j] = static_cast<uint8_t>(i * 3 + j);
+        }
+        ITMFrameWrite(5, payload, sizeof(payload));
+
+        std::vector<uint8_t> port;
+        for(const ItmPacket& packet : decode(drain()))
+        {
+            CHECK(packet.Type == ItmPacketType::Stimulus);
+            for(uint8_t b = 0; b < packet.Size; b++)
+            {
+                port.push_back(static_cast<uint8_t>(packet.Value >> (8 * b)));
+            }
+        }
+        frames.feed(port.data(), port.size());
+        CHECK(decoded == std::vector<uint8_t>(payload, payload + sizeof(payload)));
+    }
+    CHECK_EQ(ITMRamGetLost(), 8U);
+
+    // Event not fitting into ring is dropped whole, host decoder never sees truncated struct
+    drain();
+    while(ITMRamGetFree() >= 30)
+    {
+        ITMWrite32(1, 0);
+    }
+    const uint32_t eventHeader = 24U << TRACE_EVENT_SIZE_POS;
+    const uint32_t event[6] = {1, 2, 3, 4, 5, 6};
+    const uint32_t lost = ITMRamGetLost();
+    uint32_t before = ITMRamControl.Write;
+    TraceEventWrite(7, eventHeader, event, sizeof(event));
+    CHECK_EQ(ITMRamControl.Write, before);
+    CHECK_EQ(ITMRamGetLost(), lost + 1);
+    drain();
+    TraceEventWrite(7, eventHeader, event, sizeof(event));
+    packets = decode(drain());
+    CHECK_EQ(packets.size(), 8U);
+    CHECK(packets[0].Type == ItmPacketType::Overflow);
+    CHECK_EQ(packets[1].Value, eventHeader);
+    CHECK_EQ(packets[7].Address, 7U);
+    CHECK_EQ(packets[7].Value, 6U);
+
+    // Event filling ring exactly is stored whole, its last packets are below readiness threshold
+    drain();
+    for(int i = 0; i < 4; i++)
+    {
+        ITMWrite32(1, 0);
+    }
+    ITMWrite16(1, 0);
+    ITMWrite16(1, 0);
+    ITMWrite8(1, 0);
+    CHECK_EQ(ITMRamGetFree(), sizeof(eventHeader) + sizeof(event) + 7);
+    const uint32_t fullLost = ITMRamGetLost();
+    TraceEventWrite(7, eventHeader, event, sizeof(event));
+    CHECK_EQ(ITMRamGetFree(), 0U);
+    CHECK_EQ(ITMRamGetLost(), fullLost);
+    packets = decode(drain());
+    CHECK_EQ(packets.size(), 14U);
+    CHECK_EQ(packets[7].Value, eventHeader);
+    CHECK_EQ(packets[13].Value, 6U);
+
+    // Full buffer nobody drains, framed messages and histogram dumps return instead of waiting for space
+    while(ITMIsPortReady(1))
+    {
+        ITMWrite32(1, 0);
+    }
+    const uint32_t write = ITMRamControl.Write;
+    uint8_t message[100] = {};
+    ITMFrameWrite(5, message, sizeof(message));
+    uint32_t buckets[TRACE_HISTOGRAM_BUCKETS(2)];
+    TraceHistogram histogram;
+    CHECK(TraceHistogramInit(&histogram, 1, 2, buckets, TRACE_HISTOGRAM_BUCKETS(2)));
+    TraceHistogramRecord(&histogram, 10);
+    TraceHistogram* histograms[] = {&histogram};
+    TraceHistogramFlush(6, histograms, 1, false);
+    CHECK_EQ(ITMRamControl.Write, write);
+
+    return 0;
+}
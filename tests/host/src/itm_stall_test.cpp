@@ -0,0 +1,172 @@
+#include "orbcode/sim/device.hpp"
+
+#define ITM_STALL_POLICY ITM_STALL_DROP
+#define ITM_STATISTICS_ENABLED 1
+// Without CRC only terminator of abandoned frame keeps receiver from accepting it
+#define ITM_FRAME_CRC 0
+#include "orbcode/trace/event.h"
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/itm.hpp"
+#include "orbcode/trace/itm_buffer.h"
+#include "orbcode/trace/itm_frame.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/frame.hpp"
+
+using orbcode::sim::Device;
+
+ITMStatistics ITMStatisticsData;
+
+namespace
+{
+    struct Record
+    {
+        uint32_t Words[6];
+    };
+
+    void start(double drainPerAccess)
+    {
+        orbcode::sim::FifoOptions fifo;
+        fifo.Depth = 8;
+        fifo.DrainPerAccess = drainPerAccess;
+        Device.reset(fifo);
+        Device.capture(true);
+        ITMOptions itm = {};
+        itm.EnabledStimulusPorts = ITM_ENABLE_STIMULUS_PORTS_ALL;
+        ITMSetup(&itm);
+    }
+
+    // Lets trace link send everything from FIFO
+    void idle()
+    {
+        for(int i = 0; i < 64; i++)
+        {
+            (void)ITMIsPortReady(0);
+        }
+    }
+
+    bool isPrefix(const std::vector<uint8_t>& data, const std::vector<uint8_t>& of)
+    {
+        return data.size() <= of.size() && std::equal(data.begin(), data.end(), of.begin());
+    }
+}
+
+int main()
+{
+    // Trace link drains one byte per access: word stores fill FIFO, which is ready again after few polls, so later
+    // packets of the same write would fit after dropped one
+    start(1);
+    uint8_t message[40];
+    for(size_t i = 0; i < sizeof(message); i++)
+    {
+        message[i] = static_cast<uint8_t>(i % 7 + 1);
+    }
+
+    // Dropped frame is abandoned and terminated, host never receives frame with missing bytes
+    uint8_t next[3] = {9, 0, 9};
+    std::vector<uint8_t> nextEncoded(ITM_FRAME_MAX_ENCODED_SIZE(sizeof(next)));
+    nextEncoded.resize(ITMFrameEncode(nextEncoded.data(), next, sizeof(next)));
+    size_t complete = 0;
+    size_t abandoned = 0;
+    for(size_t size = 1; size <= sizeof(message); size++)
+    {
+        std::vector<uint8_t> encoded(ITM_FRAME_MAX_ENCODED_SIZE(size));
+        encoded.resize(ITMFrameEncode(encoded.data(), message, size));
+
+        idle();
+        Device.clearOutput();
+        ITMStatisticsReset();
+        const bool written = ITMFrameWrite(3, message, size);
+        const std::vector<uint8_t>& out = Device.output(3);
+        CHECK_EQ(ITMStatisticsData.Ports[3].Bytes, out.size());
+        if(written)
+        {
+            CHECK(out == encoded);
+            complete++;
+        }
+        else
+        {
+            // Followed by intact frame, only that one is decoded
+            std::vector<std::vector<uint8_t>> decoded;
+            orbcode::decoder::FrameDecoder frames(
+                [&decoded](const uint8_t* data, size_t length) { decoded.emplace_back(data, data + length); }, false);
+            std::vector<uint8_t> stream = {ITM_FRAME_DELIMITER};
+            stream.insert(stream.end(), out.begin(), out.end());
+            stream.insert(stream.end(), nextEncoded.begin(), nextEncoded.end());
+            frames.feed(stream.data(), stream.size());
+            CHECK_EQ(decoded.size(), 1U);
+            CHECK(decoded.back() == std::vector<uint8_t>(next, next + sizeof(next)));
+            abandoned++;
+        }
+    }
+    CHECK(complete > 0);
+    CHECK(abandoned > 0);
+
+    // Unrolled stores of compile-time port stop at first dropped word
+    Record record;
+    for(uint32_t i = 0; i < 6; i++)
+    {
+        record.Words[i] = 0x11111111U * (i + 1);
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    const std::vector<uint8_t> expected(bytes, bytes + sizeof(record));
+    size_t partial = 0;
+    for(size_t i = 0; i < 10; i++)
+    {
+        idle();
+        Device.clearOutput();
+        ITMStatisticsReset();
+        orbcode::trace::Port<4>::write(record);
+        CHECK(isPrefix(Device.output(4), expected));
+        // Statistics count only bytes that reached stimulus port
+        CHECK_EQ(ITMStatisticsData.Ports[4].Bytes, Device.output(4).size());
+        CHECK_EQ(ITMStatisticsData.Ports[4].Writes, Device.output(4).empty() ? 0U : 1U);
+        partial += Device.output(4).size() < expected.size() ? 1 : 0;
+    }
+    CHECK(partial > 0);
+
+    // Same for buffer writes
+    for(size_t i = 0; i < 10; i++)
+    {
+        idle();
+        Device.clearOutput();
+        ITMStatisticsReset();
+        const size_t written = ITMWriteBufferUnchecked(5, message + 1, sizeof(message) - 1);
+        CHECK_EQ(Device.output(5).size(), written);
+        CHECK_EQ(ITMStatisticsData.Ports[5].Bytes, written);
+        CHECK(isPrefix(Device.output(5), std::vector<uint8_t>(message + 1, message + sizeof(message))));
+    }
+
+    // Event header and struct bytes count as one write
+    for(size_t i = 0; i < 10; i++)
+    {
+        idle();
+        Device.clearOutput();
+        ITMStatisticsReset();
+        TraceEventWrite(7, 24U << TRACE_EVENT_SIZE_POS, &record, sizeof(record));
+        CHECK_EQ(ITMStatisticsData.Ports[7].Bytes, Device.output(7).size());
+        CHECK_EQ(ITMStatisticsData.Ports[7].Writes, Device.output(7).empty() ? 0U : 1U);
+    }
+
+    // Compile-time port counts writes to disabled port
+    ITMStatisticsReset();
+    ITMDisablePorts(1UL << 6);
+    orbcode::trace::Port<6>::write(record);
+    orbcode::trace::Port<6>::write(&record, sizeof(record));
+    CHECK_EQ(ITMStatisticsData.Ports[6].Dropped, 2U);
+    CHECK_EQ(ITMStatisticsData.Ports[6].Writes, 0U);
+
+    // Buffered data drained to disabled port is counted as dropped
+    ITMBuffer buffer;
+    uint8_t storage[64];
+    CHECK(ITMBufferInit(&buffer, 6, storage, sizeof(storage)));
+    CHECK(ITMBufferWrite(&buffer, message, 10));
+    CHECK_EQ(ITMBufferDrain(&buffer, ITM_BUFFER_DRAIN_ALL), 10U);
+    CHECK_EQ(ITMBufferGetUsed(&buffer), 0U);
+    CHECK_EQ(ITMBufferGetDropped(&buffer), 10U);
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/itm.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    bool samePackets(const std::vector<ItmPacket>& a, const std::vector<ItmPacket>& b)
+    {
+        if(a.size() != b.size())
+        {
+            return false;
+        }
+        for(size_t i = 0; i < a.size(); i++)
+        {
+            if(a[i].Type != b[i].Type || a[i].Address != b[i].Address || a[i].Size != b[i].Size ||
+               a[i].Info != b[i].Info || a[i].Value != b[i].Value)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Decoding must not depend on how stream is split into buffers
+    void checkSplitting()
+    {
+        std::vector<uint8_t> stream = {0xAB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80};
+        uint32_t seed = 12345;
+        for(int i = 0; i < 20000; i++)
+        {
+            seed = seed * 1103515245U + 12345U;
+            const uint8_t byte = static_cast<uint8_t>(seed >> 16);
+            // Frequent zero runs exercise synchronization and padding paths
+            stream.push_back((byte & 0x30) == 0 ? 0x00 : byte);
+        }
+
+        std::vector<ItmPacket> whole;
+        ItmPacketDecoder wholeDecoder([&whole](const ItmPacket& packet) { whole.push_back(packet); });
+        wholeDecoder.feed(stream.data(), stream.size());
+        CHECK(whole.size() > 1000);
+
+        std::vector<ItmPacket> bytes;
+        ItmPacketDecoder byteDecoder([&bytes](const ItmPacket& packet) { bytes.push_back(packet); });
+        for(uint8_t byte : stream)
+        {
+            byteDecoder.feed(&byte, 1);
+        }
+        CHECK(samePackets(whole, bytes));
+
+        std::vector<ItmPacket> batched;
+        ItmPacketDecoder batchDecoder(nullptr);
+        ItmPacket packets[3];
+        for(size_t offset = 0; offset < stream.size();)
+        {
+            const size_t chunk = std::min<size_t>(stream.size() - offset, 1 + offset % 37);
+            size_t count;
+            offset += batchDecoder.decode(stream.data() + offset, chunk, packets, 3, count);
+            batched.insert(batched.end(), packets, packets + count);
+        }
+        CHECK(samePackets(whole, batched));
+    }
+}
+
+int main()
+{
+    const std::vector<uint8_t> stream = {
+        0x12, 0x34,                         // Garbage before synchronization
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x80, // Sync
+        0x0B, 0x78, 0x56, 0x34, 0x12,       // Stimulus port 1, 4 bytes
+        0x30,                               // Local timestamp 3
+        0xD0, 0x81, 0x01,                   // Local timestamp 129, TC 1
+        0x0E, 0x15, 0x20,                   // Exception 21 exit
+        0x17, 0x00, 0x10, 0x00, 0x08,       // PC sample 0x08001000
+        0x15, 0x00,                         // PC sleep sample
+        0x9E, 0xAA, 0xBB,                   // Data trace comparator 1 value write
+        0x70,                               // Overflow
+        0x94, 0x81, 0x80, 0x80, 0x61,       // Global timestamp 1 with clock change and wrap
+    };
+
+    std::vector<ItmPacket> packets;
+    ItmPacketDecoder decoder([&packets](const ItmPacket& packet) { packets.push_back(packet); });
+    CHECK(!decoder.synchronized());
+
+    // Split inside sync and inside payload
+    decoder.feed(stream.data(), 5);
+    decoder.feed(stream.data() + 5, 5);
+    decoder.feed(stream.data() + 10, stream.size() - 10);
+    CHECK(decoder.synchronized());
+
+    CHECK_EQ(packets.size(), 10u);
+    CHECK(packets[0].Type == ItmPacketType::Sync);
+
+    CHECK(packets[1].Type == ItmPacketType::Stimulus);
+    CHECK_EQ(packets[1].Address, 1);
+    CHECK_EQ(packets[1].Size, 4);
+    CHECK_EQ(packets[1].Value, 0x12345678u);
+
+    CHECK(packets[2].Type == ItmPacketType::LocalTimestamp);
+    CHECK_EQ(packets[2].Value, 3u);
+    CHECK(packets[3].Type == ItmPacketType::LocalTimestamp);
+    CHECK_EQ(packets[3].Value, 129u);
+    CHECK_EQ(packets[3].Info, 1);
+
+    CHECK(packets[4].Type == ItmPacketType::Exception);
+    CHECK_EQ(packets[4].Value, 21u);
+    CHECK_EQ(packets[4].Info, 2);
+
+    CHECK(packets[5].Type == ItmPacketType::PCSample);
+    CHECK_EQ(packets[5].Value, 0x08001000u);
+    CHECK_EQ(packets[5].Info, 0);
+    CHECK(packets[6].Type == ItmPacketType::PCSample);
+    CHECK_EQ(packets[6].Info, 1);
+
+    CHECK(packets[7].Type == ItmPacketType::DataTraceValue);
+    CHECK_EQ(packets[7].Address, 1);
+    CHECK_EQ(packets[7].Info, 1);
+    CHECK_EQ(packets[7].Value, 0xBBAAu);
+
+    CHECK(packets[8].Type == ItmPacketType::Overflow);
+
+    CHECK(packets[9].Type == ItmPacketType::GlobalTimestamp1);
+    CHECK_EQ(packets[9].Value, (1u << 21) | 1u);
+    CHECK_EQ(packets[9].Info, 3);
+
+    CHECK_EQ(exceptionName(0), "Thread");
+    CHECK_EQ(exceptionName(15), "SysTick");
+    CHECK_EQ(exceptionName(21), "IRQ 5");
+
+    checkSplitting();
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/log.hpp"
+
+using namespace orbcode::decoder;
+
+int main()
+{
+    CHECK_EQ(formatLogMessage("plain", {}, nullptr), "plain");
+    CHECK_EQ(formatLogMessage("%d/%u/%x", {0xFFFFFFFF, 0xFFFFFFFF, 0xAB}, nullptr), "-1/4294967295/ab");
+    CHECK_EQ(formatLogMessage("%5d|%-4u|%08X", {42, 7, 0xBEEF}, nullptr), "   42|7   |0000BEEF");
+    CHECK_EQ(formatLogMessage("%ld %hhu %c %%", {3, 4, 'z'}, nullptr), "3 4 z %");
+    CHECK_EQ(formatLogMessage("%.2f", {0x40490FDB /* 3.14159274f */}, nullptr), "3.14");
+    CHECK_EQ(formatLogMessage("%*d", {4, 1}, nullptr), "   1");
+    CHECK_EQ(formatLogMessage("%s", {0x1000}, nullptr), "<0x00001000>");
+    CHECK_EQ(formatLogMessage("%d %d", {1}, nullptr), "1 0 <missing arguments>");
+
+    LogFormatTable formats;
+    formats.add(0x10, "a=%d b=%d");
+    formats.add(0x20, "no args");
+
+    std::vector<std::string> lines;
+    LogDecoder decoder(formats, [&lines](const LogMessage& message) {
+        lines.push_back(message.Format ? formatLogMessage(*message.Format, message.Args, nullptr) : "?");
+    });
+
+    std::vector<uint8_t> stream;
+    pushWord(stream, 0x20000010);
+    pushWord(stream, 5);
+    pushWord(stream, static_cast<uint32_t>(-6));
+    pushWord(stream, 0x00000020);
+    pushWord(stream, 0x10000099); // unknown ID, one argument skipped
+    pushWord(stream, 0);
+    pushWord(stream, 0x00000020);
+
+    // Feed in odd-sized chunks to exercise reassembly
+    for(size_t i = 0; i < stream.size(); i += 3)
+    {
+        decoder.feed(stream.data() + i, std::min<size_t>(3, stream.size() - i));
+    }
+
+    CHECK_EQ(lines.size(), 4U);
+    CHECK_EQ(lines[0], "a=5 b=-6");
+    CHECK_EQ(lines[1], "no args");
+    CHECK_EQ(lines[2], "?");
+    CHECK_EQ(lines[3], "no args");
+
+    return 0;
+}
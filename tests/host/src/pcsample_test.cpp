@@ -0,0 +1,147 @@
+#include <sstream>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/exception.hpp"
+#include "orbcode/decoder/pcsample.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    constexpr uint16_t SysTick = 15;
+    constexpr uint16_t Irq5 = 21;
+
+    void pushPcSample(std::vector<uint8_t>& stream, uint32_t pc)
+    {
+        stream.push_back(0x17);
+        for(int i = 0; i < 4; i++)
+        {
+            stream.push_back(static_cast<uint8_t>(pc >> (8 * i)));
+        }
+    }
+
+    void pushSleepSample(std::vector<uint8_t>& stream)
+    {
+        stream.push_back(0x15);
+        stream.push_back(0x00);
+    }
+
+    void pushException(std::vector<uint8_t>& stream, uint16_t exception, uint8_t function)
+    {
+        stream.push_back(0x0E);
+        stream.push_back(static_cast<uint8_t>(exception));
+        stream.push_back(static_cast<uint8_t>((exception >> 8) | (function << 4)));
+    }
+}
+
+int main()
+{
+    const SymbolTable symbols({{"main", 0x1000, 0x40},
+                               {"Work", 0x1040, 0x20},
+                               {"SysTick_Handler", 0x1100, 0x10},
+                               {"UART_IRQHandler", 0x1200, 0x10}});
+    // Line 10 is split by line 11 (e.g. loop condition and body)
+    const LineTable lines({"main.c"}, {{0x1000, 0x1010, 0, 10},
+                                       {0x1010, 0x1020, 0, 11},
+                                       {0x1020, 0x1030, 0, 10},
+                                       {0x1030, 0x1040, 0, 11},
+                                       {0x1040, 0x1060, 0, 20}});
+
+    std::vector<uint8_t> stream;
+    pushPcSample(stream, 0x1004);
+    pushPcSample(stream, 0x1024);
+    pushPcSample(stream, 0x1044);
+    // SysTick preempted by IRQ 5
+    pushException(stream, SysTick, ExceptionFunctionEnter);
+    pushPcSample(stream, 0x1104);
+    pushException(stream, Irq5, ExceptionFunctionEnter);
+    pushPcSample(stream, 0x1204);
+    pushPcSample(stream, 0x1208);
+    pushException(stream, Irq5, ExceptionFunctionExit);
+    pushException(stream, SysTick, ExceptionFunctionReturn);
+    pushPcSample(stream, 0x1108);
+    pushException(stream, SysTick, ExceptionFunctionExit);
+    pushException(stream, 0, ExceptionFunctionReturn);
+    pushPcSample(stream, 0x1014);
+    pushSleepSample(stream);
+    pushPcSample(stream, 0x2000);
+    // Entry to IRQ 5 lost in overflow, its return identifies active handler
+    stream.push_back(0x70);
+    pushException(stream, Irq5, ExceptionFunctionReturn);
+    pushPcSample(stream, 0x1200);
+    pushException(stream, 0, ExceptionFunctionReturn);
+    pushPcSample(stream, 0x1000);
+
+    PcSampleProfiler profiler(symbols, lines);
+    ItmPacketDecoder decoder([&profiler](const ItmPacket& packet) { profiler.add(packet); }, true);
+    decoder.feed(stream.data(), stream.size());
+
+    CHECK_EQ(profiler.samples(), 12U);
+    CHECK_EQ(profiler.sleepSamples(), 1U);
+    CHECK_EQ(profiler.unknownSamples(), 1U);
+    CHECK_EQ(profiler.overflows(), 1U);
+
+    const std::vector<PcFunctionSamples> functions = profiler.functions();
+    CHECK_EQ(functions.size(), 4U);
+    CHECK(functions[0].Function->Name == "main");
+    CHECK_EQ(functions[0].Samples, 4U);
+    CHECK(functions[1].Function->Name == "UART_IRQHandler");
+    CHECK_EQ(functions[1].Samples, 3U);
+    CHECK(functions[2].Function->Name == "SysTick_Handler");
+    CHECK_EQ(functions[2].Samples, 2U);
+    CHECK(functions[3].Function->Name == "Work");
+    CHECK_EQ(functions[3].Samples, 1U);
+
+    const std::vector<uint64_t>& exceptions = profiler.exceptionSamples();
+    CHECK_EQ(exceptions[0], 7U);
+    CHECK_EQ(exceptions[SysTick], 2U);
+    CHECK_EQ(exceptions[Irq5], 3U);
+
+    const std::vector<PcLineSamples> sampledLines = profiler.lines();
+    CHECK_EQ(sampledLines.size(), 3U);
+    CHECK(*sampledLines[0].File == "main.c");
+    CHECK_EQ(sampledLines[0].Line, 10U);
+    CHECK_EQ(sampledLines[0].Samples, 3U);
+    CHECK_EQ(sampledLines[1].Line, 11U);
+    CHECK_EQ(sampledLines[1].Samples, 1U);
+    CHECK_EQ(sampledLines[2].Line, 20U);
+    CHECK_EQ(sampledLines[2].Samples, 1U);
+
+    std::ostringstream folded;
+    profiler.writeFolded(folded);
+    CHECK(folded.str() == "IRQ 5;UART_IRQHandler 1\n"
+                          "SysTick;IRQ 5;UART_IRQHandler 2\n"
+                          "SysTick;SysTick_Handler 2\n"
+                          "Thread;Work 1\n"
+                          "Thread;[sleep] 1\n"
+                          "Thread;[unknown] 1\n"
+                          "Thread;main 4\n");
+
+    // Exit packets of preempting handler lost, exit of preempted one unwinds both
+    PcSampleProfiler unwind(symbols, LineTable());
+    ItmPacket packet;
+    packet.Type = ItmPacketType::Exception;
+    packet.Info = ExceptionFunctionEnter;
+    packet.Value = SysTick;
+    unwind.add(packet);
+    packet.Value = Irq5;
+    unwind.add(packet);
+    packet.Info = ExceptionFunctionExit;
+    packet.Value = SysTick;
+    unwind.add(packet);
+
+    ItmPacket sample;
+    sample.Type = ItmPacketType::PCSample;
+    sample.Size = 4;
+    sample.Value = 0x1040;
+    unwind.add(sample);
+    CHECK_EQ(unwind.exceptionSamples()[0], 1U);
+    CHECK(unwind.lines().empty());
+
+    std::ostringstream unwindFolded;
+    unwind.writeFolded(unwindFolded);
+    CHECK(unwindFolded.str() == "Thread;Work 1\n");
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/pmu.hpp"
+#include "orbcode/decoder/profile.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void pushRecord(std::vector<uint8_t>& stream, uint8_t type, uint32_t id, uint32_t value)
+    {
+        pushWord(stream, (static_cast<uint32_t>(type) << 24) | id);
+        pushWord(stream, value);
+    }
+
+    // Same layout as TraceScopeExit() with TRACE_PROFILE_PMU_COUNTERS > 0
+    void pushPmuRecord(std::vector<uint8_t>& stream, uint32_t id, uint32_t value, const std::vector<uint32_t>& counters)
+    {
+        pushRecord(stream, ProfileRecordExitPmu, id, value);
+        pushWord(stream, static_cast<uint32_t>(counters.size()));
+        for(uint32_t counter : counters)
+        {
+            pushWord(stream, counter);
+        }
+    }
+}
+
+int main()
+{
+    std::vector<uint8_t> stream;
+    pushRecord(stream, ProfileRecordEnter, 7, 1000);
+    pushRecord(stream, ProfileRecordEnter, 0x123456, 1010);
+    pushRecord(stream, ProfileRecordExit, 0x123456, 30);
+    pushRecord(stream, ProfileRecordExit, 7, 100);
+    pushRecord(stream, ProfileRecordEnter, 7, 5000);
+    pushRecord(stream, ProfileRecordExit, 7, 300);
+
+    std::vector<ProfileRecord> records;
+    ProfileSummary summary;
+    ProfileDecoder decoder([&](const ProfileRecord& record) {
+        records.push_back(record);
+        summary.add(record);
+    });
+
+    // Split in the middle of a record
+    decoder.feed(stream.data(), 13);
+    decoder.feed(stream.data() + 13, stream.size() - 13);
+
+    CHECK_EQ(records.size(), 6U);
+    CHECK_EQ(records[1].Type, ProfileRecordEnter);
+    CHECK_EQ(records[1].Id, 0x123456U);
+    CHECK_EQ(records[1].Value, 1010U);
+
+    CHECK_EQ(summary.scopes().size(), 2U);
+    const ScopeStatistics& scope7 = summary.scopes().at(7);
+    CHECK_EQ(scope7.Count, 2U);
+    CHECK_EQ(scope7.Total, 400U);
+    CHECK_EQ(scope7.Min, 100U);
+    CHECK_EQ(scope7.Max, 300U);
+    CHECK(scope7.mean() == 200.0);
+    CHECK_EQ(summary.scopes().at(0x123456).Count, 1U);
+    CHECK(scope7.Counters.empty());
+
+    // Exit records with PMU counters, split at every byte
+    stream.clear();
+    pushRecord(stream, ProfileRecordEnter, 9, 0);
+    pushPmuRecord(stream, 9, 500, {10, 200});
+    pushPmuRecord(stream, 9, 700, {30, 400});
+    pushPmuRecord(stream, 9, 10, {});
+    pushRecord(stream, ProfileRecordExit, 8, 50);
+    records.clear();
+    for(uint8_t byte : stream)
+    {
+        decoder.feed(&byte, 1);
+    }
+
+    CHECK_EQ(records.size(), 5U);
+    CHECK_EQ(records[1].Type, ProfileRecordExitPmu);
+    CHECK_EQ(records[1].Value, 500U);
+    CHECK(records[1].Counters == std::vector<uint32_t>({10, 200}));
+    CHECK(records[3].Counters.empty());
+    CHECK_EQ(records[4].Type, ProfileRecordExit);
+    CHECK_EQ(records[4].Id, 8U);
+
+    const ScopeStatistics& scope9 = summary.scopes().at(9);
+    CHECK_EQ(scope9.Count, 3U);
+    CHECK_EQ(scope9.Total, 1210U);
+    CHECK_EQ(scope9.Counters.size(), 2U);
+    CHECK_EQ(scope9.Counters[1], 600U);
+    CHECK(scope9.meanCounter(1) == 200.0);
+    CHECK(scope9.meanCounter(2) == 0.0);
+
+    // Implausible counter count drops record, next record is decoded
+    stream.clear();
+    pushRecord(stream, ProfileRecordExitPmu, 10, 1);
+    pushWord(stream, 1000);
+    pushRecord(stream, ProfileRecordExit, 11, 2);
+    records.clear();
+    decoder.feed(stream.data(), stream.size());
+    CHECK_EQ(records.size(), 1U);
+    CHECK_EQ(records[0].Id, 11U);
+
+    // PMU event names
+    uint16_t event = 0;
+    CHECK(pmuEventName(0x0003) == "L1D_CACHE_REFILL");
+    CHECK(pmuEventName(0x1234) == "0x1234");
+    CHECK(parsePmuEvent("ARM_PMU_MVE_STALL", event) && event == 0x02CC);
+    CHECK(parsePmuEvent("BR_MIS_PRED", event) && event == 0x0010);
+    CHECK(parsePmuEvent("0x4008", event) && event == 0x4008);
+    CHECK(!parsePmuEvent("CACHE_MISS", event));
+    CHECK(!parsePmuEvent("", event));
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <string>
+
+#include "check.hpp"
+#include "orbcode/decoder/elf.hpp"
+#include "orbcode/decoder/symbols.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    // Lines of tests/host/fixtures/symbol_functions.c
+    constexpr uint32_t SquareFirstLine = 5;
+    constexpr uint32_t SquareReturnLine = 7;
+    constexpr uint32_t SquareLastLine = 8;
+    constexpr uint32_t LoopBodyLine = 14;
+
+    const Symbol* findByName(const SymbolTable& symbols, const std::string& name)
+    {
+        for(const Symbol& symbol : symbols.symbols())
+        {
+            if(symbol.Name == name)
+            {
+                return &symbol;
+            }
+        }
+        return nullptr;
+    }
+
+    bool endsWith(const std::string& text, const std::string& suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Checks that some address of function maps to line
+    bool hasLine(const LineTable& lines, const Symbol& function, uint32_t line)
+    {
+        for(uint64_t address = function.Address; address < function.Address + function.Size; address++)
+        {
+            const LineRange* range = lines.find(address);
+            if(range != nullptr && range->Line == line)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void checkFixture(const std::string& path)
+    {
+        const ElfFile elf = ElfFile::load(path);
+        const SymbolTable symbols = SymbolTable::fromElf(elf);
+
+        const Symbol* square = findByName(symbols, "FixtureSquare");
+        const Symbol* loop = findByName(symbols, "FixtureLoop");
+        CHECK(square != nullptr);
+        CHECK(loop != nullptr);
+        CHECK(square->Size > 0);
+        CHECK(findByName(symbols, "FixtureSink") == nullptr);
+
+        CHECK(symbols.find(square->Address) == square);
+        CHECK(symbols.find(square->Address + square->Size - 1) == square);
+        CHECK(symbols.find(square->Address + square->Size) != square);
+        CHECK(symbols.find(loop->Address + 1) == loop);
+
+        const LineTable lines = LineTable::fromElf(elf);
+        const LineRange* entry = lines.find(square->Address);
+        CHECK(entry != nullptr);
+        CHECK(endsWith(lines.files()[entry->File], "symbol_functions.c"));
+        CHECK(entry->Line >= SquareFirstLine && entry->Line <= SquareLastLine);
+        CHECK(hasLine(lines, *square, SquareReturnLine));
+        CHECK(hasLine(lines, *loop, LoopBodyLine));
+        CHECK(!hasLine(lines, *square, LoopBodyLine));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    CHECK(argc == 3);
+
+    // Default DWARF version of compiler and DWARF 4 (different file table encoding)
+    checkFixture(argv[1]);
+    checkFixture(argv[2]);
+
+    // Aliases at the same address keep first symbol, symbols without size extend to next one
+    const SymbolTable symbols({{"Reset_Handler", 0x100, 0},
+                               {"Default_Handler", 0x140, 4},
+                               {"SysTick_Handler", 0x140, 4},
+                               {"main", 0x200, 0x20}});
+    CHECK_EQ(symbols.symbols().size(), 3U);
+    CHECK(symbols.find(0xFF) == nullptr);
+    CHECK(symbols.find(0x13E)->Name == "Reset_Handler");
+    CHECK(symbols.find(0x142)->Name == "Default_Handler");
+    CHECK(symbols.find(0x144) == nullptr);
+    CHECK(symbols.find(0x21F)->Name == "main");
+    CHECK(symbols.find(0x220) == nullptr);
+
+    const LineTable lines({"main.c"}, {{0x210, 0x218, 0, 12}, {0x200, 0x210, 0, 10}});
+    CHECK_EQ(lines.find(0x200)->Line, 10U);
+    CHECK_EQ(lines.find(0x217)->Line, 12U);
+    CHECK(lines.find(0x218) == nullptr);
+    CHECK(lines.find(0x1FF) == nullptr);
+
+    return 0;
+}
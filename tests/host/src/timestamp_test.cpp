@@ -0,0 +1,107 @@
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/timestamp.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    ItmPacket make(ItmPacketType type, uint32_t value, uint8_t size = 1, uint8_t info = 0)
+    {
+        ItmPacket packet;
+        packet.Type = type;
+        packet.Size = size;
+        packet.Info = info;
+        packet.Value = value;
+        return packet;
+    }
+
+    ItmPacket stimulus(uint32_t value)
+    {
+        return make(ItmPacketType::Stimulus, value, 4);
+    }
+}
+
+int main()
+{
+    std::vector<ItmTimedPacket> packets;
+    ItmTimestampReconstructor timestamps([&packets](const ItmTimedPacket& packet) { packets.push_back(packet); },
+                                         4);
+
+    // Packets are delayed until following local timestamp and get its time
+    timestamps.add(stimulus(1));
+    timestamps.add(stimulus(2));
+    CHECK(packets.empty());
+    timestamps.add(make(ItmPacketType::LocalTimestamp, 10));
+    CHECK_EQ(packets.size(), size_t{3});
+    CHECK_EQ(packets[0].Packet.Value, 1U);
+    CHECK_EQ(packets[1].Packet.Value, 2U);
+    CHECK_EQ(packets[0].Time, uint64_t{40});
+    CHECK_EQ(packets[2].Time, uint64_t{40});
+    CHECK(packets[0].Quality == ItmTimeQuality::Synchronous);
+    CHECK(packets[2].Packet.Type == ItmPacketType::LocalTimestamp);
+
+    // Deltas accumulate, TC field is reported as quality
+    timestamps.add(stimulus(3));
+    timestamps.add(make(ItmPacketType::LocalTimestamp, 5, 1, 2));
+    CHECK_EQ(packets[3].Time, uint64_t{60});
+    CHECK(packets[3].Quality == ItmTimeQuality::PacketDelayed);
+    CHECK_EQ(timestamps.time(), uint64_t{60});
+
+    // Global timestamp is not valid until full GTS1
+    CHECK(!packets[3].GlobalValid);
+    packets.clear();
+    timestamps.add(make(ItmPacketType::GlobalTimestamp1, 0x0123456, 4));
+    timestamps.add(stimulus(4));
+    timestamps.add(make(ItmPacketType::GlobalTimestamp1, 0x7F, 1));
+    timestamps.add(stimulus(5));
+    timestamps.add(make(ItmPacketType::LocalTimestamp, 1));
+    CHECK_EQ(packets.size(), size_t{5});
+    CHECK(packets[1].GlobalValid);
+    CHECK_EQ(packets[1].GlobalTime, uint64_t{0x0123456});
+    // Partial GTS1 replaces only bytes sent
+    CHECK_EQ(packets[3].GlobalTime, uint64_t{0x012347F});
+
+    // Wrap flag invalidates global timestamp until GTS2 supplies high bits
+    packets.clear();
+    timestamps.add(make(ItmPacketType::GlobalTimestamp1, 0x10, 4, 0x02));
+    timestamps.add(stimulus(6));
+    timestamps.add(make(ItmPacketType::GlobalTimestamp2, 0x3));
+    timestamps.add(stimulus(7));
+    timestamps.flush();
+    CHECK_EQ(packets.size(), size_t{4});
+    CHECK(!packets[1].GlobalValid);
+    CHECK(packets[3].GlobalValid);
+    CHECK_EQ(packets[3].GlobalTime, (uint64_t{3} << 26) | 0x10);
+    CHECK(packets[3].Quality == ItmTimeQuality::Approximate);
+
+    // Overflow starts new epoch and invalidates global timestamp
+    packets.clear();
+    timestamps.add(stimulus(8));
+    timestamps.add(make(ItmPacketType::Overflow, 0));
+    timestamps.add(stimulus(9));
+    timestamps.add(make(ItmPacketType::LocalTimestamp, 2));
+    CHECK_EQ(packets.size(), size_t{4});
+    CHECK_EQ(packets[0].Epoch, 0U);
+    CHECK(packets[0].Quality == ItmTimeQuality::Approximate);
+    CHECK_EQ(packets[1].Epoch, 1U);
+    CHECK_EQ(packets[2].Epoch, 1U);
+    CHECK(!packets[2].GlobalValid);
+    CHECK_EQ(packets[2].Time, uint64_t{72});
+    CHECK_EQ(timestamps.epoch(), 1U);
+
+    // Pending packets are bounded, oldest are released without waiting for timestamp
+    packets.clear();
+    for(uint32_t i = 0; i < ItmTimestampReconstructor::MaxPending + 3; i++)
+    {
+        timestamps.add(stimulus(i));
+    }
+    CHECK_EQ(packets.size(), size_t{3});
+    CHECK_EQ(packets[2].Packet.Value, 2U);
+    timestamps.flush();
+    CHECK_EQ(packets.size(), ItmTimestampReconstructor::MaxPending + 3);
+    CHECK_EQ(packets.back().Packet.Value, static_cast<uint32_t>(ItmTimestampReconstructor::MaxPending + 2));
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/tpiu.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    // Single slot of frame: data byte or ID change
+    struct Slot
+    {
+        bool Id;
+        uint8_t Value;
+        bool Delayed;
+    };
+
+    Slot data(uint8_t value)
+    {
+        return Slot{false, value, false};
+    }
+
+    Slot id(uint8_t value, bool delayed = false)
+    {
+        return Slot{true, value, delayed};
+    }
+
+    // Same encoding as TPIU formatter, 15 slots per frame
+    void pushFrame(std::vector<uint8_t>& stream, const std::vector<Slot>& slots)
+    {
+        uint8_t aux = 0;
+        for(size_t i = 0; i < 15; i++)
+        {
+            const Slot& slot = slots[i];
+            if(i % 2 == 1)
+            {
+                stream.push_back(slot.Value);
+            }
+            else if(slot.Id)
+            {
+                stream.push_back(static_cast<uint8_t>((slot.Value << 1) | 1));
+                aux |= static_cast<uint8_t>((slot.Delayed ? 1 : 0) << (i / 2));
+            }
+            else
+            {
+                stream.push_back(slot.Value & 0xFE);
+                aux |= static_cast<uint8_t>((slot.Value & 1) << (i / 2));
+            }
+        }
+        stream.push_back(aux);
+    }
+
+    std::map<uint8_t, std::vector<uint8_t>> deframe(const std::vector<uint8_t>& stream, size_t chunk,
+                                                    TpiuDeframer::Statistics& statistics)
+    {
+        std::map<uint8_t, std::vector<uint8_t>> outputs;
+        TpiuDeframer deframer([&outputs](uint8_t source, const uint8_t* bytes, size_t size) {
+            outputs[source].insert(outputs[source].end(), bytes, bytes + size);
+        });
+        for(size_t offset = 0; offset < stream.size(); offset += chunk)
+        {
+            deframer.feed(stream.data() + offset, std::min(chunk, stream.size() - offset));
+        }
+        statistics = deframer.statistics();
+        return outputs;
+    }
+}
+
+int main()
+{
+    std::vector<uint8_t> stream = {0x12, 0x34, 0xFF, 0xFF, 0xFF, 0x7F};
+    std::vector<uint8_t> expected1;
+    std::vector<uint8_t> expected2;
+
+    std::vector<Slot> slots = {id(1)};
+    for(uint8_t i = 0; i < 14; i++)
+    {
+        slots.push_back(data(static_cast<uint8_t>(0xA0 + i)));
+        expected1.push_back(static_cast<uint8_t>(0xA0 + i));
+    }
+    pushFrame(stream, slots);
+
+    // Data-only frames with all combinations of least significant bits
+    for(int frame = 0; frame < 20; frame++)
+    {
+        slots.clear();
+        for(int i = 0; i < 15; i++)
+        {
+            const uint8_t value = static_cast<uint8_t>(frame * 37 + i * 11);
+            slots.push_back(data(value));
+            expected1.push_back(value);
+        }
+        pushFrame(stream, slots);
+    }
+
+    stream.push_back(0xFF); // Halfword synchronization
+    stream.push_back(0x7F);
+
+    // Delayed ID change: byte after ID still belongs to previous source
+    slots = {data(0x01), data(0x02), id(2, true), data(0x03)};
+    expected1.insert(expected1.end(), {0x01, 0x02, 0x03});
+    for(uint8_t i = 0; i < 11; i++)
+    {
+        slots.push_back(data(static_cast<uint8_t>(0x50 + i)));
+        expected2.push_back(static_cast<uint8_t>(0x50 + i));
+    }
+    pushFrame(stream, slots);
+
+    stream.insert(stream.end(), {0xFF, 0xFF, 0xFF, 0x7F});
+
+    // Null source is discarded, ID change in last slot applies to next frame
+    slots = {id(0), data(0xEE), data(0xEE), data(0xEE), id(2), data(0x60)};
+    expected2.push_back(0x60);
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        slots.push_back(data(static_cast<uint8_t>(0x61 + i)));
+        expected2.push_back(static_cast<uint8_t>(0x61 + i));
+    }
+    slots.push_back(id(1));
+    pushFrame(stream, slots);
+
+    slots.clear();
+    for(uint8_t i = 0; i < 15; i++)
+    {
+        slots.push_back(data(static_cast<uint8_t>(0x10 + i)));
+        expected1.push_back(static_cast<uint8_t>(0x10 + i));
+    }
+    pushFrame(stream, slots);
+
+    for(size_t chunk : {stream.size(), size_t{1}, size_t{7}, size_t{16}})
+    {
+        TpiuDeframer::Statistics statistics;
+        auto outputs = deframe(stream, chunk, statistics);
+        CHECK_EQ(outputs.size(), 2u);
+        CHECK(outputs[1] == expected1);
+        CHECK(outputs[2] == expected2);
+        CHECK_EQ(statistics.Frames, 24u);
+        CHECK_EQ(statistics.Syncs, 2u);
+        CHECK_EQ(statistics.HalfSyncs, 1u);
+        CHECK_EQ(statistics.SyncLosses, 0u);
+        CHECK_EQ(statistics.DiscardedBytes, 3u);
+    }
+
+    return 0;
+}
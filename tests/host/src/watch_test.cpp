@@ -0,0 +1,72 @@
+#include <vector>
+
+#include "check.hpp"
+#include "orbcode/decoder/watch.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    constexpr uint8_t TagPort = 29;
+
+    void pushTag(std::vector<uint8_t>& stream, uint8_t comparator, uint16_t region)
+    {
+        const uint32_t tag = (static_cast<uint32_t>(WatchTagMarker) << 24) | (comparator << 16) | region;
+        stream.push_back((TagPort << 3) | 0x03);
+        for(int i = 0; i < 4; i++)
+        {
+            stream.push_back(static_cast<uint8_t>(tag >> (8 * i)));
+        }
+    }
+
+    void pushAddress(std::vector<uint8_t>& stream, uint8_t comparator, uint16_t offset)
+    {
+        stream.push_back(static_cast<uint8_t>(((0x09 | (comparator << 1)) << 3) | 0x06));
+        stream.push_back(static_cast<uint8_t>(offset));
+        stream.push_back(static_cast<uint8_t>(offset >> 8));
+    }
+
+    void pushPCAndValue(std::vector<uint8_t>& stream, uint8_t comparator, uint32_t pc, uint8_t value)
+    {
+        stream.push_back(static_cast<uint8_t>(((0x08 | (comparator << 1)) << 3) | 0x07));
+        for(int i = 0; i < 4; i++)
+        {
+            stream.push_back(static_cast<uint8_t>(pc >> (8 * i)));
+        }
+        stream.push_back(static_cast<uint8_t>(((0x11 | (comparator << 1)) << 3) | 0x05));
+        stream.push_back(value);
+    }
+}
+
+int main()
+{
+    std::vector<uint8_t> stream;
+    pushTag(stream, 0, 5);
+    pushTag(stream, 1, 6);
+    pushAddress(stream, 0, 0x10);
+    pushPCAndValue(stream, 1, 0x08000100, 0x42); // Single access with two packets
+    pushTag(stream, 0, 7);
+    pushAddress(stream, 0, 0x20);
+    pushAddress(stream, 0, 0x24);
+    pushAddress(stream, 2, 0x30); // Comparator without tag
+    stream.push_back(0x70);
+    pushTag(stream, 0, 5);
+
+    WatchHeatmap heatmap(TagPort);
+    ItmPacketDecoder decoder([&heatmap](const ItmPacket& packet) { heatmap.add(packet); }, true);
+    decoder.feed(stream.data(), stream.size());
+
+    const auto& regions = heatmap.regions();
+    CHECK_EQ(regions.size(), 3u);
+    CHECK_EQ(regions.at(5).Accesses, 1u);
+    CHECK_EQ(regions.at(5).Steps, 2u);
+    CHECK_EQ(regions.at(5).rate(), 0.5);
+    CHECK_EQ(regions.at(6).Accesses, 1u);
+    CHECK_EQ(regions.at(6).Steps, 1u);
+    CHECK_EQ(regions.at(7).Accesses, 2u);
+    CHECK_EQ(regions.at(7).rate(), 2.0);
+    CHECK_EQ(heatmap.untagged(), 1u);
+    CHECK_EQ(heatmap.overflows(), 1u);
+
+    return 0;
+}
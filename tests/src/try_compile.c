@@ -1,5 +1,237 @@
 #include "ARMCM3.h"
 
 #include "orbcode/trace/dwt.h"
+#include "orbcode/trace/dwt_counters.h"
+#include "orbcode/trace/etm.h"
+#include "orbcode/trace/funnel.h"
+#include "orbcode/trace/exception_trace.h"
+#include "orbcode/trace/timestamp.h"
 #include "orbcode/trace/tpiu.h"
+#include "orbcode/trace/capabilities.h"
+#include "orbcode/trace/swo_planner.h"
+#include "orbcode/trace/watch_rotation.h"
 #include "orbcode/trace/itm.h"
+#include "orbcode/trace/atomic.h"
+#include "orbcode/trace/itm_buffer.h"
+#include "orbcode/trace/itm_dma.h"
+#include "orbcode/trace/itm_lowpower.h"
+#include "orbcode/trace/itm_atomic.h"
+#include "orbcode/trace/itm_frame.h"
+#include "orbcode/trace/delta.h"
+#include "orbcode/trace/event.h"
+#include "orbcode/trace/flight_recorder.h"
+#include "orbcode/trace/profile.h"
+#include "orbcode/trace/histogram.h"
+#include "orbcode/trace/bench.h"
+#include "orbcode/trace/log.h"
+
+void TryCompileLog(int value)
+{
+    TRACE_LOG(1, "no arguments");
+    TRACE_LOG(1, "value %d, float %f", value, TraceLogFloat(1.5f));
+}
+
+typedef struct
+{
+    uint32_t Timestamp;
+    int16_t Current[3];
+    char Phase[2];
+} TryCompileMotorEvent;
+
+TRACE_EVENT_DEFINE(TryCompileMotorEvent, "u32 timestamp; i16 current[3]; char phase[2]");
+
+void TryCompileEvent(const TryCompileMotorEvent* event)
+{
+    TRACE_EVENT(4, TryCompileMotorEvent, event);
+}
+
+void TryCompileFilter(uint32_t value)
+{
+    ITM_WRITE8(2, (uint8_t)value);
+    ITM_WRITE16(2, (uint16_t)value);
+    ITM_WRITE32(2, value);
+    ITM_WRITE_BUFFER(2, &value, sizeof(value));
+    TRACE_LOG_ERROR(1, "error %u", value);
+    TRACE_LOG_WARNING(1, "warning");
+    TRACE_LOG_INFO(1, "info");
+    TRACE_LOG_DEBUG(1, "debug");
+}
+
+int TryCompileScope(int value)
+{
+    TRACE_SCOPE(1);
+    if(value > 0)
+    {
+        TRACE_SCOPE(2);
+        return value;
+    }
+    return 0;
+}
+
+bool TryCompileComparator(uint32_t* variable)
+{
+    if(DWTComparatorCount() > 1)
+    {
+        DWTEnableComparator(1, (uintptr_t)variable, 2, true, 0x6);
+    }
+    bool matched = DWTComparatorMatched(1);
+    DWTDisableComparator(1);
+    return matched;
+}
+
+bool TryCompileWatchRotation(TraceWatchRotation* rotation, const TraceWatchRegion* regions, uint16_t count)
+{
+    TraceWatchRotationOptions options = {
+        .Regions = regions,
+        .RegionCount = count,
+        .FirstComparator = 1,
+        .TagPort = 29,
+    };
+    if(!TraceWatchRotationStart(rotation, &options))
+    {
+        return false;
+    }
+    TraceWatchRotationStep(rotation);
+    TraceWatchRotationStop(rotation);
+    return true;
+}
+
+void TryCompileReconfigure(uint8_t prescaler)
+{
+    DWTPCSamplingStart();
+    DWTSetSamplingPrescaler(prescaler);
+    DWTEnableCounterEvents(DWT_COUNTER_EVENT_CPI | DWT_COUNTER_EVENT_LSU);
+    ITMDisablePorts(1UL << 3);
+    ITMEnablePorts(ITMGetPortMask() | (1UL << 3));
+    DWTDisableCounterEvents(DWT_COUNTER_EVENT_ALL);
+    DWTPCSamplingStop();
+}
+
+void TryCompileExceptionTrace(void)
+{
+    TraceExceptionTraceEnable();
+    TraceExceptionPend(Interrupt0_IRQn);
+    TraceExceptionMarkPending(SysTick_IRQn + 16);
+    TraceExceptionTraceDisable();
+}
+
+bool TryCompileCapabilities(const DWTOptions* options)
+{
+    TraceCapabilities caps;
+    TraceProbeCapabilities(&caps);
+
+    DWTOptions applied;
+    return DWTSetupChecked(&caps, options, &applied) == TraceSetupApplied;
+}
+
+bool TryCompileSwoPlanner(uint32_t coreClock)
+{
+    TpiuOptions tpiu = {.Protocol = TpiuProtocolSwoUart};
+    ITMOptions itm = {.TraceBusID = 1, .EnableLocalTimestamp = true};
+    DWTOptions dwt = {.PCSampling = true};
+    TraceSwoTargets targets = {
+        .TraceClock = coreClock,
+        .CoreClock = coreClock,
+        .MaxBaudrate = 2000000,
+        .PCSampleRate = 10000,
+        .ITMPayloadRate = 20000,
+    };
+    TraceSwoPlan plan;
+    return TracePlanSwo(&targets, &tpiu, &itm, &dwt, &plan);
+}
+
+uint32_t TryCompileStatistics(void)
+{
+    ITMPortStatistics statistics;
+    ITMStatisticsRead(2, &statistics);
+    ITMStatisticsReset();
+    return statistics.Writes;
+}
+
+bool TryCompileEtm(uintptr_t start, uintptr_t end)
+{
+    const ETMAddressRange ranges[] = {{.Start = start, .End = end}};
+    ETMOptions options = {
+        .TraceBusID = 2,
+        .BranchBroadcast = true,
+        .Timestamps = true,
+        .Ranges = ranges,
+        .RangeCount = ETMAddressRangeCount() > 0 ? 1 : 0,
+    };
+    bool result = ETMSetup(&options);
+    ETMDisable();
+    return result;
+}
+
+bool TryCompileFunnel(uintptr_t base, uint32_t bandwidth)
+{
+    TraceFunnelTargets targets = {.PortRates = {[0] = 20000, [1] = 4000000, [2] = 10000}, .Bandwidth = bandwidth};
+    TraceFunnelOptions funnel = {.Base = base};
+    TraceFunnelPlan plan;
+    if(!TracePlanFunnel(&targets, &funnel, &plan) || !TraceFunnelSetup(&funnel))
+    {
+        TraceFunnelDisable(base);
+        return false;
+    }
+
+    ITMOptions itm = {.TraceBusID = TRACE_FUNNEL_TRACE_ID(1, TraceSourceItm)};
+    ITMSetup(&itm);
+    return TraceFunnelPortCount(base) > 2U;
+}
+
+uint32_t TryCompilePortWidth(uint32_t traceClock)
+{
+    TpiuPortWidthSelection selection;
+    if(!TpiuSelectPortWidth(TPIU_PORT_WIDTH_MASK(4) | TPIU_PORT_WIDTH_MASK(2) | TPIU_PORT_WIDTH_MASK(1), traceClock,
+                            &selection))
+    {
+        return 0;
+    }
+    return selection.Bandwidth;
+}
+
+void TryCompileDelta(const int32_t* samples)
+{
+    static TraceDeltaEncoder encoder;
+    TraceDeltaInit(&encoder, 9, 1, 4, 64);
+    TraceDeltaWrite(&encoder, samples);
+    TraceDeltaRequestKey(&encoder);
+
+    uint8_t record[TRACE_DELTA_MAX_RECORD_SIZE(4)];
+    ITMFrameWrite(9, record, TraceDeltaEncode(&encoder, samples, record));
+}
+
+void TryCompileLowPower(void)
+{
+    static uint8_t storage[256];
+    static ITMBuffer buffer;
+    static ITMLowPower power;
+    ITMBufferInit(&buffer, 1, storage, sizeof(storage));
+
+    ITMLowPowerOptions options = {.Buffer = &buffer, .Watermark = sizeof(storage) / 2};
+    ITMLowPowerInit(&power, &options);
+    ITMBufferWrite(&buffer, "A", 1);
+    ITMLowPowerPoll(&power);
+    ITMLowPowerSleep(&power);
+
+    ITMLowPowerStatistics statistics;
+    ITMLowPowerReadStatistics(&power, &statistics, true);
+}
+
+TRACE_FLIGHT_RECORDER_NOINIT static TraceFlightRecorder TryCompileRecorder;
+TRACE_FLIGHT_RECORDER_NOINIT static uint32_t TryCompileRecorderStorage[64];
+
+void TryCompileFlightRecorder(uint32_t reason)
+{
+    if(TraceFlightRecorderInit(&TryCompileRecorder, TryCompileRecorderStorage, sizeof(TryCompileRecorderStorage)) &&
+       TraceFlightRecorderIsFrozen(&TryCompileRecorder))
+    {
+        TraceFlightRecorderDump(&TryCompileRecorder, 31, 16, TraceFlightRecorderItmSink, NULL);
+        TraceFlightRecorderClear(&TryCompileRecorder);
+    }
+
+    const uint32_t message[] = {TraceLogHeader("value %u", 1), reason};
+    TraceFlightRecorderWrite(&TryCompileRecorder, 1, message, sizeof(message));
+    TraceFlightRecorderWriteEvent(&TryCompileRecorder, 4, message[0], &reason, sizeof(reason));
+    TraceFlightRecorderFreeze(&TryCompileRecorder, reason);
+}
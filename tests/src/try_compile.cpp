@@ -1,5 +1,65 @@
 #include "ARMCM3.h"
 
 #include "orbcode/trace/dwt.h"
+#include "orbcode/trace/dwt_counters.h"
+#include "orbcode/trace/etm.h"
+#include "orbcode/trace/funnel.h"
+#include "orbcode/trace/exception_trace.h"
+#include "orbcode/trace/timestamp.h"
 #include "orbcode/trace/tpiu.h"
-#include "orbcode/trace/itm.h"
\ No newline at end of file
+#include "orbcode/trace/capabilities.h"
+#include "orbcode/trace/swo_planner.h"
+#include "orbcode/trace/watch_rotation.h"
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/atomic.h"
+#include "orbcode/trace/itm_buffer.h"
+#include "orbcode/trace/itm_dma.h"
+#include "orbcode/trace/itm_lowpower.h"
+#include "orbcode/trace/itm_atomic.h"
+#include "orbcode/trace/itm_frame.h"
+#include "orbcode/trace/delta.h"
+#include "orbcode/trace/event.h"
+#include "orbcode/trace/flight_recorder.h"
+#include "orbcode/trace/profile.h"
+#include "orbcode/trace/histogram.h"
+#include "orbcode/trace/bench.h"
+#include "orbcode/trace/log.h"
+#include "orbcode/trace/itm.hpp"
+#include "orbcode/trace/profile.hpp"
+
+void TryCompileLog(int value)
+{
+    TRACE_LOG(1, "no arguments");
+    TRACE_LOG(1, "value %d, float %f", value, TraceLogFloat(1.5f));
+}
+
+struct TryCompileSample
+{
+    uint16_t Channel;
+    int32_t Value;
+    uint8_t Flags[3];
+};
+
+TRACE_EVENT_DEFINE(TryCompileSample, "u16 channel; i32 value; u8 flags[3]");
+
+void TryCompileEvent(const TryCompileSample& sample)
+{
+    TRACE_EVENT(4, TryCompileSample, &sample);
+}
+
+void TryCompilePort(const TryCompileSample& sample, const uint8_t (&block)[64])
+{
+    using SamplePort = orbcode::trace::Port<5>;
+    SamplePort::write(sample);
+    SamplePort::write(uint8_t{1});
+    SamplePort::write(uint16_t{2});
+    SamplePort::write(uint32_t{3});
+    SamplePort::write(block);
+    SamplePort::write(&sample, sizeof(sample));
+}
+
+void TryCompileProfileScope()
+{
+    orbcode::trace::ProfileScope scope(3);
+    TRACE_SCOPE(4);
+}
@@ -0,0 +1,25 @@
+#include "ARMCM3.h"
+
+#define ITM_COMPILED_PORT_MASK 0x00000003UL
+#define TRACE_LOG_LEVEL TRACE_LOG_LEVEL_WARNING
+
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/log.h"
+
+typedef char TryCompileFilterPort0[ITM_IS_PORT_COMPILED(0) ? 1 : -1];
+typedef char TryCompileFilterPort5[ITM_IS_PORT_COMPILED(5) ? -1 : 1];
+
+static int TryCompileFilterSideEffect(void)
+{
+    static int counter;
+    return ++counter;
+}
+
+void TryCompileFilterDisabled(void)
+{
+    ITM_WRITE32(5, TryCompileFilterSideEffect());
+    TRACE_LOG(5, "port disabled %d", TryCompileFilterSideEffect());
+    TRACE_LOG_WARNING(1, "kept %d", TryCompileFilterSideEffect());
+    TRACE_LOG_INFO(1, "removed %d", TryCompileFilterSideEffect());
+    TRACE_LOG_DEBUG(1, "removed %d", TryCompileFilterSideEffect());
+}
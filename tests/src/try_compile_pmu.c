@@ -0,0 +1,47 @@
+#include "ARMCM55.h"
+
+#define TRACE_PROFILE_PMU_COUNTERS 2
+#define TRACE_BENCH_PMU_COUNTERS 2
+
+#include "orbcode/trace/bench.h"
+#include "orbcode/trace/pmu.h"
+#include "orbcode/trace/profile.h"
+
+static PMUCounterAccumulator Accumulator;
+
+static void TryCompilePmuKernel(void* context)
+{
+    (*(volatile uint32_t*)context)++;
+}
+
+void TryCompilePmuSetup(void)
+{
+    PMUOptions options = {
+        .Events = {ARM_PMU_L1D_CACHE_REFILL, ARM_PMU_MVE_STALL},
+        .Count = 2,
+        .CycleCounter = true,
+    };
+    PMUSetup(&options);
+    PMUCounterAccumulatorInit(&Accumulator, options.Count);
+}
+
+uint64_t TryCompilePmuMeasure(uint32_t value)
+{
+    PMUCounters before, after;
+    PMUCounterAccumulatorRead(&Accumulator, &before);
+
+    {
+        TRACE_SCOPE(1);
+        ITMWrite32(1, value + PMUReadCounter(0) + PMUCycles());
+    }
+
+    volatile uint32_t counter = value;
+    const TraceBenchmark benchmark = {.Name = "kernel", .Function = TryCompilePmuKernel, .Context = (void*)&counter,
+                                      .Runs = 8};
+    TraceBenchRun(2, &benchmark, 1, 1, false);
+
+    PMUCounterAccumulatorRead(&Accumulator, &after);
+    PMUCounters delta = PMUCountersDelta(&before, &after);
+    PMUStop();
+    return delta.Cycles + delta.Events[0] + PMUCounterEvent(1);
+}
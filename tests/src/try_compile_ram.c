@@ -0,0 +1,43 @@
+#include "ARMCM0plus.h"
+
+#include "orbcode/trace/delta.h"
+#include "orbcode/trace/event.h"
+#include "orbcode/trace/flight_recorder.h"
+#include "orbcode/trace/itm.h"
+#include "orbcode/trace/itm_buffer.h"
+#include "orbcode/trace/itm_frame.h"
+#include "orbcode/trace/itm_lowpower.h"
+#include "orbcode/trace/log.h"
+
+#if ITM_BACKEND != ITM_BACKEND_RAM
+#    error "RAM backend expected on ARMv6-M"
+#endif
+
+ITMRamControlBlock ITMRamControl;
+
+static uint8_t TraceRam[256];
+
+void TryCompileRamInit(void)
+{
+    ITMRamInit(TraceRam, sizeof(TraceRam));
+
+    ITMOptions options = {.EnabledStimulusPorts = ITM_ENABLE_STIMULUS_PORTS_ALL};
+    ITMSetup(&options);
+}
+
+size_t TryCompileRamWrite(uint32_t value)
+{
+    ITMWrite8(1, (uint8_t)value);
+    ITMWrite16(1, (uint16_t)value);
+    ITMWrite32(1, value);
+    ITMWriteBuffer(2, &value, sizeof(value));
+    (void)ITMTryWriteBuffer(2, &value, sizeof(value));
+    ITMFrameWrite(3, &value, sizeof(value));
+    TRACE_LOG(4, "Value %u", value);
+
+    ITMPortHandle handle;
+    ITMPortAcquire(&handle, 5);
+    ITMPortWrite32(&handle, value);
+
+    return ITMRamGetFree() + ITMRamGetLost();
+}
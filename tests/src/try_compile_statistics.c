@@ -0,0 +1,27 @@
+#include "ARMCM3.h"
+
+#define ITM_STATISTICS_ENABLED 1
+#define ITM_STATISTICS_WAIT_CYCLES 1
+#define ITM_STALL_POLICY ITM_STALL_SPIN
+#define ITM_STALL_PORT_MASK 0x00000008UL
+
+#include "orbcode/trace/itm.h"
+
+ITMStatistics ITMStatisticsData;
+
+uint32_t TryCompileStatisticsEnabled(uint32_t value)
+{
+    ITMWrite32(3, value);
+    ITM_WRITE_BUFFER(3, &value, sizeof(value));
+    (void)ITMTryWrite8(3, (uint8_t)value);
+    (void)ITMTryWriteBuffer(3, &value, sizeof(value));
+
+    ITMPortHandle handle;
+    ITMPortAcquire(&handle, 3);
+    ITMPortWrite16(&handle, (uint16_t)value);
+
+    ITMPortStatistics statistics;
+    ITMStatisticsRead(3, &statistics);
+    ITMStatisticsReset();
+    return statistics.Bytes + statistics.Waits + statistics.Dropped;
+}
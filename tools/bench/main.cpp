@@ -0,0 +1,193 @@
+// Prints benchmark results sent by TraceBenchReport() and optionally compares them with baseline. Input is raw data of
+// benchmark result stimulus port (file or stdin).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "orbcode/decoder/bench.hpp"
+#include "orbcode/decoder/pmu.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " [--csv] [--baseline <file.csv>] [--threshold <percent>] [input]\n"
+                  << "\n"
+                  << "Prints benchmark results read from input (default: stdin).\n"
+                  << "\n"
+                  << "  --csv                  Print results as CSV (can be saved and used as baseline later)\n"
+                  << "  --baseline <file.csv>  Compare median cycles with results saved earlier with --csv\n"
+                  << "  --threshold <percent>  Median increase reported as regression (default: 5)\n"
+                  << "\n"
+                  << "PMU counter sums (if reported by target) are printed as EVENT=sum after other columns.\n"
+                  << "\n"
+                  << "Exit code is 3 when any benchmark regressed compared to baseline.\n";
+    }
+
+    // EVENT<separator>sum pairs joined with delimiter
+    std::string formatPmu(const BenchResult& result, char separator, char delimiter)
+    {
+        std::string text;
+        for(const BenchPmuCounter& counter : result.Pmu)
+        {
+            if(!text.empty())
+            {
+                text.push_back(delimiter);
+            }
+            text += pmuEventName(counter.Event);
+            text.push_back(separator);
+            text += std::to_string(counter.Sum);
+        }
+        return text;
+    }
+
+    // Median cycles by benchmark name
+    bool loadBaseline(const std::string& path, std::map<std::string, uint32_t>& baseline)
+    {
+        std::ifstream file(path);
+        if(!file)
+        {
+            return false;
+        }
+
+        std::string line;
+        while(std::getline(file, line))
+        {
+            std::vector<std::string> fields;
+            std::stringstream stream(line);
+            std::string field;
+            while(std::getline(stream, field, ','))
+            {
+                fields.push_back(field);
+            }
+
+            if(fields.size() < 4 || fields[0] == "name")
+            {
+                continue;
+            }
+            baseline[fields[0]] = static_cast<uint32_t>(std::strtoul(fields[3].c_str(), nullptr, 10));
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool csv = false;
+    double threshold = 5.0;
+    std::string baselinePath;
+    std::string inputPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--csv") == 0)
+        {
+            csv = true;
+        }
+        else if(std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baselinePath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = std::strtod(argv[++i], nullptr);
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::map<std::string, uint32_t> baseline;
+    if(!baselinePath.empty() && !loadBaseline(baselinePath, baseline))
+    {
+        std::cerr << "Cannot open " << baselinePath << "\n";
+        return 1;
+    }
+
+    FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if(input == nullptr)
+    {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+
+    if(csv)
+    {
+        std::printf("name,runs,min,median,max,cpi,lsu,pmu\n");
+    }
+    else
+    {
+        std::printf("%-32s %6s %10s %10s %10s %10s %10s %9s\n", "benchmark", "runs", "min", "median", "max", "cpi",
+                    "lsu", "vs base");
+    }
+
+    int regressions = 0;
+    BenchDecoder decoder([&](const BenchResult& result) {
+        if(csv)
+        {
+            std::printf("%s,%u,%u,%u,%u,%u,%u,%s\n", result.Name.c_str(), result.Runs, result.Min, result.Median,
+                        result.Max, result.CPI, result.LSU, formatPmu(result, ':', ';').c_str());
+        }
+
+        std::string change = "-";
+        auto base = baseline.find(result.Name);
+        if(base != baseline.end() && base->second > 0)
+        {
+            const double percent = (static_cast<double>(result.Median) - base->second) * 100.0 / base->second;
+            char text[32];
+            std::snprintf(text, sizeof(text), "%+.1f%%", percent);
+            change = text;
+            if(percent > threshold)
+            {
+                regressions++;
+                std::cerr << "Regression: " << result.Name << " median " << base->second << " -> " << result.Median
+                          << " cycles\n";
+            }
+        }
+
+        if(!csv)
+        {
+            if(result.Counters)
+            {
+                std::printf("%-32s %6u %10u %10u %10u %10u %10u %9s", result.Name.c_str(), result.Runs, result.Min,
+                            result.Median, result.Max, result.CPI, result.LSU, change.c_str());
+            }
+            else
+            {
+                std::printf("%-32s %6u %10u %10u %10u %10s %10s %9s", result.Name.c_str(), result.Runs, result.Min,
+                            result.Median, result.Max, "-", "-", change.c_str());
+            }
+            const std::string pmu = formatPmu(result, '=', ' ');
+            std::printf(pmu.empty() ? "\n" : "  %s\n", pmu.c_str());
+        }
+    });
+
+    uint8_t buffer[4096];
+    size_t read;
+    while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        decoder.feed(buffer, read);
+    }
+
+    if(input != stdin)
+    {
+        std::fclose(input);
+    }
+
+    return regressions > 0 ? 3 : 0;
+}
@@ -0,0 +1,127 @@
+// Splits TPIU formatted stream of several trace sources (e.g. cores merged by trace funnel) into one raw stream per
+// source and prints amount of data of each. Input is file or stdin.
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "orbcode/decoder/funnel.hpp"
+#include "orbcode/decoder/tpiu.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " [--output <prefix>] [--synchronized] [input]\n"
+                  << "\n"
+                  << "Splits TPIU formatted input (default: stdin) by trace source ID. Sources configured with\n"
+                  << "TRACE_FUNNEL_TRACE_ID are named by core (core0-itm, core1-etm, ...), others by ID (id1).\n"
+                  << "\n"
+                  << "  --output <prefix>  Write data of each source to <prefix>-<source>.bin (raw ITM/ETM stream)\n"
+                  << "  --synchronized     Input starts at frame boundary, do not wait for sync packet\n";
+    }
+
+    struct Source
+    {
+        FILE* File = nullptr;
+        uint64_t Bytes = 0;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    std::string prefix;
+    bool synchronized = false;
+    std::string inputPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+        {
+            prefix = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--synchronized") == 0)
+        {
+            synchronized = true;
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if(input == nullptr)
+    {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+
+    std::map<uint8_t, Source> sources;
+    bool failed = false;
+    TpiuDeframer deframer(
+        [&](uint8_t id, const uint8_t* data, size_t size) {
+            Source& source = sources[id];
+            source.Bytes += size;
+            if(prefix.empty() || failed)
+            {
+                return;
+            }
+            if(source.File == nullptr)
+            {
+                const std::string path = prefix + "-" + traceSourceName(id) + ".bin";
+                source.File = std::fopen(path.c_str(), "wb");
+                if(source.File == nullptr)
+                {
+                    std::cerr << "Cannot create " << path << "\n";
+                    failed = true;
+                    return;
+                }
+            }
+            std::fwrite(data, 1, size, source.File);
+        },
+        synchronized);
+
+    uint8_t buffer[4096];
+    size_t read;
+    uint64_t total = 0;
+    while(!failed && (read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        deframer.feed(buffer, read);
+        total += read;
+    }
+
+    if(input != stdin)
+    {
+        std::fclose(input);
+    }
+
+    std::printf("%6s %-12s %14s %8s\n", "id", "source", "bytes", "share");
+    for(auto& [id, source] : sources)
+    {
+        if(source.File != nullptr)
+        {
+            std::fclose(source.File);
+        }
+        const double share = total > 0 ? static_cast<double>(source.Bytes) * 100.0 / static_cast<double>(total) : 0;
+        std::printf("  0x%02x %-12s %14llu %7.1f%%\n", static_cast<unsigned>(id), traceSourceName(id).c_str(),
+                    static_cast<unsigned long long>(source.Bytes), share);
+    }
+
+    const TpiuDeframer::Statistics& statistics = deframer.statistics();
+    std::printf("\nframes: %llu, syncs: %llu, sync losses: %llu, discarded bytes: %llu\n",
+                static_cast<unsigned long long>(statistics.Frames), static_cast<unsigned long long>(statistics.Syncs),
+                static_cast<unsigned long long>(statistics.SyncLosses),
+                static_cast<unsigned long long>(statistics.DiscardedBytes));
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+// Prints events produced by TRACE_EVENT as CSV rows. Input is raw data of single stimulus port (file or stdin).
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "orbcode/decoder/elf.hpp"
+#include "orbcode/decoder/event.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " --elf <firmware.elf> [--section <name>] [--type <name>] [input]\n"
+                  << "\n"
+                  << "Decodes TRACE_EVENT records from raw stimulus port data read from input (default: stdin).\n"
+                  << "\n"
+                  << "  --type  Print only events of given struct type as plain CSV with header row. Without it\n"
+                  << "          every row starts with type name and each type's header row is printed before its\n"
+                  << "          first event.\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string elfPath;
+    std::string section(EventDefaultSection);
+    std::string type;
+    std::string inputPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--elf") == 0 && i + 1 < argc)
+        {
+            elfPath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--section") == 0 && i + 1 < argc)
+        {
+            section = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--type") == 0 && i + 1 < argc)
+        {
+            type = argv[++i];
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(elfPath.empty())
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    try
+    {
+        const ElfFile elf = ElfFile::load(elfPath);
+        const EventSchemaTable schemas = EventSchemaTable::fromElf(elf, section);
+
+        for(const auto& entry : schemas.schemas())
+        {
+            if(!entry.second.valid())
+            {
+                std::cerr << "Schema " << entry.second.Name << ": " << entry.second.Error << "\n";
+            }
+        }
+
+        FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+        if(input == nullptr)
+        {
+            std::cerr << "Cannot open " << inputPath << "\n";
+            return 1;
+        }
+
+        // Each translation unit has its own schema record, so header rows are tracked by type name
+        std::set<std::string> printedHeaders;
+        EventDecoder decoder(schemas, [&](const Event& event) {
+            if(event.Schema == nullptr || !event.Schema->valid())
+            {
+                return;
+            }
+
+            const EventSchema& schema = *event.Schema;
+            if(!type.empty() && schema.Name != type)
+            {
+                return;
+            }
+
+            const std::string prefix = type.empty() ? schema.Name + "," : std::string();
+            if(printedHeaders.insert(schema.Name).second)
+            {
+                std::printf("%s%s\n", prefix.c_str(), eventCsvHeader(schema).c_str());
+            }
+            std::printf("%s%s\n", prefix.c_str(), formatEventCsv(schema, event.Data.data()).c_str());
+        });
+
+        uint8_t buffer[4096];
+        size_t read;
+        while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+        {
+            decoder.feed(buffer, read);
+        }
+
+        const EventDecoder::Statistics& stats = decoder.statistics();
+        if(stats.Unknown > 0 || stats.Mismatched > 0)
+        {
+            std::cerr << stats.Unknown << " events with unknown schema, " << stats.Mismatched
+                      << " events with unexpected size\n";
+        }
+
+        if(input != stdin)
+        {
+            std::fclose(input);
+        }
+    }
+    catch(const ElfError& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Prints exception handler timing (duration, self time, entry latency, nesting) from DWT exception trace. Input is
+// raw ITM stream with local timestamps (file or stdin), or TPIU formatted with --tpiu.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "orbcode/decoder/exception.hpp"
+#include "orbcode/decoder/itm.hpp"
+#include "orbcode/decoder/tpiu.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name
+                  << " [--clock <Hz>] [--prescaler <n>] [--marker-port <port>] [--synchronized] [--tpiu <id>] [input]\n"
+                  << "\n"
+                  << "Summarizes exception trace read from input (default: stdin).\n"
+                  << "\n"
+                  << "  --clock <Hz>          Timestamp clock frequency, times are printed in microseconds instead "
+                     "of ticks\n"
+                  << "  --prescaler <n>       Local timestamp prescaler (1, 4, 16 or 64, default: 1)\n"
+                  << "  --marker-port <port>  Stimulus port of pending markers (default: 30, -1 disables)\n"
+                  << "  --synchronized        Input starts at packet boundary, do not wait for sync packet\n"
+                  << "  --tpiu <id>           Input is TPIU formatted, decode trace source <id> (ITM TraceBusID)\n";
+    }
+
+    void printStatistics(const char* label, const ScopeStatistics& stats, double scale)
+    {
+        if(stats.Count == 0)
+        {
+            std::printf("  %-8s %10s\n", label, "-");
+            return;
+        }
+        std::printf("  %-8s %10llu %12.2f %12.2f %12.2f\n", label, static_cast<unsigned long long>(stats.Count),
+                    stats.Min * scale, stats.mean() * scale, stats.Max * scale);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double clock = 0;
+    double prescaler = 1;
+    int markerPort = ExceptionMarkPort;
+    bool synchronized = false;
+    int tpiuId = -1;
+    std::string inputPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--clock") == 0 && i + 1 < argc)
+        {
+            clock = std::strtod(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--prescaler") == 0 && i + 1 < argc)
+        {
+            prescaler = std::strtod(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--marker-port") == 0 && i + 1 < argc)
+        {
+            markerPort = std::atoi(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--synchronized") == 0)
+        {
+            synchronized = true;
+        }
+        else if(std::strcmp(argv[i], "--tpiu") == 0 && i + 1 < argc)
+        {
+            tpiuId = std::atoi(argv[++i]);
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(prescaler <= 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if(input == nullptr)
+    {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+
+    ExceptionAnalyzer analyzer(markerPort);
+    ItmPacketDecoder decoder([&analyzer](const ItmPacket& packet) { analyzer.add(packet); }, synchronized);
+    TpiuDeframer deframer([&decoder, tpiuId](uint8_t id, const uint8_t* data, size_t size) {
+        if(id == tpiuId)
+        {
+            decoder.feed(data, size);
+        }
+    });
+
+    uint8_t buffer[4096];
+    size_t read;
+    while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        if(tpiuId >= 0)
+        {
+            deframer.feed(buffer, read);
+        }
+        else
+        {
+            decoder.feed(buffer, read);
+        }
+    }
+
+    if(input != stdin)
+    {
+        std::fclose(input);
+    }
+
+    if(!decoder.synchronized())
+    {
+        std::cerr << "No synchronization packet found (use --synchronized for captures started before trace)\n";
+        return 1;
+    }
+
+    const double scale = clock > 0 ? prescaler * 1e6 / clock : prescaler;
+    for(const auto& [number, stats] : analyzer.exceptions())
+    {
+        std::printf("%s (%u): entries %llu, tail-chained %llu, preempted %llu, preempting %llu, max depth %zu\n",
+                    exceptionName(number).c_str(), static_cast<unsigned>(number),
+                    static_cast<unsigned long long>(stats.Entries), static_cast<unsigned long long>(stats.TailChained),
+                    static_cast<unsigned long long>(stats.Preempted),
+                    static_cast<unsigned long long>(stats.Preempting), stats.MaxDepth);
+        std::printf("  %-8s %10s %12s %12s %12s  (%s)\n", "", "count", "min", "mean", "max",
+                    clock > 0 ? "us" : "cycles");
+        printStatistics("duration", stats.Duration, scale);
+        printStatistics("self", stats.Self, scale);
+        printStatistics("latency", stats.Latency, scale);
+    }
+
+    if(analyzer.overflows() > 0)
+    {
+        std::printf("overflows: %llu (nesting state rebuilt after each)\n",
+                    static_cast<unsigned long long>(analyzer.overflows()));
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+// Prints data-access heatmap of regions watched by TraceWatchRotationStep(). Input is raw ITM stream with data trace
+// and rotation tags (file or stdin), or TPIU formatted with --tpiu.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "orbcode/decoder/itm.hpp"
+#include "orbcode/decoder/tpiu.hpp"
+#include "orbcode/decoder/watch.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name
+                  << " [--port <port>] [--names <file>] [--csv] [--synchronized] [--tpiu <id>] [input]\n"
+                  << "\n"
+                  << "Prints accesses per rotation step of each watched region, most accessed first, read from input "
+                     "(default: stdin).\n"
+                  << "\n"
+                  << "  --port <port>   Stimulus port of rotation tags (default: 29)\n"
+                  << "  --names <file>  Region names, one per line in order of TraceWatchRotationOptions::Regions\n"
+                  << "  --csv           Print results as CSV\n"
+                  << "  --synchronized  Input starts at packet boundary, do not wait for sync packet\n"
+                  << "  --tpiu <id>     Input is TPIU formatted, decode trace source <id> (ITM TraceBusID)\n";
+    }
+
+    bool loadNames(const std::string& path, std::vector<std::string>& names)
+    {
+        std::ifstream file(path);
+        if(!file)
+        {
+            return false;
+        }
+
+        std::string line;
+        while(std::getline(file, line))
+        {
+            names.push_back(line);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int port = 29;
+    bool csv = false;
+    bool synchronized = false;
+    int tpiuId = -1;
+    std::string namesPath;
+    std::string inputPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+        {
+            port = std::atoi(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--names") == 0 && i + 1 < argc)
+        {
+            namesPath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--csv") == 0)
+        {
+            csv = true;
+        }
+        else if(std::strcmp(argv[i], "--synchronized") == 0)
+        {
+            synchronized = true;
+        }
+        else if(std::strcmp(argv[i], "--tpiu") == 0 && i + 1 < argc)
+        {
+            tpiuId = std::atoi(argv[++i]);
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(port < 0 || port > 31)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> names;
+    if(!namesPath.empty() && !loadNames(namesPath, names))
+    {
+        std::cerr << "Cannot open " << namesPath << "\n";
+        return 1;
+    }
+
+    FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if(input == nullptr)
+    {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+
+    WatchHeatmap heatmap(static_cast<uint8_t>(port));
+    ItmPacketDecoder decoder([&heatmap](const ItmPacket& packet) { heatmap.add(packet); }, synchronized);
+    TpiuDeframer deframer([&decoder, tpiuId](uint8_t id, const uint8_t* data, size_t size) {
+        if(id == tpiuId)
+        {
+            decoder.feed(data, size);
+        }
+    });
+
+    uint8_t buffer[4096];
+    size_t read;
+    while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        if(tpiuId >= 0)
+        {
+            deframer.feed(buffer, read);
+        }
+        else
+        {
+            decoder.feed(buffer, read);
+        }
+    }
+
+    if(input != stdin)
+    {
+        std::fclose(input);
+    }
+
+    std::vector<std::pair<uint16_t, WatchRegionStatistics>> regions(heatmap.regions().begin(),
+                                                                    heatmap.regions().end());
+    std::stable_sort(regions.begin(), regions.end(),
+                     [](const auto& a, const auto& b) { return a.second.rate() > b.second.rate(); });
+    const double maxRate = regions.empty() ? 0.0 : regions.front().second.rate();
+
+    if(csv)
+    {
+        std::printf("region,name,accesses,steps,rate\n");
+    }
+    else
+    {
+        std::printf("%6s %-24s %12s %10s %12s\n", "region", "name", "accesses", "steps", "per step");
+    }
+
+    for(const auto& [index, stats] : regions)
+    {
+        const std::string name = index < names.size() ? names[index] : "";
+        if(csv)
+        {
+            std::printf("%u,%s,%llu,%llu,%.4f\n", static_cast<unsigned>(index), name.c_str(),
+                        static_cast<unsigned long long>(stats.Accesses), static_cast<unsigned long long>(stats.Steps),
+                        stats.rate());
+            continue;
+        }
+
+        const int bar = maxRate > 0 ? static_cast<int>(stats.rate() * 40.0 / maxRate + 0.5) : 0;
+        std::printf("%6u %-24s %12llu %10llu %12.2f %s\n", static_cast<unsigned>(index), name.c_str(),
+                    static_cast<unsigned long long>(stats.Accesses), static_cast<unsigned long long>(stats.Steps),
+                    stats.rate(), std::string(static_cast<size_t>(bar), '#').c_str());
+    }
+
+    if(heatmap.untagged() > 0 || heatmap.overflows() > 0)
+    {
+        std::cerr << "untagged packets: " << heatmap.untagged() << ", overflows: " << heatmap.overflows() << "\n";
+    }
+
+    return 0;
+}
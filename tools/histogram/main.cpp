@@ -0,0 +1,129 @@
+// Prints percentiles of histograms sent by TraceHistogramFlush(). Input is raw data of histogram stimulus port (file or
+// stdin).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "orbcode/decoder/histogram.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " [--clock <Hz>] [--each] [input]\n"
+                  << "\n"
+                  << "Prints percentiles of histograms read from input (default: stdin). Histograms with the same ID\n"
+                  << "are merged (target should flush with reset enabled).\n"
+                  << "\n"
+                  << "  --clock <Hz>  Core clock frequency, values are printed in microseconds instead of cycles\n"
+                  << "  --each        Print every received histogram instead of merged totals\n";
+    }
+
+    void printHeader(bool microseconds)
+    {
+        std::printf("%6s %12s %12s %12s %12s %12s %12s  (%s)\n", "id", "samples", "p50", "p90", "p99", "p99.9", "max",
+                    microseconds ? "us" : "cycles");
+    }
+
+    void printHistogram(const Histogram& histogram, double scale)
+    {
+        std::printf("%6u %12llu %12.2f %12.2f %12.2f %12.2f %12.2f\n", histogram.Id,
+                    static_cast<unsigned long long>(histogram.total()),
+                    static_cast<double>(histogram.percentile(0.5)) * scale,
+                    static_cast<double>(histogram.percentile(0.9)) * scale,
+                    static_cast<double>(histogram.percentile(0.99)) * scale,
+                    static_cast<double>(histogram.percentile(0.999)) * scale,
+                    static_cast<double>(histogram.percentile(1.0)) * scale);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double clock = 0;
+    bool each = false;
+    std::string inputPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--clock") == 0 && i + 1 < argc)
+        {
+            clock = std::strtod(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--each") == 0)
+        {
+            each = true;
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if(input == nullptr)
+    {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+
+    const double scale = clock > 0 ? 1e6 / clock : 1.0;
+    std::map<uint16_t, Histogram> merged;
+
+    if(each)
+    {
+        printHeader(clock > 0);
+    }
+
+    HistogramDecoder decoder([&](const Histogram& histogram) {
+        if(each)
+        {
+            printHistogram(histogram, scale);
+            return;
+        }
+
+        auto it = merged.find(histogram.Id);
+        if(it == merged.end())
+        {
+            merged.emplace(histogram.Id, histogram);
+        }
+        else if(!it->second.merge(histogram))
+        {
+            std::cerr << "Histogram " << histogram.Id << " changed layout, restarting\n";
+            it->second = histogram;
+        }
+    });
+
+    uint8_t buffer[4096];
+    size_t read;
+    while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        decoder.feed(buffer, read);
+    }
+
+    if(input != stdin)
+    {
+        std::fclose(input);
+    }
+
+    if(!each)
+    {
+        printHeader(clock > 0);
+        for(const auto& entry : merged)
+        {
+            printHistogram(entry.second, scale);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Prints every ITM/DWT packet with reconstructed time, one per line. Input is raw ITM stream (file or stdin), or TPIU
+// formatted with --tpiu.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "orbcode/decoder/funnel.hpp"
+#include "orbcode/decoder/itm.hpp"
+#include "orbcode/decoder/timestamp.hpp"
+#include "orbcode/decoder/tpiu.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " [--clock <Hz>] [--prescaler <n>] [--synchronized] [--tpiu <source>] [input]\n"
+                  << "\n"
+                  << "Prints packets read from input (default: stdin) with local time, epoch (number of overflows),\n"
+                  << "timestamp quality and global timestamp.\n"
+                  << "\n"
+                  << "  --clock <Hz>     Core clock frequency, times are printed in microseconds instead of cycles\n"
+                  << "  --prescaler <n>  Local timestamp prescaler (1, 4, 16 or 64, default: 1)\n"
+                  << "  --synchronized   Input starts at packet boundary, do not wait for sync packet\n"
+                  << "  --tpiu <source>  Input is TPIU formatted, decode trace source <source> (ITM TraceBusID or\n"
+                  << "                   name assigned by TRACE_FUNNEL_TRACE_ID, e.g. core1-itm)\n";
+    }
+
+    const char* typeName(ItmPacketType type)
+    {
+        switch(type)
+        {
+            case ItmPacketType::Sync:
+                return "sync";
+            case ItmPacketType::Overflow:
+                return "overflow";
+            case ItmPacketType::LocalTimestamp:
+                return "lts";
+            case ItmPacketType::GlobalTimestamp1:
+                return "gts1";
+            case ItmPacketType::GlobalTimestamp2:
+                return "gts2";
+            case ItmPacketType::Extension:
+                return "extension";
+            case ItmPacketType::Stimulus:
+                return "stimulus";
+            case ItmPacketType::EventCounter:
+                return "counter";
+            case ItmPacketType::Exception:
+                return "exception";
+            case ItmPacketType::PCSample:
+                return "pc";
+            case ItmPacketType::DataTracePC:
+                return "data-pc";
+            case ItmPacketType::DataTraceAddress:
+                return "data-address";
+            case ItmPacketType::DataTraceValue:
+                return "data-value";
+            case ItmPacketType::Hardware:
+                return "hardware";
+            case ItmPacketType::Reserved:
+                break;
+        }
+        return "reserved";
+    }
+
+    const char* qualityName(ItmTimeQuality quality)
+    {
+        switch(quality)
+        {
+            case ItmTimeQuality::Synchronous:
+                return "sync";
+            case ItmTimeQuality::TimestampDelayed:
+                return "ts-delayed";
+            case ItmTimeQuality::PacketDelayed:
+                return "pkt-delayed";
+            case ItmTimeQuality::BothDelayed:
+                return "delayed";
+            case ItmTimeQuality::Approximate:
+                break;
+        }
+        return "approx";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double clock = 0;
+    uint32_t prescaler = 1;
+    bool synchronized = false;
+    int tpiuId = -1;
+    std::string inputPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--clock") == 0 && i + 1 < argc)
+        {
+            clock = std::strtod(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--prescaler") == 0 && i + 1 < argc)
+        {
+            prescaler = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(std::strcmp(argv[i], "--synchronized") == 0)
+        {
+            synchronized = true;
+        }
+        else if(std::strcmp(argv[i], "--tpiu") == 0 && i + 1 < argc)
+        {
+            uint8_t id;
+            if(!parseTraceSource(argv[++i], id))
+            {
+                std::cerr << "Invalid trace source " << argv[i] << "\n";
+                return 2;
+            }
+            tpiuId = id;
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(prescaler == 0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if(input == nullptr)
+    {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+
+    ItmTimestampReconstructor timestamps(
+        [clock](const ItmTimedPacket& timed) {
+            const ItmPacket& packet = timed.Packet;
+            if(clock > 0)
+            {
+                std::printf("%14.3f", static_cast<double>(timed.Time) * 1e6 / clock);
+            }
+            else
+            {
+                std::printf("%14llu", static_cast<unsigned long long>(timed.Time));
+            }
+            std::printf(" %3u %-11s %-12s %3u %u %u 0x%08x", static_cast<unsigned>(timed.Epoch),
+                        qualityName(timed.Quality), typeName(packet.Type), static_cast<unsigned>(packet.Address),
+                        static_cast<unsigned>(packet.Size), static_cast<unsigned>(packet.Info),
+                        static_cast<unsigned>(packet.Value));
+            if(timed.GlobalValid)
+            {
+                std::printf(" global=%llu", static_cast<unsigned long long>(timed.GlobalTime));
+            }
+            std::printf("\n");
+        },
+        prescaler);
+
+    ItmPacketDecoder decoder([&timestamps](const ItmPacket& packet) { timestamps.add(packet); }, synchronized);
+    TpiuDeframer deframer([&decoder, tpiuId](uint8_t id, const uint8_t* data, size_t size) {
+        if(id == tpiuId)
+        {
+            decoder.feed(data, size);
+        }
+    });
+
+    uint8_t buffer[4096];
+    size_t read;
+    while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        if(tpiuId >= 0)
+        {
+            deframer.feed(buffer, read);
+        }
+        else
+        {
+            decoder.feed(buffer, read);
+        }
+    }
+    timestamps.flush();
+
+    if(input != stdin)
+    {
+        std::fclose(input);
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Prints messages produced by TRACE_LOG. Input is raw data of single stimulus port (file or stdin).
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "orbcode/decoder/elf.hpp"
+#include "orbcode/decoder/frame.hpp"
+#include "orbcode/decoder/log.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " --elf <firmware.elf> [--section <name>] [--framed [--no-crc]] [input]\n"
+                  << "\n"
+                  << "Decodes TRACE_LOG messages from raw stimulus port data read from input (default: stdin).\n"
+                  << "\n"
+                  << "  --framed  Messages were written as frames (ORBCODE_TRACE_LOG_WRITE set to ITMFrameWrite)\n"
+                  << "  --no-crc  Frames do not carry CRC (ITM_FRAME_CRC=0)\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string elfPath;
+    std::string section(LogDefaultSection);
+    std::string inputPath;
+    bool framed = false;
+    bool crc = true;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--elf") == 0 && i + 1 < argc)
+        {
+            elfPath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--section") == 0 && i + 1 < argc)
+        {
+            section = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--framed") == 0)
+        {
+            framed = true;
+        }
+        else if(std::strcmp(argv[i], "--no-crc") == 0)
+        {
+            crc = false;
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(elfPath.empty())
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    try
+    {
+        const ElfFile elf = ElfFile::load(elfPath);
+        const LogFormatTable formats = LogFormatTable::fromElf(elf, section);
+
+        FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+        if(input == nullptr)
+        {
+            std::cerr << "Cannot open " << inputPath << "\n";
+            return 1;
+        }
+
+        LogDecoder decoder(formats, [&elf](const LogMessage& message) {
+            if(message.Format == nullptr)
+            {
+                std::printf("<unknown message 0x%07x with %zu arguments>\n", static_cast<unsigned>(message.Id),
+                            message.Args.size());
+                return;
+            }
+
+            std::printf("%s\n", formatLogMessage(*message.Format, message.Args, &elf).c_str());
+        });
+
+        // Each frame holds exactly one message, so damaged message never affects following ones
+        FrameDecoder frames(
+            [&decoder](const uint8_t* data, size_t size) {
+                decoder.reset();
+                decoder.feed(data, size);
+            },
+            crc);
+
+        uint8_t buffer[4096];
+        size_t read;
+        while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+        {
+            if(framed)
+            {
+                frames.feed(buffer, read);
+            }
+            else
+            {
+                decoder.feed(buffer, read);
+            }
+        }
+
+        if(framed && frames.statistics().Errors > 0)
+        {
+            std::cerr << frames.statistics().Errors << " damaged frames dropped\n";
+        }
+
+        if(input != stdin)
+        {
+            std::fclose(input);
+        }
+    }
+    catch(const ElfError& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+// Prints statistical profile of functions, exception handlers and source lines from DWT PC samples symbolized with
+// ELF file. Input is raw ITM stream (file or stdin), or TPIU formatted with --tpiu.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "orbcode/decoder/elf.hpp"
+#include "orbcode/decoder/funnel.hpp"
+#include "orbcode/decoder/itm.hpp"
+#include "orbcode/decoder/pcsample.hpp"
+#include "orbcode/decoder/symbols.hpp"
+#include "orbcode/decoder/tpiu.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name
+                  << " --elf <firmware.elf> [--lines] [--top <n>] [--folded <file>] [--csv] [--clock <Hz>]\n"
+                  << "       [--cycle-tap <6|10>] [--sampling-prescaler <n>] [--report-every <samples>]\n"
+                  << "       [--synchronized] [--tpiu <source>] [input]\n"
+                  << "\n"
+                  << "Aggregates PC samples read from input (default: stdin) per function, exception and source line.\n"
+                  << "\n"
+                  << "  --lines                   Print source lines too (requires debug information)\n"
+                  << "  --top <n>                 Print only <n> most sampled functions and lines (default: 20, 0: "
+                     "all)\n"
+                  << "  --folded <file>           Write folded stacks for flame graphs, exceptions attributed to "
+                     "handlers\n"
+                  << "  --csv                     Print functions as CSV\n"
+                  << "  --clock <Hz>              Core clock, estimated time is printed in milliseconds\n"
+                  << "  --cycle-tap <6|10>        DWTOptions::CycleTap used for sampling (default: 6)\n"
+                  << "  --sampling-prescaler <n>  DWTOptions::SamplingPrescaler used for sampling (default: 1)\n"
+                  << "  --report-every <samples>  Print report each time given number of samples was received\n"
+                  << "  --synchronized            Input starts at packet boundary, do not wait for sync packet\n"
+                  << "  --tpiu <source>           Input is TPIU formatted, decode trace source <source> (ITM "
+                     "TraceBusID or\n"
+                  << "                            name like core0-itm)\n";
+    }
+
+    double percent(uint64_t value, uint64_t total)
+    {
+        return total == 0 ? 0.0 : 100.0 * static_cast<double>(value) / static_cast<double>(total);
+    }
+
+    struct Report
+    {
+        size_t Top;
+        bool Lines;
+        bool Csv;
+        // Milliseconds per sample, 0 when clock is unknown
+        double SampleTime;
+    };
+
+    void printReport(const PcSampleProfiler& profiler, const Report& report)
+    {
+        const uint64_t total = profiler.samples();
+        const std::vector<PcFunctionSamples> functions = profiler.functions();
+        const size_t count = report.Top == 0 ? functions.size() : std::min(report.Top, functions.size());
+
+        if(report.Csv)
+        {
+            std::printf("function,address,samples,percent%s\n", report.SampleTime > 0 ? ",ms" : "");
+            for(size_t i = 0; i < count; i++)
+            {
+                const PcFunctionSamples& function = functions[i];
+                std::printf("%s,0x%08llx,%llu,%.2f", function.Function->Name.c_str(),
+                            static_cast<unsigned long long>(function.Function->Address),
+                            static_cast<unsigned long long>(function.Samples), percent(function.Samples, total));
+                if(report.SampleTime > 0)
+                {
+                    std::printf(",%.3f", static_cast<double>(function.Samples) * report.SampleTime);
+                }
+                std::printf("\n");
+            }
+            return;
+        }
+
+        std::printf("samples %llu, sleep %llu (%.1f%%), unknown %llu (%.1f%%), overflows %llu\n",
+                    static_cast<unsigned long long>(total),
+                    static_cast<unsigned long long>(profiler.sleepSamples()), percent(profiler.sleepSamples(), total),
+                    static_cast<unsigned long long>(profiler.unknownSamples()),
+                    percent(profiler.unknownSamples(), total), static_cast<unsigned long long>(profiler.overflows()));
+
+        std::printf("\n%10s %7s %10s  %s\n", "samples", "%", report.SampleTime > 0 ? "ms" : "", "function");
+        for(size_t i = 0; i < count; i++)
+        {
+            const PcFunctionSamples& function = functions[i];
+            std::printf("%10llu %7.2f ", static_cast<unsigned long long>(function.Samples),
+                        percent(function.Samples, total));
+            if(report.SampleTime > 0)
+            {
+                std::printf("%10.3f", static_cast<double>(function.Samples) * report.SampleTime);
+            }
+            else
+            {
+                std::printf("%10s", "");
+            }
+            std::printf("  %s\n", function.Function->Name.c_str());
+        }
+
+        std::printf("\n%10s %7s  %s\n", "samples", "%", "context");
+        const std::vector<uint64_t>& exceptions = profiler.exceptionSamples();
+        for(size_t exception = 0; exception < exceptions.size(); exception++)
+        {
+            if(exceptions[exception] > 0)
+            {
+                std::printf("%10llu %7.2f  %s\n", static_cast<unsigned long long>(exceptions[exception]),
+                            percent(exceptions[exception], total),
+                            exceptionName(static_cast<uint16_t>(exception)).c_str());
+            }
+        }
+
+        if(report.Lines)
+        {
+            const std::vector<PcLineSamples> lines = profiler.lines();
+            const size_t lineCount = report.Top == 0 ? lines.size() : std::min(report.Top, lines.size());
+            std::printf("\n%10s %7s  %s\n", "samples", "%", "line");
+            for(size_t i = 0; i < lineCount; i++)
+            {
+                std::printf("%10llu %7.2f  %s:%u\n", static_cast<unsigned long long>(lines[i].Samples),
+                            percent(lines[i].Samples, total), lines[i].File->c_str(), lines[i].Line);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string elfPath;
+    std::string foldedPath;
+    std::string inputPath;
+    Report report = {20, false, false, 0};
+    double clock = 0;
+    unsigned cycleTap = 6;
+    unsigned samplingPrescaler = 1;
+    uint64_t reportEvery = 0;
+    bool synchronized = false;
+    int tpiuId = -1;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--elf") == 0 && i + 1 < argc)
+        {
+            elfPath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--lines") == 0)
+        {
+            report.Lines = true;
+        }
+        else if(std::strcmp(argv[i], "--top") == 0 && i + 1 < argc)
+        {
+            report.Top = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--folded") == 0 && i + 1 < argc)
+        {
+            foldedPath = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--csv") == 0)
+        {
+            report.Csv = true;
+        }
+        else if(std::strcmp(argv[i], "--clock") == 0 && i + 1 < argc)
+        {
+            clock = std::strtod(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--cycle-tap") == 0 && i + 1 < argc)
+        {
+            cycleTap = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(std::strcmp(argv[i], "--sampling-prescaler") == 0 && i + 1 < argc)
+        {
+            samplingPrescaler = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(std::strcmp(argv[i], "--report-every") == 0 && i + 1 < argc)
+        {
+            reportEvery = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--synchronized") == 0)
+        {
+            synchronized = true;
+        }
+        else if(std::strcmp(argv[i], "--tpiu") == 0 && i + 1 < argc)
+        {
+            uint8_t id;
+            if(!parseTraceSource(argv[++i], id))
+            {
+                std::cerr << "Invalid trace source " << argv[i] << "\n";
+                return 2;
+            }
+            tpiuId = id;
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(elfPath.empty() || (cycleTap != 6 && cycleTap != 10) || samplingPrescaler < 1 || samplingPrescaler > 16)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Sample is taken every SamplingPrescaler ticks of POSTCNT clock (core clock / 64 or / 1024)
+    if(clock > 0)
+    {
+        report.SampleTime = (cycleTap == 6 ? 64.0 : 1024.0) * samplingPrescaler * 1e3 / clock;
+    }
+
+    try
+    {
+        const ElfFile elf = ElfFile::load(elfPath);
+        const SymbolTable symbols = SymbolTable::fromElf(elf);
+        const LineTable lines = report.Lines ? LineTable::fromElf(elf) : LineTable();
+        if(symbols.symbols().empty())
+        {
+            std::cerr << "No function symbols in " << elfPath << "\n";
+            return 1;
+        }
+
+        FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+        if(input == nullptr)
+        {
+            std::cerr << "Cannot open " << inputPath << "\n";
+            return 1;
+        }
+
+        PcSampleProfiler profiler(symbols, lines);
+        uint64_t nextReport = reportEvery;
+        ItmPacketDecoder decoder(
+            [&](const ItmPacket& packet) {
+                profiler.add(packet);
+                if(reportEvery > 0 && profiler.samples() >= nextReport)
+                {
+                    printReport(profiler, report);
+                    std::printf("\n");
+                    std::fflush(stdout);
+                    nextReport += reportEvery;
+                }
+            },
+            synchronized);
+        TpiuDeframer deframer([&decoder, tpiuId](uint8_t id, const uint8_t* data, size_t size) {
+            if(id == tpiuId)
+            {
+                decoder.feed(data, size);
+            }
+        });
+
+        uint8_t buffer[4096];
+        size_t read;
+        while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+        {
+            if(tpiuId >= 0)
+            {
+                deframer.feed(buffer, read);
+            }
+            else
+            {
+                decoder.feed(buffer, read);
+            }
+        }
+
+        if(input != stdin)
+        {
+            std::fclose(input);
+        }
+
+        if(!decoder.synchronized())
+        {
+            std::cerr << "No synchronization packet found (use --synchronized for captures started before trace)\n";
+            return 1;
+        }
+
+        printReport(profiler, report);
+
+        if(!foldedPath.empty())
+        {
+            std::ofstream folded(foldedPath);
+            if(!folded)
+            {
+                std::cerr << "Cannot open " << foldedPath << "\n";
+                return 1;
+            }
+            profiler.writeFolded(folded);
+        }
+    }
+    catch(const ElfError& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Prints per-scope timing statistics from TRACE_SCOPE records. Input is raw data of profiler stimulus port (file or
+// stdin).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "orbcode/decoder/pmu.hpp"
+#include "orbcode/decoder/profile.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " [--clock <Hz>] [--pmu <event,...>] [input]\n"
+                  << "\n"
+                  << "Summarizes TRACE_SCOPE records read from input (default: stdin).\n"
+                  << "\n"
+                  << "  --clock <Hz>          Core clock frequency, durations are printed in microseconds instead of cycles\n"
+                  << "  --pmu <event,...>     PMU events configured on target (names like L1D_CACHE_REFILL or numbers),\n"
+                  << "                        used as headers of per-execution PMU counter columns\n";
+    }
+
+    bool parseEvents(const std::string& text, std::vector<std::string>& names)
+    {
+        size_t start = 0;
+        while(start <= text.size())
+        {
+            size_t end = text.find(',', start);
+            end = end == std::string::npos ? text.size() : end;
+
+            uint16_t event;
+            if(!parsePmuEvent(text.substr(start, end - start), event))
+            {
+                return false;
+            }
+            names.push_back(pmuEventName(event));
+            start = end + 1;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double clock = 0;
+    std::string inputPath;
+    std::vector<std::string> events;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--clock") == 0 && i + 1 < argc)
+        {
+            clock = std::strtod(argv[++i], nullptr);
+        }
+        else if(std::strcmp(argv[i], "--pmu") == 0 && i + 1 < argc)
+        {
+            if(!parseEvents(argv[++i], events))
+            {
+                std::cerr << "Unknown PMU event in " << argv[i] << "\n";
+                return 2;
+            }
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if(input == nullptr)
+    {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+
+    ProfileSummary summary;
+    ProfileDecoder decoder([&summary](const ProfileRecord& record) { summary.add(record); });
+
+    uint8_t buffer[4096];
+    size_t read;
+    while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        decoder.feed(buffer, read);
+    }
+
+    if(input != stdin)
+    {
+        std::fclose(input);
+    }
+
+    // PMU columns show mean increment per execution, unnamed counters get generic headers
+    size_t counters = 0;
+    for(const auto& [id, stats] : summary.scopes())
+    {
+        counters = stats.Counters.size() > counters ? stats.Counters.size() : counters;
+    }
+    for(size_t i = events.size(); i < counters; i++)
+    {
+        events.push_back("pmu" + std::to_string(i));
+    }
+
+    const double scale = clock > 0 ? 1e6 / clock : 1.0;
+    std::printf("%8s %10s %12s %12s %12s %14s", "scope", "count", "min", "mean", "max", "total");
+    for(size_t i = 0; i < counters; i++)
+    {
+        std::printf(" %18s", events[i].c_str());
+    }
+    std::printf("  (%s)\n", clock > 0 ? "us" : "cycles");
+    for(const auto& [id, stats] : summary.scopes())
+    {
+        std::printf("%8u %10llu %12.2f %12.2f %12.2f %14.2f", static_cast<unsigned>(id),
+                    static_cast<unsigned long long>(stats.Count), stats.Min * scale, stats.mean() * scale,
+                    stats.Max * scale, static_cast<double>(stats.Total) * scale);
+        for(size_t i = 0; i < counters; i++)
+        {
+            std::printf(" %18.2f", stats.meanCounter(i));
+        }
+        std::printf("\n");
+    }
+
+    return 0;
+}
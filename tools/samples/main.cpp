@@ -0,0 +1,122 @@
+// Prints delta-compressed samples sent by TraceDeltaWrite() as CSV. Input is raw data of samples stimulus port (file or
+// stdin).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "orbcode/decoder/delta.hpp"
+#include "orbcode/decoder/frame.hpp"
+
+using namespace orbcode::decoder;
+
+namespace
+{
+    void usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " [--stream <id>] [--framed [--no-crc]] [input]\n"
+                  << "\n"
+                  << "Prints records read from input (default: stdin) as CSV: stream, sequence number, samples.\n"
+                  << "\n"
+                  << "  --stream <id>  Print only records of given stream\n"
+                  << "  --framed       Records were written as frames\n"
+                  << "                 (ORBCODE_TRACE_DELTA_WRITE set to ITMFrameWrite)\n"
+                  << "  --no-crc       Frames do not carry CRC (ITM_FRAME_CRC=0)\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int stream = -1;
+    bool framed = false;
+    bool crc = true;
+    std::string inputPath;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--stream") == 0 && i + 1 < argc)
+        {
+            stream = std::atoi(argv[++i]);
+        }
+        else if(std::strcmp(argv[i], "--framed") == 0)
+        {
+            framed = true;
+        }
+        else if(std::strcmp(argv[i], "--no-crc") == 0)
+        {
+            crc = false;
+        }
+        else if(argv[i][0] != '-' && inputPath.empty())
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    FILE* input = inputPath.empty() ? stdin : std::fopen(inputPath.c_str(), "rb");
+    if(input == nullptr)
+    {
+        std::cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+
+    DeltaDecoder decoder([stream](const DeltaRecord& record) {
+        if(stream >= 0 && record.Stream != stream)
+        {
+            return;
+        }
+
+        std::printf("%u,%u", static_cast<unsigned>(record.Stream), static_cast<unsigned>(record.Sequence));
+        for(int32_t sample : record.Samples)
+        {
+            std::printf(",%d", static_cast<int>(sample));
+        }
+        std::printf("\n");
+    });
+
+    // Each frame holds exactly one record
+    FrameDecoder frames(
+        [&decoder](const uint8_t* data, size_t size) {
+            decoder.reset();
+            decoder.feed(data, size);
+        },
+        crc);
+
+    uint8_t buffer[4096];
+    size_t read;
+    while((read = std::fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        if(framed)
+        {
+            frames.feed(buffer, read);
+        }
+        else
+        {
+            decoder.feed(buffer, read);
+        }
+    }
+
+    if(input != stdin)
+    {
+        std::fclose(input);
+    }
+
+    const DeltaDecoder::Statistics& statistics = decoder.statistics();
+    if(statistics.Lost > 0 || statistics.Skipped > 0 || statistics.Errors > 0)
+    {
+        std::cerr << statistics.Lost << " records lost, " << statistics.Skipped << " skipped waiting for key record, "
+                  << statistics.Errors << " malformed\n";
+    }
+    if(framed && frames.statistics().Errors > 0)
+    {
+        std::cerr << frames.statistics().Errors << " damaged frames dropped\n";
+    }
+
+    return 0;
+}